@@ -102,10 +102,15 @@ bool Client::PrepareVC()
         return false;
     }
 
-    // Tune for WAN links with out-of-order delivery.
-    // Default 4000ms reorder timeout can trigger false timeouts when packets
-    // take different paths through the 32 connections on high-RTT links.
-    ((TcpVirtualChannel *)newVc.get())->setReorderTimeout(std::chrono::milliseconds(8000));
+    // The VC adapts its reorder timeout to the path; a configured value pins it.
+    if (auto reorderTimeout = ClientConfiguration::getInstance()->getReorderTimeout())
+        ((TcpVirtualChannel *)newVc.get())->setReorderTimeout(*reorderTimeout);
+    if (auto fecGroupSize = ClientConfiguration::getInstance()->getFecGroupSize())
+        ((TcpVirtualChannel *)newVc.get())->setFec(true, FecConfig{.groupSize = *fecGroupSize});
+    if (ClientConfiguration::getInstance()->getCongestionControl())
+        ((TcpVirtualChannel *)newVc.get())->setCongestionControl(true);
+    if (ClientConfiguration::getInstance()->getAcks())
+        ((TcpVirtualChannel *)newVc.get())->setAcks(true);
 
     // Set up receive callback
     newVc->setReceiveCallback([this](const char *data, size_t size) {
@@ -192,15 +197,23 @@ bool Client::PrepareUdpSocket()
 
     log_info("UDP socket created and bound successfully.");
 
+    // The VC queues flows fairly and sends low-delay DSCP classes first; without the
+    // TOS byte it still separates flows by source address.
+    if (SocketEnableRecvTos(udpSocket) != 0)
+        log_info("IP_RECVTOS unavailable; UDP traffic is classified by source only");
+
     // Start receiving data in a loop
 
-    char buffer[2500];
     while (running)
     {
+        // Receive straight into a VC frame: the payload lands behind reserved header
+        // headroom and the frame is handed to the VC by ownership, so it is never copied.
+        auto frame = VirtualChannel::allocateSendFrame();
         struct sockaddr_in srcAddr{};
         socklen_t srcAddrLen = sizeof(srcAddr);
-        ssize_t receivedBytes =
-            RecvUdpData(udpSocket, buffer, sizeof(buffer), 0, (struct sockaddr *)&srcAddr, &srcAddrLen);
+        uint8_t tos = 0;
+        ssize_t receivedBytes = RecvUdpDataWithTos(udpSocket, frame.data(), frame.size(), 0,
+                                                   (struct sockaddr *)&srcAddr, &srcAddrLen, &tos);
         if (receivedBytes < 0)
         {
             log_warnning("UDP receive error, retrying in 10s...");
@@ -216,11 +229,12 @@ bool Client::PrepareUdpSocket()
         {
             log_debug(std::format("Received {} bytes from UDP socket", receivedBytes));
            this->remoteUdpAddr = srcAddr;
+            frame.resize(static_cast<size_t>(receivedBytes));
             // send data to virtual channel
             {
                 std::lock_guard<std::mutex> lock(vcMutex);
                 if (vc && vc->isOpen()) {
-                    vc->send(buffer, receivedBytes);
+                    vc->sendFrame(std::move(frame), FlowInfo{FlowIdOf(srcAddr), tos});
                 }
             }
         }
@@ -24,6 +24,26 @@ void ClientConfiguration::setClientId(uint32_t id)
     cliClientId = id;
 }
 
+void ClientConfiguration::setReorderTimeout(std::chrono::milliseconds timeout)
+{
+    cliReorderTimeout = timeout;
+}
+
+void ClientConfiguration::setFecGroupSize(size_t groupSize)
+{
+    cliFecGroupSize = groupSize;
+}
+
+void ClientConfiguration::setCongestionControl(bool enabled)
+{
+    cliCongestionControl = enabled;
+}
+
+void ClientConfiguration::setAcks(bool enabled)
+{
+    cliAcks = enabled;
+}
+
 const std::string ClientConfiguration::getSocketAddress() const
 {
     if (cliPeerAddress.has_value())
@@ -108,6 +128,90 @@ uint32_t ClientConfiguration::getClientId() const
     return 0;
 }
 
+std::optional<std::chrono::milliseconds> ClientConfiguration::getReorderTimeout() const
+{
+    if (cliReorderTimeout.has_value())
+    {
+        return cliReorderTimeout;
+    }
+
+    if (configJson.is_null())
+    {
+        const_cast<ClientConfiguration *>(this)->LoadJsonConfig();
+    }
+
+    // Unlike the keys above this one is optional, so check it exists before reading it.
+    if (!configJson.is_null() && configJson.contains(reorderTimeoutKey) &&
+        configJson[reorderTimeoutKey].is_number_unsigned())
+    {
+        return std::chrono::milliseconds(configJson[reorderTimeoutKey].get<uint32_t>());
+    }
+
+    return std::nullopt;
+}
+
+std::optional<size_t> ClientConfiguration::getFecGroupSize() const
+{
+    if (cliFecGroupSize.has_value())
+    {
+        return cliFecGroupSize;
+    }
+
+    if (configJson.is_null())
+    {
+        const_cast<ClientConfiguration *>(this)->LoadJsonConfig();
+    }
+
+    if (!configJson.is_null() && configJson.contains(fecGroupSizeKey) &&
+        configJson[fecGroupSizeKey].is_number_unsigned())
+    {
+        return configJson[fecGroupSizeKey].get<size_t>();
+    }
+
+    return std::nullopt;
+}
+
+bool ClientConfiguration::getCongestionControl() const
+{
+    if (cliCongestionControl.has_value())
+    {
+        return cliCongestionControl.value();
+    }
+
+    if (configJson.is_null())
+    {
+        const_cast<ClientConfiguration *>(this)->LoadJsonConfig();
+    }
+
+    if (!configJson.is_null() && configJson.contains(congestionControlKey) &&
+        configJson[congestionControlKey].is_boolean())
+    {
+        return configJson[congestionControlKey].get<bool>();
+    }
+
+    return false;
+}
+
+bool ClientConfiguration::getAcks() const
+{
+    if (cliAcks.has_value())
+    {
+        return cliAcks.value();
+    }
+
+    if (configJson.is_null())
+    {
+        const_cast<ClientConfiguration *>(this)->LoadJsonConfig();
+    }
+
+    if (!configJson.is_null() && configJson.contains(acksKey) && configJson[acksKey].is_boolean())
+    {
+        return configJson[acksKey].get<bool>();
+    }
+
+    return false;
+}
+
 void ClientConfiguration::LoadJsonConfig()
 {
     try
@@ -1,4 +1,6 @@
 #pragma once
+#include <chrono>
+#include <cstddef>
 #include <nlohmann/json.hpp>
 #include <optional>
 #include <string>
@@ -19,11 +21,25 @@ class ClientConfiguration
     uint16_t getPortNumber() const;
     const std::uint16_t getLocalHostUdpPort() const;
     uint32_t getClientId() const;
+    // Fixed VC reorder timeout; unset means the VC adapts it to the path.
+    std::optional<std::chrono::milliseconds> getReorderTimeout() const;
+    // FEC on the VC's outgoing data, starting at this many frames per parity frame;
+    // unset means no FEC.
+    std::optional<size_t> getFecGroupSize() const;
+    // Pace the VC's data at the path's estimated bandwidth (off by default).
+    bool getCongestionControl() const;
+    // Send ACK frames from the start rather than once the server sends one; only for
+    // servers that understand them (off by default).
+    bool getAcks() const;
 
     void setSocketAddress(const std::string &addr);
     void setPortNumber(uint16_t port);
     void setLocalHostUdpPort(uint16_t port);
     void setClientId(uint32_t id);
+    void setReorderTimeout(std::chrono::milliseconds timeout);
+    void setFecGroupSize(size_t groupSize);
+    void setCongestionControl(bool enabled);
+    void setAcks(bool enabled);
 
   private:
     ClientConfiguration() = default;
@@ -35,9 +51,17 @@ class ClientConfiguration
     const char *peerTcpPortKey = "peerTcpPort";
     const char *localHostUdpPortKey = "localHostUdpPort";
     const char *clientIdKey = "clientId";
+    const char *reorderTimeoutKey = "reorderTimeoutMs";
+    const char *fecGroupSizeKey = "fecGroupSize";
+    const char *congestionControlKey = "congestionControl";
+    const char *acksKey = "acks";
 
     std::optional<std::string> cliPeerAddress;
     std::optional<uint16_t> cliPeerTcpPort;
     std::optional<uint16_t> cliLocalHostUdpPort;
     std::optional<uint32_t> cliClientId;
+    std::optional<std::chrono::milliseconds> cliReorderTimeout;
+    std::optional<size_t> cliFecGroupSize;
+    std::optional<bool> cliCongestionControl;
+    std::optional<bool> cliAcks;
 };
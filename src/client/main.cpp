@@ -1,6 +1,7 @@
 #include "Client.h"
 #include "ClientConfiguration.h"
 #include <Log.h>
+#include <VcProtocol.h>
 #include <chrono>
 #include <iostream>
 #include <string>
@@ -29,6 +30,14 @@ void printUsage(const char *programName)
     std::cout << "  --peer-port=PORT        Server TCP port (default: from config.json)" << std::endl;
     std::cout << "  --local-udp-port=PORT   Local UDP bind port (default: from config.json)" << std::endl;
     std::cout << "  --client-id=ID          Client ID (default: from config.json)" << std::endl;
+    std::cout << "  --reorder-timeout=MS    Fixed VC reorder timeout (default: reorderTimeoutMs from" << std::endl;
+    std::cout << "                          config.json, else adapted to the path)" << std::endl;
+    std::cout << "  --fec=N                 Send FEC parity, starting at one per N data frames and" << std::endl;
+    std::cout << "                          adapted to loss (default: fecGroupSize from config.json, else off)" << std::endl;
+    std::cout << "  --congestion-control    Pace the VC at the path's estimated bandwidth" << std::endl;
+    std::cout << "                          (default: congestionControl from config.json, else off)" << std::endl;
+    std::cout << "  --acks                  Send ACKs from the start; the server must understand them" << std::endl;
+    std::cout << "                          (default: acks from config.json, else once the server sends one)" << std::endl;
     std::cout << "  --help                  Display this help message" << std::endl;
 }
 
@@ -70,6 +79,34 @@ int main(int argc, char *argv[])
             uint32_t id = static_cast<uint32_t>(std::stoul(arg.substr(12)));
             ClientConfiguration::getInstance()->setClientId(id);
         }
+        else if (arg.find("--reorder-timeout=") == 0)
+        {
+            int ms = std::stoi(arg.substr(18));
+            if (ms <= 0)
+            {
+                std::cerr << "Invalid --reorder-timeout: must be a positive number of milliseconds" << std::endl;
+                return 1;
+            }
+            ClientConfiguration::getInstance()->setReorderTimeout(std::chrono::milliseconds(ms));
+        }
+        else if (arg.find("--fec=") == 0)
+        {
+            int groupSize = std::stoi(arg.substr(6));
+            if (groupSize < 1 || static_cast<size_t>(groupSize) > VC_FEC_MAX_GROUP)
+            {
+                std::cerr << "Invalid --fec: group size must be 1-" << VC_FEC_MAX_GROUP << std::endl;
+                return 1;
+            }
+            ClientConfiguration::getInstance()->setFecGroupSize(static_cast<size_t>(groupSize));
+        }
+        else if (arg == "--congestion-control")
+        {
+            ClientConfiguration::getInstance()->setCongestionControl(true);
+        }
+        else if (arg == "--acks")
+        {
+            ClientConfiguration::getInstance()->setAcks(true);
+        }
     }
 
     Log::getInstance().setLogLevel(logLevel);
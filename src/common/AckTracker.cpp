@@ -0,0 +1,226 @@
+#include "AckTracker.h"
+#include <algorithm>
+#include <bit>
+#include <format>
+
+std::string AckStats::format() const
+{
+    uint64_t samples = latencySamples.load(std::memory_order_relaxed);
+    uint64_t avgUs = samples ? latencyTotalUs.load(std::memory_order_relaxed) / samples : 0;
+    return std::format("[ACK] writes={} acks={} acked={} inFlight={} retransmits={} abandoned={} untracked={} "
+                       "latencyAvgMs={:.1f} latencyMaxMs={:.1f} srttMs={:.1f} rtoMs={}",
+                       writes.load(std::memory_order_relaxed), acks.load(std::memory_order_relaxed),
+                       acked.load(std::memory_order_relaxed),
+                       inFlight.load(std::memory_order_relaxed), retransmits.load(std::memory_order_relaxed),
+                       abandoned.load(std::memory_order_relaxed), untracked.load(std::memory_order_relaxed),
+                       avgUs / 1000.0, latencyMaxUs.load(std::memory_order_relaxed) / 1000.0,
+                       srttUs.load(std::memory_order_relaxed) / 1000.0,
+                       rtoUs.load(std::memory_order_relaxed) / 1000);
+}
+
+AckTracker::AckTracker(size_t capacity, std::shared_ptr<AckStats> stats_)
+    : stats(stats_ ? std::move(stats_) : std::make_shared<AckStats>())
+{
+    ring.resize(std::bit_ceil(std::max<size_t>(capacity, 2)));
+    mask = ring.size() - 1;
+    stats->rtoUs.store(std::chrono::duration_cast<std::chrono::microseconds>(VC_INITIAL_RTO).count(),
+                       std::memory_order_relaxed);
+}
+
+AckTracker::Clock::duration AckTracker::rto() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return rtoLocked();
+}
+
+AckTracker::Clock::duration AckTracker::rtoLocked() const
+{
+    if (latency.empty())
+        return VC_INITIAL_RTO;
+    // At least a millisecond of variance, so a perfectly steady path still has slack.
+    return std::clamp<Clock::duration>(latency.rto(4, std::chrono::milliseconds(1)), VC_MIN_RTO, VC_MAX_RTO);
+}
+
+void AckTracker::onSent(uint64_t messageId, Clock::time_point now)
+{
+    // Until the peer acknowledges nothing drains the queue but the timer checks; an
+    // older peer never will, so only a current one's overflow counts.
+    if (!sentQueue.try_enqueue(Sent{messageId, now}) && peerAcks.load(std::memory_order_relaxed))
+        stats->untracked.fetch_add(1, std::memory_order_relaxed);
+    // Single writer: a plain store, published after the queued send.
+    stats->writes.store(stats->writes.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void AckTracker::drainSent()
+{
+    Sent sent;
+    while (sentQueue.try_dequeue(sent))
+        trackSent(sent.messageId, sent.at);
+}
+
+void AckTracker::trackSent(uint64_t messageId, Clock::time_point at)
+{
+    if (!started)
+    {
+        base = nextId = messageId;
+        started = true;
+    }
+    if (messageId < base)
+        return; // acknowledged before its write completed, or out of the ring
+
+    if (messageId >= nextId)
+    {
+        // The ring holds the newest capacity() IDs; older unacknowledged ones drop out.
+        while (messageId - base > mask)
+        {
+            Entry &old = ring[base & mask];
+            if (!old.acked)
+            {
+                old.acked = true;
+                if (old.sent)
+                    outstanding--;
+                stats->untracked.fetch_add(1, std::memory_order_relaxed);
+            }
+            base++;
+        }
+        // IDs in between are still being written on other connections.
+        for (uint64_t id = std::max(nextId, base); id <= messageId; id++)
+            ring[id & mask] = Entry{id, {}, Clock::time_point::max(), 0, false, false};
+        nextId = messageId + 1;
+    }
+
+    Entry &e = ring[messageId & mask];
+    if (e.acked || e.sent)
+        return; // a later write of the same message times nothing
+    e.sent = true;
+    e.sentAt = at;
+    e.deadline = at + rtoLocked();
+    outstanding++;
+    publishInFlight();
+}
+
+bool AckTracker::ackOne(Entry &e, Clock::time_point now)
+{
+    if (e.acked)
+        return false;
+    e.acked = true;
+    if (!e.sent)
+        return true;
+    outstanding--;
+    if (e.retransmits == 0)
+        sampleLatency(now - e.sentAt);
+    return true;
+}
+
+void AckTracker::sampleLatency(Clock::duration elapsed)
+{
+    auto us = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    if (us < 0)
+        return;
+    latency.sample(us);
+    auto sample = static_cast<uint64_t>(us);
+    stats->latencySamples.fetch_add(1, std::memory_order_relaxed);
+    stats->latencyTotalUs.fetch_add(sample, std::memory_order_relaxed);
+    if (sample > stats->latencyMaxUs.load(std::memory_order_relaxed))
+        stats->latencyMaxUs.store(sample, std::memory_order_relaxed);
+    stats->srttUs.store(static_cast<uint64_t>(latency.srtt()), std::memory_order_relaxed);
+    stats->rtoUs.store(std::chrono::duration_cast<std::chrono::microseconds>(rtoLocked()).count(),
+                       std::memory_order_relaxed);
+}
+
+size_t AckTracker::onAck(uint64_t cumulative, const uint64_t *sack, size_t sackWords, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    drainSent();
+    peerAcks.store(true, std::memory_order_release);
+    stats->acks.fetch_add(1, std::memory_order_relaxed);
+    if (!started)
+        return 0;
+
+    size_t newlyAcked = 0;
+    const uint64_t upTo = std::min(cumulative, nextId);
+    for (uint64_t id = base; id < upTo; id++)
+        newlyAcked += ackOne(ring[id & mask], now);
+    base = std::max(base, upTo);
+
+    for (size_t w = 0; w < sackWords; w++)
+    {
+        for (uint64_t bits = sack[w]; bits != 0; bits &= bits - 1)
+        {
+            uint64_t id = cumulative + 1 + w * 64 + std::countr_zero(bits);
+            if (id >= base && id < nextId)
+                newlyAcked += ackOne(ring[id & mask], now);
+        }
+    }
+    advanceBase();
+    stats->acked.fetch_add(newlyAcked, std::memory_order_relaxed);
+    publishInFlight();
+    return newlyAcked;
+}
+
+void AckTracker::collectExpired(std::vector<uint64_t> &out, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    drainSent();
+    if (!peerAcks.load(std::memory_order_relaxed) || outstanding == 0)
+        return;
+    const Clock::duration timeout = rtoLocked();
+    for (uint64_t id = base; id < nextId; id++)
+    {
+        Entry &e = ring[id & mask];
+        if (e.acked || !e.sent)
+            continue;
+        if (e.deadline > now)
+        {
+            // First transmissions expire in about ID order (writes on different
+            // connections complete slightly out of it), so anything later that is
+            // due is caught on the next pass.
+            if (e.retransmits == 0)
+                break;
+            continue;
+        }
+        if (e.retransmits >= VC_MAX_RETRANSMITS)
+        {
+            e.acked = true;
+            outstanding--;
+            stats->abandoned.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        e.retransmits++;
+        e.deadline = now + std::min<Clock::duration>(timeout * (1 << e.retransmits), VC_MAX_RTO);
+        out.push_back(id);
+        stats->retransmits.fetch_add(1, std::memory_order_relaxed);
+    }
+    advanceBase();
+    publishInFlight();
+}
+
+AckTracker::Clock::time_point AckTracker::nextDeadline()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    drainSent();
+    Clock::time_point next = Clock::time_point::max();
+    if (!peerAcks.load(std::memory_order_relaxed) || outstanding == 0)
+        return next;
+    for (uint64_t id = base; id < nextId; id++)
+    {
+        const Entry &e = ring[id & mask];
+        if (e.acked || !e.sent)
+            continue;
+        next = std::min(next, e.deadline);
+        if (e.retransmits == 0)
+            break;
+    }
+    return next;
+}
+
+void AckTracker::advanceBase()
+{
+    while (base < nextId && ring[base & mask].acked)
+        base++;
+}
+
+void AckTracker::publishInFlight()
+{
+    stats->inFlight.store(outstanding, std::memory_order_relaxed);
+}
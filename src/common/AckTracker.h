@@ -0,0 +1,134 @@
+#pragma once
+
+#include "RttEstimator.h"
+#include "SpscQueue.h"
+#include "VcProtocol.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Acknowledgement and delivery-latency counters of an AckTracker. Readable from any
+/// thread.
+struct AckStats
+{
+    std::atomic<uint64_t> writes{0};        // data frame writes reported (send thread only)
+    std::atomic<uint64_t> acks{0};          // ACK frames processed
+    std::atomic<uint64_t> acked{0};         // messages acknowledged, cumulatively or selectively
+    std::atomic<uint64_t> retransmits{0};   // retransmission timer expiries acted on
+    std::atomic<uint64_t> abandoned{0};     // given up after VC_MAX_RETRANSMITS
+    std::atomic<uint64_t> untracked{0};     // pushed out of the tracking ring unacknowledged
+    std::atomic<uint64_t> latencySamples{0};
+    std::atomic<uint64_t> latencyTotalUs{0};
+    std::atomic<uint64_t> latencyMaxUs{0};
+    std::atomic<uint64_t> srttUs{0};
+    std::atomic<uint64_t> rtoUs{0};
+    std::atomic<uint64_t> inFlight{0}; // sent and not yet acknowledged, as of the last drain
+
+    /// One-line summary suitable for log output.
+    std::string format() const;
+};
+
+/// Sender side of the VC acknowledgement scheme: which sent messages the peer has not
+/// acknowledged yet, and when each is due for retransmission.
+///
+/// The peer's ACK frames carry a cumulative watermark (every ID below it was delivered
+/// or given up) and a SACK bitmap of the IDs it holds beyond that. The time from a
+/// message's first send to its acknowledgement is its delivery latency; as in TCP
+/// (RFC 6298) those samples give a smoothed latency and a retransmission timeout, and
+/// only first transmissions are sampled (Karn). A message unacknowledged for one RTO
+/// is due for retransmission, after which its timer backs off exponentially; after
+/// VC_MAX_RETRANSMITS it is abandoned to the peer's reorder timeout.
+///
+/// IDs are tracked in a ring, so only the latest capacity() messages can be
+/// outstanding. The send thread records sends without locking, through a queue the
+/// other calls drain; those are serialized by a mutex between the IO thread, which
+/// applies ACKs, and the reorder thread, which runs the timer.
+class AckTracker
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16; // matches SentDataCache
+
+    explicit AckTracker(size_t capacity = DEFAULT_CAPACITY, std::shared_ptr<AckStats> stats = nullptr);
+
+    /// Message `messageId` was just written to a socket. IDs arrive roughly in
+    /// increasing order: frames on different connections complete out of order, and
+    /// later writes of a message (resends, stall rescue) are ignored. Send thread only;
+    /// lock-free. A message is not timed until its send is drained by one of the calls
+    /// below, so a caller waiting on nextDeadline() must also wake within rto() of the
+    /// send to see it.
+    void onSent(uint64_t messageId, Clock::time_point now = Clock::now());
+
+    /// Apply an ACK: everything below `cumulative` and every ID `cumulative + 1 + i`
+    /// whose bit i is set in `sack`. Returns the number of messages newly acknowledged.
+    size_t onAck(uint64_t cumulative, const uint64_t *sack, size_t sackWords, Clock::time_point now = Clock::now());
+
+    /// Append to `out` every message whose retransmission timer has expired, and
+    /// re-arm their timers with backoff.
+    void collectExpired(std::vector<uint64_t> &out, Clock::time_point now = Clock::now());
+
+    /// When collectExpired() next has something to return; Clock::time_point::max()
+    /// when nothing is outstanding.
+    Clock::time_point nextDeadline();
+
+    /// True once any ACK arrived: a peer that never acknowledges is never retransmitted to.
+    bool peerAcknowledges() const
+    {
+        return peerAcks.load(std::memory_order_acquire);
+    }
+
+    Clock::duration rto() const;
+
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+  private:
+    struct Entry
+    {
+        uint64_t messageId = 0;
+        Clock::time_point sentAt{};   // first transmission
+        Clock::time_point deadline{}; // next retransmission
+        uint8_t retransmits = 0;
+        bool acked = true; // free slots count as acknowledged
+        bool sent = false; // false: stamped, waiting on its write behind a later ID's
+    };
+
+    struct Sent
+    {
+        uint64_t messageId = 0;
+        Clock::time_point at{};
+    };
+    // Sends not yet drained: enough for the IO thread's ACK rate to keep up at any
+    // realistic frame rate. A full queue drops the send, leaving the message untimed.
+    static constexpr size_t SENT_QUEUE_CAPACITY = 1 << 14;
+
+    // Caller holds mtx.
+    void drainSent();
+    void trackSent(uint64_t messageId, Clock::time_point at);
+    Clock::duration rtoLocked() const;
+    bool ackOne(Entry &e, Clock::time_point now);
+    void sampleLatency(Clock::duration elapsed);
+    void advanceBase();
+    void publishInFlight();
+
+    // Consumed under mtx, so the callers take turns as its single consumer.
+    SpscQueue<Sent, SENT_QUEUE_CAPACITY> sentQueue;
+    mutable std::mutex mtx;
+    std::vector<Entry> ring;
+    size_t mask = 0;
+    uint64_t base = 0;   // oldest ID that may be unacknowledged
+    uint64_t nextId = 0; // one past the newest ID sent
+    bool started = false;
+    size_t outstanding = 0;
+    std::atomic<bool> peerAcks{false};
+    RttEstimator latency; // over delivery latency
+    std::shared_ptr<AckStats> stats;
+};
@@ -6,12 +6,12 @@
 
 using namespace Logger;
 
-void BlockingQueue::enqueue(const std::shared_ptr<std::vector<char>> &data)
+void BlockingQueue::enqueue(PacketBuffer data)
 {
     std::function<void()> notifier;
     {
         std::lock_guard<std::mutex> lock(queueMutex);
-        queue.push(data);
+        queue.push(std::move(data));
         notifier = enqueueNotifier; // copy under lock so it can't be torn by setEnqueueNotifier
     }
     approxQueueSize.fetch_add(1, std::memory_order_relaxed);
@@ -22,13 +22,13 @@ void BlockingQueue::enqueue(const std::shared_ptr<std::vector<char>> &data)
         notifier();
 }
 
-std::shared_ptr<std::vector<char>> BlockingQueue::dequeue()
+PacketBuffer BlockingQueue::dequeue()
 {
     std::unique_lock<std::mutex> lock(queueMutex);
     queueCondVar.wait(lock, [this] { return !queue.empty() || cancelled; });
     if (cancelled)
     {
-        return nullptr;
+        return {};
     }
     auto result = std::move(queue.front());
     queue.pop();
@@ -37,12 +37,12 @@ std::shared_ptr<std::vector<char>> BlockingQueue::dequeue()
     return result;
 }
 
-std::shared_ptr<std::vector<char>> BlockingQueue::tryDequeue()
+PacketBuffer BlockingQueue::tryDequeue()
 {
     std::lock_guard<std::mutex> lock(queueMutex);
     if (queue.empty() || cancelled)
     {
-        return nullptr;
+        return {};
     }
     auto result = std::move(queue.front());
     queue.pop();
@@ -1,6 +1,8 @@
 #ifndef BLOCKING_QUEUE_H
 #define BLOCKING_QUEUE_H
 
+#include "PacketBuffer.h"
+#include <atomic>
 #include <memory>
 #include <condition_variable>
 #include <functional>
@@ -13,9 +15,11 @@ class BlockingQueue {
 public:
   BlockingQueue() {};
 
-  void enqueue(const std::shared_ptr<std::vector<char>> &data);
-  std::shared_ptr<std::vector<char>> dequeue();
-  std::shared_ptr<std::vector<char>> tryDequeue();
+  void enqueue(PacketBuffer data);
+  // Returns an empty (false) buffer once cancelWait() has been called.
+  PacketBuffer dequeue();
+  // Returns an empty (false) buffer when the queue is empty or cancelled.
+  PacketBuffer tryDequeue();
   void cancelWait();
   size_t size();
   /// Lock-free approximate size. Suitable for threshold checks where exact count is not required.
@@ -30,7 +34,7 @@ public:
 private:
 
   // Standard queue for UDP data
-  std::queue<std::shared_ptr<std::vector<char>>> queue;
+  std::queue<PacketBuffer> queue;
   std::mutex queueMutex; // Mutex for queue protection
   std::condition_variable queueCondVar; // Condition variable for producer-consumer
   bool cancelled = false;
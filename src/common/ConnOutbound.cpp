@@ -0,0 +1,116 @@
+#include "ConnOutbound.h"
+
+ConnOutbound::ConnOutbound(size_t capacity)
+{
+    size_t slotCount = 1;
+    while (slotCount < capacity)
+        slotCount <<= 1;
+    frames = std::make_unique<PacketBuffer[]>(slotCount);
+    mask = slotCount - 1;
+}
+
+bool ConnOutbound::push(PacketBuffer &frame)
+{
+    if (full())
+        return false;
+    if (count == 0)
+        progressAt = std::chrono::steady_clock::now();
+    queuedBytes += frame.size();
+    frames[(head + count) & mask] = std::move(frame);
+    count++;
+    return true;
+}
+
+ConnOutbound::FlushResult ConnOutbound::flush(SocketFd fd, std::vector<PacketBuffer> &completed,
+                                              WriteCounts &counts)
+{
+    SendSegment segments[MAX_GATHER_FRAMES];
+    while (count > 0)
+    {
+        size_t segmentCount = 0;
+        size_t batchBytes = 0;
+        for (size_t i = 0; i < count && segmentCount < MAX_GATHER_FRAMES; i++)
+        {
+            const PacketBuffer &f = frames[(head + i) & mask];
+            size_t offset = (i == 0) ? frontOffset : 0;
+            size_t length = f.size() - offset;
+            if (segmentCount > 0 && batchBytes + length > MAX_GATHER_BYTES)
+                break;
+            segments[segmentCount++] = {f.data() + offset, length};
+            batchBytes += length;
+        }
+
+        ssize_t n = (segmentCount == 1) ? SendTcpDirect(fd, segments[0].data, segments[0].length, 0)
+                                        : SendTcpGather(fd, segments, segmentCount);
+        if (n > 0)
+        {
+            progressAt = std::chrono::steady_clock::now();
+            counts.calls++;
+            counts.bytes += static_cast<uint64_t>(n);
+
+            // Retire every frame the write covered; the last one may be partial.
+            size_t written = static_cast<size_t>(n);
+            while (written > 0)
+            {
+                PacketBuffer &f = frames[head];
+                size_t remaining = f.size() - frontOffset;
+                if (written < remaining)
+                {
+                    frontOffset += written;
+                    break;
+                }
+                written -= remaining;
+                queuedBytes -= f.size();
+                frontOffset = 0;
+                completed.push_back(std::move(f));
+                f = PacketBuffer();
+                head = (head + 1) & mask;
+                count--;
+            }
+            // After a short write the next call says whether the socket is full.
+        }
+        else if (n == SOCKET_ERROR_INTERRUPTED)
+        {
+            continue;
+        }
+        else if (n == SOCKET_ERROR_WOULD_BLOCK)
+        {
+            return FlushResult::WouldBlock;
+        }
+        else
+        {
+            return FlushResult::Error;
+        }
+    }
+    return FlushResult::Drained;
+}
+
+void ConnOutbound::takeAll(std::vector<PacketBuffer> &out)
+{
+    for (; count > 0; count--)
+    {
+        out.push_back(std::move(frames[head]));
+        frames[head] = PacketBuffer();
+        head = (head + 1) & mask;
+    }
+    head = 0;
+    frontOffset = 0;
+    queuedBytes = 0;
+}
+
+void ConnOutbound::takeUnstarted(std::vector<PacketBuffer> &out)
+{
+    if (frontOffset == 0)
+    {
+        takeAll(out);
+        return;
+    }
+    for (size_t i = 1; i < count; i++)
+    {
+        PacketBuffer &f = frames[(head + i) & mask];
+        queuedBytes -= f.size();
+        out.push_back(std::move(f));
+        f = PacketBuffer();
+    }
+    count = 1;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "PacketBuffer.h"
+#include "Socket.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Frames committed to one TCP connection but not yet fully handed to the kernel.
+///
+/// Owned by the send thread, one per connection slot. Frames are written strictly in
+/// order; `frontOffset` is the write cursor into the front frame, so a partial write
+/// just leaves the cursor mid-frame and the next flush() resumes there. flush() never
+/// waits: when the socket would block it returns and the caller polls for POLLOUT, so
+/// a stalled connection only holds back the few frames already committed to it.
+///
+/// flush() gathers up to MAX_GATHER_FRAMES queued frames (at most MAX_GATHER_BYTES)
+/// into one sendmsg()/WSASend(), so a backlog of small frames costs one syscall per
+/// batch instead of one per frame. A short write may end inside any of them.
+///
+/// A fixed power-of-two ring (no per-frame allocation). Not thread-safe.
+class ConnOutbound
+{
+  public:
+    static constexpr size_t DEFAULT_CAPACITY = 32; // rounded up to a power of two
+    static constexpr size_t MAX_GATHER_FRAMES = 32;
+    static_assert(MAX_GATHER_FRAMES <= SEND_GATHER_MAX_SEGMENTS);
+    static constexpr size_t MAX_GATHER_BYTES = 64 * 1024;
+
+    enum class FlushResult
+    {
+        Drained,    // everything queued was written
+        WouldBlock, // the socket buffer is full; wait for POLLOUT
+        Error       // the socket is dead; takeAll() the frames and drop the connection
+    };
+
+    /// Accumulated by flush(): successful write syscalls and the bytes they took.
+    struct WriteCounts
+    {
+        uint64_t calls = 0;
+        uint64_t bytes = 0;
+    };
+
+    explicit ConnOutbound(size_t capacity = DEFAULT_CAPACITY);
+
+    ConnOutbound(ConnOutbound &&) = default;
+    ConnOutbound &operator=(ConnOutbound &&) = default;
+
+    /// False (and `frame` untouched) when the ring is full.
+    bool push(PacketBuffer &frame);
+
+    /// Write as much as the non-blocking socket takes. Frames written completely are
+    /// moved onto the end of `completed`, in order.
+    FlushResult flush(SocketFd fd, std::vector<PacketBuffer> &completed, WriteCounts &counts);
+
+    /// Move every queued frame, including a partially written front frame, onto the
+    /// end of `out` and reset. Used when the connection dies or is replaced: the frames
+    /// are resent whole elsewhere (the receiver dedups by messageId).
+    void takeAll(std::vector<PacketBuffer> &out);
+
+    /// Like takeAll(), but a partially written front frame stays queued: its remaining
+    /// bytes still belong to this TCP stream. Used to move work off a quarantined
+    /// connection without breaking its framing.
+    void takeUnstarted(std::vector<PacketBuffer> &out);
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+    bool full() const
+    {
+        return count == mask + 1;
+    }
+    size_t size() const
+    {
+        return count;
+    }
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+    /// Bytes still to write, counting only the unwritten tail of the front frame.
+    size_t pendingBytes() const
+    {
+        return queuedBytes - frontOffset;
+    }
+    /// True when the front frame is partly in the TCP stream. Its remaining bytes must
+    /// go out on this connection or the connection must be dropped.
+    bool midFrame() const
+    {
+        return frontOffset > 0;
+    }
+    /// Last time bytes were written, or when the ring became non-empty.
+    std::chrono::steady_clock::time_point lastProgress() const
+    {
+        return progressAt;
+    }
+    /// The front frame (the one flush() writes next). Only valid when !empty().
+    const PacketBuffer &front() const
+    {
+        return frames[head];
+    }
+
+    /// The connection these frames belong to. The send thread compares it against the
+    /// current table entry to notice a replaced slot.
+    const void *owner = nullptr;
+
+  private:
+    std::unique_ptr<PacketBuffer[]> frames;
+    size_t mask = 0;
+    size_t head = 0;
+    size_t count = 0;
+    size_t frontOffset = 0;
+    size_t queuedBytes = 0;
+    std::chrono::steady_clock::time_point progressAt{};
+};
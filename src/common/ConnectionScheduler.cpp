@@ -0,0 +1,229 @@
+#include "ConnectionScheduler.h"
+#include <algorithm>
+
+const char *SchedulerPolicyName(SchedulerPolicy policy)
+{
+    switch (policy)
+    {
+    case SchedulerPolicy::WeightedScore:
+        return "weighted-score";
+    case SchedulerPolicy::RoundRobin:
+        return "round-robin";
+    case SchedulerPolicy::LowestRtt:
+        return "lowest-rtt";
+    case SchedulerPolicy::CwndWeighted:
+        return "cwnd-weighted";
+    case SchedulerPolicy::EarliestDelivery:
+        return "earliest-delivery";
+    }
+    return "unknown";
+}
+
+std::unique_ptr<ConnectionScheduler> MakeConnectionScheduler(SchedulerPolicy policy, size_t numSlots)
+{
+    switch (policy)
+    {
+    case SchedulerPolicy::RoundRobin:
+        return std::make_unique<RoundRobinScheduler>(numSlots);
+    case SchedulerPolicy::LowestRtt:
+        return std::make_unique<LowestRttScheduler>(numSlots);
+    case SchedulerPolicy::CwndWeighted:
+        return std::make_unique<CwndWeightedScheduler>(numSlots);
+    case SchedulerPolicy::EarliestDelivery:
+        return std::make_unique<EarliestDeliveryScheduler>(numSlots);
+    case SchedulerPolicy::WeightedScore:
+        break;
+    }
+    return std::make_unique<WeightedScoreScheduler>(numSlots);
+}
+
+RankedScheduler::RankedScheduler(size_t numSlots) : keys(numSlots), selectable(numSlots, 0)
+{
+    for (size_t i = 0; i < numSlots; i++)
+        keys[i] = {0, 0, i};
+}
+
+size_t RankedScheduler::select(size_t /*frameBytes*/)
+{
+    if (ranked.empty())
+        return NONE;
+    size_t slot = ranked.begin()->slot;
+    onSelected(slot);
+    return slot;
+}
+
+void RankedScheduler::onMetricsUpdate(size_t slot, const SlotMetrics &metrics)
+{
+    if (slot >= keys.size())
+        return;
+    int64_t rank = rankOf(slot, metrics);
+    place(slot, metrics.selectable(), rank);
+}
+
+void RankedScheduler::onSelected(size_t slot)
+{
+    auto node = ranked.extract(keys[slot]);
+    keys[slot].turn = ++nextTurn;
+    node.value() = keys[slot];
+    ranked.insert(std::move(node));
+}
+
+void RankedScheduler::setRank(size_t slot, int64_t rank)
+{
+    place(slot, selectable[slot] != 0, rank);
+}
+
+void RankedScheduler::place(size_t slot, bool isSelectable, int64_t rank)
+{
+    if (selectable[slot] && isSelectable)
+    {
+        if (keys[slot].rank == rank)
+            return;
+        // Re-key in place: reuse the set node instead of freeing and allocating one.
+        auto node = ranked.extract(keys[slot]);
+        keys[slot].rank = rank;
+        node.value() = keys[slot];
+        ranked.insert(std::move(node));
+        return;
+    }
+    if (selectable[slot])
+        ranked.erase(keys[slot]);
+    keys[slot].rank = rank;
+    if (isSelectable)
+        ranked.insert(keys[slot]);
+    selectable[slot] = isSelectable ? 1 : 0;
+}
+
+int WeightedScoreScheduler::score(const SlotMetrics &metrics)
+{
+    const auto &info = metrics.info;
+    if (info.isInExponentialBackoff)
+        return -1;
+
+    int score = 10000;
+    // RTT is weighted more heavily than cwnd to prefer low-latency paths.
+    // A 50ms RTT difference (100pt) now outweighs a 20KB cwnd difference (100pt),
+    // whereas the old weights let a high-cwnd/high-RTT connection beat a
+    // low-cwnd/low-RTT one (cwnd/100 vs rtt/500 made cwnd 5x more influential).
+    score += static_cast<int>(info.congestionWindowBytes / 200);
+    score -= static_cast<int>(info.smoothedRttUs / 200);
+    score -= static_cast<int>(info.bytesInFlight / 200);
+    score -= static_cast<int>(info.timeoutEpisodes) * 200;
+    score -= static_cast<int>(metrics.failCount) * 200;
+
+    // A backlogged slot stays eligible but ranks last: its kernel buffer is full, so a
+    // frame committed there would only queue behind the backlog.
+    if (score > 0 && metrics.backlogged)
+        score = 0;
+    return score > 0 ? score : 0;
+}
+
+int64_t WeightedScoreScheduler::rankOf(size_t /*slot*/, const SlotMetrics &metrics)
+{
+    return -static_cast<int64_t>(score(metrics));
+}
+
+int64_t RoundRobinScheduler::rankOf(size_t /*slot*/, const SlotMetrics & /*metrics*/)
+{
+    return 0;
+}
+
+int64_t LowestRttScheduler::rankOf(size_t /*slot*/, const SlotMetrics &metrics)
+{
+    const auto &info = metrics.info;
+    int64_t tier = 0;
+    if (info.isInExponentialBackoff)
+        tier = 2;
+    else if (metrics.backlogged || (info.valid && info.bytesInFlight >= info.congestionWindowBytes))
+        tier = 1;
+    return (tier << 40) + info.smoothedRttUs;
+}
+
+CwndWeightedScheduler::CwndWeightedScheduler(size_t numSlots)
+    : RankedScheduler(numSlots), pass(numSlots, 0), weight(numSlots, DEFAULT_WEIGHT)
+{
+}
+
+int64_t CwndWeightedScheduler::rankOf(size_t slot, const SlotMetrics &metrics)
+{
+    const auto &info = metrics.info;
+    weight[slot] = (info.valid && info.congestionWindowBytes > 0) ? info.congestionWindowBytes : DEFAULT_WEIGHT;
+    bool becomesSelectable = !isSelectable(slot) && metrics.selectable();
+    if (becomesSelectable && anySelectable())
+        pass[slot] = std::max(pass[slot], bestRank());
+    return pass[slot];
+}
+
+void CwndWeightedScheduler::onSelected(size_t /*slot*/)
+{
+    // The pass only moves when bytes are actually written (onSendComplete).
+}
+
+void CwndWeightedScheduler::onSendComplete(size_t slot, size_t bytes)
+{
+    if (slot >= pass.size())
+        return;
+    pass[slot] += static_cast<int64_t>(bytes) * STRIDE_SCALE / weight[slot];
+    setRank(slot, pass[slot]);
+}
+
+EarliestDeliveryScheduler::EarliestDeliveryScheduler(size_t numSlots) : RankedScheduler(numSlots), paths(numSlots)
+{
+    for (auto &path : paths)
+    {
+        path.usPerByte = static_cast<double>(DEFAULT_RTT_US) / DEFAULT_CWND;
+        path.halfRttUs = DEFAULT_RTT_US / 2;
+    }
+}
+
+int64_t EarliestDeliveryScheduler::nowUs() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int64_t EarliestDeliveryScheduler::rankOf(size_t slot, const SlotMetrics &metrics)
+{
+    Path &path = paths[slot];
+    const auto &info = metrics.info;
+    int64_t now = nowUs();
+
+    path.tier = info.isInExponentialBackoff ? 2 : (metrics.backlogged ? 1 : 0);
+    if (info != path.sampled)
+    {
+        // A fresh sample: what the kernel still holds replaces our running estimate.
+        path.sampled = info;
+        bool known = info.valid && info.smoothedRttUs > 0 && info.congestionWindowBytes > 0;
+        uint32_t rttUs = known ? info.smoothedRttUs : DEFAULT_RTT_US;
+        uint32_t cwnd = known ? info.congestionWindowBytes : DEFAULT_CWND;
+        path.usPerByte = static_cast<double>(rttUs) / cwnd;
+        path.halfRttUs = rttUs / 2;
+        path.drainEndUs = now + static_cast<int64_t>(info.notSentBytes * path.usPerByte);
+    }
+    return arrivalRank(path, now);
+}
+
+void EarliestDeliveryScheduler::onSendComplete(size_t slot, size_t bytes)
+{
+    if (slot >= paths.size())
+        return;
+    Path &path = paths[slot];
+    int64_t now = nowUs();
+    path.drainEndUs = std::max(path.drainEndUs, now) + static_cast<int64_t>(bytes * path.usPerByte);
+    setRank(slot, arrivalRank(path, now));
+}
+
+int64_t EarliestDeliveryScheduler::predictedArrivalUs(size_t slot, size_t frameBytes) const
+{
+    const Path &path = paths[slot];
+    int64_t now = nowUs();
+    return std::max(path.drainEndUs, now) - now + path.halfRttUs +
+           static_cast<int64_t>(frameBytes * path.usPerByte);
+}
+
+int64_t EarliestDeliveryScheduler::arrivalRank(const Path &path, int64_t now) const
+{
+    return path.tier * TIER_SPAN + std::max(path.drainEndUs, now) + path.halfRttUs +
+           static_cast<int64_t>(NOMINAL_FRAME_BYTES * path.usPerByte);
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "TcpConnection.h"
+#include <cstddef>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+
+/// Slot-selection policies for a VC's data connections.
+enum class SchedulerPolicy
+{
+    WeightedScore,   // cwnd, RTT, in-flight bytes and failures folded into one score
+    RoundRobin,      // every usable slot in turn, metrics ignored
+    LowestRtt,       // lowest smoothed RTT among slots with congestion-window space
+    CwndWeighted,    // bytes shared in proportion to each slot's congestion window
+    EarliestDelivery // earliest predicted arrival from unsent bytes, cwnd/srtt and srtt
+};
+
+const char *SchedulerPolicyName(SchedulerPolicy policy);
+
+/// What the send thread knows about one data slot. A slot is selectable only while
+/// it is connected, not quarantined and its outbound queue has room.
+struct SlotMetrics
+{
+    bool connected = false;
+    bool hasRoom = true;
+    bool backlogged = false;  // last write hit WOULD_BLOCK; waiting for POLLOUT
+    bool quarantined = false; // stalled; its frames were re-sent on other slots
+    uint64_t failCount = 0;   // ConnSendStats::reenqueueCount
+    TcpConnection::TcpConnectionRuntimeInfo info{};
+
+    bool selectable() const
+    {
+        return connected && hasRoom && !quarantined;
+    }
+
+    bool operator==(const SlotMetrics &) const = default;
+};
+
+/// Picks the data slot for each outgoing frame.
+///
+/// The send thread reports every change to a slot's metrics through onMetricsUpdate()
+/// and every completed write through onSendComplete(); implementations keep whatever
+/// ranking they need up to date there, so select() does not rescan the slots. Owned
+/// and called only by the send thread.
+class ConnectionScheduler
+{
+  public:
+    static constexpr size_t NONE = SIZE_MAX;
+
+    virtual ~ConnectionScheduler() = default;
+
+    /// Slot for a frame of `frameBytes`, or NONE when no slot is selectable.
+    virtual size_t select(size_t frameBytes) = 0;
+    virtual void onSendComplete(size_t slot, size_t bytes)
+    {
+        (void)slot;
+        (void)bytes;
+    }
+    virtual void onMetricsUpdate(size_t slot, const SlotMetrics &metrics) = 0;
+};
+
+std::unique_ptr<ConnectionScheduler> MakeConnectionScheduler(SchedulerPolicy policy, size_t numSlots);
+
+/// Base for policies that rank slots by a key: selectable slots live in an ordered set,
+/// smallest key first, so select() is O(1) and a key change is O(log n). Slots with
+/// equal rank rotate: a selected slot moves behind the others of its rank.
+class RankedScheduler : public ConnectionScheduler
+{
+  public:
+    explicit RankedScheduler(size_t numSlots);
+
+    size_t select(size_t frameBytes) override;
+    void onMetricsUpdate(size_t slot, const SlotMetrics &metrics) override;
+
+  protected:
+    /// Smaller is preferred.
+    virtual int64_t rankOf(size_t slot, const SlotMetrics &metrics) = 0;
+    /// Called after `slot` was returned by select(). The default rotates it behind its
+    /// equals.
+    virtual void onSelected(size_t slot);
+
+    void setRank(size_t slot, int64_t rank);
+    bool isSelectable(size_t slot) const
+    {
+        return selectable[slot] != 0;
+    }
+    /// Rank of the preferred selectable slot. Only valid when one exists.
+    int64_t bestRank() const
+    {
+        return ranked.begin()->rank;
+    }
+    bool anySelectable() const
+    {
+        return !ranked.empty();
+    }
+
+  private:
+    struct Key
+    {
+        int64_t rank;
+        uint64_t turn; // rotation order among equal ranks
+        size_t slot;
+        auto operator<=>(const Key &) const = default;
+    };
+    void place(size_t slot, bool isSelectable, int64_t rank);
+
+    std::set<Key> ranked;
+    std::vector<Key> keys;
+    std::vector<char> selectable;
+    uint64_t nextTurn = 0;
+};
+
+/// The long-standing VC policy: a higher score is better; slots in exponential backoff
+/// are used only when nothing else is selectable, backlogged ones just before them.
+class WeightedScoreScheduler : public RankedScheduler
+{
+  public:
+    using RankedScheduler::RankedScheduler;
+    static int score(const SlotMetrics &metrics);
+
+  protected:
+    int64_t rankOf(size_t slot, const SlotMetrics &metrics) override;
+};
+
+class RoundRobinScheduler : public RankedScheduler
+{
+  public:
+    using RankedScheduler::RankedScheduler;
+
+  protected:
+    int64_t rankOf(size_t slot, const SlotMetrics &metrics) override;
+};
+
+/// Lowest smoothed RTT first, among slots whose congestion window still has space
+/// (bytes in flight below cwnd) and whose socket is not backlogged; the rest follow
+/// in the same RTT order.
+class LowestRttScheduler : public RankedScheduler
+{
+  public:
+    using RankedScheduler::RankedScheduler;
+
+  protected:
+    int64_t rankOf(size_t slot, const SlotMetrics &metrics) override;
+};
+
+/// Stride scheduling by congestion window: every completed write advances its slot's
+/// pass by bytes / cwnd and the slot with the lowest pass goes next, so over time each
+/// slot carries bytes in proportion to its cwnd. A slot that becomes selectable again
+/// starts from the current lowest pass instead of catching up in a burst.
+class CwndWeightedScheduler : public RankedScheduler
+{
+  public:
+    explicit CwndWeightedScheduler(size_t numSlots);
+
+    void onSendComplete(size_t slot, size_t bytes) override;
+
+  protected:
+    int64_t rankOf(size_t slot, const SlotMetrics &metrics) override;
+    void onSelected(size_t slot) override;
+
+  private:
+    static constexpr int64_t STRIDE_SCALE = 1 << 20;
+    static constexpr uint32_t DEFAULT_WEIGHT = 64 * 1024; // bytes, when cwnd is unknown
+
+    std::vector<int64_t> pass;
+    std::vector<uint32_t> weight;
+};
+
+/// Earliest predicted arrival. A frame written to a slot reaches the peer once the
+/// bytes queued ahead of it in the socket have drained at the slot's delivery rate
+/// (cwnd / srtt) and then crossed the path (srtt / 2); the slot where that happens
+/// first gets the frame, so frames arrive close to send order and the peer's reorder
+/// window stays shallow.
+///
+/// Each slot keeps the time its queue drains: a new TCP_INFO sample resets it to now +
+/// notSentBytes at the sampled rate, every completed write extends it. Ranks are
+/// absolute times, so they stay comparable without rescanning; an idle slot's rank is
+/// as of its last update, which the send thread refreshes with each sample. Slots in
+/// exponential backoff come last and backlogged ones just before them. Slots without
+/// TCP_INFO (Windows) use one default rate, which shares bytes evenly.
+class EarliestDeliveryScheduler : public RankedScheduler
+{
+  public:
+    explicit EarliestDeliveryScheduler(size_t numSlots);
+
+    void onSendComplete(size_t slot, size_t bytes) override;
+
+    /// Predicted arrival, in microseconds from now, of a `frameBytes` frame written to
+    /// `slot` now.
+    int64_t predictedArrivalUs(size_t slot, size_t frameBytes) const;
+
+  protected:
+    int64_t rankOf(size_t slot, const SlotMetrics &metrics) override;
+    /// Monotonic microseconds; virtual so tests can drive time.
+    virtual int64_t nowUs() const;
+
+  private:
+    static constexpr uint32_t DEFAULT_RTT_US = 10000;     // when TCP_INFO is unavailable
+    static constexpr uint32_t DEFAULT_CWND = 64 * 1024;   // bytes, likewise
+    static constexpr size_t NOMINAL_FRAME_BYTES = 2048;   // about one full data frame
+    static constexpr int64_t TIER_SPAN = int64_t(1) << 52; // us; far beyond any uptime
+
+    struct Path
+    {
+        TcpConnection::TcpConnectionRuntimeInfo sampled{};
+        int64_t drainEndUs = 0; // when the bytes already written will have left
+        double usPerByte = 0;
+        int64_t halfRttUs = 0;
+        int64_t tier = 0;
+    };
+    int64_t arrivalRank(const Path &path, int64_t now) const;
+
+    std::vector<Path> paths;
+};
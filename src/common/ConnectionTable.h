@@ -0,0 +1,21 @@
+#pragma once
+
+#include "EpochProtected.h"
+#include "TcpConnection.h"
+#include "TcpVCWriteThread.h"
+#include <memory>
+#include <vector>
+
+/// One immutable version of a VC's per-slot state. Index i of each vector belongs to
+/// connection slot i. TcpVirtualChannel publishes a new version on every
+/// replaceConnection(); the IO thread, the send thread and getNetworkScore() read the
+/// current one through an EpochProtected pin instead of copying the vectors.
+struct ConnectionTable
+{
+    std::vector<TcpConnectionSp> connections;
+    std::vector<std::shared_ptr<ConnSendStats>> sendStats;
+    std::vector<std::shared_ptr<SocketStatus>> statuses;
+};
+
+using SharedConnectionTable = EpochProtected<ConnectionTable>;
+typedef std::shared_ptr<SharedConnectionTable> SharedConnectionTableSp;
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/// Atomically swappable pointer to an immutable T with epoch-based reclamation.
+///
+/// Readers pin the current version through a Reader, which owns one of MAX_READERS
+/// per-thread epoch slots: a pin is a store to the reader's own cache line plus an
+/// acquire load of the pointer, with no refcounting and no shared RMW. Writers (rare)
+/// copy the current version, modify the copy and publish it; the old version is
+/// retired with the epoch it was replaced in and freed once every pinned reader has
+/// moved past that epoch.
+///
+/// When all slots are taken, a Reader falls back to reading under the writer mutex.
+template <typename T>
+class EpochProtected
+{
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> epoch{IDLE};
+        std::atomic<bool> claimed{false};
+    };
+
+  public:
+    static constexpr size_t MAX_READERS = 16;
+
+    explicit EpochProtected(T initial) : current(new T(std::move(initial))) {}
+
+    ~EpochProtected()
+    {
+        delete current.load(std::memory_order_relaxed);
+        for (auto &r : retired)
+            delete r.ptr;
+    }
+
+    EpochProtected(const EpochProtected &) = delete;
+    EpochProtected &operator=(const EpochProtected &) = delete;
+
+    /// Keeps the version it was pinned on alive until destroyed or reset().
+    class Guard
+    {
+      public:
+        Guard() = default;
+        Guard(Guard &&other) noexcept
+            : slot(std::exchange(other.slot, nullptr)), lock(std::move(other.lock)),
+              ptr(std::exchange(other.ptr, nullptr))
+        {
+        }
+        Guard &operator=(Guard &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                slot = std::exchange(other.slot, nullptr);
+                lock = std::move(other.lock);
+                ptr = std::exchange(other.ptr, nullptr);
+            }
+            return *this;
+        }
+        ~Guard()
+        {
+            reset();
+        }
+
+        const T &operator*() const
+        {
+            return *ptr;
+        }
+        const T *operator->() const
+        {
+            return ptr;
+        }
+        const T *get() const
+        {
+            return ptr;
+        }
+
+        /// Unpin early, e.g. before blocking.
+        void reset()
+        {
+            if (slot)
+                slot->epoch.store(IDLE, std::memory_order_release);
+            slot = nullptr;
+            if (lock.owns_lock())
+                lock.unlock();
+            ptr = nullptr;
+        }
+
+      private:
+        friend class EpochProtected;
+        Slot *slot = nullptr;
+        std::unique_lock<std::mutex> lock;
+        const T *ptr = nullptr;
+    };
+
+    /// A reading thread's registration. Holds at most one Guard at a time.
+    class Reader
+    {
+      public:
+        explicit Reader(EpochProtected &owner_) : owner(owner_)
+        {
+            for (auto &s : owner.slots)
+            {
+                bool expected = false;
+                if (s.claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                {
+                    slot = &s;
+                    break;
+                }
+            }
+        }
+        ~Reader()
+        {
+            if (slot)
+                slot->claimed.store(false, std::memory_order_release);
+        }
+
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+        Guard pin()
+        {
+            Guard g;
+            if (!slot)
+            {
+                g.lock = std::unique_lock<std::mutex>(owner.writeMutex);
+                g.ptr = owner.current.load(std::memory_order_acquire);
+                return g;
+            }
+            // seq_cst on the slot store and the pointer load pairs with the writer's
+            // exchange + epoch bump + slot scan: either the writer sees this pin, or this
+            // load sees the new version.
+            slot->epoch.store(owner.epoch.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+            g.slot = slot;
+            g.ptr = owner.current.load(std::memory_order_seq_cst);
+            return g;
+        }
+
+      private:
+        EpochProtected &owner;
+        Slot *slot = nullptr;
+    };
+
+    /// Publish a modified copy of the current version: mutate(T&) edits the copy.
+    template <typename Fn>
+    void update(Fn &&mutate)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        auto next = std::make_unique<T>(*current.load(std::memory_order_relaxed));
+        mutate(*next);
+        T *old = current.exchange(next.release(), std::memory_order_seq_cst);
+        uint64_t retiredIn = epoch.fetch_add(1, std::memory_order_seq_cst);
+        retired.push_back({old, retiredIn});
+        reclaimLocked();
+    }
+
+    /// Free retired versions no reader can still hold. update() does this too; call it
+    /// periodically if updates are rare and versions are large.
+    void reclaim()
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        reclaimLocked();
+    }
+
+    /// Versions retired but not yet freed.
+    size_t retiredCount()
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        return retired.size();
+    }
+
+  private:
+    static constexpr uint64_t IDLE = std::numeric_limits<uint64_t>::max();
+
+    struct Retired
+    {
+        T *ptr;
+        uint64_t epoch; // readers pinned at or before this epoch may still hold ptr
+    };
+
+    void reclaimLocked()
+    {
+        uint64_t oldestPinned = IDLE;
+        for (auto &s : slots)
+        {
+            uint64_t e = s.epoch.load(std::memory_order_seq_cst);
+            if (e < oldestPinned)
+                oldestPinned = e;
+        }
+        size_t kept = 0;
+        for (auto &r : retired)
+        {
+            if (r.epoch < oldestPinned)
+                delete r.ptr;
+            else
+                retired[kept++] = r;
+        }
+        retired.resize(kept);
+    }
+
+    std::atomic<T *> current;
+    std::atomic<uint64_t> epoch{0};
+    std::array<Slot, MAX_READERS> slots;
+
+    std::mutex writeMutex; // serialises update() and reclaim(); guards `retired`
+    std::vector<Retired> retired;
+};
@@ -0,0 +1,213 @@
+#include "FecDecoder.h"
+#include <algorithm>
+#include <cstring>
+
+FecDecoder::FecDecoder(std::shared_ptr<FecStats> stats_)
+    : stats(stats_ ? std::move(stats_) : std::make_shared<FecStats>())
+{
+}
+
+void FecDecoder::onParity(const PacketBuffer &frame)
+{
+    stats->parityReceived.fetch_add(1, std::memory_order_relaxed);
+    active = true;
+
+    Parity parity;
+    const char *ptr = frame.data();
+    VCHeader header;
+    std::memcpy(&header, ptr, sizeof(header));
+    ptr += sizeof(header);
+    parity.first = header.messageId;
+    parity.count = *reinterpret_cast<const uint8_t *>(ptr);
+    ptr += sizeof(uint8_t);
+    std::memcpy(&parity.lengthXor, ptr, sizeof(uint16_t));
+    ptr += sizeof(uint16_t);
+    uint16_t dataLength;
+    std::memcpy(&dataLength, ptr, sizeof(uint16_t));
+    ptr += sizeof(uint16_t);
+    std::memcpy(parity.offsets, ptr, parity.count * sizeof(uint16_t));
+    ptr += parity.count * sizeof(uint16_t);
+    for (size_t i = 1; i < parity.count; i++)
+    {
+        if (parity.offsets[i] <= parity.offsets[i - 1])
+        {
+            stats->parityLost.fetch_add(1, std::memory_order_relaxed);
+            return; // malformed
+        }
+    }
+    parity.data = PacketBuffer::copyOf(ptr, dataLength);
+
+    if (pending.size() >= MAX_PENDING)
+    {
+        pending.pop_front();
+        stats->parityLost.fetch_add(1, std::memory_order_relaxed);
+    }
+    pending.push_back(std::move(parity));
+}
+
+int FecDecoder::Parity::member(uint64_t messageId) const
+{
+    if (count == 0 || messageId < first || messageId - first > offsets[count - 1])
+        return -1;
+    const uint16_t offset = static_cast<uint16_t>(messageId - first);
+    const uint16_t *it = std::lower_bound(offsets, offsets + count, offset);
+    return it != offsets + count && *it == offset ? static_cast<int>(it - offsets) : -1;
+}
+
+void FecDecoder::onDelivered(uint64_t messageId, const PacketBuffer &payload)
+{
+    if (!active)
+        return;
+    for (auto &parity : pending)
+    {
+        // Waiting on another member: outlive the history.
+        int index = parity.member(messageId);
+        if (index >= 0)
+        {
+            parity.kept[index] = PacketBuffer::copyOf(payload.data(), payload.size());
+            return;
+        }
+    }
+    history.push_back({messageId, payload});
+    historyBytes += payload.size();
+    trimHistory();
+}
+
+FecDecoder::Delivered *FecDecoder::findDelivered(uint64_t messageId)
+{
+    auto it = std::lower_bound(history.begin(), history.end(), messageId,
+                               [](const Delivered &entry, uint64_t id) { return entry.messageId < id; });
+    return it != history.end() && it->messageId == messageId && it->data ? &*it : nullptr;
+}
+
+void FecDecoder::release(Delivered &entry)
+{
+    historyBytes -= entry.data.size();
+    entry.data = PacketBuffer{};
+}
+
+void FecDecoder::trimHistory()
+{
+    while (!history.empty() &&
+           (!history.front().data || history.size() > HISTORY || historyBytes > HISTORY_BYTES))
+    {
+        if (history.front().data)
+            release(history.front());
+        history.pop_front();
+    }
+}
+
+const PacketBuffer *FecDecoder::lookup(const Parity &parity, size_t index, const ReorderWindow &window)
+{
+    const uint64_t messageId = parity.first + parity.offsets[index];
+    if (messageId >= window.base())
+    {
+        const auto *item = window.find(messageId);
+        return item ? &item->data : nullptr;
+    }
+    if (parity.kept[index])
+        return &parity.kept[index];
+    const Delivered *entry = findDelivered(messageId);
+    return entry ? &entry->data : nullptr;
+}
+
+size_t FecDecoder::recover(ReorderWindow &window, std::vector<uint64_t> &recovered)
+{
+    size_t rebuilt = 0;
+    // A rebuilt frame may complete another group, so go round until nothing changes.
+    for (bool progress = true; progress;)
+    {
+        progress = false;
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            const Outcome outcome = tryRecover(*it, window, recovered);
+            if (outcome == Outcome::Waiting)
+            {
+                ++it;
+                continue;
+            }
+            // Resolved: its members' payloads are no longer needed.
+            for (size_t i = 0; i < it->count; i++)
+            {
+                if (Delivered *entry = findDelivered(it->first + it->offsets[i]))
+                    release(*entry);
+            }
+            switch (outcome)
+            {
+            case Outcome::Waiting:
+                break;
+            case Outcome::Recovered:
+                rebuilt++;
+                progress = true;
+                stats->recovered.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case Outcome::Unused:
+                stats->parityUnused.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case Outcome::Lost:
+                stats->parityLost.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            it = pending.erase(it);
+        }
+    }
+    trimHistory();
+    return rebuilt;
+}
+
+FecDecoder::Outcome FecDecoder::tryRecover(Parity &parity, ReorderWindow &window, std::vector<uint64_t> &recovered)
+{
+    size_t missing = 0;
+    uint64_t missingId = 0;
+    bool gone = false; // below the window and no longer in the history: skipped or too old
+    for (size_t i = 0; i < parity.count; i++)
+    {
+        uint64_t id = parity.first + parity.offsets[i];
+        if (lookup(parity, i, window))
+            continue;
+        if (id < window.base())
+            gone = true;
+        else
+        {
+            missing++;
+            missingId = id;
+        }
+    }
+    if (missing == 0)
+        return Outcome::Unused;
+    if (gone)
+        return Outcome::Lost;
+    if (missing > 1)
+    {
+        // Members already delivered must outlive the history while the group waits.
+        for (size_t i = 0; i < parity.count; i++)
+        {
+            Delivered *entry = parity.kept[i] ? nullptr : findDelivered(parity.first + parity.offsets[i]);
+            if (!entry)
+                continue;
+            parity.kept[i] = PacketBuffer::copyOf(entry->data.data(), entry->data.size());
+            release(*entry);
+        }
+        return Outcome::Waiting;
+    }
+
+    PacketBuffer data = PacketBuffer::copyOf(parity.data.data(), parity.data.size());
+    uint16_t length = parity.lengthXor;
+    for (size_t i = 0; i < parity.count; i++)
+    {
+        if (parity.first + parity.offsets[i] == missingId)
+            continue;
+        const PacketBuffer *member = lookup(parity, i, window);
+        if (member->size() > data.size())
+            return Outcome::Lost; // does not match this parity
+        FecXor(data.data(), member->data(), member->size());
+        length ^= static_cast<uint16_t>(member->size());
+    }
+    if (length > data.size())
+        return Outcome::Lost;
+    data.resize(length);
+    if (window.insert(missingId, {std::move(data), -1}) != ReorderWindow::InsertResult::Inserted)
+        return Outcome::Lost;
+    recovered.push_back(missingId);
+    return Outcome::Recovered;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "FecEncoder.h"
+#include "PacketBuffer.h"
+#include "ReorderWindow.h"
+#include "VcProtocol.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+/// Receiver side of FEC: rebuilds a missing data frame from its group's FEC_PARITY
+/// frame and the other members (see FecEncoder).
+///
+/// Members are looked up in the reorder window while buffered there and, once
+/// delivered, in a short history. A group's parity trails its members, so the history
+/// holds the delivered payloads themselves until the parity covering them resolves.
+/// Those are views that pin the connection's receive ring, so it is bounded to
+/// HISTORY entries and HISTORY_BYTES, oldest dropped first. Only a group that is still
+/// missing a member keeps copies: its waiting parity frame takes them off the history,
+/// and copies any member delivered later. The history only fills after the first
+/// parity frame arrives, so a peer that never sends parity costs nothing.
+///
+/// A parity frame waits while two or more of its members are missing, since either may
+/// still arrive, and is dropped once none is missing or one can no longer be found; at
+/// most MAX_PENDING wait, oldest evicted first.
+///
+/// Single-threaded: owned by the VC reorder thread.
+class FecDecoder
+{
+  public:
+    static constexpr size_t HISTORY = 1024;
+    static constexpr size_t HISTORY_BYTES = 64 * 1024; // a quarter of a ReceiveRing
+    static constexpr size_t MAX_PENDING = 64;
+
+    explicit FecDecoder(std::shared_ptr<FecStats> stats = nullptr);
+
+    /// A FEC_PARITY frame arrived (the whole frame, as validated by the IO thread).
+    void onParity(const PacketBuffer &frame);
+    /// Message `messageId` is being delivered with `payload`.
+    void onDelivered(uint64_t messageId, const PacketBuffer &payload);
+
+    /// Rebuild every missing frame the waiting parity frames allow and insert it into
+    /// `window`, appending its ID to `recovered`. Returns the number rebuilt.
+    size_t recover(ReorderWindow &window, std::vector<uint64_t> &recovered);
+
+    bool hasPending() const
+    {
+        return !pending.empty();
+    }
+
+  private:
+    struct Parity
+    {
+        uint64_t first = 0;
+        uint8_t count = 0;
+        uint16_t offsets[VC_FEC_MAX_GROUP]{};
+        uint16_t lengthXor = 0;
+        PacketBuffer data; // own copy of the parity payload
+        PacketBuffer kept[VC_FEC_MAX_GROUP]; // copies of members delivered while waiting
+
+        // Index of `messageId` among the members, or -1.
+        int member(uint64_t messageId) const;
+    };
+    struct Delivered
+    {
+        uint64_t messageId = 0;
+        PacketBuffer data; // empty once released
+    };
+    enum class Outcome
+    {
+        Waiting,
+        Recovered,
+        Unused,
+        Lost,
+    };
+
+    Outcome tryRecover(Parity &parity, ReorderWindow &window, std::vector<uint64_t> &recovered);
+    // Payload of member `index` if it is still known: buffered, kept or recently delivered.
+    const PacketBuffer *lookup(const Parity &parity, size_t index, const ReorderWindow &window);
+    Delivered *findDelivered(uint64_t messageId);
+    void release(Delivered &entry);
+    void trimHistory();
+
+    std::deque<Parity> pending;    // oldest first
+    std::deque<Delivered> history; // in delivery, and so ID, order
+    size_t historyBytes = 0;
+    bool active = false; // a parity frame has arrived
+    std::shared_ptr<FecStats> stats;
+};
@@ -0,0 +1,173 @@
+#include "FecEncoder.h"
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+namespace
+{
+// Room in front of a group's parity payload for the largest FEC_PARITY header.
+constexpr size_t PARITY_HEADROOM = VC_MIN_FEC_PARITY_SIZE + VC_FEC_MAX_GROUP * sizeof(uint16_t);
+} // namespace
+
+std::string FecStats::format() const
+{
+    return std::format("[FEC] groupSize={} protected={} parity={} parityKB={} parityDropped={} resent={} "
+                       "lossPermille={} parityReceived={} recovered={} parityUnused={} parityLost={}",
+                       groupSize.load(std::memory_order_relaxed), protectedFrames.load(std::memory_order_relaxed),
+                       parityFrames.load(std::memory_order_relaxed),
+                       parityBytes.load(std::memory_order_relaxed) / 1024,
+                       parityDropped.load(std::memory_order_relaxed), resent.load(std::memory_order_relaxed),
+                       lossPermille.load(std::memory_order_relaxed), parityReceived.load(std::memory_order_relaxed),
+                       recovered.load(std::memory_order_relaxed), parityUnused.load(std::memory_order_relaxed),
+                       parityLost.load(std::memory_order_relaxed));
+}
+
+void FecXor(char *dst, const char *src, size_t n)
+{
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+    {
+        uint64_t a, b;
+        std::memcpy(&a, dst + i, sizeof(a));
+        std::memcpy(&b, src + i, sizeof(b));
+        a ^= b;
+        std::memcpy(dst + i, &a, sizeof(a));
+    }
+    for (; i < n; i++)
+        dst[i] ^= src[i];
+}
+
+FecEncoder::FecEncoder(const FecConfig &config_, std::shared_ptr<FecStats> stats_)
+    : config(config_), stats(stats_ ? std::move(stats_) : std::make_shared<FecStats>())
+{
+    config.maxGroupSize = std::clamp<size_t>(config.maxGroupSize, 1, VC_FEC_MAX_GROUP);
+    config.minGroupSize = std::clamp<size_t>(config.minGroupSize, 1, config.maxGroupSize);
+    currentGroupSize = std::clamp(config.groupSize, config.minGroupSize, config.maxGroupSize);
+    stats->groupSize.store(currentGroupSize, std::memory_order_relaxed);
+}
+
+void FecEncoder::add(const PacketBuffer &frame, size_t slot, std::vector<PacketBuffer> &parity, Clock::time_point now)
+{
+    const auto *packet = reinterpret_cast<const VCDataPacket *>(frame.data());
+    const uint64_t messageId = packet->header.messageId;
+    if (messageId < nextId)
+        return;
+    nextId = messageId + 1;
+
+    const uint64_t slotBit = uint64_t{1} << (slot % 64);
+    size_t index = 0;
+    while (index < open.size() &&
+           ((open[index].slots & slotBit) || messageId - open[index].first > UINT16_MAX))
+        index++;
+    if (index == open.size())
+    {
+        if (open.size() >= MAX_OPEN_GROUPS)
+            close(0, parity);
+        Group group;
+        group.first = messageId;
+        group.openedAt = now;
+        group.parity = PacketBuffer::allocate(VC_MAX_DATA_PAYLOAD_SIZE, PARITY_HEADROOM);
+        open.push_back(std::move(group));
+        index = open.size() - 1;
+    }
+
+    Group &group = open[index];
+    const uint16_t length = packet->dataLength;
+    if (length > group.maxLength)
+    {
+        // The parity covers the longest member; shorter ones count as zero-padded.
+        std::memset(group.parity.data() + group.maxLength, 0, length - group.maxLength);
+        group.maxLength = length;
+    }
+    FecXor(group.parity.data(), reinterpret_cast<const char *>(packet->data), length);
+    group.offsets[group.count++] = static_cast<uint16_t>(messageId - group.first);
+    group.slots |= slotBit;
+    group.lengthXor ^= length;
+    stats->protectedFrames.fetch_add(1, std::memory_order_relaxed);
+    protectedSinceAdapt++;
+
+    if (group.count >= currentGroupSize)
+        close(index, parity);
+}
+
+void FecEncoder::close(size_t index, std::vector<PacketBuffer> &parity)
+{
+    Group &group = open[index];
+    PacketBuffer frame = std::move(group.parity);
+    const size_t headerSize = VC_MIN_FEC_PARITY_SIZE + group.count * sizeof(uint16_t);
+    frame.resize(group.maxLength);
+    frame.prepend(headerSize);
+
+    char *ptr = frame.data();
+    VCHeader header{VcPacketType::FEC_PARITY, group.first};
+    std::memcpy(ptr, &header, sizeof(header));
+    ptr += sizeof(header);
+    *reinterpret_cast<uint8_t *>(ptr) = group.count;
+    ptr += sizeof(uint8_t);
+    std::memcpy(ptr, &group.lengthXor, sizeof(uint16_t));
+    ptr += sizeof(uint16_t);
+    std::memcpy(ptr, &group.maxLength, sizeof(uint16_t));
+    ptr += sizeof(uint16_t);
+    std::memcpy(ptr, group.offsets, group.count * sizeof(uint16_t));
+
+    stats->parityFrames.fetch_add(1, std::memory_order_relaxed);
+    stats->parityBytes.fetch_add(frame.size(), std::memory_order_relaxed);
+    parity.push_back(std::move(frame));
+    open.erase(open.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+void FecEncoder::flushExpired(std::vector<PacketBuffer> &parity, Clock::time_point now)
+{
+    // Groups open in order, so the expired ones are at the front.
+    while (!open.empty() && now - open.front().openedAt >= config.maxHold)
+        close(0, parity);
+}
+
+void FecEncoder::flush(std::vector<PacketBuffer> &parity)
+{
+    while (!open.empty())
+        close(0, parity);
+}
+
+FecEncoder::Clock::time_point FecEncoder::nextDeadline() const
+{
+    if (open.empty())
+        return Clock::time_point::max();
+    return open.front().openedAt + config.maxHold;
+}
+
+void FecEncoder::adapt(Clock::time_point now)
+{
+    if (!config.adaptive)
+        return;
+    const uint64_t resent = stats->resent.load(std::memory_order_relaxed);
+    if (lastAdapt == Clock::time_point{})
+    {
+        lastAdapt = now;
+        lastResent = resent;
+        return;
+    }
+    // With too little traffic to tell, the period runs on until there is enough.
+    if (now - lastAdapt < ADAPT_PERIOD || protectedSinceAdapt < MIN_ADAPT_FRAMES)
+        return;
+    const uint64_t lost = resent - lastResent;
+    double rate = std::min(1.0, static_cast<double>(lost) / static_cast<double>(protectedSinceAdapt));
+    lastAdapt = now;
+    lastResent = resent;
+    protectedSinceAdapt = 0;
+
+    // Rising loss is taken at once, falling loss gradually.
+    lossRate = std::max(rate, 0.75 * lossRate + 0.25 * rate);
+    size_t target = config.maxGroupSize;
+    if (lossRate > 0)
+    {
+        double size = std::min(1.0 / (2.0 * lossRate), static_cast<double>(config.maxGroupSize));
+        target = std::max(static_cast<size_t>(size), config.minGroupSize);
+    }
+    if (target < currentGroupSize)
+        currentGroupSize = target;
+    else if (target > currentGroupSize)
+        currentGroupSize++;
+    stats->groupSize.store(currentGroupSize, std::memory_order_relaxed);
+    stats->lossPermille.store(static_cast<uint64_t>(lossRate * 1000), std::memory_order_relaxed);
+}
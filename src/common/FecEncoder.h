@@ -0,0 +1,129 @@
+#pragma once
+
+#include "PacketBuffer.h"
+#include "VcProtocol.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Forward error correction counters. The sender side (parity sent, resends that
+/// drive the group size) and the receiver side (frames rebuilt from parity) of one VC
+/// share the struct, so recovered and resent frames can be compared in one line.
+/// Readable from any thread.
+struct FecStats
+{
+    // Sender.
+    std::atomic<uint64_t> groupSize{0}; // data frames per parity frame; 0 while FEC is off
+    std::atomic<uint64_t> protectedFrames{0};
+    std::atomic<uint64_t> parityFrames{0};
+    std::atomic<uint64_t> parityBytes{0};
+    std::atomic<uint64_t> parityDropped{0}; // the resend lane was backed up
+    std::atomic<uint64_t> resent{0};        // frames re-sent on a NACK or retransmission timeout
+    std::atomic<uint64_t> lossPermille{0};  // smoothed resent / protected
+    // Receiver.
+    std::atomic<uint64_t> parityReceived{0};
+    std::atomic<uint64_t> recovered{0}; // missing frames rebuilt from parity
+    std::atomic<uint64_t> parityUnused{0}; // every member arrived on its own
+    std::atomic<uint64_t> parityLost{0};   // more than one member missing for good, or evicted
+
+    /// One-line summary suitable for log output.
+    std::string format() const;
+};
+
+/// Sender-side FEC settings (TcpVirtualChannel::setFec()).
+struct FecConfig
+{
+    size_t groupSize = VC_FEC_GROUP_SIZE; // initial; fixed unless adaptive
+    size_t minGroupSize = VC_FEC_MIN_GROUP_SIZE;
+    size_t maxGroupSize = VC_FEC_MAX_GROUP;
+    bool adaptive = true;
+    std::chrono::microseconds maxHold = VC_FEC_MAX_HOLD;
+};
+
+/// dst[i] ^= src[i] for n bytes.
+void FecXor(char *dst, const char *src, size_t n);
+
+/// Builds the FEC_PARITY frames protecting the data frames a VC sends.
+///
+/// A group collects up to groupSize() data frames, each committed to a different data
+/// connection, so a stalled or lossy connection costs a group at most one member and
+/// the parity (the XOR of the members' payloads) rebuilds it at the receiver without
+/// a resend round trip. Consecutive frames often share a connection (the send thread
+/// writes runs in one syscall), so several groups stay open and a frame joins the
+/// oldest one its connection is not in yet; that interleaves the groups across runs
+/// of up to MAX_OPEN_GROUPS frames. A group is closed when full, when it has been open
+/// for the configured maxHold (a lone frame's parity is then a plain copy of it), or
+/// when a new group needs its place.
+///
+/// Adaptive mode sizes groups from the loss the peer reports: resends (FecStats::
+/// resent) per frame protected, measured each ADAPT_PERIOD and smoothed. A group of N
+/// expects N * loss missing members and one parity rebuilds one, so N is kept near
+/// 1 / (2 * loss) within [minGroupSize, maxGroupSize]. Losses that the parity repairs
+/// are never reported, so the size grows back one step per period rather than at once.
+///
+/// Single-threaded: owned by the VC send thread.
+class FecEncoder
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t MAX_OPEN_GROUPS = 32;
+    static constexpr std::chrono::milliseconds ADAPT_PERIOD{1000};
+    // Frames a period must have protected before its loss rate counts.
+    static constexpr uint64_t MIN_ADAPT_FRAMES = 64;
+
+    explicit FecEncoder(const FecConfig &config = {}, std::shared_ptr<FecStats> stats = nullptr);
+
+    /// Protect `frame`, a stamped DATA frame being committed to data slot `slot`.
+    /// Frames not above the last one protected (re-sends) are ignored. Appends to
+    /// `parity` the frames of any group this completes or pushes out.
+    void add(const PacketBuffer &frame, size_t slot, std::vector<PacketBuffer> &parity,
+             Clock::time_point now = Clock::now());
+    /// Close the groups open for maxHold or longer.
+    void flushExpired(std::vector<PacketBuffer> &parity, Clock::time_point now = Clock::now());
+    /// Close every open group.
+    void flush(std::vector<PacketBuffer> &parity);
+    /// When flushExpired() next has something to close; Clock::time_point::max() with
+    /// no group open.
+    Clock::time_point nextDeadline() const;
+
+    /// Re-size groups from the loss reported since the last period. Cheap to call
+    /// every iteration; acts at most once per ADAPT_PERIOD.
+    void adapt(Clock::time_point now = Clock::now());
+
+    size_t groupSize() const
+    {
+        return currentGroupSize;
+    }
+
+  private:
+    struct Group
+    {
+        uint64_t first = 0;
+        uint8_t count = 0;
+        uint16_t offsets[VC_FEC_MAX_GROUP]{};
+        uint64_t slots = 0; // bit (slot % 64) per member
+        uint16_t lengthXor = 0;
+        uint16_t maxLength = 0;
+        Clock::time_point openedAt{};
+        PacketBuffer parity; // XOR of the payloads so far, with headroom for the header
+    };
+
+    void close(size_t index, std::vector<PacketBuffer> &parity);
+
+    FecConfig config;
+    size_t currentGroupSize;
+    std::deque<Group> open; // oldest first
+    uint64_t nextId = 0;    // one past the last frame protected
+    // Adaptation.
+    Clock::time_point lastAdapt{};
+    uint64_t lastResent = 0;
+    uint64_t protectedSinceAdapt = 0;
+    double lossRate = 0;
+    std::shared_ptr<FecStats> stats;
+};
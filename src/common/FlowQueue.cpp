@@ -0,0 +1,252 @@
+#include "FlowQueue.h"
+#include <algorithm>
+#include <cmath>
+#include <format>
+
+namespace
+{
+// Deficit added per round: one full data frame.
+constexpr int64_t QUANTUM_BYTES = VC_MAX_DATA_PAYLOAD_SIZE + sizeof(VCDataPacket);
+} // namespace
+
+std::string FlowQueueStats::format() const
+{
+    uint64_t frames = sojournFrames.load(std::memory_order_relaxed);
+    uint64_t avgUs = frames ? sojournTotalUs.load(std::memory_order_relaxed) / frames : 0;
+    return std::format("[FQ] flows={} priorityDepth={} bulkDepth={} priorityDrops={} bulkDrops={} codelDrops={} "
+                       "sojournAvgUs={} sojournMaxUs={}",
+                       activeFlows.load(std::memory_order_relaxed), priorityDepth.load(std::memory_order_relaxed),
+                       bulkDepth.load(std::memory_order_relaxed), priorityDrops.load(std::memory_order_relaxed),
+                       bulkDrops.load(std::memory_order_relaxed), codelDrops.load(std::memory_order_relaxed), avgUs,
+                       sojournMaxUs.load(std::memory_order_relaxed));
+}
+
+uint64_t FlowQueue::tagOf(uint64_t flowId, uint8_t tos)
+{
+    return (flowId << 8) | tos;
+}
+
+bool FlowQueue::isPriorityTos(uint8_t tos)
+{
+    uint8_t dscp = tos >> 2;
+    return dscp >= 40 ||               // CS5, EF (46), CS6, CS7
+           (dscp >= 34 && dscp <= 38); // AF41-AF43
+}
+
+FlowQueue::FlowQueue(size_t limit_, std::shared_ptr<FlowQueueStats> stats_, size_t bucketCount)
+    : limit(limit_), stats(stats_ ? std::move(stats_) : std::make_shared<FlowQueueStats>())
+{
+    size_t n = 1;
+    while (n < bucketCount)
+    {
+        n <<= 1;
+        bucketBits++;
+    }
+    buckets.resize(n);
+}
+
+void FlowQueue::setCoDel(std::chrono::microseconds target_, std::chrono::microseconds interval_)
+{
+    target = target_;
+    interval = interval_;
+}
+
+size_t FlowQueue::bucketOf(uint64_t tag) const
+{
+    if (bucketBits == 0)
+        return 0;
+    // Fibonacci hashing of the flow part; the TOS byte does not split a flow.
+    return static_cast<size_t>(((tag >> 8) * 0x9E3779B97F4A7C15ull) >> (64 - bucketBits));
+}
+
+void FlowQueue::push(PacketBuffer frame, uint64_t tag, Clock::time_point enqueuedAt)
+{
+    uint8_t tos = static_cast<uint8_t>(tag & 0xFF);
+    if ((frame.size() <= PRIORITY_MAX_BYTES || isPriorityTos(tos)) && priority.size() < PRIORITY_CAPACITY)
+    {
+        priority.push_back({std::move(frame), enqueuedAt});
+    }
+    else
+    {
+        size_t idx = bucketOf(tag);
+        Bucket &b = buckets[idx];
+        b.bytes += frame.size();
+        b.frames.push_back({std::move(frame), enqueuedAt});
+        if (b.list == List::None)
+        {
+            b.list = List::New;
+            b.deficit = QUANTUM_BYTES;
+            newFlows.push_back(static_cast<uint32_t>(idx));
+        }
+        bulkCount++;
+    }
+    count++;
+    if (count > limit)
+        dropOne();
+    publish();
+}
+
+void FlowQueue::dropOne()
+{
+    if (bulkCount == 0)
+    {
+        priority.pop_front();
+        count--;
+        stats->priorityDrops.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Only reached with a full queue, so scanning the buckets is rare.
+    Bucket *fattest = nullptr;
+    for (auto &b : buckets)
+    {
+        if (!b.frames.empty() && (!fattest || b.bytes > fattest->bytes))
+            fattest = &b;
+    }
+    fattest->bytes -= fattest->frames.front().frame.size();
+    fattest->frames.pop_front();
+    bulkCount--;
+    count--;
+    stats->bulkDrops.fetch_add(1, std::memory_order_relaxed);
+}
+
+PacketBuffer FlowQueue::pop(Clock::time_point now)
+{
+    if (!priority.empty() && (priorityStreak < PRIORITY_BURST || bulkCount == 0))
+    {
+        Entry entry = std::move(priority.front());
+        priority.pop_front();
+        priorityStreak++;
+        count--;
+        recordSojourn(now - entry.enqueuedAt);
+        publish();
+        return std::move(entry.frame);
+    }
+    priorityStreak = 0;
+
+    for (;;)
+    {
+        auto &list = !newFlows.empty() ? newFlows : oldFlows;
+        if (list.empty())
+        {
+            publish();
+            return {};
+        }
+        uint32_t idx = list.front();
+        Bucket &b = buckets[idx];
+        if (b.deficit <= 0)
+        {
+            b.deficit += QUANTUM_BYTES;
+            list.pop_front();
+            oldFlows.push_back(idx);
+            b.list = List::Old;
+            continue;
+        }
+
+        PacketBuffer frame = codelDequeue(b, now);
+        if (!frame)
+        {
+            list.pop_front();
+            // A new flow that empties moves to the old list rather than leaving, so it
+            // cannot re-enter the new list every time it sends one packet.
+            if (&list == &newFlows)
+            {
+                oldFlows.push_back(idx);
+                b.list = List::Old;
+            }
+            else
+            {
+                b.list = List::None;
+            }
+            continue;
+        }
+
+        b.deficit -= static_cast<int64_t>(frame.size());
+        recordSojourn(lastSojourn);
+        publish();
+        return frame;
+    }
+}
+
+PacketBuffer FlowQueue::takeHead(Bucket &b, Clock::time_point now, bool &okToDrop)
+{
+    okToDrop = false;
+    CoDelState &c = b.codel;
+    if (b.frames.empty())
+    {
+        c.firstAboveTime = {};
+        return {};
+    }
+    Entry entry = std::move(b.frames.front());
+    b.frames.pop_front();
+    b.bytes -= entry.frame.size();
+    bulkCount--;
+    count--;
+
+    lastSojourn = now - entry.enqueuedAt;
+    // Never drop the last full frame of a flow: it cannot be a standing queue.
+    if (lastSojourn < target || b.bytes <= static_cast<size_t>(QUANTUM_BYTES))
+        c.firstAboveTime = {};
+    else if (c.firstAboveTime == Clock::time_point{})
+        c.firstAboveTime = now + interval;
+    else if (now >= c.firstAboveTime)
+        okToDrop = true;
+    return std::move(entry.frame);
+}
+
+PacketBuffer FlowQueue::codelDequeue(Bucket &b, Clock::time_point now)
+{
+    CoDelState &c = b.codel;
+    bool okToDrop = false;
+    PacketBuffer frame = takeHead(b, now, okToDrop);
+
+    if (c.dropping)
+    {
+        if (!okToDrop)
+            c.dropping = false;
+        while (c.dropping && now >= c.dropNext)
+        {
+            stats->codelDrops.fetch_add(1, std::memory_order_relaxed);
+            c.count++;
+            frame = takeHead(b, now, okToDrop);
+            if (!okToDrop)
+                c.dropping = false;
+            else
+                c.dropNext = controlLaw(c.dropNext, c.count);
+        }
+    }
+    else if (okToDrop)
+    {
+        stats->codelDrops.fetch_add(1, std::memory_order_relaxed);
+        frame = takeHead(b, now, okToDrop);
+        c.dropping = true;
+        // Resume near the previous drop rate if the last dropping state ended recently.
+        uint32_t delta = c.count - c.lastCount;
+        c.count = (delta > 1 && now - c.dropNext < 16 * interval) ? delta : 1;
+        c.dropNext = controlLaw(now, c.count);
+        c.lastCount = c.count;
+    }
+    return frame;
+}
+
+FlowQueue::Clock::time_point FlowQueue::controlLaw(Clock::time_point t, uint32_t dropCount) const
+{
+    return t + std::chrono::duration_cast<Clock::duration>(interval / std::sqrt(static_cast<double>(dropCount)));
+}
+
+void FlowQueue::recordSojourn(Clock::duration sojourn)
+{
+    auto us = static_cast<uint64_t>(std::max<int64_t>(
+        0, std::chrono::duration_cast<std::chrono::microseconds>(sojourn).count()));
+    stats->sojournFrames.fetch_add(1, std::memory_order_relaxed);
+    stats->sojournTotalUs.fetch_add(us, std::memory_order_relaxed);
+    if (us > stats->sojournMaxUs.load(std::memory_order_relaxed))
+        stats->sojournMaxUs.store(us, std::memory_order_relaxed);
+}
+
+void FlowQueue::publish()
+{
+    stats->priorityDepth.store(priority.size(), std::memory_order_relaxed);
+    stats->bulkDepth.store(bulkCount, std::memory_order_relaxed);
+    stats->activeFlows.store(newFlows.size() + oldFlows.size(), std::memory_order_relaxed);
+}
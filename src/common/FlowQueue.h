@@ -0,0 +1,148 @@
+#pragma once
+
+#include "PacketBuffer.h"
+#include "VcProtocol.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Per-class depth and drop counters of a FlowQueue. Written by the queue's owner,
+/// readable from any thread.
+struct FlowQueueStats
+{
+    std::atomic<uint64_t> priorityDepth{0};
+    std::atomic<uint64_t> bulkDepth{0};
+    std::atomic<uint64_t> activeFlows{0};
+    std::atomic<uint64_t> priorityDrops{0}; // over the limit
+    std::atomic<uint64_t> bulkDrops{0};     // over the limit
+    std::atomic<uint64_t> codelDrops{0};    // queueing delay above target
+    // Sojourn time (enqueue to dequeue) of the frames sent.
+    std::atomic<uint64_t> sojournFrames{0};
+    std::atomic<uint64_t> sojournTotalUs{0};
+    std::atomic<uint64_t> sojournMaxUs{0};
+
+    /// One-line summary suitable for log output.
+    std::string format() const;
+};
+
+/// Fair queueing for the datagrams entering a VC, between the producers and the send
+/// thread.
+///
+/// Bulk class: frames are hashed by flow (the UDP source address) into buckets that
+/// are served deficit round robin, one QUANTUM_BYTES per turn, so a bulk transfer
+/// only delays its own packets. As in fq_codel, a flow that was idle starts on the
+/// new-flows list, which is served before the old-flows list, so sparse interactive
+/// flows (DNS, VoIP, games) rarely wait behind a backlog at all.
+///
+/// Priority class: short frames (at most PRIORITY_MAX_BYTES) and frames whose DSCP
+/// asks for low latency go to a small strict-priority FIFO. It yields one bulk frame
+/// after every PRIORITY_BURST frames, and when it is full further frames fall back to
+/// their flow's bucket, so a flood of small packets cannot starve bulk traffic. A flow
+/// mixing short and long frames may see them reordered.
+///
+/// Each bucket runs CoDel (RFC 8289) on its frames' sojourn time: once a flow's frames
+/// have waited longer than the target for a whole interval, its head frames are dropped
+/// at a rate rising with the square root of the drop count until the delay is back
+/// under target. The queue therefore holds about one target's worth of delay whatever
+/// the link rate, and only the flows that build the queue lose packets. The limit is a
+/// memory cap behind that: over it, the oldest frame of the bucket holding the most
+/// bytes is dropped. The priority class is bounded by its capacity instead.
+///
+/// Single-threaded: owned by the VC send thread.
+class FlowQueue
+{
+  public:
+    static constexpr size_t DEFAULT_BUCKETS = 1024; // rounded up to a power of two
+    static constexpr size_t PRIORITY_MAX_BYTES = 256;
+    static constexpr size_t PRIORITY_CAPACITY = 64;
+    static constexpr size_t PRIORITY_BURST = 8;
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Classification carried with a frame from the producer: a flow identifier and
+    /// the datagram's IP TOS byte, packed into one word (see MpscQueue tags).
+    static uint64_t tagOf(uint64_t flowId, uint8_t tos);
+    /// DSCP EF, CS5-CS7 and AF4x: the classes that ask for low delay.
+    static bool isPriorityTos(uint8_t tos);
+
+    explicit FlowQueue(size_t limit, std::shared_ptr<FlowQueueStats> stats = nullptr,
+                       size_t bucketCount = DEFAULT_BUCKETS);
+
+    /// CoDel parameters: the acceptable standing queueing delay, and how long the delay
+    /// may stay above it before dropping starts (about one worst-case RTT).
+    void setCoDel(std::chrono::microseconds target, std::chrono::microseconds interval);
+
+    /// Queue `frame`, which entered the send path at `enqueuedAt`; may drop a frame (not
+    /// necessarily this one) to stay in the limit.
+    void push(PacketBuffer frame, uint64_t tag, Clock::time_point enqueuedAt = Clock::now());
+    /// The next frame to send, or an empty buffer. May drop frames that waited too long.
+    PacketBuffer pop(Clock::time_point now = Clock::now());
+
+    size_t size() const
+    {
+        return count;
+    }
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+  private:
+    enum class List : uint8_t
+    {
+        None,
+        New,
+        Old
+    };
+    struct Entry
+    {
+        PacketBuffer frame;
+        Clock::time_point enqueuedAt;
+    };
+    struct CoDelState
+    {
+        Clock::time_point firstAboveTime{}; // {} while the delay is below target
+        Clock::time_point dropNext{};
+        uint32_t count = 0; // drops in the current dropping state
+        uint32_t lastCount = 0;
+        bool dropping = false;
+    };
+    struct Bucket
+    {
+        std::deque<Entry> frames;
+        size_t bytes = 0;
+        int64_t deficit = 0;
+        List list = List::None;
+        CoDelState codel;
+    };
+
+    size_t bucketOf(uint64_t tag) const;
+    void dropOne();
+    // RFC 8289 dequeue from one bucket: the frame to send, or empty if dropping
+    // emptied the bucket.
+    PacketBuffer codelDequeue(Bucket &b, Clock::time_point now);
+    // Remove the bucket's head frame; okToDrop says whether CoDel may drop it.
+    PacketBuffer takeHead(Bucket &b, Clock::time_point now, bool &okToDrop);
+    Clock::time_point controlLaw(Clock::time_point t, uint32_t count) const;
+    void recordSojourn(Clock::duration sojourn);
+    void publish();
+
+    const size_t limit;
+    std::shared_ptr<FlowQueueStats> stats;
+    std::vector<Bucket> buckets;
+    unsigned bucketBits = 0;
+    std::deque<uint32_t> newFlows;
+    std::deque<uint32_t> oldFlows;
+    std::deque<Entry> priority;
+    Clock::duration target = VC_CODEL_TARGET;
+    Clock::duration interval = VC_CODEL_INTERVAL;
+    Clock::duration lastSojourn{}; // of the frame takeHead() returned last
+    size_t count = 0;     // both classes
+    size_t bulkCount = 0; // frames in buckets
+    size_t priorityStreak = 0;
+};
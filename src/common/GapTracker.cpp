@@ -0,0 +1,194 @@
+#include "GapTracker.h"
+#include <algorithm>
+#include <bit>
+#include <format>
+
+size_t GapStats::bucketOf(std::chrono::microseconds fillTime)
+{
+    auto ms = static_cast<uint64_t>(std::max<int64_t>(0, fillTime.count() / 1000));
+    return std::min<size_t>(std::bit_width(ms), FILL_BUCKETS - 1);
+}
+
+std::string GapStats::format() const
+{
+    std::string hist;
+    for (size_t i = 0; i < FILL_BUCKETS; i++)
+    {
+        if (i > 0)
+            hist += ' ';
+        if (i + 1 < FILL_BUCKETS)
+            hist += std::format("<{}:{}", uint64_t{1} << i, fillMs[i].load(std::memory_order_relaxed));
+        else
+            hist += std::format(">={}:{}", uint64_t{1} << (i - 1), fillMs[i].load(std::memory_order_relaxed));
+    }
+    return std::format("[GAP] reorderFills={} resendFills={} fecFills={} skipped={} nacks={} renacks={} "
+                       "skewMs={:.1f} distance={} resendRttMs={:.1f} fillMs=[{}]",
+                       reorderFills.load(std::memory_order_relaxed), resendFills.load(std::memory_order_relaxed),
+                       fecFills.load(std::memory_order_relaxed), skipped.load(std::memory_order_relaxed),
+                       nacks.load(std::memory_order_relaxed), renacks.load(std::memory_order_relaxed),
+                       skewUs.load(std::memory_order_relaxed) / 1000.0, reorderDistance.load(std::memory_order_relaxed),
+                       resendRttUs.load(std::memory_order_relaxed) / 1000.0, hist);
+}
+
+GapTracker::GapTracker(std::shared_ptr<GapStats> stats_)
+    : stats(stats_ ? std::move(stats_) : std::make_shared<GapStats>())
+{
+}
+
+void GapTracker::onArrival(uint64_t messageId, Copy copy, Clock::time_point now)
+{
+    if (messageId >= nextExpected)
+    {
+        if (messageId > nextExpected)
+            gaps.push_back({nextExpected, messageId, now});
+        nextExpected = messageId + 1;
+        return;
+    }
+
+    // Below the highest ID seen: fills a gap, unless it is a copy of one that arrived.
+    auto it = std::upper_bound(gaps.begin(), gaps.end(), messageId,
+                               [](uint64_t id, const Gap &gap) { return id < gap.first; });
+    if (it == gaps.begin() || messageId >= std::prev(it)->end)
+        return;
+    onFill(static_cast<size_t>(std::prev(it) - gaps.begin()), messageId, copy, now);
+}
+
+void GapTracker::onFill(size_t index, uint64_t messageId, Copy copy, Clock::time_point now)
+{
+    Gap &gap = gaps[index];
+    auto fillTime = std::chrono::duration_cast<std::chrono::microseconds>(now - gap.detectedAt);
+    stats->fillMs[GapStats::bucketOf(fillTime)].fetch_add(1, std::memory_order_relaxed);
+
+    bool resent = copy == Copy::Resend || (copy == Copy::Unknown && gap.nacks > 0);
+    if (copy == Copy::Recovered)
+    {
+        stats->fecFills.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (resent)
+    {
+        // Only a fill after exactly one NACK times the resend round trip: after none it
+        // was the sender's own retransmission, after several it is unknown which (Karn).
+        if (gap.nacks == 1)
+            resendRtt.sample(static_cast<double>(
+                std::chrono::duration_cast<std::chrono::microseconds>(now - gap.nackedAt).count()));
+        stats->resendFills.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        // Decaying maxima: a larger spread is taken at once, a smaller one gradually.
+        auto us = static_cast<double>(fillTime.count());
+        auto dist = static_cast<double>(nextExpected - 1 - messageId);
+        skewUs = us >= skewUs ? us : skewUs - (skewUs - us) / 8;
+        distance = dist >= distance ? dist : distance - (distance - dist) / 8;
+        stats->reorderFills.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (messageId == gap.first)
+        gap.first++;
+    else if (messageId + 1 == gap.end)
+        gap.end--;
+    else
+    {
+        Gap tail = gap;
+        tail.first = messageId + 1;
+        gap.end = messageId;
+        gaps.insert(gaps.begin() + static_cast<std::ptrdiff_t>(index) + 1, tail);
+    }
+    if (gaps[index].first == gaps[index].end)
+        gaps.erase(gaps.begin() + static_cast<std::ptrdiff_t>(index));
+    publish();
+}
+
+void GapTracker::advance(uint64_t base)
+{
+    while (!gaps.empty() && gaps.front().first < base)
+    {
+        Gap &gap = gaps.front();
+        uint64_t skipped = std::min(gap.end, base) - gap.first;
+        stats->skipped.fetch_add(skipped, std::memory_order_relaxed);
+        if (gap.end <= base)
+            gaps.pop_front();
+        else
+            gap.first = base;
+    }
+    if (nextExpected < base)
+        nextExpected = base;
+}
+
+void GapTracker::collectDue(std::vector<MissingRange> &out, size_t maxRanges, Clock::time_point now)
+{
+    size_t added = 0;
+    for (auto &gap : gaps)
+    {
+        if (added >= maxRanges)
+            break;
+        bool due = dueAt(gap) <= now || (gap.nacks == 0 && distanceDue(gap));
+        if (!due)
+        {
+            // Gaps not NACKed yet are detected in ID order, so the rest are not due either.
+            if (gap.nacks == 0)
+                break;
+            continue;
+        }
+        (gap.nacks == 0 ? stats->nacks : stats->renacks).fetch_add(1, std::memory_order_relaxed);
+        gap.nacks++;
+        gap.nackedAt = now;
+        for (uint64_t first = gap.first; first < gap.end && added < maxRanges; first += VC_MAX_MISSING_RUN)
+        {
+            out.push_back({first, std::min(gap.end - first, VC_MAX_MISSING_RUN)});
+            added++;
+        }
+    }
+}
+
+GapTracker::Clock::time_point GapTracker::nextDeadline() const
+{
+    auto deadline = Clock::time_point::max();
+    for (const auto &gap : gaps)
+    {
+        deadline = std::min(deadline, dueAt(gap));
+        if (gap.nacks == 0)
+            break; // later un-NACKed gaps are due later
+    }
+    return deadline;
+}
+
+GapTracker::Clock::time_point GapTracker::dueAt(const Gap &gap) const
+{
+    if (gap.nacks == 0)
+        return gap.detectedAt + firstNackDelay();
+    if (gap.nacks >= MAX_NACKS)
+        return Clock::time_point::max();
+    return gap.nackedAt + renackDelay(gap.nacks);
+}
+
+bool GapTracker::distanceDue(const Gap &gap) const
+{
+    if (distance <= 0)
+        return false;
+    auto threshold = std::max(static_cast<double>(MIN_REORDER_DISTANCE), REORDER_MULTIPLIER * distance);
+    return static_cast<double>(nextExpected - gap.end) >= threshold;
+}
+
+GapTracker::Clock::duration GapTracker::firstNackDelay() const
+{
+    if (skewUs <= 0)
+        return initialDelay;
+    return std::max<Clock::duration>(std::chrono::microseconds(static_cast<int64_t>(REORDER_MULTIPLIER * skewUs)),
+                                     MIN_NACK_DELAY);
+}
+
+GapTracker::Clock::duration GapTracker::renackDelay(uint8_t nacks) const
+{
+    Clock::duration rtt = initialDelay;
+    if (!resendRtt.empty())
+        rtt = std::max<Clock::duration>(resendRtt.rto(), MIN_NACK_DELAY);
+    return rtt * (1 << (nacks - 1));
+}
+
+void GapTracker::publish()
+{
+    stats->skewUs.store(static_cast<uint64_t>(skewUs), std::memory_order_relaxed);
+    stats->reorderDistance.store(static_cast<uint64_t>(distance), std::memory_order_relaxed);
+    stats->resendRttUs.store(static_cast<uint64_t>(resendRtt.srtt()), std::memory_order_relaxed);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "RttEstimator.h"
+#include "VcProtocol.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Gap and NACK counters of a GapTracker, including a histogram of how long gaps took
+/// to fill. Readable from any thread.
+struct GapStats
+{
+    /// Detection-to-fill time buckets: [0, 1ms), [1, 2ms), [2, 4ms) ... [512, 1024ms),
+    /// then everything from 1024ms up.
+    static constexpr size_t FILL_BUCKETS = 12;
+
+    std::array<std::atomic<uint64_t>, FILL_BUCKETS> fillMs{};
+    std::atomic<uint64_t> reorderFills{0}; // filled before any NACK: only overtaken
+    std::atomic<uint64_t> resendFills{0};  // filled after a NACK
+    std::atomic<uint64_t> fecFills{0};     // rebuilt from FEC parity
+    std::atomic<uint64_t> skipped{0};      // given up by the reorder timeout
+    std::atomic<uint64_t> nacks{0};        // first NACKs of a gap
+    std::atomic<uint64_t> renacks{0};      // repeated NACKs
+    std::atomic<uint64_t> skewUs{0};
+    std::atomic<uint64_t> reorderDistance{0};
+    std::atomic<uint64_t> resendRttUs{0};
+
+    static size_t bucketOf(std::chrono::microseconds fillTime);
+
+    /// One-line summary suitable for log output.
+    std::string format() const;
+};
+
+/// Receiver side of fast NACK: the open gaps in the message ID sequence, and when each
+/// is due for a (repeated) missing notification.
+///
+/// A gap is detected when a later ID arrives. How far frames overtake each other across
+/// the connections is learned from gaps that fill without a NACK: a decaying maximum of
+/// their fill time (the skew) and of how many later IDs arrived meanwhile (the reorder
+/// distance). A gap is NACKed once it outlives that spread: when
+/// REORDER_MULTIPLIER * distance later IDs have arrived, or after
+/// REORDER_MULTIPLIER * skew, whichever comes first; before the first sample, after
+/// the initial delay (the VC's missing-notify interval). A gap still open after its
+/// NACK is NACKed again once the resend round trip (RFC 6298 style srtt + 4 * rttvar
+/// over NACK-to-fill times) has passed, backing off exponentially, at most MAX_NACKS
+/// times; after that it is left to the ACK retransmission timer and the reorder
+/// timeout.
+///
+/// Gaps are kept as runs ordered by ID, so a burst loss is one entry. Single-threaded:
+/// owned by the VC reorder thread.
+class GapTracker
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr double REORDER_MULTIPLIER = 1.5;
+    static constexpr uint64_t MIN_REORDER_DISTANCE = 3;
+    static constexpr std::chrono::milliseconds MIN_NACK_DELAY{1};
+    static constexpr uint8_t MAX_NACKS = 4;
+
+    /// Which copy of a message an arrival is, when the connection it came on tells.
+    enum class Copy : uint8_t
+    {
+        Unknown,  // a gap NACKed before it filled counts as filled by the resend
+        Original, // the first transmission, overtaken by later IDs
+        Resend,
+        Recovered, // rebuilt from FEC parity: says nothing about reordering or resends
+    };
+
+    explicit GapTracker(std::shared_ptr<GapStats> stats = nullptr);
+
+    /// Delay of a gap's first NACK until the first gap filled, and of repeats until
+    /// the first resend round trip was measured.
+    void setInitialDelay(Clock::duration delay)
+    {
+        initialDelay = delay;
+    }
+
+    /// Message `messageId` arrived (first copy only, at or above the window base).
+    void onArrival(uint64_t messageId, Copy copy = Copy::Unknown, Clock::time_point now = Clock::now());
+    /// Everything below `base` was delivered or skipped.
+    void advance(uint64_t base);
+
+    /// Append to `out` the gaps due for a NACK, at most `maxRanges`, runs capped at
+    /// VC_MAX_MISSING_RUN, and mark them NACKed.
+    void collectDue(std::vector<MissingRange> &out, size_t maxRanges, Clock::time_point now = Clock::now());
+    /// When collectDue() next has something to return; Clock::time_point::max() when
+    /// no gap is waiting for a NACK.
+    Clock::time_point nextDeadline() const;
+
+    bool empty() const
+    {
+        return gaps.empty();
+    }
+
+  private:
+    struct Gap
+    {
+        uint64_t first = 0;
+        uint64_t end = 0; // one past the last missing ID
+        Clock::time_point detectedAt{};
+        Clock::time_point nackedAt{};
+        uint8_t nacks = 0;
+    };
+
+    // When `gap` is due for its next NACK; max() once it has had MAX_NACKS.
+    Clock::time_point dueAt(const Gap &gap) const;
+    bool distanceDue(const Gap &gap) const;
+    Clock::duration firstNackDelay() const;
+    Clock::duration renackDelay(uint8_t nacks) const;
+    void onFill(size_t index, uint64_t messageId, Copy copy, Clock::time_point now);
+    void publish();
+
+    std::deque<Gap> gaps; // disjoint, ordered by first
+    uint64_t nextExpected = 0; // one past the highest ID seen
+    Clock::duration initialDelay = std::chrono::milliseconds(200);
+    // Spread of reordering across the connections (decaying maxima; 0 until sampled).
+    double skewUs = 0;
+    double distance = 0;
+    RttEstimator resendRtt; // over NACK-to-fill times
+    std::shared_ptr<GapStats> stats;
+};
@@ -0,0 +1,98 @@
+#include "MirroredRing.h"
+#include "Log.h"
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+MirroredRing::MirroredRing(size_t minSize)
+{
+    // Power of two so ring positions map with a mask; page sizes are powers of two, so
+    // this is page-aligned whenever it is at least one page.
+    ringSize = MIRROR_FALLBACK_BYTES;
+    while (ringSize < minSize)
+        ringSize <<= 1;
+    mask = ringSize - 1;
+
+    if (mapMirrored())
+        return;
+
+    base = static_cast<char *>(::operator new(ringSize + MIRROR_FALLBACK_BYTES));
+    mirrored = false;
+}
+
+MirroredRing::~MirroredRing()
+{
+#if defined(__linux__)
+    if (mirrored)
+    {
+        munmap(base, ringSize * 2);
+        return;
+    }
+#endif
+    ::operator delete(base);
+}
+
+bool MirroredRing::mapMirrored()
+{
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    if (ringSize % static_cast<size_t>(sysconf(_SC_PAGESIZE)) != 0)
+        return false;
+
+    int fd = memfd_create("vc-read-ring", MFD_CLOEXEC);
+    if (fd < 0)
+    {
+        log_warnning(std::format("[RING] memfd_create failed (errno={}), using copy fallback", errno));
+        return false;
+    }
+
+    bool ok = false;
+    void *reserved = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(ringSize)) == 0)
+    {
+        // Reserve 2x address space first so both halves land back-to-back, then map the
+        // same file over each half.
+        reserved = mmap(nullptr, ringSize * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (reserved != MAP_FAILED)
+        {
+            char *lo = static_cast<char *>(reserved);
+            void *first = mmap(lo, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+            void *second = mmap(lo + ringSize, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+            ok = first == lo && second == lo + ringSize;
+        }
+    }
+    int savedErrno = errno;
+    ::close(fd); // the mappings keep the memory alive
+
+    if (!ok)
+    {
+        if (reserved != MAP_FAILED)
+            munmap(reserved, ringSize * 2);
+        log_warnning(std::format("[RING] mirrored mapping of {} bytes failed (errno={}), using copy fallback",
+                                 ringSize, savedErrno));
+        return false;
+    }
+
+    base = static_cast<char *>(reserved);
+    mirrored = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MirroredRing::commit(uint64_t pos, size_t n)
+{
+    if (mirrored || n == 0)
+        return;
+    size_t start = pos & mask;
+    if (start >= MIRROR_FALLBACK_BYTES)
+        return;
+    size_t end = start + n < MIRROR_FALLBACK_BYTES ? start + n : MIRROR_FALLBACK_BYTES;
+    std::memcpy(base + ringSize + start, base + start, end - start);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// Fixed-size byte ring whose storage is mapped twice back-to-back, so the bytes at
+/// [pos, pos + n) are contiguous in memory for any pos < size() and n <= size().
+/// A frame that wraps the end of the ring can therefore be parsed in place, with no
+/// compaction and no special case at the wrap point.
+///
+/// On Linux the two views share one memfd (memfd_create + two MAP_FIXED mappings).
+/// Where that is unavailable, or the mapping fails, the ring falls back to plain
+/// memory with a MIRROR_FALLBACK_BYTES tail: commit() copies writes that land in the
+/// first MIRROR_FALLBACK_BYTES of the ring into the tail, which keeps any window of up
+/// to that many bytes contiguous. Writers must then respect writableAt().
+class MirroredRing
+{
+  public:
+    /// Largest contiguous window guaranteed by the fallback. Covers any VC frame.
+    static constexpr size_t MIRROR_FALLBACK_BYTES = 4096;
+
+    /// `minSize` is rounded up to the page size (mirrored) or to a power of two.
+    explicit MirroredRing(size_t minSize);
+    ~MirroredRing();
+
+    MirroredRing(const MirroredRing &) = delete;
+    MirroredRing &operator=(const MirroredRing &) = delete;
+
+    /// Pointer to the byte at ring position `pos` (any 64-bit stream offset).
+    char *at(uint64_t pos) const
+    {
+        return base + (pos & mask);
+    }
+
+    /// Largest write at `pos` that stays contiguous, capped at `wanted`.
+    size_t writableAt(uint64_t pos, size_t wanted) const
+    {
+        if (mirrored)
+            return wanted;
+        size_t untilEnd = ringSize - (pos & mask);
+        return wanted < untilEnd ? wanted : untilEnd;
+    }
+
+    /// Must be called after writing `n` bytes at `pos`; keeps the fallback tail in sync.
+    void commit(uint64_t pos, size_t n);
+
+    size_t size() const
+    {
+        return ringSize;
+    }
+
+    bool isMirrored() const
+    {
+        return mirrored;
+    }
+
+  private:
+    bool mapMirrored();
+
+    char *base = nullptr;
+    size_t ringSize = 0;
+    size_t mask = 0;
+    bool mirrored = false;
+};
@@ -0,0 +1,143 @@
+#include "MpscQueue.h"
+
+MpscQueue::MpscQueue(size_t capacity, bool stampEnqueueTime_) : stampEnqueueTime(stampEnqueueTime_)
+{
+    size_t slotCount = 2;
+    while (slotCount < capacity)
+        slotCount <<= 1;
+    slots = std::make_unique<Slot[]>(slotCount);
+    mask = slotCount - 1;
+    // Slot i is free for the producer whose position is i.
+    for (size_t i = 0; i < slotCount; i++)
+        slots[i].seq.store(i, std::memory_order_relaxed);
+}
+
+bool MpscQueue::enqueue(PacketBuffer data, uint64_t tag)
+{
+    if (cancelled.load(std::memory_order_relaxed))
+        return false;
+
+    // Count the item before it becomes visible so the consumer can never take the
+    // count below zero. The seq_cst increment pairs with park() followed by
+    // approxSize() on the consumer: either the consumer sees the item before it
+    // sleeps, or the parked check below sees the consumer parked and wakes it.
+    count.fetch_add(1, std::memory_order_seq_cst);
+
+    uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;)
+    {
+        slot = &slots[pos & mask];
+        uint64_t seq = slot->seq.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq - pos);
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            count.fetch_sub(1, std::memory_order_relaxed);
+            return false; // full: the consumer has not freed this slot yet
+        }
+        else
+        {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->data = std::move(data);
+    slot->tag = tag;
+    if (stampEnqueueTime)
+        slot->enqueuedAt = std::chrono::steady_clock::now();
+    slot->seq.store(pos + 1, std::memory_order_release);
+    if (parked.load(std::memory_order_seq_cst) && parked.exchange(false, std::memory_order_acq_rel))
+        notify();
+    return true;
+}
+
+PacketBuffer MpscQueue::tryDequeue()
+{
+    std::chrono::steady_clock::time_point enqueuedAt;
+    return tryDequeue(enqueuedAt);
+}
+
+PacketBuffer MpscQueue::tryDequeue(std::chrono::steady_clock::time_point &enqueuedAt)
+{
+    if (cancelled.load(std::memory_order_relaxed))
+        return {};
+    Slot &slot = slots[dequeuePos & mask];
+    if (slot.seq.load(std::memory_order_acquire) != dequeuePos + 1)
+        return {};
+    PacketBuffer result = std::move(slot.data);
+    enqueuedAt = slot.enqueuedAt;
+    slot.seq.store(dequeuePos + mask + 1, std::memory_order_release);
+    dequeuePos++;
+    count.fetch_sub(1, std::memory_order_relaxed);
+    return result;
+}
+
+size_t MpscQueue::tryDequeueMany(std::vector<PacketBuffer> &out, size_t max)
+{
+    return dequeueMany(out, nullptr, nullptr, max);
+}
+
+size_t MpscQueue::tryDequeueMany(std::vector<PacketBuffer> &out, std::vector<uint64_t> &tags, size_t max)
+{
+    return dequeueMany(out, &tags, nullptr, max);
+}
+
+size_t MpscQueue::tryDequeueMany(std::vector<PacketBuffer> &out, std::vector<uint64_t> &tags,
+                                 std::vector<std::chrono::steady_clock::time_point> &enqueuedAt, size_t max)
+{
+    return dequeueMany(out, &tags, &enqueuedAt, max);
+}
+
+size_t MpscQueue::dequeueMany(std::vector<PacketBuffer> &out, std::vector<uint64_t> *tags,
+                              std::vector<std::chrono::steady_clock::time_point> *enqueuedAt, size_t max)
+{
+    if (cancelled.load(std::memory_order_relaxed))
+        return 0;
+    size_t taken = 0;
+    while (taken < max)
+    {
+        Slot &slot = slots[dequeuePos & mask];
+        if (slot.seq.load(std::memory_order_acquire) != dequeuePos + 1)
+            break;
+        out.push_back(std::move(slot.data));
+        if (tags)
+            tags->push_back(slot.tag);
+        if (enqueuedAt)
+            enqueuedAt->push_back(slot.enqueuedAt);
+        slot.seq.store(dequeuePos + mask + 1, std::memory_order_release);
+        dequeuePos++;
+        taken++;
+    }
+    if (taken > 0)
+        count.fetch_sub(taken, std::memory_order_relaxed);
+    return taken;
+}
+
+void MpscQueue::cancelWait()
+{
+    cancelled.store(true, std::memory_order_release);
+    notify();
+}
+
+void MpscQueue::setEnqueueNotifier(std::function<void()> notifier)
+{
+    std::lock_guard<std::mutex> lock(notifierMutex);
+    enqueueNotifier = std::move(notifier);
+}
+
+void MpscQueue::notify()
+{
+    std::function<void()> notifier;
+    {
+        std::lock_guard<std::mutex> lock(notifierMutex);
+        notifier = enqueueNotifier;
+    }
+    // Called outside notifierMutex so the notifier may take the consumer's wait mutex.
+    if (notifier)
+        notifier();
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "PacketBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// Bounded lock-free multi-producer / single-consumer queue of PacketBuffers.
+///
+/// Producers claim a slot with one CAS on the enqueue position and publish it through
+/// the slot's sequence number (Vyukov's bounded queue); the single consumer reads
+/// slots in order without any atomic RMW on the shared positions.
+///
+/// Wakeups are opt-in. A consumer about to sleep calls park(), re-checks approxSize()
+/// and only then waits. A producer calls the enqueue notifier only if it finds the
+/// consumer parked, so an enqueue onto a queue whose consumer is busy costs no lock
+/// and no futex wake.
+class MpscQueue
+{
+  public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096; // rounded up to a power of two
+
+    /// With `stampEnqueueTime` every enqueue records when it happened, for the
+    /// tryDequeue() overload that reports queueing delay.
+    explicit MpscQueue(size_t capacity = DEFAULT_CAPACITY, bool stampEnqueueTime = false);
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /// Append `data`. Returns false (and drops it) when the queue is full or cancelled.
+    /// Safe from any number of threads, including the consumer. `tag` is an opaque word
+    /// carried with the item (e.g. its flow classification).
+    bool enqueue(PacketBuffer data, uint64_t tag = 0);
+
+    /// Returns an empty (false) buffer when the queue is empty or cancelled.
+    /// Consumer thread only.
+    PacketBuffer tryDequeue();
+    /// As above, also returning when the item was enqueued (the epoch unless the queue
+    /// stamps enqueue times).
+    PacketBuffer tryDequeue(std::chrono::steady_clock::time_point &enqueuedAt);
+
+    /// Move up to `max` items onto the end of `out`. Returns the number moved.
+    /// Consumer thread only.
+    size_t tryDequeueMany(std::vector<PacketBuffer> &out, size_t max);
+    /// As above, also appending each item's tag to `tags`.
+    size_t tryDequeueMany(std::vector<PacketBuffer> &out, std::vector<uint64_t> &tags, size_t max);
+    /// As above, also appending when each item was enqueued (see tryDequeue()).
+    size_t tryDequeueMany(std::vector<PacketBuffer> &out, std::vector<uint64_t> &tags,
+                          std::vector<std::chrono::steady_clock::time_point> &enqueuedAt, size_t max);
+
+    /// Items enqueued and not yet dequeued. Exact once producers are quiescent; an
+    /// in-flight enqueue is counted slightly before it can be dequeued. Suitable for
+    /// threshold checks.
+    size_t approxSize() const
+    {
+        return count.load(std::memory_order_seq_cst);
+    }
+
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    /// Consumer: announce an upcoming wait. The next enqueue calls the notifier once.
+    /// The consumer must re-check approxSize() after park() and before sleeping.
+    void park()
+    {
+        parked.store(true, std::memory_order_seq_cst);
+    }
+
+    /// Consumer: withdraw park() after waking up (or deciding not to sleep).
+    void unpark()
+    {
+        parked.store(false, std::memory_order_relaxed);
+    }
+
+    /// Reject further enqueues, make tryDequeue() return empty and wake the consumer.
+    void cancelWait();
+
+    bool isCancelled() const
+    {
+        return cancelled.load(std::memory_order_acquire);
+    }
+
+    /// Callback used to wake a parked consumer. Pass nullptr to clear. Thread-safe.
+    void setEnqueueNotifier(std::function<void()> notifier);
+
+  private:
+    struct Slot
+    {
+        std::atomic<uint64_t> seq{0};
+        PacketBuffer data;
+        uint64_t tag = 0;
+        std::chrono::steady_clock::time_point enqueuedAt{};
+    };
+
+    void notify();
+    size_t dequeueMany(std::vector<PacketBuffer> &out, std::vector<uint64_t> *tags,
+                       std::vector<std::chrono::steady_clock::time_point> *enqueuedAt, size_t max);
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+    bool stampEnqueueTime = false;
+
+    alignas(64) std::atomic<uint64_t> enqueuePos{0};
+    alignas(64) uint64_t dequeuePos = 0;
+    alignas(64) std::atomic<size_t> count{0};
+    std::atomic<bool> parked{false};
+    std::atomic<bool> cancelled{false};
+
+    std::mutex notifierMutex; // guards enqueueNotifier; only taken on the wake path
+    std::function<void()> enqueueNotifier;
+};
+
+typedef std::shared_ptr<MpscQueue> MpscQueueSp;
@@ -6,8 +6,12 @@ std::string NetworkScore::format() const
 {
     return std::format(
         "[SCORE] overall={} latency={} throughput={} stability={} queueHealth={} "
-        "| rtt={:.1f}ms cwnd={:.0f}KB tx={} reenq={} degraded={} dead={} alive={} qdepth={}",
+        "| rtt={:.1f}ms cwnd={:.0f}KB tx={} reenq={} degraded={} dead={} alive={} qdepth={} "
+        "| cc={} bw={:.0f}KB/s minRtt={:.1f}ms pacing={:.0f}KB/s qdelay={:.1f}ms "
+        "| reorderTimeout={:.0f}ms",
         overall, latency, throughput, stability, queueHealth,
         avgRttMs, avgCwndKB, totalTxCount, totalReenqueueCount,
-        degradedCount, deadCount, aliveCount, sendQueueDepth);
+        degradedCount, deadCount, aliveCount, sendQueueDepth,
+        congestionState, btlBwKBps, minRttMs, pacingRateKBps, queueDelayMs,
+        reorderTimeoutMs);
 }
@@ -23,7 +23,7 @@ struct NetworkScore
     /// Based on retransmissions, timeout episodes, and connection health.
     int stability = 0;
 
-    /// Based on send-queue depth relative to the drop threshold.
+    /// Based on send backlog relative to SEND_QUEUE_UNHEALTHY_DEPTH.
     int queueHealth = 0;
 
     // ---- Raw metrics (for diagnostics / before-after comparison) ----
@@ -37,9 +37,23 @@ struct NetworkScore
     int aliveCount = 0;
     size_t sendQueueDepth = 0;
 
+    // ---- VC congestion controller (see VcCongestionController) ----
+
+    const char *congestionState = "off"; // "off" when the controller is disabled
+    double btlBwKBps = 0.0;      // estimated bottleneck bandwidth
+    double minRttMs = 0.0;       // estimated base RTT of the path
+    double pacingRateKBps = 0.0; // 0: not paced
+    double queueDelayMs = 0.0;   // average RTT above the base RTT
+
+    // ---- Receive side (see ReorderTimeoutEstimator) ----
+
+    double reorderTimeoutMs = 0.0; // how long a gap may hold back delivery
+
     /// One-line summary suitable for log output.
     /// Example:
     ///   "[SCORE] overall=85 latency=90 throughput=78 stability=88 queueHealth=95
-    ///    | rtt=2.3ms cwnd=64KB tx=12345 reenq=3 degraded=0 dead=0 alive=32 qdepth=12"
+    ///    | rtt=2.3ms cwnd=64KB tx=12345 reenq=3 degraded=0 dead=0 alive=32 qdepth=12
+    ///    | cc=probe-bw bw=4096KB/s minRtt=20.0ms pacing=4096KB/s qdelay=3.1ms
+    ///    | reorderTimeout=450ms"
     std::string format() const;
 };
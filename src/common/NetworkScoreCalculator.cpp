@@ -1,5 +1,5 @@
 #include "NetworkScoreCalculator.h"
-#include "VcProtocol.h" // SEND_QUEUE_DROP_THRESHOLD
+#include "VcProtocol.h" // SEND_QUEUE_UNHEALTHY_DEPTH
 #include <algorithm>
 #include <cmath>
 
@@ -234,13 +234,13 @@ int NetworkScoreCalculator::scoreStability(uint64_t totalReenqueueCount, uint64_
 
 int NetworkScoreCalculator::scoreQueueHealth(size_t sendQueueDepth)
 {
-    // 0 depth → 100, at SEND_QUEUE_DROP_THRESHOLD → 0, above → 0.
+    // 0 depth → 100, at SEND_QUEUE_UNHEALTHY_DEPTH → 0, above → 0.
     if (sendQueueDepth == 0)
         return 100;
-    if (sendQueueDepth >= SEND_QUEUE_DROP_THRESHOLD)
+    if (sendQueueDepth >= SEND_QUEUE_UNHEALTHY_DEPTH)
         return 0;
 
-    // Linear interpolation: 100 at depth=0, 0 at depth=SEND_QUEUE_DROP_THRESHOLD
-    double ratio = static_cast<double>(sendQueueDepth) / static_cast<double>(SEND_QUEUE_DROP_THRESHOLD);
+    // Linear interpolation: 100 at depth=0, 0 at depth=SEND_QUEUE_UNHEALTHY_DEPTH
+    double ratio = static_cast<double>(sendQueueDepth) / static_cast<double>(SEND_QUEUE_UNHEALTHY_DEPTH);
     return static_cast<int>(std::round(100.0 * (1.0 - ratio)));
 }
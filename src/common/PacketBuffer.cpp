@@ -0,0 +1,291 @@
+#include "PacketBuffer.h"
+#include "Log.h"
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// ---- PacketBuffer ----
+
+PacketBuffer::PacketBuffer(const PacketBuffer &other) noexcept
+    : block(other.block), offset(other.offset), length(other.length)
+{
+    if (block)
+        block->refCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+PacketBuffer::PacketBuffer(PacketBuffer &&other) noexcept
+    : block(other.block), offset(other.offset), length(other.length)
+{
+    other.block = nullptr;
+    other.offset = 0;
+    other.length = 0;
+}
+
+PacketBuffer &PacketBuffer::operator=(const PacketBuffer &other) noexcept
+{
+    if (this != &other)
+    {
+        if (other.block)
+            other.block->refCount.fetch_add(1, std::memory_order_relaxed);
+        reset();
+        block = other.block;
+        offset = other.offset;
+        length = other.length;
+    }
+    return *this;
+}
+
+PacketBuffer &PacketBuffer::operator=(PacketBuffer &&other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        block = other.block;
+        offset = other.offset;
+        length = other.length;
+        other.block = nullptr;
+        other.offset = 0;
+        other.length = 0;
+    }
+    return *this;
+}
+
+PacketBuffer PacketBuffer::allocate(size_t size, size_t headroom)
+{
+    return PacketPool::instance().allocate(size, headroom);
+}
+
+PacketBuffer PacketBuffer::copyOf(const void *src, size_t size)
+{
+    auto buf = allocate(size);
+    if (size > 0)
+        std::memcpy(buf.data(), src, size);
+    return buf;
+}
+
+bool PacketBuffer::resize(size_t newSize)
+{
+    if (!block || offset + newSize > block->capacity)
+        return false;
+    length = static_cast<uint32_t>(newSize);
+    return true;
+}
+
+bool PacketBuffer::prepend(size_t n)
+{
+    if (!block || n > offset)
+        return false;
+    offset -= static_cast<uint32_t>(n);
+    length += static_cast<uint32_t>(n);
+    return true;
+}
+
+PacketBuffer PacketBuffer::slice(size_t sliceOffset, size_t sliceLength) const
+{
+    if (!block || sliceOffset > length || sliceLength > length - sliceOffset)
+        return PacketBuffer{};
+    block->refCount.fetch_add(1, std::memory_order_relaxed);
+    return PacketBuffer(block, offset + static_cast<uint32_t>(sliceOffset), static_cast<uint32_t>(sliceLength));
+}
+
+void PacketBuffer::reset()
+{
+    if (block)
+    {
+        // acq_rel: the thread that drops the last ref must observe every write made
+        // through other handles before the block is recycled.
+        if (block->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            block->owner->releaseBlock(block);
+        block = nullptr;
+    }
+    offset = 0;
+    length = 0;
+}
+
+// ---- PacketPool ----
+
+std::string PacketPool::Stats::format() const
+{
+    std::string out = "[POOL]";
+    for (const auto &c : classes)
+    {
+        out += std::format(" {}B:hit={} miss={} out={} hwm={} slabKB={}", c.blockSize, c.hits, c.misses,
+                           c.outstanding, c.highWater, c.slabBytes / 1024);
+    }
+    out += std::format(" oversize={}", oversize);
+    return out;
+}
+
+PacketPool &PacketPool::instance()
+{
+    static PacketPool *pool = new PacketPool();
+    return *pool;
+}
+
+PacketPool::~PacketPool()
+{
+    std::lock_guard<std::mutex> lock(slabsMutex);
+    for (auto &slab : slabs)
+    {
+#if defined(__linux__)
+        if (slab.mapped)
+        {
+            munmap(slab.memory, slab.bytes);
+            continue;
+        }
+#endif
+        ::operator delete(slab.memory, std::align_val_t(alignof(PacketBlock)));
+    }
+    slabs.clear();
+}
+
+int PacketPool::classFor(size_t size)
+{
+    for (size_t i = 0; i < SIZE_CLASSES.size(); i++)
+    {
+        if (size <= SIZE_CLASSES[i])
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+size_t PacketPool::strideFor(size_t classIndex)
+{
+    size_t stride = sizeof(PacketBlock) + SIZE_CLASSES[classIndex];
+    return (stride + alignof(PacketBlock) - 1) & ~(alignof(PacketBlock) - 1);
+}
+
+PacketBuffer PacketPool::allocate(size_t size, size_t headroom)
+{
+    const size_t total = size + headroom;
+    int cls = classFor(total);
+    if (cls < 0)
+    {
+        // Larger than any size class: plain heap block, freed back to the heap.
+        void *mem = ::operator new(sizeof(PacketBlock) + total, std::align_val_t(alignof(PacketBlock)));
+        auto *block = new (mem) PacketBlock();
+        block->capacity = static_cast<uint32_t>(total);
+        block->sizeClass = OVERSIZE_CLASS;
+        block->owner = this;
+        block->base = reinterpret_cast<char *>(block + 1);
+        block->refCount.store(1, std::memory_order_relaxed);
+        oversizeCount.fetch_add(1, std::memory_order_relaxed);
+        return PacketBuffer(block, static_cast<uint32_t>(headroom), static_cast<uint32_t>(size));
+    }
+
+    auto &sc = classes[cls];
+    PacketBlock *block = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(sc.mutex);
+        if (!sc.freeList)
+        {
+            refill(static_cast<size_t>(cls));
+            sc.stats.misses++;
+        }
+        else
+        {
+            sc.stats.hits++;
+        }
+        block = sc.freeList;
+        if (!block)
+            throw std::bad_alloc();
+        sc.freeList = block->nextFree;
+        sc.stats.outstanding++;
+        sc.stats.highWater = std::max(sc.stats.highWater, sc.stats.outstanding);
+    }
+
+    block->nextFree = nullptr;
+    // release: a lock-free reader (SentDataCache::find) that races this reuse and
+    // bumps the new count must also see everything that happened before the block
+    // was freed, so its re-validation notices the slot changed.
+    block->refCount.store(1, std::memory_order_release);
+    return PacketBuffer(block, static_cast<uint32_t>(headroom), static_cast<uint32_t>(size));
+}
+
+void PacketPool::releaseBlock(PacketBlock *block)
+{
+    if (block->sizeClass == OVERSIZE_CLASS)
+    {
+        block->~PacketBlock();
+        ::operator delete(block, std::align_val_t(alignof(PacketBlock)));
+        return;
+    }
+
+    auto &sc = classes[block->sizeClass];
+    std::lock_guard<std::mutex> lock(sc.mutex);
+    block->nextFree = sc.freeList;
+    sc.freeList = block;
+    sc.stats.outstanding--;
+}
+
+// Caller holds classes[classIndex].mutex.
+void PacketPool::refill(size_t classIndex)
+{
+    const size_t stride = strideFor(classIndex);
+    size_t bytes = stride * BLOCKS_PER_SLAB;
+    bool hugePages = useHugePages.load(std::memory_order_relaxed);
+    if (hugePages)
+    {
+        static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+        bytes = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    }
+
+    bool mapped = false;
+    void *memory = allocateSlab(bytes, mapped);
+    if (!memory)
+        return;
+
+    auto &sc = classes[classIndex];
+    char *base = static_cast<char *>(memory);
+    const size_t count = bytes / stride;
+    for (size_t i = 0; i < count; i++)
+    {
+        auto *block = new (base + i * stride) PacketBlock();
+        block->capacity = static_cast<uint32_t>(SIZE_CLASSES[classIndex]);
+        block->sizeClass = static_cast<uint8_t>(classIndex);
+        block->owner = this;
+        block->base = reinterpret_cast<char *>(block + 1);
+        block->nextFree = sc.freeList;
+        sc.freeList = block;
+    }
+    sc.stats.slabBytes += bytes;
+
+    std::lock_guard<std::mutex> lock(slabsMutex);
+    slabs.push_back({memory, bytes, mapped});
+}
+
+void *PacketPool::allocateSlab(size_t bytes, bool &mapped)
+{
+    mapped = false;
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    if (useHugePages.load(std::memory_order_relaxed))
+    {
+        void *mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mem != MAP_FAILED)
+        {
+            mapped = true;
+            return mem;
+        }
+        log_warnning(std::format("[POOL] MAP_HUGETLB slab of {} bytes failed, using regular pages", bytes));
+    }
+#endif
+    return ::operator new(bytes, std::align_val_t(alignof(PacketBlock)), std::nothrow);
+}
+
+PacketPool::Stats PacketPool::getStats() const
+{
+    Stats out;
+    for (size_t i = 0; i < SIZE_CLASSES.size(); i++)
+    {
+        std::lock_guard<std::mutex> lock(classes[i].mutex);
+        out.classes[i] = classes[i].stats;
+        out.classes[i].blockSize = SIZE_CLASSES[i];
+    }
+    out.oversize = oversizeCount.load(std::memory_order_relaxed);
+    return out;
+}
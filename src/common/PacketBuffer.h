@@ -0,0 +1,237 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class PacketPool;
+struct PacketBlock;
+
+/// Whoever hands out PacketBlocks and takes them back when the last PacketBuffer
+/// referencing one is released: PacketPool for pooled and heap blocks, ReceiveRing for
+/// views into a connection's receive ring.
+class PacketBlockOwner
+{
+  public:
+    virtual void releaseBlock(PacketBlock *block) = 0;
+
+  protected:
+    ~PacketBlockOwner() = default;
+};
+
+/// Header of a reference-counted byte block. For pooled blocks the payload bytes follow
+/// the header directly inside the slab the block was carved from; other owners point
+/// `base` at memory they manage themselves.
+///
+/// Pooled blocks are never handed back to the OS while their pool is alive, so a
+/// stale PacketBlock* still points at a valid header (type-stable memory). Lock-free
+/// readers such as SentDataCache rely on this to validate a slot after taking a ref.
+struct alignas(16) PacketBlock
+{
+    std::atomic<uint32_t> refCount{0};
+    uint32_t capacity{0};
+    uint8_t sizeClass{0};
+    PacketBlockOwner *owner{nullptr};
+    PacketBlock *nextFree{nullptr};
+    char *base{nullptr};
+
+    char *bytes()
+    {
+        return base;
+    }
+};
+
+/// Refcounted handle to a byte range [offset, offset + length) of a PacketBlock.
+///
+/// Copying a PacketBuffer only bumps the block refcount; the block goes back to its
+/// pool when the last handle is released. This is the unit that travels through the
+/// VC data path (send queues, SentDataCache, receive queues, reorder buffer) in place
+/// of std::shared_ptr<std::vector<char>>.
+class PacketBuffer
+{
+  public:
+    PacketBuffer() = default;
+    PacketBuffer(const PacketBuffer &other) noexcept;
+    PacketBuffer(PacketBuffer &&other) noexcept;
+    PacketBuffer &operator=(const PacketBuffer &other) noexcept;
+    PacketBuffer &operator=(PacketBuffer &&other) noexcept;
+    ~PacketBuffer()
+    {
+        reset();
+    }
+
+    /// Allocate an uninitialized buffer of `size` bytes from the global pool, with
+    /// `headroom` spare bytes reserved in front of data() for prepend().
+    static PacketBuffer allocate(size_t size, size_t headroom = 0);
+
+    /// Allocate from the global pool and copy `size` bytes from `src`.
+    static PacketBuffer copyOf(const void *src, size_t size);
+
+    char *data()
+    {
+        return block ? block->bytes() + offset : nullptr;
+    }
+    const char *data() const
+    {
+        return block ? block->bytes() + offset : nullptr;
+    }
+    size_t size() const
+    {
+        return length;
+    }
+    bool empty() const
+    {
+        return length == 0;
+    }
+    explicit operator bool() const
+    {
+        return block != nullptr;
+    }
+
+    /// Bytes available in front of data() inside the same block.
+    size_t headroom() const
+    {
+        return offset;
+    }
+
+    /// Bytes available after the end of this buffer inside the same block.
+    size_t tailroom() const
+    {
+        return block ? block->capacity - offset - length : 0;
+    }
+
+    /// Shrink or grow the buffer in place. Growth must fit in tailroom().
+    /// Returns false (and leaves the buffer unchanged) if it does not.
+    bool resize(size_t newSize);
+
+    /// Extend the buffer `n` bytes to the front, into its headroom, so a protocol
+    /// header can be written in place before the payload. Returns false (and
+    /// leaves the buffer unchanged) if there is not enough headroom.
+    bool prepend(size_t n);
+
+    /// A view of [offset, offset + length) of this buffer that shares (and keeps alive)
+    /// the same block. Returns an empty buffer if the range is out of bounds.
+    PacketBuffer slice(size_t offset, size_t length) const;
+
+    /// Drop the reference held by this handle.
+    void reset();
+
+    uint32_t useCount() const
+    {
+        return block ? block->refCount.load(std::memory_order_relaxed) : 0;
+    }
+
+  private:
+    friend class PacketPool;
+    friend class SentDataCache; // stores raw (block, offset, length) in seqlocked slots
+    friend class ReceiveRing;   // wraps ring spans in PacketBuffers
+
+    PacketBuffer(PacketBlock *block, uint32_t offset, uint32_t length)
+        : block(block), offset(offset), length(length)
+    {
+    }
+
+    PacketBlock *block = nullptr;
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+/// Slab allocator for PacketBlocks with a fixed set of size classes.
+///
+/// Each size class keeps a free list of blocks carved from slabs; a released block
+/// goes back onto its class free list instead of to the heap, so steady-state
+/// traffic does no malloc/free at all. Requests larger than the biggest class are
+/// served straight from the heap (counted as oversize).
+class PacketPool : public PacketBlockOwner
+{
+  public:
+    /// Block payload sizes. The 2 KB class holds one full VC data frame
+    /// (VC_MAX_DATA_PAYLOAD_SIZE + sizeof(VCDataPacket)); 1 KB covers control frames
+    /// such as MISSING_NOTIFY; 64 KB is for bulk receive buffers.
+    static constexpr std::array<size_t, 4> SIZE_CLASSES = {128, 1024, 2048, 65536};
+    static constexpr uint8_t OVERSIZE_CLASS = 0xFF;
+    static constexpr uint8_t EXTERNAL_CLASS = 0xFE; // block owned by something other than a pool
+
+    /// True for blocks carved from a pool slab, which are type-stable.
+    static bool isPooled(const PacketBlock *block)
+    {
+        return block->sizeClass < SIZE_CLASSES.size();
+    }
+
+    struct ClassStats
+    {
+        size_t blockSize = 0;
+        uint64_t hits = 0;      // served from the free list
+        uint64_t misses = 0;    // free list empty, block carved from a new slab
+        size_t outstanding = 0; // blocks currently held by PacketBuffers
+        size_t highWater = 0;   // peak of `outstanding`
+        size_t slabBytes = 0;   // total slab memory reserved for this class
+    };
+
+    struct Stats
+    {
+        std::array<ClassStats, SIZE_CLASSES.size()> classes;
+        uint64_t oversize = 0;
+
+        /// One-line summary suitable for log output.
+        std::string format() const;
+    };
+
+    PacketPool() = default;
+    ~PacketPool();
+
+    PacketPool(const PacketPool &) = delete;
+    PacketPool &operator=(const PacketPool &) = delete;
+
+    /// Process-wide pool used by PacketBuffer::allocate. Intentionally never
+    /// destroyed so buffers released during static destruction stay valid.
+    static PacketPool &instance();
+
+    PacketBuffer allocate(size_t size, size_t headroom = 0);
+
+    /// Back new slabs with huge pages where the platform supports it (Linux
+    /// MAP_HUGETLB). Falls back to regular pages if the mapping fails. Only
+    /// affects slabs allocated after the call.
+    void setUseHugePages(bool enable)
+    {
+        useHugePages.store(enable, std::memory_order_relaxed);
+    }
+
+    Stats getStats() const;
+
+  private:
+    friend class PacketBuffer;
+
+    struct SizeClass
+    {
+        mutable std::mutex mutex;
+        PacketBlock *freeList = nullptr;
+        ClassStats stats;
+    };
+
+    struct Slab
+    {
+        void *memory = nullptr;
+        size_t bytes = 0;
+        bool mapped = false;
+    };
+
+    static constexpr size_t BLOCKS_PER_SLAB = 64;
+
+    static int classFor(size_t size);
+    static size_t strideFor(size_t classIndex);
+
+    void releaseBlock(PacketBlock *block) override;
+    void refill(size_t classIndex);
+    void *allocateSlab(size_t bytes, bool &mapped);
+
+    std::array<SizeClass, SIZE_CLASSES.size()> classes;
+    std::mutex slabsMutex;
+    std::vector<Slab> slabs;
+    std::atomic<uint64_t> oversizeCount{0};
+    std::atomic<bool> useHugePages{false};
+};
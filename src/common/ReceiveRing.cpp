@@ -0,0 +1,90 @@
+#include "ReceiveRing.h"
+
+ReceiveRing::Ptr ReceiveRing::create(size_t size, std::function<void()> onSpaceFreed)
+{
+    return Ptr(new ReceiveRing(size, std::move(onSpaceFreed)));
+}
+
+ReceiveRing::ReceiveRing(size_t size, std::function<void()> onSpaceFreed_)
+    : ring(size), spans(std::make_unique<Span[]>(MAX_SPANS)), onSpaceFreed(std::move(onSpaceFreed_))
+{
+}
+
+void ReceiveRing::retire()
+{
+    unref();
+}
+
+void ReceiveRing::unref()
+{
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+}
+
+void ReceiveRing::releaseBlock(PacketBlock *block)
+{
+    // Runs on whichever thread dropped the last handle (usually the reorder thread).
+    auto *span = reinterpret_cast<Span *>(block);
+    span->released.store(true, std::memory_order_release);
+    // Pairs with the fence in writable(): either it sees this release, or this sees its
+    // waitingForSpace and wakes the IO thread. Must run before unref() may free the ring.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waitingForSpace.load(std::memory_order_relaxed) && waitingForSpace.exchange(false, std::memory_order_relaxed) &&
+        onSpaceFreed)
+        onSpaceFreed();
+    unref();
+}
+
+void ReceiveRing::reclaim()
+{
+    while (spanTail != spanHead && spans[spanTail % MAX_SPANS].released.load(std::memory_order_acquire))
+        spanTail++;
+    reclaimPos = spanTail != spanHead ? spans[spanTail % MAX_SPANS].startPos : readPos;
+}
+
+size_t ReceiveRing::writable()
+{
+    reclaim();
+    size_t free = ring.size() - static_cast<size_t>(writePos - reclaimPos);
+    size_t space = ring.writableAt(writePos, free);
+    if (space == 0 && onSpaceFreed)
+    {
+        // Arm the wake, then look again so a release racing with the arm is not lost.
+        waitingForSpace.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        reclaim();
+        free = ring.size() - static_cast<size_t>(writePos - reclaimPos);
+        space = ring.writableAt(writePos, free);
+        if (space != 0)
+            waitingForSpace.store(false, std::memory_order_relaxed);
+    }
+    return space;
+}
+
+void ReceiveRing::commitWrite(size_t n)
+{
+    ring.commit(writePos, n);
+    writePos += n;
+}
+
+PacketBuffer ReceiveRing::view(size_t offset, size_t length)
+{
+    if (spanHead - spanTail >= MAX_SPANS)
+    {
+        reclaim();
+        if (spanHead - spanTail >= MAX_SPANS)
+            return PacketBuffer::copyOf(readPtr() + offset, length);
+    }
+
+    Span &span = spans[spanHead % MAX_SPANS];
+    span.startPos = readPos + offset;
+    span.released.store(false, std::memory_order_relaxed);
+    span.block.refCount.store(1, std::memory_order_relaxed);
+    span.block.capacity = static_cast<uint32_t>(length);
+    span.block.sizeClass = PacketPool::EXTERNAL_CLASS;
+    span.block.owner = this;
+    span.block.base = ring.at(span.startPos);
+    spanHead++;
+    refs.fetch_add(1, std::memory_order_relaxed);
+    return PacketBuffer(&span.block, 0, static_cast<uint32_t>(length));
+}
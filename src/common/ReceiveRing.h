@@ -0,0 +1,124 @@
+#pragma once
+
+#include "MirroredRing.h"
+#include "PacketBuffer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+/// Per-connection TCP read buffer: a fixed MirroredRing that recv() writes into and
+/// the IO thread parses in place, plus tracking for the payload views handed out of
+/// it.
+///
+/// DATA payloads leave as PacketBuffer views straight into the ring (no copy). Each
+/// view is backed by a span descriptor. Ring space is reclaimed in stream order up to
+/// the oldest span that is still referenced, so a payload sitting in the reorder
+/// window pins the ring from that point on. When the ring is full, writable() returns
+/// 0 and the IO thread stops reading the connection (TCP backpressure) until views are
+/// released; the first release after that calls the ring's onSpaceFreed hook so the IO
+/// thread can resume at once instead of on its next poll timeout. If all span descriptors are in use, view() copies the payload into the
+/// PacketPool instead.
+///
+/// Lifetime: the IO thread owns one reference (dropped with retire(), e.g. through
+/// ReceiveRing::Ptr) and every outstanding view owns another, so a ring whose
+/// connection has been replaced stays mapped until its last payload is delivered.
+class ReceiveRing final : public PacketBlockOwner
+{
+  public:
+    static constexpr size_t DEFAULT_SIZE = 256 * 1024;
+    static constexpr size_t MAX_SPANS = 1024;
+
+    struct Retire
+    {
+        void operator()(ReceiveRing *ring) const
+        {
+            ring->retire();
+        }
+    };
+    using Ptr = std::unique_ptr<ReceiveRing, Retire>;
+
+    /// `onSpaceFreed` runs on the releasing thread, after writable() has returned 0, when
+    /// a view is released. It must be cheap and must not touch the ring.
+    static Ptr create(size_t size = DEFAULT_SIZE, std::function<void()> onSpaceFreed = nullptr);
+
+    /// Drop the owner's reference. The ring is freed once no views remain.
+    void retire();
+
+    // ---- recv side ----
+
+    /// Start of the free space that recv() may write into.
+    char *writePtr() const
+    {
+        return ring.at(writePos);
+    }
+    /// Contiguous free bytes at writePtr(), after reclaiming released views. Returning 0
+    /// arms onSpaceFreed for the next release.
+    size_t writable();
+    /// Account for `n` bytes written at writePtr().
+    void commitWrite(size_t n);
+
+    // ---- parser side ----
+
+    size_t available() const
+    {
+        return static_cast<size_t>(writePos - readPos);
+    }
+    /// Unparsed bytes; contiguous for at least min(available(), ring size).
+    char *readPtr() const
+    {
+        return ring.at(readPos);
+    }
+    void consume(size_t n)
+    {
+        readPos += n;
+    }
+    /// Drop all unparsed bytes (e.g. after a framing error). Outstanding views stay valid.
+    void discardUnparsed()
+    {
+        readPos = writePos;
+    }
+
+    /// A PacketBuffer over [readPtr() + offset, + length) that keeps those bytes from
+    /// being overwritten until it (and every copy of it) is released.
+    PacketBuffer view(size_t offset, size_t length);
+
+    size_t size() const
+    {
+        return ring.size();
+    }
+    bool isMirrored() const
+    {
+        return ring.isMirrored();
+    }
+
+  private:
+    struct Span
+    {
+        PacketBlock block; // first member: releaseBlock() maps the block back to its Span
+        uint64_t startPos = 0;
+        std::atomic<bool> released{true};
+    };
+
+    ReceiveRing(size_t size, std::function<void()> onSpaceFreed);
+    ~ReceiveRing() = default;
+
+    void releaseBlock(PacketBlock *block) override;
+    void unref();
+    void reclaim();
+
+    MirroredRing ring;
+    std::unique_ptr<Span[]> spans;
+    uint64_t spanHead = 0; // next descriptor to hand out
+    uint64_t spanTail = 0; // oldest descriptor not yet reclaimed
+
+    uint64_t writePos = 0;   // end of received bytes
+    uint64_t readPos = 0;    // end of parsed bytes
+    uint64_t reclaimPos = 0; // bytes before this may be overwritten
+
+    std::function<void()> onSpaceFreed;
+    std::atomic<bool> waitingForSpace{false}; // set by writable() == 0, cleared by the wake
+
+    std::atomic<uint32_t> refs{1};
+};
@@ -0,0 +1,84 @@
+#include "ReorderTimeoutEstimator.h"
+#include <algorithm>
+#include <format>
+
+std::string ReorderTimeoutStats::format() const
+{
+    return std::format("[REORDER] timeoutMs={}{} srttMs={:.1f} rttvarMs={:.1f} samples={} lateFills={}",
+                       timeoutUs.load(std::memory_order_relaxed) / 1000,
+                       fixed.load(std::memory_order_relaxed) ? " (fixed)" : "",
+                       srttUs.load(std::memory_order_relaxed) / 1000.0,
+                       rttvarUs.load(std::memory_order_relaxed) / 1000.0, samples.load(std::memory_order_relaxed),
+                       lateFills.load(std::memory_order_relaxed));
+}
+
+ReorderTimeoutEstimator::ReorderTimeoutEstimator(std::shared_ptr<ReorderTimeoutStats> stats_)
+    : stats(stats_ ? std::move(stats_) : std::make_shared<ReorderTimeoutStats>())
+{
+    update();
+}
+
+void ReorderTimeoutEstimator::setFixed(Clock::duration timeout)
+{
+    fixed = std::max<Clock::duration>(timeout, Clock::duration::zero());
+    update();
+}
+
+void ReorderTimeoutEstimator::setBounds(Clock::duration min, Clock::duration max)
+{
+    minTimeout = min;
+    maxTimeout = std::max(min, max);
+    update();
+}
+
+void ReorderTimeoutEstimator::setRecoveryTime(Clock::duration recovery_)
+{
+    recovery = recovery_;
+    update();
+}
+
+void ReorderTimeoutEstimator::onGapFilled(Clock::duration held)
+{
+    sample(static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(held).count()));
+    update();
+}
+
+void ReorderTimeoutEstimator::onLateFill(Clock::duration late)
+{
+    auto us = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(late).count());
+    sample(us);
+    fillTime.floorSrtt(us);
+    stats->lateFills.fetch_add(1, std::memory_order_relaxed);
+    update();
+}
+
+void ReorderTimeoutEstimator::sample(double us)
+{
+    if (us < 0)
+        return;
+    fillTime.sample(us);
+    stats->samples.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ReorderTimeoutEstimator::update()
+{
+    if (fixed > Clock::duration::zero())
+    {
+        current = fixed;
+    }
+    else
+    {
+        Clock::duration adaptive = VC_INITIAL_REORDER_TIMEOUT;
+        if (!fillTime.empty())
+        {
+            // As in the RTO, at least a millisecond of variance.
+            adaptive = std::max<Clock::duration>(fillTime.rto(4, std::chrono::milliseconds(1)), recovery);
+        }
+        current = std::clamp(adaptive, minTimeout, maxTimeout);
+    }
+    stats->timeoutUs.store(std::chrono::duration_cast<std::chrono::microseconds>(current).count(),
+                           std::memory_order_relaxed);
+    stats->srttUs.store(static_cast<uint64_t>(fillTime.srtt()), std::memory_order_relaxed);
+    stats->rttvarUs.store(static_cast<uint64_t>(fillTime.rttvar()), std::memory_order_relaxed);
+    stats->fixed.store(fixed > Clock::duration::zero(), std::memory_order_relaxed);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "RttEstimator.h"
+#include "VcProtocol.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/// Current reorder timeout and the estimate behind it. Readable from any thread.
+struct ReorderTimeoutStats
+{
+    std::atomic<uint64_t> timeoutUs{0};
+    std::atomic<uint64_t> srttUs{0};   // smoothed gap fill time; 0 until sampled
+    std::atomic<uint64_t> rttvarUs{0};
+    std::atomic<uint64_t> samples{0};  // gaps that filled
+    std::atomic<uint64_t> lateFills{0}; // frames that arrived after their gap was skipped
+    std::atomic<bool> fixed{false};
+
+    /// One-line summary suitable for log output.
+    std::string format() const;
+};
+
+/// Receiver-side reorder timeout, adapted to the path the way TCP adapts its RTO
+/// (RFC 6298).
+///
+/// A sample is how long a gap at the head of the reorder window stayed open before it
+/// filled: the arrival skew between connections when the frame was only overtaken,
+/// or the NACK and resend round trip when it was lost. The timeout is
+/// srtt + 4 * rttvar of those samples, but never less than the recovery time (what
+/// one NACK-driven resend needs: the notify delay plus a round trip on the path), and
+/// clamped to the bounds. A frame arriving after the timeout already skipped its gap
+/// proves gaps take at least that long; its delay is both sampled and taken as the
+/// new srtt floor, so the next timeout covers it.
+///
+/// setFixed() pins the timeout, e.g. to a configured value.
+///
+/// Single-threaded: owned by the VC reorder thread; configure before open().
+class ReorderTimeoutEstimator
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ReorderTimeoutEstimator(std::shared_ptr<ReorderTimeoutStats> stats = nullptr);
+
+    /// Use `timeout` as is instead of adapting; zero returns to adapting.
+    void setFixed(Clock::duration timeout);
+    void setBounds(Clock::duration min, Clock::duration max);
+    /// Time a NACK-driven resend needs to fill a gap: the floor of the timeout.
+    void setRecoveryTime(Clock::duration recovery);
+
+    /// The gap at the head of the window filled after being open for `held`.
+    void onGapFilled(Clock::duration held);
+    /// A frame whose gap the timeout had skipped arrived `late` after the gap opened.
+    void onLateFill(Clock::duration late);
+
+    Clock::duration timeout() const
+    {
+        return current;
+    }
+
+  private:
+    void sample(double us);
+    void update();
+
+    Clock::duration fixed{};
+    Clock::duration minTimeout = VC_MIN_REORDER_TIMEOUT;
+    Clock::duration maxTimeout = VC_MAX_REORDER_TIMEOUT;
+    Clock::duration recovery{};
+    Clock::duration current = VC_INITIAL_REORDER_TIMEOUT;
+    RttEstimator fillTime; // over gap fill times
+    std::shared_ptr<ReorderTimeoutStats> stats;
+};
@@ -0,0 +1,268 @@
+#pragma once
+
+#include "PacketBuffer.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/// Fixed-capacity reorder buffer for the dense, monotonic VC message IDs.
+///
+/// Covers the window [base(), base() + capacity()). Message M lives in slot
+/// (M & mask) and an occupancy bitmap tracks which slots hold an item, so an insert
+/// is an index plus a bit set (no node allocation, no tree walk). Draining the
+/// in-order run at the front and walking the gaps for MISSING_RANGES both scan the
+/// bitmap a 64-bit word at a time with countr_zero.
+///
+/// Single-threaded: owned by the reorder thread.
+class ReorderWindow
+{
+  public:
+    /// Matches the sender's resend horizon (SentDataCache / MessageTracker): an ID
+    /// further ahead than this means the gap behind it is no longer recoverable.
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    struct Item
+    {
+        PacketBuffer data;
+        int sourceConnIndex{-1};
+    };
+
+    enum class InsertResult
+    {
+        Inserted,
+        Duplicate,    // already buffered
+        Stale,        // below base(): already delivered or skipped
+        BeyondWindow, // >= base() + capacity(); caller must advance() first
+    };
+
+    explicit ReorderWindow(size_t capacity = DEFAULT_CAPACITY)
+    {
+        size_t slotCount = WORD_BITS;
+        while (slotCount < capacity)
+            slotCount <<= 1;
+        items.resize(slotCount);
+        occupied.assign(slotCount / WORD_BITS, 0);
+        mask = slotCount - 1;
+    }
+
+    InsertResult insert(uint64_t messageId, Item item)
+    {
+        if (messageId < windowBase)
+            return InsertResult::Stale;
+        if (messageId - windowBase > mask)
+            return InsertResult::BeyondWindow;
+
+        size_t idx = messageId & mask;
+        uint64_t bit = uint64_t{1} << (idx % WORD_BITS);
+        uint64_t &word = occupied[idx / WORD_BITS];
+        if (word & bit)
+            return InsertResult::Duplicate;
+
+        word |= bit;
+        items[idx] = std::move(item);
+        if (count == 0 || messageId > highestId)
+            highestId = messageId;
+        count++;
+        return InsertResult::Inserted;
+    }
+
+    /// Next ID expected in order; everything below it has been delivered or skipped.
+    uint64_t base() const
+    {
+        return windowBase;
+    }
+    size_t size() const
+    {
+        return count;
+    }
+    bool empty() const
+    {
+        return count == 0;
+    }
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    /// Lowest / highest buffered ID. Only meaningful when !empty().
+    uint64_t lowest() const
+    {
+        return nextPresent(windowBase, highestId + 1);
+    }
+    uint64_t highest() const
+    {
+        return highestId;
+    }
+
+    const Item *find(uint64_t messageId) const
+    {
+        if (messageId < windowBase || messageId - windowBase > mask || !test(messageId & mask))
+            return nullptr;
+        return &items[messageId & mask];
+    }
+
+    /// Pop the contiguous run starting at base(), calling deliver(id, Item&&) for each
+    /// in order, and advance base() past it. Returns the number delivered.
+    template <typename Deliver>
+    size_t drain(Deliver &&deliver)
+    {
+        if (count == 0)
+            return 0;
+        uint64_t end = nextMissing(windowBase, highestId + 1);
+        size_t delivered = 0;
+        for (uint64_t id = windowBase; id < end; id++)
+        {
+            deliver(id, take(id));
+            delivered++;
+        }
+        windowBase = end;
+        return delivered;
+    }
+
+    /// Move base() forward to `newBase`, delivering any buffered items below it in
+    /// order and skipping the holes between them. Returns the number delivered.
+    template <typename Deliver>
+    size_t advance(uint64_t newBase, Deliver &&deliver)
+    {
+        if (newBase <= windowBase)
+            return 0;
+        size_t delivered = 0;
+        if (count > 0)
+        {
+            uint64_t limit = std::min(newBase, highestId + 1);
+            for (uint64_t id = nextPresent(windowBase, limit); id < limit; id = nextPresent(id + 1, limit))
+            {
+                deliver(id, take(id));
+                delivered++;
+            }
+        }
+        windowBase = newBase;
+        return delivered;
+    }
+
+    /// Visit buffered items in ID order: fn(id, const Item&).
+    template <typename Fn>
+    void forEach(Fn &&fn) const
+    {
+        if (count == 0)
+            return;
+        const uint64_t limit = highestId + 1;
+        for (uint64_t id = nextPresent(windowBase, limit); id < limit; id = nextPresent(id + 1, limit))
+            fn(id, items[id & mask]);
+    }
+
+    /// Visit the IDs missing below the highest buffered one, in order. fn(id) returns
+    /// false to stop early.
+    template <typename Fn>
+    void forEachMissing(Fn &&fn) const
+    {
+        if (count == 0)
+            return;
+        const uint64_t limit = highestId;
+        for (uint64_t id = nextMissing(windowBase, limit); id < limit; id = nextMissing(id + 1, limit))
+        {
+            if (!fn(id))
+                return;
+        }
+    }
+
+    /// Visit the gaps below the highest buffered ID, starting at `from`, as runs:
+    /// fn(firstMissing, count) returns false to stop early. Costs one word scan per
+    /// run rather than one step per missing ID.
+    template <typename Fn>
+    void forEachMissingRun(uint64_t from, Fn &&fn) const
+    {
+        if (count == 0)
+            return;
+        const uint64_t limit = highestId;
+        for (uint64_t id = nextMissing(std::max(from, windowBase), limit); id < limit;)
+        {
+            uint64_t end = nextPresent(id, limit);
+            if (!fn(id, end - id))
+                return;
+            id = nextMissing(end, limit);
+        }
+    }
+
+    /// Fill `words` with the occupancy of IDs [from, from + 64 * wordCount): bit i of
+    /// word w is set if ID from + 64 * w + i is buffered.
+    void bitmap(uint64_t from, uint64_t *words, size_t wordCount) const
+    {
+        std::fill(words, words + wordCount, 0);
+        if (count == 0)
+            return;
+        const uint64_t limit = std::min<uint64_t>(from + wordCount * WORD_BITS, highestId + 1);
+        for (uint64_t id = nextPresent(std::max(from, windowBase), limit); id < limit; id = nextPresent(id + 1, limit))
+            words[(id - from) / WORD_BITS] |= uint64_t{1} << ((id - from) % WORD_BITS);
+    }
+
+    /// Drop everything and restart the window at `newBase`.
+    void reset(uint64_t newBase = 0)
+    {
+        for (auto &item : items)
+            item = Item{};
+        std::fill(occupied.begin(), occupied.end(), 0);
+        count = 0;
+        highestId = 0;
+        windowBase = newBase;
+    }
+
+  private:
+    static constexpr size_t WORD_BITS = 64;
+
+    bool test(size_t idx) const
+    {
+        return (occupied[idx / WORD_BITS] >> (idx % WORD_BITS)) & 1;
+    }
+
+    Item take(uint64_t messageId)
+    {
+        size_t idx = messageId & mask;
+        occupied[idx / WORD_BITS] &= ~(uint64_t{1} << (idx % WORD_BITS));
+        count--;
+        return std::move(items[idx]);
+    }
+
+    // First ID in [from, limit) whose occupancy bit equals `present`, or `limit` if
+    // none. Steps a whole word at a time; the capacity is a multiple of the word size,
+    // so stepping past the last word wraps cleanly to word 0.
+    uint64_t scan(uint64_t from, uint64_t limit, bool present) const
+    {
+        while (from < limit)
+        {
+            size_t idx = from & mask;
+            unsigned shift = idx % WORD_BITS;
+            uint64_t word = occupied[idx / WORD_BITS];
+            if (!present)
+                word = ~word;
+            word >>= shift;
+            if (word != 0)
+            {
+                uint64_t hit = from + std::countr_zero(word);
+                return hit < limit ? hit : limit;
+            }
+            from += WORD_BITS - shift;
+        }
+        return limit;
+    }
+
+    uint64_t nextPresent(uint64_t from, uint64_t limit) const
+    {
+        return scan(from, limit, true);
+    }
+
+    uint64_t nextMissing(uint64_t from, uint64_t limit) const
+    {
+        return scan(from, limit, false);
+    }
+
+    std::vector<Item> items;
+    std::vector<uint64_t> occupied;
+    size_t mask = 0;
+    uint64_t windowBase = 0;
+    uint64_t highestId = 0;
+    size_t count = 0;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+/// Smoothed round-trip estimate as TCP keeps it (RFC 6298): srtt and rttvar in
+/// microseconds, with gains 1/8 and 1/4, seeded by the first sample. Used for any
+/// round-trip-like delay: delivery latency, gap fill times, NACK-to-fill times.
+///
+/// Not thread-safe; the owner serializes access.
+class RttEstimator
+{
+  public:
+    /// Feed one measurement; negative ones are ignored.
+    void sample(double us)
+    {
+        if (us < 0)
+            return;
+        if (srttUs == 0)
+        {
+            srttUs = std::max(us, 1.0);
+            rttvarUs = us / 2;
+        }
+        else
+        {
+            rttvarUs = 0.75 * rttvarUs + 0.25 * std::abs(srttUs - us);
+            srttUs = 0.875 * srttUs + 0.125 * us;
+        }
+    }
+
+    /// Raise srtt to at least `us`, e.g. after a sample proved the estimate too low.
+    void floorSrtt(double us)
+    {
+        srttUs = std::max(srttUs, us);
+    }
+
+    /// srtt + k * rttvar, the variance term at least `minVar`. Zero until sampled.
+    std::chrono::microseconds rto(double k = 4, std::chrono::microseconds minVar = {}) const
+    {
+        if (empty())
+            return {};
+        return std::chrono::microseconds(
+            static_cast<int64_t>(srttUs + std::max(k * rttvarUs, static_cast<double>(minVar.count()))));
+    }
+
+    bool empty() const
+    {
+        return srttUs == 0;
+    }
+    double srtt() const
+    {
+        return srttUs;
+    }
+    double rttvar() const
+    {
+        return rttvarUs;
+    }
+
+  private:
+    double srttUs = 0; // 0 until sampled
+    double rttvarUs = 0;
+};
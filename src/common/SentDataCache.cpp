@@ -0,0 +1,310 @@
+#include "SentDataCache.h"
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <thread>
+
+std::string SentDataCache::Stats::format() const
+{
+    return std::format("[SENTCACHE] entries={}/{} KB={}/{} minAgeMs={} inserts={} hits={} misses={} "
+                       "budgetEvict={} forcedEvict={} released={}",
+                       entries, capacity, bytes / 1024, byteBudget / 1024, minAgeUs / 1000, inserts, hits, misses,
+                       budgetEvictions, forcedEvictions, released);
+}
+
+SentDataCache::SentDataCache(size_t capacity, size_t byteBudget)
+    : byteBudget(byteBudget)
+{
+    const size_t slotCount = std::bit_ceil(std::max<size_t>(capacity, 2));
+    slots = std::make_unique<Slot[]>(slotCount);
+    mask = slotCount - 1;
+}
+
+SentDataCache::~SentDataCache()
+{
+    clear();
+}
+
+int64_t SentDataCache::nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+uint64_t SentDataCache::lockSlot(Slot &slot)
+{
+    uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        if ((seq & 1) == 0 &&
+            slot.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            // Field stores below must not become visible before the odd sequence.
+            std::atomic_thread_fence(std::memory_order_release);
+            return seq + 1;
+        }
+        // Another writer only holds a slot for a handful of stores.
+        std::this_thread::yield();
+        seq = slot.seq.load(std::memory_order_relaxed);
+    }
+}
+
+void SentDataCache::unlockSlot(Slot &slot, uint64_t lockedSeq)
+{
+    slot.seq.store(lockedSeq + 1, std::memory_order_release);
+}
+
+PacketBuffer SentDataCache::exchangeLocked(Slot &slot, uint64_t messageId, PacketBuffer frame, int64_t timeUs)
+{
+    // Adopt the ref the slot was holding; the caller drops it after unlockSlot().
+    PacketBuffer old(slot.block.load(std::memory_order_relaxed), slot.offset.load(std::memory_order_relaxed),
+                     slot.length.load(std::memory_order_relaxed));
+
+    slot.messageId.store(messageId, std::memory_order_relaxed);
+    slot.block.store(frame.block, std::memory_order_relaxed);
+    slot.offset.store(frame.offset, std::memory_order_relaxed);
+    slot.length.store(frame.length, std::memory_order_relaxed);
+    slot.insertTimeUs.store(timeUs, std::memory_order_relaxed);
+
+    // The slot now owns the frame's ref.
+    frame.block = nullptr;
+    frame.offset = 0;
+    frame.length = 0;
+    return old;
+}
+
+void SentDataCache::insert(uint64_t messageId, PacketBuffer frame)
+{
+    if (!frame)
+        return;
+
+    // Readers take refs on blocks they may race with recycling, which is only safe for
+    // type-stable pooled memory. Heap and externally owned blocks are copied into the pool.
+    if (!PacketPool::isPooled(frame.block))
+        frame = PacketBuffer::copyOf(frame.data(), frame.size());
+
+    const int64_t now = nowUs();
+    const size_t frameBytes = frame.size();
+
+    if (tail.load(std::memory_order_relaxed) == NO_MESSAGE)
+    {
+        uint64_t expected = NO_MESSAGE;
+        tail.compare_exchange_strong(expected, messageId, std::memory_order_relaxed);
+    }
+
+    Slot &slot = slots[messageId & mask];
+    const uint64_t seq = lockSlot(slot);
+    const uint64_t oldId = slot.messageId.load(std::memory_order_relaxed);
+    if (oldId != NO_MESSAGE && oldId > messageId)
+    {
+        // A sender that lost the race by a full ring lap: the newer frame wins.
+        unlockSlot(slot, seq);
+        forcedEvictions.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const int64_t oldTimeUs = slot.insertTimeUs.load(std::memory_order_relaxed);
+    PacketBuffer old = exchangeLocked(slot, messageId, std::move(frame), now);
+    unlockSlot(slot, seq);
+
+    if (old)
+    {
+        bytes.fetch_sub(old.size(), std::memory_order_relaxed);
+        entries.fetch_sub(1, std::memory_order_relaxed);
+        if (now - oldTimeUs < minAgeUs.load(std::memory_order_relaxed))
+            forcedEvictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    bytes.fetch_add(frameBytes, std::memory_order_relaxed);
+    entries.fetch_add(1, std::memory_order_relaxed);
+    inserts.fetch_add(1, std::memory_order_relaxed);
+    uint64_t h = head.load(std::memory_order_relaxed);
+    while (h <= messageId && !head.compare_exchange_weak(h, messageId + 1, std::memory_order_relaxed))
+    {
+    }
+
+    evictForBudget(messageId, now);
+}
+
+void SentDataCache::evictForBudget(uint64_t newestId, int64_t now)
+{
+    const int64_t minAge = minAgeUs.load(std::memory_order_relaxed);
+
+    while (bytes.load(std::memory_order_relaxed) > byteBudget.load(std::memory_order_relaxed))
+    {
+        uint64_t t = tail.load(std::memory_order_acquire);
+        if (t == NO_MESSAGE || t >= newestId)
+            return;
+
+        // Anything more than a ring behind the newest ID has already been overwritten.
+        if (newestId - t > mask)
+        {
+            tail.compare_exchange_strong(t, newestId - mask, std::memory_order_acq_rel);
+            continue;
+        }
+
+        Slot &slot = slots[t & mask];
+        const uint64_t seq = lockSlot(slot);
+        const uint64_t id = slot.messageId.load(std::memory_order_relaxed);
+        if (id == t)
+        {
+            if (now - slot.insertTimeUs.load(std::memory_order_relaxed) < minAge)
+            {
+                // The oldest frame may still be asked for: run over budget instead.
+                unlockSlot(slot, seq);
+                return;
+            }
+            if (!tail.compare_exchange_strong(t, t + 1, std::memory_order_acq_rel))
+            {
+                unlockSlot(slot, seq);
+                continue;
+            }
+            PacketBuffer old = exchangeLocked(slot, NO_MESSAGE, PacketBuffer{}, 0);
+            unlockSlot(slot, seq);
+            bytes.fetch_sub(old.size(), std::memory_order_relaxed);
+            entries.fetch_sub(1, std::memory_order_relaxed);
+            budgetEvictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (id != NO_MESSAGE && id > t)
+        {
+            // Already overwritten by a newer lap.
+            unlockSlot(slot, seq);
+            tail.compare_exchange_strong(t, t + 1, std::memory_order_acq_rel);
+        }
+        else
+        {
+            unlockSlot(slot, seq);
+            // Either another evictor just took `t`, or the insert for `t` is still in
+            // flight on another sender thread; in the latter case a later insert retries.
+            if (tail.load(std::memory_order_acquire) != t)
+                continue;
+            return;
+        }
+    }
+}
+
+void SentDataCache::releaseBelow(uint64_t messageId)
+{
+    for (;;)
+    {
+        uint64_t t = tail.load(std::memory_order_acquire);
+        if (t == NO_MESSAGE || t >= messageId)
+            return;
+        // Slots more than a ring behind have been reused by newer frames.
+        if (messageId - t > mask + 1)
+        {
+            tail.compare_exchange_strong(t, messageId - mask - 1, std::memory_order_acq_rel);
+            continue;
+        }
+
+        Slot &slot = slots[t & mask];
+        const uint64_t seq = lockSlot(slot);
+        if (!tail.compare_exchange_strong(t, t + 1, std::memory_order_acq_rel))
+        {
+            unlockSlot(slot, seq);
+            continue;
+        }
+        PacketBuffer old;
+        if (slot.messageId.load(std::memory_order_relaxed) == t)
+            old = exchangeLocked(slot, NO_MESSAGE, PacketBuffer{}, 0);
+        unlockSlot(slot, seq);
+        if (old)
+        {
+            bytes.fetch_sub(old.size(), std::memory_order_relaxed);
+            entries.fetch_sub(1, std::memory_order_relaxed);
+            released.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+PacketBuffer SentDataCache::find(uint64_t messageId)
+{
+    Slot &slot = slots[messageId & mask];
+    for (;;)
+    {
+        const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq & 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const uint64_t id = slot.messageId.load(std::memory_order_relaxed);
+        PacketBlock *block = slot.block.load(std::memory_order_relaxed);
+        const uint32_t offset = slot.offset.load(std::memory_order_relaxed);
+        const uint32_t length = slot.length.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq)
+            continue;
+
+        if (id != messageId || !block)
+        {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+
+        // Take a ref only if the block is still live. Pooled blocks are type-stable, so
+        // touching refCount is safe even if the slot was replaced meanwhile.
+        uint32_t refs = block->refCount.load(std::memory_order_relaxed);
+        do
+        {
+            if (refs == 0)
+                break;
+        } while (!block->refCount.compare_exchange_weak(refs, refs + 1, std::memory_order_acq_rel,
+                                                        std::memory_order_relaxed));
+        if (refs == 0)
+            continue;
+
+        PacketBuffer out(block, offset, length);
+        // If the sequence is unchanged, the slot still held its ref when ours was taken,
+        // so `block` cannot have been recycled. Otherwise drop our ref and retry.
+        if (slot.seq.load(std::memory_order_acquire) != seq)
+            continue;
+
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return out;
+    }
+}
+
+void SentDataCache::clear()
+{
+    for (size_t i = 0; i <= mask; i++)
+    {
+        Slot &slot = slots[i];
+        if (slot.messageId.load(std::memory_order_relaxed) == NO_MESSAGE)
+            continue;
+        const uint64_t seq = lockSlot(slot);
+        PacketBuffer old = exchangeLocked(slot, NO_MESSAGE, PacketBuffer{}, 0);
+        unlockSlot(slot, seq);
+    }
+    bytes.store(0, std::memory_order_relaxed);
+    entries.store(0, std::memory_order_relaxed);
+    tail.store(NO_MESSAGE, std::memory_order_relaxed);
+    head.store(0, std::memory_order_relaxed);
+}
+
+std::pair<uint64_t, uint64_t> SentDataCache::idRange() const
+{
+    const uint64_t t = tail.load(std::memory_order_acquire);
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    if (t == NO_MESSAGE || t >= h)
+        return {0, 0};
+    // The tail only moves on eviction and release; a ring wrap overwrites without it.
+    return {std::max(t, h > mask + 1 ? h - mask - 1 : 0), h};
+}
+
+SentDataCache::Stats SentDataCache::getStats() const
+{
+    Stats out;
+    out.capacity = mask + 1;
+    out.entries = entries.load(std::memory_order_relaxed);
+    out.bytes = bytes.load(std::memory_order_relaxed);
+    out.byteBudget = byteBudget.load(std::memory_order_relaxed);
+    out.minAgeUs = minAgeUs.load(std::memory_order_relaxed);
+    out.inserts = inserts.load(std::memory_order_relaxed);
+    out.hits = hits.load(std::memory_order_relaxed);
+    out.misses = misses.load(std::memory_order_relaxed);
+    out.budgetEvictions = budgetEvictions.load(std::memory_order_relaxed);
+    out.forcedEvictions = forcedEvictions.load(std::memory_order_relaxed);
+    out.released = released.load(std::memory_order_relaxed);
+    return out;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "PacketBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+/// Cache of sent VC frames kept for resend, indexed by messageId.
+///
+/// Message IDs are dense and monotonic, so the cache is a power-of-two ring where
+/// messageId M lives in slot (M & mask). Inserts (send path) and lookups (IO thread,
+/// on RESEND_REQUEST / MISSING_NOTIFY) take no locks: every slot is guarded by a
+/// seqlock, and a reader that wants to keep the frame takes a ref on its block with
+/// an increment-if-nonzero and then re-validates the slot sequence.
+///
+/// Retention is governed by a byte budget and a minimum age instead of a fixed
+/// count. Once the cached bytes exceed the budget the oldest frames are evicted, but
+/// only if they are older than the minimum age (normally derived from RTT, see
+/// setMinAge()), so a burst at high pps cannot push out frames the peer may still
+/// ask for. A frame is only lost early when the ring itself wraps onto it; that is
+/// counted as a forced eviction. Frames the peer acknowledges are released at once
+/// (releaseBelow()), so with an acknowledging peer the cache holds what is in flight.
+class SentDataCache
+{
+  public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;             // slots, rounded up to a power of two
+    static constexpr size_t DEFAULT_BYTE_BUDGET = 32 * 1024 * 1024; // bytes of cached frames
+    static constexpr std::chrono::microseconds DEFAULT_MIN_AGE{1000 * 1000};
+
+    struct Stats
+    {
+        size_t capacity = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t byteBudget = 0;
+        int64_t minAgeUs = 0;
+        uint64_t inserts = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t budgetEvictions = 0; // aged out because the byte budget was exceeded
+        uint64_t forcedEvictions = 0; // overwritten by ring wrap while younger than the minimum age
+        uint64_t released = 0;        // acknowledged by the peer
+
+        /// One-line summary suitable for log output.
+        std::string format() const;
+    };
+
+    SentDataCache() : SentDataCache(DEFAULT_CAPACITY, DEFAULT_BYTE_BUDGET) {}
+    SentDataCache(size_t capacity, size_t byteBudget);
+    ~SentDataCache();
+
+    SentDataCache(const SentDataCache &) = delete;
+    SentDataCache &operator=(const SentDataCache &) = delete;
+
+    /// Cache `frame` under `messageId`. Safe to call concurrently with find() and
+    /// with other inserts for distinct IDs.
+    void insert(uint64_t messageId, PacketBuffer frame);
+
+    /// Returns a handle sharing the cached frame, or an empty buffer if `messageId`
+    /// is not (or no longer) cached. Lock-free; safe from any thread.
+    PacketBuffer find(uint64_t messageId);
+
+    /// Drop every frame below `messageId`: the peer acknowledged them, so they will not
+    /// be asked for again. Safe to call concurrently with insert() and find().
+    void releaseBelow(uint64_t messageId);
+
+    /// IDs that may still be cached, as [first, end); empty before the first insert.
+    /// Anything outside is certainly gone, so callers can skip it without a lookup.
+    std::pair<uint64_t, uint64_t> idRange() const;
+
+    /// Drop every cached frame. Must not race with insert().
+    void clear();
+
+    /// Frames younger than `minAge` are never evicted for the byte budget.
+    void setMinAge(std::chrono::microseconds minAge)
+    {
+        minAgeUs.store(minAge.count(), std::memory_order_relaxed);
+    }
+
+    void setByteBudget(size_t bytes)
+    {
+        byteBudget.store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    Stats getStats() const;
+
+  private:
+    static constexpr uint64_t NO_MESSAGE = ~uint64_t{0};
+
+    // All fields are atomics so a reader racing a writer is well defined; the
+    // seqlock `seq` (odd while a writer is mid-update) tells the reader whether the
+    // snapshot it took is consistent.
+    struct Slot
+    {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<uint64_t> messageId{NO_MESSAGE};
+        std::atomic<PacketBlock *> block{nullptr};
+        std::atomic<uint32_t> offset{0};
+        std::atomic<uint32_t> length{0};
+        std::atomic<int64_t> insertTimeUs{0};
+    };
+
+    static int64_t nowUs();
+
+    // Seqlock writer side. lockSlot() spins while another writer owns the slot and
+    // returns the (odd) sequence now held; unlockSlot() publishes the update.
+    static uint64_t lockSlot(Slot &slot);
+    static void unlockSlot(Slot &slot, uint64_t lockedSeq);
+
+    // Swap the slot contents with a new frame (or with nothing) and return the
+    // handle that was there, so the old ref is dropped after the slot is republished.
+    static PacketBuffer exchangeLocked(Slot &slot, uint64_t messageId, PacketBuffer frame, int64_t timeUs);
+
+    void evictForBudget(uint64_t newestId, int64_t now);
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+
+    // Oldest messageId that may still be cached; advanced by budget eviction.
+    // NO_MESSAGE until the first insert (and again after clear()).
+    std::atomic<uint64_t> tail{NO_MESSAGE};
+    // One past the newest messageId inserted.
+    std::atomic<uint64_t> head{0};
+
+    std::atomic<size_t> byteBudget;
+    std::atomic<int64_t> minAgeUs{DEFAULT_MIN_AGE.count()};
+    std::atomic<size_t> bytes{0};
+    std::atomic<size_t> entries{0};
+
+    std::atomic<uint64_t> inserts{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> budgetEvictions{0};
+    std::atomic<uint64_t> forcedEvictions{0};
+    std::atomic<uint64_t> released{0};
+};
@@ -11,6 +11,7 @@
 #include <cstring> // For strerror
 #include <errno.h> // For errno
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #endif
 
 using namespace Logger;
@@ -190,7 +191,8 @@ int SocketPollMany(struct pollfd *fds, size_t count, int timeoutMs) {
     //     stall every other connection on the channel — the select() path did, and
     //     unlike macOS the Windows select() error was never mapped to a retry.
     // The known WSAPoll connect-bug only affects POLLOUT on *connecting* sockets;
-    // this poll requests POLLIN on established sockets, so it is unaffected.
+    // callers poll established sockets only (POLLIN in the IO thread, POLLOUT in the
+    // send thread), so they are unaffected.
     ULONG validCount = 0;
     for (size_t i = 0; i < count; i++) {
         fds[i].revents = 0;
@@ -321,6 +323,51 @@ ssize_t RecvUdpData(SocketFd socketFd, void *buffer, size_t bufferSize,
     return length;
 }
 
+int SocketEnableRecvTos(SocketFd socketFd) {
+#if defined(IP_RECVTOS) && !defined(_WIN32)
+    int opt = 1;
+    return setsockopt(socketFd, IPPROTO_IP, IP_RECVTOS, &opt, sizeof(opt));
+#else
+    (void)socketFd;
+    return -1;
+#endif
+}
+
+ssize_t RecvUdpDataWithTos(SocketFd socketFd, void *buffer, size_t bufferSize, int flags,
+                           struct sockaddr *srcAddr, socklen_t *srcAddrLen, uint8_t *tos) {
+    *tos = 0;
+#if defined(IP_RECVTOS) && !defined(_WIN32)
+    struct iovec iov{buffer, bufferSize};
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    struct msghdr msg{};
+    msg.msg_name = srcAddr;
+    msg.msg_namelen = srcAddrLen ? *srcAddrLen : 0;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t length = recvmsg(socketFd, &msg, flags);
+    if (length < 0)
+        return length;
+    if (srcAddrLen)
+        *srcAddrLen = msg.msg_namelen;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        // Linux reports IP_TOS, the BSDs IP_RECVTOS; both carry the byte first.
+        if (cmsg->cmsg_level == IPPROTO_IP && (cmsg->cmsg_type == IP_TOS || cmsg->cmsg_type == IP_RECVTOS)) {
+            *tos = *reinterpret_cast<const uint8_t *>(CMSG_DATA(cmsg));
+            break;
+        }
+    }
+    return length;
+#else
+    return RecvUdpData(socketFd, buffer, bufferSize, flags, srcAddr, srcAddrLen);
+#endif
+}
+
+uint64_t FlowIdOf(const sockaddr_in &addr) {
+    return (static_cast<uint64_t>(ntohl(addr.sin_addr.s_addr)) << 16) | ntohs(addr.sin_port);
+}
+
 ssize_t RecvTcpData(SocketFd socketFd, void *buffer, size_t bufferSize, int flags) {
 #if defined(_WIN32)
     ssize_t length = recv(socketFd, (char *)buffer, bufferSize, flags);
@@ -333,6 +380,29 @@ ssize_t RecvTcpData(SocketFd socketFd, void *buffer, size_t bufferSize, int flag
 // Direct non-blocking send/recv. Callers must ensure the socket is already set
 // to non-blocking mode (these skip any internal readiness poll).
 
+// Maps a failed send()/sendmsg()/WSASend() to a SocketError.
+static ssize_t LastSendError()
+{
+#ifdef _WIN32
+    int error = WSAGetLastError();
+    if (error == WSAEWOULDBLOCK)
+        return SOCKET_ERROR_WOULD_BLOCK;
+    if (error == WSAEINTR)
+        return SOCKET_ERROR_INTERRUPTED;
+#else
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return SOCKET_ERROR_WOULD_BLOCK;
+    if (errno == EINTR)
+        return SOCKET_ERROR_INTERRUPTED;
+#endif
+    // Any other error (ECONNRESET, EPIPE, ETIMEDOUT, ...) is a genuine,
+    // non-recoverable connection failure. Return SOCKET_ERROR_CLOSED rather
+    // than the raw -1, which aliases SOCKET_ERROR_WOULD_BLOCK (-1) and would
+    // make callers treat a dead connection as transient backpressure (the
+    // connection then lingers as an undetected zombie).
+    return SOCKET_ERROR_CLOSED;
+}
+
 ssize_t SendTcpDirect(SocketFd socketFd, const void *data, size_t length, int flags)
 {
 #if defined(_WIN32)
@@ -341,27 +411,40 @@ ssize_t SendTcpDirect(SocketFd socketFd, const void *data, size_t length, int fl
     ssize_t bytesSent = send(socketFd, data, length, flags);
 #endif
     if (bytesSent < 0)
-    {
+        return LastSendError();
+    return bytesSent;
+}
+
+ssize_t SendTcpGather(SocketFd socketFd, const SendSegment *segments, size_t count)
+{
+    if (count > SEND_GATHER_MAX_SEGMENTS)
+        count = SEND_GATHER_MAX_SEGMENTS;
 #ifdef _WIN32
-        int error = WSAGetLastError();
-        if (error == WSAEWOULDBLOCK)
-            return SOCKET_ERROR_WOULD_BLOCK;
-        if (error == WSAEINTR)
-            return SOCKET_ERROR_INTERRUPTED;
+    WSABUF bufs[SEND_GATHER_MAX_SEGMENTS];
+    for (size_t i = 0; i < count; i++)
+    {
+        bufs[i].buf = (CHAR *)segments[i].data;
+        bufs[i].len = (ULONG)segments[i].length;
+    }
+    DWORD bytesSent = 0;
+    if (WSASend(socketFd, bufs, (DWORD)count, &bytesSent, 0, nullptr, nullptr) == SOCKET_ERROR)
+        return LastSendError();
+    return (ssize_t)bytesSent;
 #else
-        if (errno == EAGAIN || errno == EWOULDBLOCK)
-            return SOCKET_ERROR_WOULD_BLOCK;
-        if (errno == EINTR)
-            return SOCKET_ERROR_INTERRUPTED;
-#endif
-        // Any other error (ECONNRESET, EPIPE, ETIMEDOUT, ...) is a genuine,
-        // non-recoverable connection failure. Return SOCKET_ERROR_CLOSED rather
-        // than the raw -1, which aliases SOCKET_ERROR_WOULD_BLOCK (-1) and would
-        // make callers treat a dead connection as transient backpressure (the
-        // connection then lingers as an undetected zombie).
-        return SOCKET_ERROR_CLOSED;
+    struct iovec iov[SEND_GATHER_MAX_SEGMENTS];
+    for (size_t i = 0; i < count; i++)
+    {
+        iov[i].iov_base = const_cast<void *>(segments[i].data);
+        iov[i].iov_len = segments[i].length;
     }
+    struct msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+    ssize_t bytesSent = sendmsg(socketFd, &msg, 0);
+    if (bytesSent < 0)
+        return LastSendError();
     return bytesSent;
+#endif
 }
 
 ssize_t RecvTcpDirect(SocketFd socketFd, void *buffer, size_t bufferSize, int flags)
@@ -481,6 +564,78 @@ int SocketShutdown(SocketFd socketFd, int how) {
     return shutdown(socketFd, how);
 }
 
+int SocketWakePairCreate(SocketFd &waitFd, SocketFd &signalFd) {
+#ifdef _WIN32
+    waitFd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    signalFd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (waitFd == INVALID_SOCKET || signalFd == INVALID_SOCKET) {
+        SocketLogLastError();
+        SocketWakePairClose(waitFd, signalFd);
+        return -1;
+    }
+    // Bind both to an ephemeral loopback port and connect each to the other, so only
+    // the pair's own datagrams are ever accepted.
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sockaddr_in waitAddr{}, signalAddr{};
+    int len = sizeof(sockaddr_in);
+    if (bind(waitFd, (sockaddr *)&addr, sizeof(addr)) != 0 ||
+        bind(signalFd, (sockaddr *)&addr, sizeof(addr)) != 0 ||
+        getsockname(waitFd, (sockaddr *)&waitAddr, &len) != 0 ||
+        (len = sizeof(sockaddr_in), getsockname(signalFd, (sockaddr *)&signalAddr, &len)) != 0 ||
+        connect(waitFd, (sockaddr *)&signalAddr, sizeof(signalAddr)) != 0 ||
+        connect(signalFd, (sockaddr *)&waitAddr, sizeof(waitAddr)) != 0) {
+        SocketLogLastError();
+        SocketWakePairClose(waitFd, signalFd);
+        return -1;
+    }
+#else
+    int fds[2];
+    if (pipe(fds) != 0) {
+        SocketLogLastError();
+        waitFd = signalFd = -1;
+        return -1;
+    }
+    waitFd = fds[0];
+    signalFd = fds[1];
+#endif
+    SetSocketNonBlocking(waitFd);
+    SetSocketNonBlocking(signalFd);
+    return 0;
+}
+
+void SocketWakePairSignal(SocketFd signalFd) {
+    // A full pipe / socket buffer already holds a pending wake, so a failed write is fine.
+    char byte = 1;
+#ifdef _WIN32
+    send(signalFd, &byte, 1, 0);
+#else
+    [[maybe_unused]] ssize_t n = write(signalFd, &byte, 1);
+#endif
+}
+
+void SocketWakePairDrain(SocketFd waitFd) {
+    char buf[64];
+#ifdef _WIN32
+    while (recv(waitFd, buf, sizeof(buf), 0) > 0) {
+    }
+#else
+    while (read(waitFd, buf, sizeof(buf)) > 0) {
+    }
+#endif
+}
+
+void SocketWakePairClose(SocketFd waitFd, SocketFd signalFd) {
+#ifdef _WIN32
+    if (waitFd != INVALID_SOCKET) closesocket(waitFd);
+    if (signalFd != INVALID_SOCKET) closesocket(signalFd);
+#else
+    if (waitFd != -1) close(waitFd);
+    if (signalFd != -1) close(signalFd);
+#endif
+}
+
 // Specialized receive functions
 ssize_t RecvTcpDataWithSize(SocketFd socketFd, void *buffer, size_t bufferSize, int flags, int bytesToRead) {
     char *bufPtr = static_cast<char *>(buffer);
@@ -38,6 +38,8 @@ typedef SOCKADDR sockaddr;
 typedef int SocketFd; // Use int type for Linux/macOS
 #endif
 
+#include <cstdint>
+
 // Socket creation and configuration
 SocketFd SocketCreate(int domain, int type, int protocol);
 int SetSocketNonBlocking(SocketFd socketFd);
@@ -52,6 +54,16 @@ ssize_t RecvUdpData(SocketFd socketFd, void *buffer, size_t bufferSize, int flag
                     socklen_t *srcAddrLen);
 ssize_t RecvTcpData(SocketFd socketFd, void *buffer, size_t bufferSize, int flags);
 
+// Have a UDP socket report each datagram's IP TOS byte (IP_RECVTOS) to
+// RecvUdpDataWithTos(). Returns 0 on success, non-zero where unsupported.
+int SocketEnableRecvTos(SocketFd socketFd);
+// RecvUdpData() that also stores the datagram's TOS byte in *tos: 0 unless
+// SocketEnableRecvTos() succeeded on the socket.
+ssize_t RecvUdpDataWithTos(SocketFd socketFd, void *buffer, size_t bufferSize, int flags, struct sockaddr *srcAddr,
+                           socklen_t *srcAddrLen, uint8_t *tos);
+// Flow identifier of an IPv4 UDP endpoint (address and port), for FlowInfo.
+uint64_t FlowIdOf(const sockaddr_in &addr);
+
 // Specialized receive functions
 ssize_t RecvTcpDataWithSize(SocketFd socketFd, void *buffer, size_t bufferSize, int flags, int bytesToRead);
 
@@ -72,11 +84,31 @@ bool IsSocketReadable(SocketFd socketFd, int timeoutMs);
 bool IsSocketWritable(SocketFd socketFd, int timeoutMs);
 int SocketBytesAvailable(SocketFd socketFd);
 
+// Self-wake pair for a poll loop: writing to `signalFd` makes `waitFd` readable. POSIX
+// uses a pipe; Windows a connected loopback UDP socket pair, since WSAPoll only takes
+// sockets. Both ends are non-blocking. Returns 0 on success, -1 on failure.
+int SocketWakePairCreate(SocketFd &waitFd, SocketFd &signalFd);
+void SocketWakePairSignal(SocketFd signalFd);
+// Swallow every pending signal so `waitFd` stops polling readable.
+void SocketWakePairDrain(SocketFd waitFd);
+void SocketWakePairClose(SocketFd waitFd, SocketFd signalFd);
+
 // Direct non-blocking I/O for sockets already set non-blocking.
 // These skip the redundant poll() that SendTcpDataNonBlocking / RecvTcpDataNonBlocking perform.
 ssize_t SendTcpDirect(SocketFd socketFd, const void *data, size_t length, int flags);
 ssize_t RecvTcpDirect(SocketFd socketFd, void *buffer, size_t bufferSize, int flags);
 
+// Gathered non-blocking send: writes up to SEND_GATHER_MAX_SEGMENTS buffers with a single
+// sendmsg() / WSASend(). Same return values as SendTcpDirect; a partial write may end
+// anywhere, including mid-segment.
+struct SendSegment
+{
+    const void *data;
+    size_t length;
+};
+constexpr size_t SEND_GATHER_MAX_SEGMENTS = 64;
+ssize_t SendTcpGather(SocketFd socketFd, const SendSegment *segments, size_t count);
+
 // Error handling
 int SocketLogLastError();
 
@@ -4,9 +4,19 @@
 #include <cstddef>
 #include <memory>
 
+/// Bounded single-producer / single-consumer ring.
+///
+/// Positions run freely and are masked into the buffer, so Capacity must be a power of
+/// two and every slot is usable. Each side keeps a private copy of the other side's
+/// position and only reloads the shared atomic when that copy says the ring is full
+/// (producer) or empty (consumer), so the cache line owned by the other thread is
+/// touched once per batch rather than once per item. The bulk calls publish any number
+/// of items with a single release store.
 template <typename T, size_t Capacity = 1024>
 class SpscQueue
 {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
   public:
     SpscQueue() : buffer(std::make_unique<T[]>(Capacity)) {}
 
@@ -16,31 +26,86 @@ class SpscQueue
     bool try_enqueue(T item)
     {
         auto w = writePos.load(std::memory_order_relaxed);
-        auto nextW = (w + 1) % Capacity;
-        if (nextW == readPos.load(std::memory_order_acquire))
-            return false;
-        buffer[w] = std::move(item);
-        writePos.store(nextW, std::memory_order_release);
+        if (w - cachedReadPos == Capacity)
+        {
+            cachedReadPos = readPos.load(std::memory_order_acquire);
+            if (w - cachedReadPos == Capacity)
+                return false;
+        }
+        buffer[w & MASK] = std::move(item);
+        writePos.store(w + 1, std::memory_order_release);
         return true;
     }
 
+    /// Move up to `count` items from `first` into the queue, in order. Returns how many
+    /// were enqueued; items beyond that are left untouched.
+    template <typename InputIt>
+    size_t try_enqueue_bulk(InputIt first, size_t count)
+    {
+        auto w = writePos.load(std::memory_order_relaxed);
+        size_t room = Capacity - (w - cachedReadPos);
+        if (room < count)
+        {
+            cachedReadPos = readPos.load(std::memory_order_acquire);
+            room = Capacity - (w - cachedReadPos);
+        }
+        size_t n = count < room ? count : room;
+        for (size_t i = 0; i < n; i++, ++first)
+            buffer[(w + i) & MASK] = std::move(*first);
+        if (n > 0)
+            writePos.store(w + n, std::memory_order_release);
+        return n;
+    }
+
     bool try_dequeue(T &item)
     {
         auto r = readPos.load(std::memory_order_relaxed);
-        if (r == writePos.load(std::memory_order_acquire))
-            return false;
-        item = std::move(buffer[r]);
-        readPos.store((r + 1) % Capacity, std::memory_order_release);
+        if (r == cachedWritePos)
+        {
+            cachedWritePos = writePos.load(std::memory_order_acquire);
+            if (r == cachedWritePos)
+                return false;
+        }
+        item = std::move(buffer[r & MASK]);
+        readPos.store(r + 1, std::memory_order_release);
         return true;
     }
 
+    /// Move up to `max` items to `out` (e.g. a back_inserter), in order. Returns how
+    /// many were dequeued.
+    template <typename OutputIt>
+    size_t try_dequeue_bulk(OutputIt out, size_t max)
+    {
+        auto r = readPos.load(std::memory_order_relaxed);
+        if (cachedWritePos - r < max)
+            cachedWritePos = writePos.load(std::memory_order_acquire);
+        size_t ready = cachedWritePos - r;
+        size_t n = ready < max ? ready : max;
+        for (size_t i = 0; i < n; i++, ++out)
+            *out = std::move(buffer[(r + i) & MASK]);
+        if (n > 0)
+            readPos.store(r + n, std::memory_order_release);
+        return n;
+    }
+
     bool empty() const
     {
         return readPos.load(std::memory_order_acquire) == writePos.load(std::memory_order_acquire);
     }
 
+    static constexpr size_t capacity()
+    {
+        return Capacity;
+    }
+
   private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    // Producer line: its own position plus its view of the consumer's.
     alignas(64) std::atomic<size_t> writePos{0};
+    size_t cachedReadPos = 0;
+    // Consumer line.
     alignas(64) std::atomic<size_t> readPos{0};
-    std::unique_ptr<T[]> buffer;
+    size_t cachedWritePos = 0;
+    alignas(64) std::unique_ptr<T[]> buffer;
 };
@@ -6,6 +6,10 @@
 #include <chrono>
 #include <cstring>
 #include <mutex>
+#if defined(__linux__)
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+#endif
 
 TcpConnection::~TcpConnection()
 {
@@ -168,6 +172,9 @@ TcpConnection::TcpConnectionRuntimeInfo TcpConnection::sampleRuntimeInfo()
         // macOS. tcpi_snd_sbbytes is the actual send-buffer occupancy, so a backed-up
         // connection now scores lower and the sender steers traffic to idle ones.
         info.bytesInFlight = tcpInfo.tcpi_snd_sbbytes;
+        // No separate unsent count here; the whole send-buffer occupancy is the closest
+        // upper bound for what a new frame would queue behind.
+        info.notSentBytes = tcpInfo.tcpi_snd_sbbytes;
         // macOS tcpi_txretransmitpackets is a cumulative lifetime counter (total
         // retransmitted packets since connection start), unlike Linux tcpi_retransmits
         // which is the current consecutive timeout count (resets to 0 on ACK).
@@ -196,6 +203,14 @@ TcpConnection::TcpConnectionRuntimeInfo TcpConnection::sampleRuntimeInfo()
         // Estimate bytes in flight using actual MSS
         info.bytesInFlight = tcpInfo.tcpi_unacked * tcpInfo.tcpi_snd_mss;
 
+        // Bytes still waiting in the send buffer: a new frame goes out only after them.
+        // glibc's tcp_info predates tcpi_notsent_bytes, so ask the socket directly.
+        int notSent = 0;
+        if (ioctl(socketFd, SIOCOUTQNSD, &notSent) == 0 && notSent > 0)
+            info.notSentBytes = static_cast<uint32_t>(notSent);
+
+        info.lastAckAgeMs = tcpInfo.tcpi_last_ack_recv;
+
         // Timeout episodes
         info.timeoutEpisodes = tcpInfo.tcpi_retransmits;
 
@@ -72,8 +72,12 @@ class TcpConnection
         uint32_t smoothedRttUs = 0;
         uint32_t congestionWindowBytes = 0;
         uint32_t bytesInFlight = 0;
+        uint32_t notSentBytes = 0; // accepted by the socket but not yet transmitted
+        uint32_t lastAckAgeMs = 0; // since the last ACK arrived; 0 when unknown
         uint32_t retransmissionIndicator = 0;
         uint32_t timeoutEpisodes = 0;
+
+        bool operator==(const TcpConnectionRuntimeInfo &) const = default;
     };
 
     TcpConnectionRuntimeInfo sampleRuntimeInfo();
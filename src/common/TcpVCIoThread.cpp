@@ -1,6 +1,7 @@
 #include "TcpVCIoThread.h"
 #include "Log.h"
 #include "Socket.h"
+#include <cstring>
 #include <format>
 #include <thread>
 
@@ -8,19 +9,27 @@ using namespace Logger;
 
 static constexpr int IO_POLL_TIMEOUT_MS = 50;
 
-TcpVCIoThread::TcpVCIoThread(std::vector<TcpConnectionSp> connections_,
-                              std::function<void(uint64_t, std::shared_ptr<std::vector<char>>, int)> dataCallback_,
+TcpVCIoThread::TcpVCIoThread(SharedConnectionTableSp connTable_,
+                              DataBatchCallback dataCallback_,
                               std::function<void(uint64_t)> resendRequestCallback_,
-                              std::function<void(const std::vector<uint64_t> &)> missingNotifyCallback_,
+                              std::function<void(const std::vector<MissingRange> &)> missingNotifyCallback_,
+                              std::function<void(const VCAck &)> ackCallback_,
                               std::function<void(TcpConnectionSp)> disconnectCallback_)
-    : connections(std::move(connections_)),
+    : connTable(std::move(connTable_)),
       dataCallback(std::move(dataCallback_)),
       resendRequestCallback(std::move(resendRequestCallback_)),
       missingNotifyCallback(std::move(missingNotifyCallback_)),
-      disconnectCallback(std::move(disconnectCallback_))
+      ackCallback(std::move(ackCallback_)),
+      disconnectCallback(std::move(disconnectCallback_)),
+      wakeup(std::make_shared<Wakeup>())
 {
-    readBuffers.resize(connections.size());
-    for (auto &conn : connections)
+    if (!wakeup->ok)
+        log_warnning("TcpVCIoThread: no wake pipe, a full read ring resumes on the poll timeout");
+    SharedConnectionTable::Reader reader(*connTable);
+    auto table = reader.pin();
+    numConns = table->connections.size();
+    readBuffers.resize(numConns);
+    for (auto &conn : table->connections)
     {
         if (conn && conn->isConnected())
         {
@@ -33,46 +42,25 @@ TcpVCIoThread::TcpVCIoThread(std::vector<TcpConnectionSp> connections_,
 
 TcpVCIoThread::~TcpVCIoThread() = default;
 
-void TcpVCIoThread::replaceConnection(int slot, TcpConnectionSp conn)
-{
-    if (slot < 0 || static_cast<size_t>(slot) >= connections.size())
-        return;
-    SetSocketNonBlocking(conn->getSocketFd());
-    std::lock_guard<std::mutex> lock(connectionsMutex);
-    connections[slot] = conn;
-    // Signal run() to refresh its cached snapshot on the next iteration.
-    connGeneration.fetch_add(1, std::memory_order_release);
-    // readBuffers[slot] is reset on the next run() iteration when the fd change is detected.
-}
-
 void TcpVCIoThread::run()
 {
     log_info("TcpVCIoThread started");
 
-    const size_t numConns = connections.size();
-    std::vector<struct pollfd> pollfds(numConns);
+    // One slot per connection, plus the wake pipe at index numConns.
+    std::vector<struct pollfd> pollfds(numConns + 1);
     // Track per-slot fd values so we can detect when a connection is replaced
     // and clear the stale read buffer before the new connection's data arrives.
     std::vector<SocketFd> prevFds(numConns, -1);
 
-    // Cached connection snapshot, refreshed only when replaceConnection() bumps
-    // connGeneration. Copying 32 shared_ptrs (plus the mutex lock) every poll cycle
-    // was pure overhead on the hot receive path; replacements are rare (reconnects).
-    std::vector<TcpConnectionSp> snapshot;
-    uint64_t cachedGen = static_cast<uint64_t>(-1);
+    SharedConnectionTable::Reader tableReader(*connTable);
 
     while (this->isRunning())
     {
-        // Refresh the snapshot only on change. Disconnections are still detected every
-        // iteration because the per-slot fd is re-read from the cached shared_ptrs
-        // (getSocketFd()/isConnected()) when building pollfds below.
-        uint64_t gen = connGeneration.load(std::memory_order_acquire);
-        if (gen != cachedGen)
-        {
-            std::lock_guard<std::mutex> lock(connectionsMutex);
-            snapshot = connections;
-            cachedGen = gen;
-        }
+        // Pin the current table for this poll cycle. Disconnections are still detected
+        // every iteration because the per-slot fd is re-read (getSocketFd()/isConnected())
+        // when building pollfds below.
+        auto table = tableReader.pin();
+        const auto &snapshot = table->connections;
 
         for (size_t i = 0; i < numConns; i++)
         {
@@ -80,14 +68,18 @@ void TcpVCIoThread::run()
             // If the fd changed (connection replaced), discard buffered data from the old stream.
             if (currFd != prevFds[i])
             {
-                readBuffers[i] = ReadBuffer{};
+                readBuffers[i].reset();
                 prevFds[i] = currFd;
             }
 
             if (currFd != -1)
             {
                 pollfds[i].fd = currFd;
-                pollfds[i].events = POLLIN;
+                // A full read ring cannot take more bytes: poll only for errors/hangup so a
+                // readable socket does not spin. The ring signals the wake pipe on the next
+                // view release, which brings us back here to re-check.
+                bool ringFull = readBuffers[i] && readBuffers[i]->writable() == 0;
+                pollfds[i].events = ringFull ? 0 : POLLIN;
                 pollfds[i].revents = 0;
             }
             else
@@ -98,7 +90,11 @@ void TcpVCIoThread::run()
             }
         }
 
-        int ready = SocketPollMany(pollfds.data(), numConns, IO_POLL_TIMEOUT_MS);
+        pollfds[numConns].fd = wakeup->ok ? wakeup->waitFd : (SocketFd)-1;
+        pollfds[numConns].events = POLLIN;
+        pollfds[numConns].revents = 0;
+
+        int ready = SocketPollMany(pollfds.data(), pollfds.size(), IO_POLL_TIMEOUT_MS);
         if (ready < 0)
         {
             log_error("SocketPollMany failed");
@@ -106,6 +102,10 @@ void TcpVCIoThread::run()
             continue;
         }
 
+        // Drain first: the rings are re-checked when pollfds is rebuilt next iteration.
+        if (pollfds[numConns].revents & POLLIN)
+            SocketWakePairDrain(wakeup->waitFd);
+
         for (size_t i = 0; i < numConns; i++)
         {
             if (pollfds[i].fd == (SocketFd)-1) continue;
@@ -123,21 +123,41 @@ void TcpVCIoThread::run()
     log_info("TcpVCIoThread stopped");
 }
 
-void TcpVCIoThread::readFromConnection(int connIndex, TcpConnectionSp conn)
+void TcpVCIoThread::readFromConnection(int connIndex, const TcpConnectionSp &conn)
 {
     if (!conn || !conn->isConnected()) return;
 
-    auto &buf = readBuffers[connIndex];
-
-    char temp[4096];
+    if (!readBuffers[connIndex])
+    {
+        std::weak_ptr<Wakeup> weakWakeup = wakeup;
+        readBuffers[connIndex] = ReceiveRing::create(ReceiveRing::DEFAULT_SIZE, [weakWakeup] {
+            if (auto w = weakWakeup.lock(); w && w->ok)
+                SocketWakePairSignal(w->signalFd);
+        });
+    }
+    auto &buf = *readBuffers[connIndex];
 
     // Drain socket using direct recv (socket is already non-blocking; poll() already confirmed POLLIN).
     while (this->isRunning())
     {
-        ssize_t n = RecvTcpDirect(conn->getSocketFd(), temp, sizeof(temp), 0);
+        size_t space = buf.writable();
+        if (space == 0)
+        {
+            // Every byte is pinned by payloads still waiting in the reorder window. Leave
+            // the rest in the socket; run() stops polling this slot until views are released.
+            break;
+        }
+        ssize_t n = RecvTcpDirect(conn->getSocketFd(), buf.writePtr(), space, 0);
         if (n > 0)
         {
-            buf.data.insert(buf.data.end(), temp, temp + n);
+            buf.commitWrite(static_cast<size_t>(n));
+            parsePackets(buf);
+            if (!parsedFrames.empty())
+            {
+                if (dataCallback)
+                    dataCallback(connIndex, parsedFrames);
+                parsedFrames.clear();
+            }
         }
         else if (n == SOCKET_ERROR_CLOSED)
         {
@@ -164,27 +184,28 @@ void TcpVCIoThread::readFromConnection(int connIndex, TcpConnectionSp conn)
             return;
         }
     }
+}
 
+void TcpVCIoThread::parsePackets(ReceiveRing &buf)
+{
     // Parse packets using a read-offset to avoid O(N) erase-from-front on every packet.
     while (buf.available() >= VC_MIN_DATA_PACKET_SIZE)
     {
-        uint8_t packetType = static_cast<uint8_t>(buf.begin()[0]);
+        uint8_t packetType = static_cast<uint8_t>(buf.readPtr()[0]);
         switch (static_cast<VcPacketType>(packetType))
         {
         case VcPacketType::DATA:
         {
             if (buf.available() < sizeof(VCDataPacket))
                 return;
-            VCDataPacket *pkt = reinterpret_cast<VCDataPacket *>(buf.begin());
+            VCDataPacket *pkt = reinterpret_cast<VCDataPacket *>(buf.readPtr());
             if (pkt->dataLength > VC_MAX_DATA_PAYLOAD_SIZE)
                 return;
             size_t totalSize = sizeof(VCDataPacket) + pkt->dataLength;
             if (buf.available() < totalSize)
                 return;
 
-            auto data = std::make_shared<std::vector<char>>(pkt->data, pkt->data + pkt->dataLength);
-            if (dataCallback)
-                dataCallback(pkt->header.messageId, data, connIndex);
+            parsedFrames.push_back({pkt->header.messageId, buf.view(sizeof(VCDataPacket), pkt->dataLength)});
             buf.consume(totalSize);
             break;
         }
@@ -192,7 +213,7 @@ void TcpVCIoThread::readFromConnection(int connIndex, TcpConnectionSp conn)
         {
             if (buf.available() < sizeof(VCResendRequest))
                 return;
-            VCResendRequest *req = reinterpret_cast<VCResendRequest *>(buf.begin());
+            VCResendRequest *req = reinterpret_cast<VCResendRequest *>(buf.readPtr());
             if (resendRequestCallback)
                 resendRequestCallback(req->missingMessageId);
             buf.consume(sizeof(VCResendRequest));
@@ -202,7 +223,7 @@ void TcpVCIoThread::readFromConnection(int connIndex, TcpConnectionSp conn)
         {
             if (buf.available() < sizeof(VCHeader) + 1)
                 return;
-            VCMissingNotify *notify = reinterpret_cast<VCMissingNotify *>(buf.begin());
+            VCMissingNotify *notify = reinterpret_cast<VCMissingNotify *>(buf.readPtr());
 
             // Reject malformed packet: count must not exceed the fixed-size array in the struct.
             // Without this check, notify->count > 64 causes an out-of-bounds read (UB / CVE risk).
@@ -210,8 +231,7 @@ void TcpVCIoThread::readFromConnection(int connIndex, TcpConnectionSp conn)
             {
                 log_error(std::format("MISSING_NOTIFY count {} exceeds max {}, dropping connection",
                                       notify->count, VC_MAX_MISSING_IDS_PER_NOTIFY));
-                buf.data.clear();
-                buf.readOffset = 0;
+                buf.discardUnparsed();
                 return;
             }
 
@@ -219,16 +239,83 @@ void TcpVCIoThread::readFromConnection(int connIndex, TcpConnectionSp conn)
             if (buf.available() < expectedSize)
                 return;
 
-            std::vector<uint64_t> missingIds(notify->missingIds, notify->missingIds + notify->count);
+            missingRanges.clear();
+            for (size_t i = 0; i < notify->count; i++)
+                missingRanges.push_back({notify->missingIds[i], 1});
+            buf.consume(expectedSize);
             if (missingNotifyCallback)
-                missingNotifyCallback(missingIds);
+                missingNotifyCallback(missingRanges);
+            break;
+        }
+        case VcPacketType::MISSING_RANGES:
+        {
+            if (buf.available() < VC_MIN_MISSING_RANGES_SIZE)
+                return;
+            VCMissingRanges *notify = reinterpret_cast<VCMissingRanges *>(buf.readPtr());
+            if (notify->count > VC_MAX_MISSING_RANGES)
+            {
+                log_error(std::format("MISSING_RANGES count {} exceeds max {}, dropping connection",
+                                      notify->count, VC_MAX_MISSING_RANGES));
+                buf.discardUnparsed();
+                return;
+            }
+            size_t expectedSize = VC_MIN_MISSING_RANGES_SIZE + notify->count * sizeof(VCMissingRange);
+            if (buf.available() < expectedSize)
+                return;
+
+            const uint64_t base = notify->header.messageId;
+            missingRanges.clear();
+            for (size_t i = 0; i < notify->count; i++)
+            {
+                VCMissingRange range;
+                std::memcpy(&range, &notify->ranges[i], sizeof(range));
+                if (range.count == 0 || range.count > VC_MAX_MISSING_RUN)
+                {
+                    log_error(std::format("MISSING_RANGES run of {} IDs is malformed, dropping connection", range.count));
+                    buf.discardUnparsed();
+                    return;
+                }
+                missingRanges.push_back({base + range.offset, range.count});
+            }
             buf.consume(expectedSize);
+            if (missingNotifyCallback)
+                missingNotifyCallback(missingRanges);
+            break;
+        }
+        case VcPacketType::FEC_PARITY:
+        {
+            if (buf.available() < VC_MIN_FEC_PARITY_SIZE)
+                return;
+            VCFecParity *pkt = reinterpret_cast<VCFecParity *>(buf.readPtr());
+            if (pkt->count == 0 || pkt->count > VC_FEC_MAX_GROUP || pkt->dataLength > VC_MAX_DATA_PAYLOAD_SIZE)
+            {
+                log_error(std::format("FEC_PARITY with {} members of up to {} bytes is malformed, dropping connection",
+                                      pkt->count, pkt->dataLength));
+                buf.discardUnparsed();
+                return;
+            }
+            size_t totalSize = VC_MIN_FEC_PARITY_SIZE + pkt->count * sizeof(uint16_t) + pkt->dataLength;
+            if (buf.available() < totalSize)
+                return;
+
+            parsedFrames.push_back({pkt->header.messageId, buf.view(0, totalSize), true});
+            buf.consume(totalSize);
+            break;
+        }
+        case VcPacketType::ACK:
+        {
+            if (buf.available() < sizeof(VCAck))
+                return;
+            VCAck ack;
+            std::memcpy(&ack, buf.readPtr(), sizeof(VCAck));
+            buf.consume(sizeof(VCAck));
+            if (ackCallback)
+                ackCallback(ack);
             break;
         }
         default:
             log_error(std::format("Unknown packet type: {}", packetType));
-            buf.data.clear();
-            buf.readOffset = 0;
+            buf.discardUnparsed();
             return;
         }
     }
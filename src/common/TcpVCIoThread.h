@@ -1,5 +1,8 @@
 #pragma once
 
+#include "ConnectionTable.h"
+#include "PacketBuffer.h"
+#include "ReceiveRing.h"
 #include "Socket.h"
 #include "StopableThread.h"
 #include "TcpConnection.h"
@@ -14,55 +17,66 @@
 class TcpVCIoThread : public StopableThread
 {
   public:
-    TcpVCIoThread(std::vector<TcpConnectionSp> connections,
-                  std::function<void(uint64_t, std::shared_ptr<std::vector<char>>, int)> dataCallback,
+    // One DATA payload parsed off a connection, or a whole FEC_PARITY frame.
+    struct DataFrame
+    {
+        uint64_t messageId{0};
+        PacketBuffer data;
+        bool parity{false};
+    };
+
+    // Receives every DATA and FEC_PARITY frame parsed from one recv() on `connIndex`, in stream order.
+    // The callee moves out what it keeps; the vector is cleared and reused afterwards.
+    using DataBatchCallback = std::function<void(int connIndex, std::vector<DataFrame> &frames)>;
+
+    TcpVCIoThread(SharedConnectionTableSp connTable,
+                  DataBatchCallback dataCallback,
                   std::function<void(uint64_t)> resendRequestCallback,
-                  std::function<void(const std::vector<uint64_t> &)> missingNotifyCallback,
+                  std::function<void(const std::vector<MissingRange> &)> missingNotifyCallback,
+                  std::function<void(const VCAck &)> ackCallback,
                   std::function<void(TcpConnectionSp)> disconnectCallback);
 
     virtual ~TcpVCIoThread();
 
-    // Hot-swap the connection at the given slot. The IO thread picks up the
-    // new socket on its next poll iteration (within IO_POLL_TIMEOUT_MS).
-    void replaceConnection(int slot, TcpConnectionSp conn);
-
   protected:
     virtual void run() override;
 
   private:
-    struct ReadBuffer
-    {
-        std::vector<char> data;
-        size_t readOffset = 0; // start of unprocessed data; avoids O(N) erase-from-front
-
-        // Number of unprocessed bytes
-        size_t available() const { return data.size() - readOffset; }
-        // Pointer to unprocessed data
-        char *begin() { return data.data() + readOffset; }
-        // Advance past consumed bytes, compacting when offset is large
-        void consume(size_t n)
-        {
-            readOffset += n;
-            if (readOffset > 4096 && readOffset >= data.size() / 2)
-            {
-                data.erase(data.begin(), data.begin() + static_cast<ptrdiff_t>(readOffset));
-                readOffset = 0;
-            }
-        }
-    };
+    void readFromConnection(int connIndex, const TcpConnectionSp &conn);
+    void parsePackets(ReceiveRing &buf);
 
-    void readFromConnection(int connIndex, TcpConnectionSp conn);
+    // Read by pinning it once per poll cycle; a replaced slot shows up on the next
+    // cycle (within IO_POLL_TIMEOUT_MS) with no lock and no snapshot copy.
+    SharedConnectionTableSp connTable;
+    size_t numConns = 0; // fixed for the channel's lifetime
+    // Per-connection read rings, created on first read and dropped when the slot's fd
+    // changes. DATA payloads are handed on as views into them (see ReceiveRing).
+    std::vector<ReceiveRing::Ptr> readBuffers;
+    // DATA and FEC_PARITY frames from the current parse pass, handed to dataCallback in one call.
+    std::vector<DataFrame> parsedFrames;
 
-    std::mutex connectionsMutex;
-    std::vector<TcpConnectionSp> connections;
-    // Bumped under connectionsMutex whenever a slot is replaced. The run() loop
-    // re-copies its connection snapshot only when this changes, avoiding a 32-element
-    // shared_ptr copy on every poll cycle under active traffic.
-    std::atomic<uint64_t> connGeneration{0};
-    std::vector<ReadBuffer> readBuffers;
-
-    std::function<void(uint64_t, std::shared_ptr<std::vector<char>>, int)> dataCallback;
+    DataBatchCallback dataCallback;
     std::function<void(uint64_t)> resendRequestCallback;
-    std::function<void(const std::vector<uint64_t> &)> missingNotifyCallback;
+    // MISSING_NOTIFY and MISSING_RANGES, both decoded to runs.
+    std::function<void(const std::vector<MissingRange> &)> missingNotifyCallback;
+    std::vector<MissingRange> missingRanges; // scratch for it
+    std::function<void(const VCAck &)> ackCallback;
     std::function<void(TcpConnectionSp)> disconnectCallback;
+
+    // Polled alongside the connections. A read ring that filled up signals it when the
+    // reorder side releases a view, so reading resumes without waiting out the poll
+    // timeout. The rings' hooks hold it weakly, since a ring may outlive this thread.
+    struct Wakeup
+    {
+        SocketFd waitFd;
+        SocketFd signalFd;
+        bool ok;
+        Wakeup() : ok(SocketWakePairCreate(waitFd, signalFd) == 0) {}
+        ~Wakeup()
+        {
+            if (ok)
+                SocketWakePairClose(waitFd, signalFd);
+        }
+    };
+    std::shared_ptr<Wakeup> wakeup;
 };
@@ -3,37 +3,99 @@
 #include "Socket.h"
 #include <algorithm>
 #include <chrono>
+#include <format>
 #include <thread>
 
 using namespace Logger;
 
-TcpVCSendThread::TcpVCSendThread(std::vector<TcpConnectionSp> connections_,
-                                 BlockingQueueSp sendQueue_,
-                                 BlockingQueueSp resendQueue_,
-                                 std::vector<std::shared_ptr<ConnSendStats>> connSendStats_,
+std::string SendWriteStats::format() const
+{
+    uint64_t calls = writeCalls.load(std::memory_order_relaxed);
+    uint64_t sentFrames = frames.load(std::memory_order_relaxed);
+    uint64_t sentBytes = bytes.load(std::memory_order_relaxed);
+    return std::format("[SENDWRITE] writes={} frames={} KB={} framesPerWrite={:.1f} bytesPerWrite={} "
+                       "stallRescues={} rescuedFrames={} pacingPauses={} pacingWaitMs={}",
+                       calls, sentFrames, sentBytes / 1024,
+                       calls ? static_cast<double>(sentFrames) / calls : 0.0,
+                       calls ? sentBytes / calls : 0,
+                       stallRescues.load(std::memory_order_relaxed),
+                       rescuedFrames.load(std::memory_order_relaxed),
+                       pacingPauses.load(std::memory_order_relaxed),
+                       pacingWaitUs.load(std::memory_order_relaxed) / 1000);
+}
+
+void ControlLaneStats::record(uint64_t delayUs)
+{
+    frames.fetch_add(1, std::memory_order_relaxed);
+    totalDelayUs.fetch_add(delayUs, std::memory_order_relaxed);
+    uint64_t prev = maxDelayUs.load(std::memory_order_relaxed);
+    while (delayUs > prev && !maxDelayUs.compare_exchange_weak(prev, delayUs, std::memory_order_relaxed))
+    {
+    }
+}
+
+std::string ControlLaneStats::format() const
+{
+    uint64_t sent = frames.load(std::memory_order_relaxed);
+    uint64_t total = totalDelayUs.load(std::memory_order_relaxed);
+    return std::format("[CONTROL] frames={} avgDelayUs={} maxDelayUs={}", sent, sent ? total / sent : 0,
+                       maxDelayUs.load(std::memory_order_relaxed));
+}
+
+TcpVCSendThread::TcpVCSendThread(SharedConnectionTableSp connTable_,
+                                 MpscQueueSp sendQueue_,
+                                 MpscQueueSp resendQueue_,
+                                 MpscQueueSp controlQueue_,
                                  std::shared_ptr<MessageTracker> messageTracker_,
-                                 std::vector<std::shared_ptr<SocketStatus>> socketStatuses_,
+                                 std::shared_ptr<SendWriteStats> writeStats_,
+                                 std::shared_ptr<ControlLaneStats> controlStats_,
+                                 std::shared_ptr<FlowQueueStats> flowStats,
+                                 SchedulerPolicy schedulerPolicy,
                                  std::function<void(TcpConnectionSp)> disconnectCallback_)
-    : connections(std::move(connections_)),
+    : disconnectCallback(std::move(disconnectCallback_)),
+      connTable(std::move(connTable_)),
       sendQueue(std::move(sendQueue_)),
       resendQueue(std::move(resendQueue_)),
-      connSendStats(std::move(connSendStats_)),
+      controlQueue(std::move(controlQueue_)),
       messageTracker(std::move(messageTracker_)),
-      socketStatuses(std::move(socketStatuses_)),
-      disconnectCallback(std::move(disconnectCallback_))
+      writeStats(writeStats_ ? std::move(writeStats_) : std::make_shared<SendWriteStats>()),
+      controlStats(controlStats_ ? std::move(controlStats_) : std::make_shared<ControlLaneStats>()),
+      flowQueue(SEND_QUEUE_HARD_LIMIT, std::move(flowStats))
 {
-    lastRuntimeRefresh.resize(connections.size());
+    SharedConnectionTable::Reader reader(*connTable);
+    auto table = reader.pin();
+    numConns = table->connections.size();
+    // Reserve resend slots only when the channel has enough connections. Test channels
+    // with fewer connections use all slots for normal data.
+    hasResendConns = (numConns > VC_FIRST_RESEND_CONN_INDEX);
+    numDataConns = hasResendConns ? static_cast<size_t>(VC_FIRST_RESEND_CONN_INDEX) : numConns;
+    scheduler = MakeConnectionScheduler(schedulerPolicy, numDataConns);
+    slotMetrics.resize(numDataConns);
+    highestDataId.assign(numDataConns, 0);
+    slotWritten.assign(numDataConns, 0);
+    slotDelivered.assign(numDataConns, 0);
+    unackedSince.resize(numDataConns);
+    quarantinedSince.resize(numDataConns);
+    log_info(std::format("TcpVCSendThread using {} scheduling over {} data connections",
+                         SchedulerPolicyName(schedulerPolicy), numDataConns));
+    lastRuntimeRefresh.resize(numConns);
+    outbound.reserve(numConns);
+    for (size_t i = 0; i < numConns; i++)
+        outbound.emplace_back(OUTBOUND_FRAMES_PER_CONN);
+    awaitingWritable.assign(numConns, 0);
     auto now = std::chrono::steady_clock::now();
-    for (size_t i = 0; i < connections.size(); i++)
+    for (size_t i = 0; i < numConns; i++)
     {
         lastRuntimeRefresh[i] = now;
         // Ensure sockets are non-blocking so SendTcpDirect returns immediately on EAGAIN.
-        if (connections[i] && connections[i]->isConnected())
-            SetSocketNonBlocking(connections[i]->getSocketFd());
+        const auto &conn = table->connections[i];
+        if (conn && conn->isConnected())
+            SetSocketNonBlocking(conn->getSocketFd());
     }
 
-    // Wake the run() idle wait whenever either queue receives work, so the thread
-    // no longer has to poll the resend queue on a short timer. The notifier captures
+    // Wake the run() idle wait when either queue receives work while the thread is
+    // parked on it, so the thread no longer has to poll the resend queue on a short
+    // timer. Enqueues while the thread is busy skip the notifier. The notifier captures
     // only the shared Waker (not this), so it stays safe if the thread is destroyed
     // while a queue still references it. The brief lock on waker->mtx closes the
     // lost-wakeup window against run()'s wait_for predicate.
@@ -48,35 +110,28 @@ TcpVCSendThread::TcpVCSendThread(std::vector<TcpConnectionSp> connections_,
         sendQueue->setEnqueueNotifier(wake);
     if (resendQueue)
         resendQueue->setEnqueueNotifier(wake);
+    if (controlQueue)
+        controlQueue->setEnqueueNotifier(wake);
 }
 
 TcpVCSendThread::~TcpVCSendThread()
 {
     // Stop the queues from calling into our Waker once we're gone. Safe to call
-    // concurrently with enqueue() (guarded by the queue mutex); any in-flight
+    // concurrently with enqueue() (guarded by the notifier mutex); any in-flight
     // notifier already holds its own shared_ptr to the Waker.
     if (sendQueue)
         sendQueue->setEnqueueNotifier(nullptr);
     if (resendQueue)
         resendQueue->setEnqueueNotifier(nullptr);
+    if (controlQueue)
+        controlQueue->setEnqueueNotifier(nullptr);
 }
 
-void TcpVCSendThread::replaceConnection(int slot, TcpConnectionSp conn,
-                                        std::shared_ptr<ConnSendStats> stats,
-                                        std::shared_ptr<SocketStatus> status)
+void TcpVCSendThread::onConnectionReplaced(int /*slot*/)
 {
-    if (slot < 0 || static_cast<size_t>(slot) >= connections.size())
-        return;
-    SetSocketNonBlocking(conn->getSocketFd());
     {
-        std::lock_guard<std::mutex> lock(connectionsMutex);
-        connections[slot] = conn;
-        if (static_cast<size_t>(slot) < connSendStats.size())
-            connSendStats[slot] = stats;
-        if (static_cast<size_t>(slot) < socketStatuses.size())
-            socketStatuses[slot] = status;
-        if (static_cast<size_t>(slot) < lastRuntimeRefresh.size())
-            lastRuntimeRefresh[slot] = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(connAvailableMutex);
+        connReplacements.fetch_add(1, std::memory_order_release);
     }
     connAvailableCv.notify_one();
 }
@@ -113,534 +168,910 @@ void TcpVCSendThread::refreshConnRuntimeInfo(size_t connIndex,
     conn->refreshRuntimeInfoIfStale(std::chrono::milliseconds(TCP_RUNTIME_REFRESH_MS));
 }
 
-int TcpVCSendThread::rateConnection(size_t connIndex,
-                                    const std::vector<TcpConnectionSp>& conns,
-                                    const std::vector<std::shared_ptr<ConnSendStats>>& stats)
+static uint64_t FrameMessageId(const PacketBuffer &frame)
 {
-    if (connIndex >= conns.size())
-        return -1;
-    const auto &conn = conns[connIndex];
-    if (!conn || !conn->isConnected())
-        return -1;
-
-    refreshConnRuntimeInfo(connIndex, conns);
-    auto info = conn->getLastRuntimeInfo();
+    return reinterpret_cast<const VCDataPacket *>(frame.data())->header.messageId;
+}
 
-    if (info.isInExponentialBackoff)
-        return -1;
+static bool IsDataFrame(const PacketBuffer &frame)
+{
+    return reinterpret_cast<const VCDataPacket *>(frame.data())->header.type == VcPacketType::DATA;
+}
 
-    int score = 10000;
-    // RTT is weighted more heavily than cwnd to prefer low-latency paths.
-    // A 50ms RTT difference (100pt) now outweighs a 20KB cwnd difference (100pt),
-    // whereas the old weights let a high-cwnd/high-RTT connection beat a
-    // low-cwnd/low-RTT one (cwnd/100 vs rtt/500 made cwnd 5x more influential).
-    score += static_cast<int>(info.congestionWindowBytes / 200);
-    score -= static_cast<int>(info.smoothedRttUs / 200);
-    score -= static_cast<int>(info.bytesInFlight / 200);
-    score -= info.timeoutEpisodes * 200;
+static bool IsParityFrame(const PacketBuffer &frame)
+{
+    return reinterpret_cast<const VCDataPacket *>(frame.data())->header.type == VcPacketType::FEC_PARITY;
+}
 
-    if (connIndex < stats.size() && stats[connIndex])
+void TcpVCSendThread::setFec(const FecConfig &config, std::shared_ptr<FecStats> stats)
+{
+    if (!hasResendConns)
     {
-        uint64_t failCount = stats[connIndex]->reenqueueCount.load(std::memory_order_relaxed);
-        score -= static_cast<int>(failCount) * 200;
+        log_warnning(std::format("FEC needs the resend connections ({} connections); sending without parity",
+                                 numConns));
+        return;
     }
-
-    return score > 0 ? score : 0;
+    fec = std::make_unique<FecEncoder>(config, stats);
+    fecStats = std::move(stats);
+    log_info(std::format("TcpVCSendThread sending FEC parity every {} data frames{}", fec->groupSize(),
+                         config.adaptive ? " (adaptive)" : ""));
 }
 
-void TcpVCSendThread::run()
+void TcpVCSendThread::queueParity()
 {
-    log_info("TcpVCSendThread started");
+    for (auto &frame : parityFrames)
+    {
+        if (pendingParity.size() >= MAX_PENDING_PARITY)
+        {
+            pendingParity.pop_front();
+            if (fecStats)
+                fecStats->parityDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        pendingParity.push_back(std::move(frame));
+    }
+    parityFrames.clear();
+}
 
-    const size_t numConns = connections.size();
-    // Reserve resend slots only when the channel has enough connections.
-    // Test channels with fewer connections use all slots for normal data
-    // (sendOnResendConn handles the absent-conn case).
-    const bool hasResendConns = (numConns > VC_FIRST_RESEND_CONN_INDEX);
-    const size_t numDataConns = hasResendConns ? static_cast<size_t>(VC_FIRST_RESEND_CONN_INDEX) : numConns;
+void TcpVCSendThread::commit(size_t connIndex, PacketBuffer &frame,
+                             const std::vector<TcpConnectionSp>& conns)
+{
+    auto &out = outbound[connIndex];
+    if (out.empty())
+        conns[connIndex]->diagMarkSendStart(FrameMessageId(frame));
+    out.push(frame);
+    if (out.full() && connIndex < numDataConns)
+    {
+        slotMetrics[connIndex].hasRoom = false;
+        scheduler->onMetricsUpdate(connIndex, slotMetrics[connIndex]);
+    }
+}
 
-    // Scores are recomputed per packet but the storage is reused.
-    std::vector<int> scores(numDataConns);
-    // Indices sorted by score, reused across iterations.
-    std::vector<size_t> order(numDataConns);
+bool TcpVCSendThread::flushOutbound(size_t connIndex,
+                                    const std::vector<TcpConnectionSp>& conns,
+                                    const std::vector<std::shared_ptr<ConnSendStats>>& stats)
+{
+    auto &out = outbound[connIndex];
+    const auto &conn = conns[connIndex];
 
-    // Packet retained across iterations when all connections fail — avoids re-enqueuing
-    // (which inflates approxSize and causes spurious drops).
-    std::shared_ptr<std::vector<char>> pendingDataVec;
+    completedFrames.clear();
+    ConnOutbound::WriteCounts counts;
+    auto result = out.flush(conn->getSocketFd(), completedFrames, counts);
+    if (counts.calls > 0)
+    {
+        writeStats->writeCalls.fetch_add(counts.calls, std::memory_order_relaxed);
+        writeStats->frames.fetch_add(completedFrames.size(), std::memory_order_relaxed);
+        writeStats->bytes.fetch_add(counts.bytes, std::memory_order_relaxed);
+        if (connIndex < numDataConns)
+            slotWritten[connIndex] += counts.bytes;
+    }
 
-    while (this->isRunning())
+    const bool progressed = !completedFrames.empty();
+    if (progressed)
     {
-        // Priority: drain resend queue first (non-blocking), but batch-limit
-        // to avoid starving normal sends when the resend queue is busy.
-        // anyResendAlive is reused by the idle wait below to decide whether
-        // pending resend work is actually drainable right now.
-        bool anyResendAlive = false;
-        if (resendQueue)
+        const auto now = std::chrono::steady_clock::now();
+        auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+        size_t completedBytes = 0;
+        for (const auto &frame : completedFrames)
         {
-            // Quick check: are ANY resend connections alive? If none are,
-            // skip draining to avoid a hot re-enqueue loop while the
-            // watchdog reconnects.
-            {
-                std::lock_guard<std::mutex> lock(connectionsMutex);
-                for (size_t i = VC_FIRST_RESEND_CONN_INDEX; i < connections.size(); i++)
-                {
-                    if (connections[i] && connections[i]->isConnected())
-                    {
-                        anyResendAlive = true;
-                        break;
-                    }
-                }
-            }
-
-            if (anyResendAlive)
+            completedBytes += frame.size();
+            uint64_t messageId = FrameMessageId(frame);
+            conn->diagMarkSendEnd(messageId);
+            if (!IsDataFrame(frame))
+                continue; // control frames carry no messageId to track
+            if (isResendSlot(connIndex))
             {
-                size_t resendBatch = 0;
-                while (resendBatch < MAX_RESEND_BATCH)
-                {
-                    auto resendData = resendQueue->tryDequeue();
-                    if (!resendData)
-                        break;
-                    std::vector<TcpConnectionSp> connSnap;
-                    {
-                        std::lock_guard<std::mutex> lock(connectionsMutex);
-                        connSnap = connections;
-                    }
-                    sendOnResendConn(std::move(resendData), connSnap);
-                    resendBatch++;
-                }
+                resendRetryCount.erase(messageId);
+                log_info("[RESEND] Sent resend msgId=" + std::to_string(messageId) +
+                         " on conn " + std::to_string(connIndex));
+                continue;
             }
-
-            // Prevent unbounded growth of the retry tracker map.
-            if (resendRetryCount.size() > MAX_RESEND_TRACKED)
+            if (messageTracker)
+                messageTracker->recordMessage(messageId, static_cast<int>(connIndex), nowMs);
+            if (ackTracker)
+                ackTracker->onSent(messageId, now);
+            if (connIndex < numDataConns)
+                highestDataId[connIndex] = std::max(highestDataId[connIndex], messageId + 1);
+            if (connIndex < stats.size() && stats[connIndex])
             {
-                log_warnning("[RESEND] Retry tracker has " +
-                             std::to_string(resendRetryCount.size()) +
-                             " entries, clearing stale entries");
-                resendRetryCount.clear();
+                auto &connStats = stats[connIndex];
+                connStats->lastTxMessageId.store(messageId);
+                connStats->lastTxTimeMs.store(nowMs);
+                connStats->txCount.fetch_add(1);
+                connStats->valid.store(true);
+                connStats->reenqueueCount.store(0, std::memory_order_relaxed);
             }
         }
+        if (connIndex < numDataConns)
+            scheduler->onSendComplete(connIndex, completedBytes);
+        if (!out.empty())
+            conn->diagMarkSendStart(FrameMessageId(out.front()));
+        completedFrames.clear();
+    }
 
-        // Use retained pending packet or dequeue a new one (non-blocking).
-        std::shared_ptr<std::vector<char>> dataVec;
-        if (pendingDataVec)
-        {
-            dataVec = std::move(pendingDataVec);
-        }
-        else
-        {
-            dataVec = sendQueue->tryDequeue();
-        }
-        if (!dataVec)
-        {
-            // No normal-send work right now. Block until there is work or shutdown.
-            // The queues' enqueue notifier wakes us instantly, so send/resend latency
-            // is unchanged in the common case; IDLE_WAIT_MS is only a backstop. This
-            // replaces the old 5ms busy-poll that woke the thread ~200x/sec per
-            // channel even when fully idle.
-            //
-            // Resend work only counts as wakeable when a resend connection is alive
-            // to drain it. Otherwise (the watchdog-reconnect window) pending resend
-            // items would keep the predicate true and spin the CPU; instead we fall
-            // back to the IDLE_WAIT_MS backstop and re-check liveness next iteration.
-            const bool resendDrainable = anyResendAlive;
-            std::unique_lock<std::mutex> lock(waker->mtx);
-            waker->cv.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MS), [&] {
-                return !this->isRunning() ||
-                       (sendQueue && sendQueue->approxSize() > 0) ||
-                       (resendDrainable && resendQueue && resendQueue->approxSize() > 0);
-            });
-            continue; // loop back: drain resend first, then re-dequeue
-        }
-        if (!this->isRunning())
-            break;
+    switch (result)
+    {
+    case ConnOutbound::FlushResult::Drained:
+        awaitingWritable[connIndex] = 0;
+        break;
+    case ConnOutbound::FlushResult::WouldBlock:
+        // Backpressure: the scorer steers new frames away from this slot until it
+        // drains, and run() polls it for POLLOUT instead of retrying.
+        awaitingWritable[connIndex] = 1;
+        if (connIndex < stats.size() && stats[connIndex])
+            stats[connIndex]->reenqueueCount.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case ConnOutbound::FlushResult::Error:
+        // A genuine socket error: drop the connection so the watchdog reconnects the
+        // slot, and resend its queued frames elsewhere.
+        log_warnning("Send error on conn " + std::to_string(connIndex) + " with " +
+                     std::to_string(out.size()) + " frame(s) queued; disconnecting");
+        failConnection(connIndex, conns);
+        break;
+    }
+    return progressed;
+}
+
+void TcpVCSendThread::reclaimOutbound(size_t connIndex)
+{
+    auto &out = outbound[connIndex];
+    awaitingWritable[connIndex] = 0;
+    if (out.empty())
+        return;
 
-        // Take a consistent snapshot of connections + stats under the mutex.
-        // This ensures replaceConnection() writes are visible for this packet —
-        // no stale pointers during scoring/sending.
-        std::vector<TcpConnectionSp> connSnap;
-        std::vector<std::shared_ptr<ConnSendStats>> statsSnap;
+    reclaimedFrames.clear();
+    out.takeAll(reclaimedFrames);
+    if (isResendSlot(connIndex))
+    {
+        for (auto &frame : reclaimedFrames)
         {
-            std::lock_guard<std::mutex> lock(connectionsMutex);
-            connSnap = connections;
-            statsSnap = connSendStats;
+            if (IsParityFrame(frame))
+                continue; // stale by the time another connection could carry it
+            uint64_t messageId = FrameMessageId(frame);
+            uint8_t &retries = resendRetryCount[messageId];
+            if (retries >= MAX_RESEND_RETRIES)
+            {
+                log_warnning("[RESEND] Resend of msgId=" + std::to_string(messageId) +
+                             " failed after " + std::to_string(retries) + " retries, dropping");
+                resendRetryCount.erase(messageId);
+                continue;
+            }
+            retries++;
+            pendingResend.push_back(std::move(frame));
         }
+    }
+    else
+    {
+        // These are older than anything still waiting for a slot, so they go first,
+        // and were paced when first written.
+        for (auto it = reclaimedFrames.rbegin(); it != reclaimedFrames.rend(); ++it)
+            rescuedData.push_front(std::move(*it));
+    }
+    reclaimedFrames.clear();
+}
 
-        if (numDataConns == 0 || !connSnap[0])
-            continue;
+void TcpVCSendThread::failConnection(size_t connIndex, const std::vector<TcpConnectionSp>& conns)
+{
+    reclaimOutbound(connIndex);
+    const auto &conn = conns[connIndex];
+    if (!conn)
+        return;
+    conn->disconnect();
+    if (disconnectCallback)
+        disconnectCallback(conn);
+}
 
-        const VCDataPacket *packet = reinterpret_cast<const VCDataPacket *>(dataVec->data());
-        uint64_t messageId = packet->header.messageId;
+void TcpVCSendThread::syncSlot(size_t connIndex,
+                               const std::vector<TcpConnectionSp>& conns,
+                               const std::vector<std::shared_ptr<ConnSendStats>>& stats)
+{
+    if (connIndex >= numDataConns)
+        return;
+    const auto &conn = conns[connIndex];
+    SlotMetrics m = slotMetrics[connIndex];
+    m.connected = conn && conn->isConnected();
+    m.hasRoom = !outbound[connIndex].full();
+    m.backlogged = awaitingWritable[connIndex] != 0;
+    m.quarantined = quarantinedSince[connIndex] != std::chrono::steady_clock::time_point{};
+    m.failCount = (connIndex < stats.size() && stats[connIndex])
+                      ? stats[connIndex]->reenqueueCount.load(std::memory_order_relaxed)
+                      : 0;
+    if (m.connected)
+    {
+        // Rate-limited TCP_INFO sample; the scheduler only re-ranks the slot when the
+        // sample (or anything else above) actually changed.
+        refreshConnRuntimeInfo(connIndex, conns);
+        m.info = conn->getLastRuntimeInfo();
+    }
+    if (m == slotMetrics[connIndex])
+        return;
+    slotMetrics[connIndex] = m;
+    scheduler->onMetricsUpdate(connIndex, m);
+}
 
-        // Rate data connections only (indices 0..numDataConns-1).
-        // Resend connections (VC_FIRST_RESEND_CONN_INDEX..VC_TCP_CONNECTIONS-1) are excluded.
-        int bestScore = -1;
-        bool uniformScores = true;
-        for (size_t i = 0; i < numDataConns; i++)
-        {
-            scores[i] = rateConnection(i, connSnap, statsSnap);
-            if (i > 0 && scores[i] != scores[0])
-                uniformScores = false;
-            if (scores[i] > bestScore)
-                bestScore = scores[i];
-        }
+void TcpVCSendThread::checkStall(size_t connIndex, const std::vector<TcpConnectionSp>& conns)
+{
+    using TimePoint = std::chrono::steady_clock::time_point;
+    const auto &conn = conns[connIndex];
+    if (!conn || !conn->isConnected())
+    {
+        unackedSince[connIndex] = {};
+        quarantinedSince[connIndex] = {};
+        return;
+    }
 
-        // Build an order of indices to try, best-scored first.
-        for (size_t i = 0; i < numDataConns; i++)
-            order[i] = i;
-
-        // Sort by score only when scores actually differ. On Windows TCP_INFO is
-        // unavailable, so every live connection scores identically and the sort would
-        // merely reproduce the natural order at O(N log N) per packet — pure
-        // hot-path overhead. When scores diverge (Linux/macOS, or a failing conn on
-        // any platform) the stable_sort orders best-first.
-        if (!uniformScores)
-        {
-            std::stable_sort(order.begin(), order.end(),
-                             [&](size_t a, size_t b) { return scores[a] > scores[b]; });
-        }
+    refreshConnRuntimeInfo(connIndex, conns);
+    auto info = conn->getLastRuntimeInfo();
+    const auto sampledAt = lastRuntimeRefresh[connIndex];
+    bool stalled = false;
+    uint32_t silentMs = 0;
+    if (info.valid && info.bytesInFlight > 0)
+    {
+        if (unackedSince[connIndex] == TimePoint{})
+            unackedSince[connIndex] = sampledAt;
+        // Judged as of the sample: the ACK silence counts from the last ACK or from
+        // when data was first seen outstanding, whichever is later (an idle
+        // connection's last ACK says nothing about the data just written).
+        auto outstandingMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 sampledAt - unackedSince[connIndex])
+                                 .count();
+        silentMs = std::min<uint32_t>(info.lastAckAgeMs, static_cast<uint32_t>(outstandingMs));
+        uint32_t limitMs = std::max(STALL_MIN_MS, 2 * info.rtoUs / 1000);
+        stalled = silentMs >= limitMs || info.isInExponentialBackoff;
+    }
+    else
+    {
+        unackedSince[connIndex] = {};
+    }
 
-        // Fallback: if backoff eliminated all candidates, allow any connected socket.
-        bool anyEligible = (bestScore >= 0);
-
-        // Load-balance across the connections tied at the top. The previous code
-        // rotated the start index over ALL connections, but stable_sort only keeps
-        // the rotation order *within* a tie group. Since the rotation domain (all
-        // connections) is larger than a tie group that is a subset of them, the
-        // lowest-indexed member of the tie group won most rotation positions and was
-        // hammered while its equally-good peers sat idle. Instead, rotate the leading
-        // run of equally-best connections by a round-robin counter so each tied
-        // connection is selected in turn. When no connection is eligible (all in
-        // backoff), rotate across every connection so the connected-socket fallback
-        // below still spreads load.
-        size_t rotateCount = numDataConns;
-        if (anyEligible)
+    if (quarantinedSince[connIndex] != TimePoint{})
+    {
+        auto quarantinedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - quarantinedSince[connIndex])
+                                 .count();
+        if (!stalled)
         {
-            rotateCount = 0;
-            while (rotateCount < numDataConns && scores[order[rotateCount]] == bestScore)
-                rotateCount++;
+            log_info(std::format("Conn {} is getting ACKs again; quarantine lifted after {}ms", connIndex,
+                                 quarantinedMs));
+            quarantinedSince[connIndex] = {};
         }
-        if (rotateCount > 1)
+        else if (quarantinedMs >= QUARANTINE_MAX_MS)
         {
-            size_t pick = roundRobinStart % rotateCount;
-            std::rotate(order.begin(), order.begin() + pick, order.begin() + rotateCount);
+            log_warnning(std::format("Conn {} still stalled after {}ms in quarantine; disconnecting", connIndex,
+                                     quarantinedMs));
+            quarantinedSince[connIndex] = {};
+            // No frames were queued here since the quarantine, and those left (at most a
+            // partly written one) were re-sent then, so they are not reclaimed again.
+            reclaimedFrames.clear();
+            outbound[connIndex].takeAll(reclaimedFrames);
+            reclaimedFrames.clear();
+            failConnection(connIndex, conns);
         }
-        roundRobinStart = (roundRobinStart + 1) % numDataConns;
+        return;
+    }
+    if (!stalled)
+        return;
+
+    log_warnning(std::format("Conn {} stalled: {} bytes unacked, {} unsent, no ACK for {}ms, backoff={}", connIndex,
+                             info.bytesInFlight, info.notSentBytes, silentMs, info.isInExponentialBackoff));
+    rescueStalled(connIndex, conns, false);
+}
+
+void TcpVCSendThread::rescueStalled(size_t connIndex, const std::vector<TcpConnectionSp>& conns,
+                                    bool dropConnection)
+{
+    auto &out = outbound[connIndex];
+    auto info = conns[connIndex]->getLastRuntimeInfo();
+    quarantinedSince[connIndex] = std::chrono::steady_clock::now();
 
-        bool sent = false;
-        for (size_t rank = 0; rank < numDataConns; rank++)
+    // Walk back from the newest data frame written to this slot, collecting the slot's
+    // frames until they cover what its socket still holds. The peer drops duplicates,
+    // so overshooting a little only costs bandwidth.
+    reclaimedFrames.clear();
+    uint64_t budget = info.valid ? uint64_t{info.bytesInFlight} + info.notSentBytes : RESCUE_FALLBACK_BYTES;
+    uint64_t covered = 0;
+    if (messageTracker && frameSource)
+    {
+        uint64_t id = highestDataId[connIndex]; // one past the newest
+        for (size_t scanned = 0; id > 0 && scanned < messageTracker->capacity() && covered < budget; scanned++)
         {
-            size_t idx = order[rank];
-            if (!anyEligible)
-            {
-                if (!connSnap[idx] || !connSnap[idx]->isConnected())
-                    continue;
-            }
-            else if (scores[idx] < 0)
-            {
+            id--;
+            if (messageTracker->getConnectionIndex(id) != static_cast<int>(connIndex))
                 continue;
-            }
-
-            auto &conn = connSnap[idx];
+            PacketBuffer frame = frameSource(id);
+            if (!frame)
+                break; // evicted from the cache, and so is everything older
+            covered += frame.size();
+            reclaimedFrames.push_back(std::move(frame));
+        }
+    }
+    std::reverse(reclaimedFrames.begin(), reclaimedFrames.end());
+    const size_t fromSocket = reclaimedFrames.size();
 
-            // No per-packet writability pre-poll. The socket is non-blocking, so
-            // SendTcpDirect returns immediately with SOCKET_ERROR_WOULD_BLOCK when
-            // the kernel send buffer is full.
-            conn->diagMarkSendStart(messageId);
+    // Then what was never written. A partly written front frame has to stay for the
+    // stream's framing and a copy of it goes with the rest, unless the caller is about
+    // to drop the connection: then it comes out whole, and only once.
+    if (dropConnection)
+    {
+        out.takeAll(reclaimedFrames);
+    }
+    else
+    {
+        if (out.midFrame())
+            reclaimedFrames.push_back(out.front());
+        out.takeUnstarted(reclaimedFrames);
+    }
+    if (out.empty())
+        awaitingWritable[connIndex] = 0;
 
-            // Use direct send — socket is already non-blocking.
-            ssize_t n = SendTcpDirect(conn->getSocketFd(), dataVec->data(), dataVec->size(), 0);
+    // All of it was paced when first written, so like a resend it does not wait for
+    // pacing tokens again. With resend connections it goes out there: to the peer these
+    // are retransmissions, and arriving on a resend connection they are counted as such
+    // instead of as reordering between the data connections.
+    if (hasResendConns)
+    {
+        for (auto &frame : reclaimedFrames)
+            pendingResend.push_back(std::move(frame));
+    }
+    else
+    {
+        // Older than anything still waiting for a slot.
+        for (auto it = reclaimedFrames.rbegin(); it != reclaimedFrames.rend(); ++it)
+            rescuedData.push_front(std::move(*it));
+    }
+    writeStats->stallRescues.fetch_add(1, std::memory_order_relaxed);
+    writeStats->rescuedFrames.fetch_add(reclaimedFrames.size(), std::memory_order_relaxed);
+    log_warnning(std::format("Conn {} quarantined; re-sending {} frame(s) elsewhere ({} from its socket buffer)",
+                             connIndex, reclaimedFrames.size(), fromSocket));
+    reclaimedFrames.clear();
+}
 
-            conn->diagMarkSendEnd(messageId);
+bool TcpVCSendThread::assignResend(PacketBuffer &frame, const std::vector<TcpConnectionSp>& conns)
+{
+    const size_t resendCount = numConns - VC_FIRST_RESEND_CONN_INDEX;
 
-            if (n > 0)
-            {
-                // Handle partial send: on non-blocking sockets, send() may return
-                // fewer bytes than requested when the kernel buffer is nearly full.
-                // Once we've written ANY bytes to this connection we MUST complete
-                // the packet here — switching connections mid-packet corrupts both
-                // TCP streams (the receiver expects contiguous protocol bytes).
-                size_t totalSent = static_cast<size_t>(n);
-                // Flush the rest of the packet on THIS connection — partial bytes are
-                // already in the stream, so switching connections mid-packet would
-                // corrupt the framing. A full kernel send buffer under load is
-                // backpressure, not a dead socket: keep waiting for writability up to
-                // PARTIAL_SEND_BUDGET_MS instead of giving up after one short poll.
-                // Stalling here only delays throughput (and applies natural send-queue
-                // backpressure); it does NOT create a receiver-side gap, because the
-                // packets queued behind this one have not been sent yet. Only a genuine
-                // socket error or a sustained stall past the budget tears the conn down.
-                auto partialStart = std::chrono::steady_clock::now();
-                bool hardError = false;
-                while (totalSent < dataVec->size())
-                {
-                    if (!conn->isConnected() || !this->isRunning())
-                        break;
-                    if (!IsSocketWritable(conn->getSocketFd(), PARTIAL_SEND_POLL_MS))
-                    {
-                        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                             std::chrono::steady_clock::now() - partialStart)
-                                             .count();
-                        if (elapsedMs >= PARTIAL_SEND_BUDGET_MS)
-                            break; // truly stuck — give up
-                        continue;
-                    }
-                    ssize_t r = SendTcpDirect(
-                        conn->getSocketFd(),
-                        dataVec->data() + totalSent,
-                        dataVec->size() - totalSent, 0);
-                    if (r > 0)
-                    {
-                        totalSent += static_cast<size_t>(r);
-                    }
-                    else if (r == SOCKET_ERROR_WOULD_BLOCK || r == SOCKET_ERROR_INTERRUPTED)
-                    {
-                        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                             std::chrono::steady_clock::now() - partialStart)
-                                             .count();
-                        if (elapsedMs >= PARTIAL_SEND_BUDGET_MS)
-                            break;
-                        continue;
-                    }
-                    else
-                    {
-                        hardError = true;
-                        break; // genuine connection error
-                    }
-                }
+    // Round-robin over live resend connections with room, preferring one whose socket
+    // is not already backlogged.
+    size_t chosen = numConns;
+    size_t backlogged = numConns;
+    for (size_t attempt = 0; attempt < resendCount; attempt++)
+    {
+        size_t idx = VC_FIRST_RESEND_CONN_INDEX +
+                     (resendRoundRobin + attempt) % resendCount;
+        const auto &conn = conns[idx];
+        if (!conn || !conn->isConnected() || outbound[idx].full())
+            continue;
 
-                if (totalSent < dataVec->size())
-                {
-                    // Couldn't finish — partial bytes already in the TCP stream make
-                    // the framing unrecoverable, so this connection must be dropped.
-                    // With the budget above this now only happens on a real error or a
-                    // sustained (>= PARTIAL_SEND_BUDGET_MS) stall, not brief backpressure.
-                    conn->disconnect();
-                    if (disconnectCallback)
-                        disconnectCallback(conn);
-                    if (idx < statsSnap.size() && statsSnap[idx])
-                        statsSnap[idx]->reenqueueCount.fetch_add(1, std::memory_order_relaxed);
-                    log_warnning("Partial send on conn " + std::to_string(idx) +
-                                 " for msgId " + std::to_string(messageId) +
-                                 " (" + std::to_string(totalSent) + "/" +
-                                 std::to_string(dataVec->size()) + " bytes, " +
-                                 (hardError ? "error" : "stalled") + "); disconnecting");
-                    continue; // try next connection for this packet
-                }
+        // Skip connections in TCP exponential backoff — sending on them
+        // would waste a round-trip on a connection the kernel already
+        // considers congested.  Refresh runtime info first (resend slots
+        // are not tracked by the scheduler, so it may be stale).
+        refreshConnRuntimeInfo(idx, conns);
+        if (conn->getLastRuntimeInfo().isInExponentialBackoff)
+            continue;
 
-                if (messageTracker)
-                    messageTracker->recordMessage(messageId, static_cast<int>(idx));
+        if (awaitingWritable[idx])
+        {
+            if (backlogged == numConns)
+                backlogged = idx;
+            continue;
+        }
+        chosen = idx;
+        break;
+    }
+    if (chosen == numConns)
+        chosen = backlogged;
+    if (chosen == numConns)
+        return false;
 
-                auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                 std::chrono::steady_clock::now().time_since_epoch())
-                                 .count();
-                if (idx < statsSnap.size() && statsSnap[idx])
-                {
-                    auto &stats = statsSnap[idx];
-                    stats->lastTxMessageId.store(messageId);
-                    stats->lastTxTimeMs.store(nowMs);
-                    stats->txCount.fetch_add(1);
-                    stats->valid.store(true);
-                    stats->reenqueueCount.store(0, std::memory_order_relaxed);
-                }
+    resendRoundRobin = (resendRoundRobin + 1) % resendCount;
+    commit(chosen, frame, conns);
+    return true;
+}
 
-                sent = true;
-                break;
-            }
-            else
-            {
-                if (idx < statsSnap.size() && statsSnap[idx])
-                    statsSnap[idx]->reenqueueCount.fetch_add(1, std::memory_order_relaxed);
-                // WOULD_BLOCK just means this connection's buffer is full — skip to the
-                // next one. A genuine error (SOCKET_ERROR_CLOSED) means the connection
-                // is dead: disconnect it so the watchdog reaps and reconnects the slot.
-                // Without this, a reset connection that never sees a read event would
-                // linger as an undetected zombie that the scorer silently avoids.
-                if (n == SOCKET_ERROR_CLOSED)
-                {
-                    conn->disconnect();
-                    if (disconnectCallback)
-                        disconnectCallback(conn);
-                }
-            }
-        }
+size_t TcpVCSendThread::pickControlSlot(const std::vector<TcpConnectionSp>& conns) const
+{
+    size_t best = numConns;
+    int64_t bestDelay = 0;
+    for (size_t i = 0; i < numConns; i++)
+    {
+        const auto &conn = conns[i];
+        const auto &out = outbound[i];
+        if (!conn || !conn->isConnected() || out.full())
+            continue;
+        if (i < numDataConns && quarantinedSince[i] != std::chrono::steady_clock::time_point{})
+            continue;
 
-        if (!sent)
+        // Until a frame written now leaves: what is queued ahead of it here and in the
+        // socket, drained at cwnd / srtt, plus half a round trip. Without TCP_INFO only
+        // the local queue is known. Backlogged slots and slots in RTO backoff go last.
+        auto info = conn->getLastRuntimeInfo();
+        uint64_t ahead = out.pendingBytes() + info.notSentBytes;
+        int64_t delay = static_cast<int64_t>(ahead);
+        if (info.valid && info.congestionWindowBytes > 0)
+            delay = info.smoothedRttUs / 2 +
+                    static_cast<int64_t>(ahead * info.smoothedRttUs / info.congestionWindowBytes);
+        if (awaitingWritable[i] || info.isInExponentialBackoff)
+            delay += int64_t{1} << 40;
+        if (best == numConns || delay < bestDelay)
         {
-            // Retain the packet for the next iteration instead of re-enqueuing.
-            // Block until the watchdog reconnects a slot (signalled via
-            // connAvailableCv) or until the send/resend queues receive new
-            // work. This avoids burning CPU while no connections are available
-            // yet wakes instantly when one becomes usable.
-            pendingDataVec = std::move(dataVec);
-            std::unique_lock<std::mutex> lock(connectionsMutex);
-            connAvailableCv.wait_for(lock, std::chrono::milliseconds(50), [&] {
-                if (!this->isRunning())
-                    return true;
-                for (size_t i = 0; i < numDataConns; i++)
-                {
-                    if (connections[i] && connections[i]->isConnected())
-                        return true;
-                }
-                return false;
-            });
+            best = i;
+            bestDelay = delay;
         }
     }
-
-    log_info("TcpVCSendThread stopped");
+    return best;
 }
 
-void TcpVCSendThread::sendOnResendConn(std::shared_ptr<std::vector<char>> data,
-                                       const std::vector<TcpConnectionSp>& conns)
+bool TcpVCSendThread::sendControl(const std::vector<TcpConnectionSp>& conns,
+                                  const std::vector<std::shared_ptr<ConnSendStats>>& stats)
 {
-    if (conns.size() <= VC_FIRST_RESEND_CONN_INDEX)
+    std::chrono::steady_clock::time_point enqueuedAt;
+    while (pendingControl.size() < MAX_CONTROL_BATCH)
+    {
+        PacketBuffer frame = controlQueue->tryDequeue(enqueuedAt);
+        if (!frame)
+            break;
+        pendingControl.push_back({std::move(frame), enqueuedAt});
+    }
+
+    bool sent = false;
+    while (!pendingControl.empty())
     {
-        log_warnning("[RESEND] No resend connections available (connections.size()=" +
-                     std::to_string(conns.size()) + ")");
+        size_t slot = pickControlSlot(conns);
+        if (slot == numConns)
+            break; // held until a connection is usable
+        enqueuedAt = pendingControl.front().enqueuedAt;
+        commit(slot, pendingControl.front().frame, conns);
+        pendingControl.pop_front();
+        // Written straight away rather than with the iteration's other flushes.
+        if (!awaitingWritable[slot])
+            flushOutbound(slot, conns, stats);
+        auto delay = std::chrono::steady_clock::now() - enqueuedAt;
+        controlStats->record(std::chrono::duration_cast<std::chrono::microseconds>(delay).count());
+        sent = true;
+    }
+    return sent;
+}
+
+void TcpVCSendThread::updateCongestion(const std::vector<TcpConnectionSp>& conns,
+                                       std::chrono::steady_clock::time_point now)
+{
+    if (!congestion || now - lastCongestionSample < std::chrono::milliseconds(CONGESTION_SAMPLE_MS))
         return;
+    lastCongestionSample = now;
+
+    // The kernel's delivery-rate estimate is not in glibc's tcp_info, so delivery is
+    // counted here: whatever was written to a socket and is no longer held by it has
+    // been acknowledged.
+    VcCongestionController::Sample sample;
+    sample.now = now;
+    uint64_t srttSum = 0;
+    uint32_t srttCount = 0;
+    bool backlogged = false;
+    for (size_t i = 0; i < numDataConns; i++)
+    {
+        const auto &conn = conns[i];
+        if (!conn || !conn->isConnected())
+            continue;
+        auto info = conn->sampleRuntimeInfo();
+        if (!info.valid)
+            continue;
+#if defined(__APPLE__)
+        uint64_t held = info.bytesInFlight; // the whole send buffer; notSentBytes repeats it
+#else
+        uint64_t held = static_cast<uint64_t>(info.bytesInFlight) + info.notSentBytes;
+#endif
+        uint64_t delivered = slotWritten[i] > held ? slotWritten[i] - held : 0;
+        if (delivered > slotDelivered[i])
+        {
+            deliveredTotal += delivered - slotDelivered[i];
+            slotDelivered[i] = delivered;
+        }
+        if (info.smoothedRttUs == 0)
+            continue;
+        if (sample.minSrttUs == 0 || info.smoothedRttUs < sample.minSrttUs)
+            sample.minSrttUs = info.smoothedRttUs;
+        // Queueing delay is judged on the connections carrying data; an idle one's RTT
+        // is as old as its last send.
+        if (held > 0)
+        {
+            srttSum += info.smoothedRttUs;
+            srttCount++;
+        }
+        backlogged |= awaitingWritable[i] != 0;
     }
+    sample.deliveredBytes = deliveredTotal;
+    sample.avgSrttUs = srttCount ? static_cast<uint32_t>(srttSum / srttCount) : sample.minSrttUs;
+    sample.appLimited =
+        flowQueue.empty() && pendingData.empty() && rescuedData.empty() && !pacedSinceSample && !backlogged;
+    pacedSinceSample = false;
 
-    const VCDataPacket *packet = reinterpret_cast<const VCDataPacket *>(data->data());
-    uint64_t messageId = packet->header.messageId;
+    uint64_t rate = congestion->onSample(sample);
+    if (rate == congestionRate)
+        return;
+    congestionRate = rate;
+    RateLimit limit = pacingLimit;
+    if (rate != 0 && (limit.unlimited() || rate < limit.bytesPerSec))
+        limit = RateLimit{rate, 0};
+    pacer.setLimit(limit, now);
+}
 
-    const size_t resendCount = conns.size() - VC_FIRST_RESEND_CONN_INDEX;
+void TcpVCSendThread::run()
+{
+    log_info("TcpVCSendThread started");
 
-    int aliveCount = 0;
-    int nullCount = 0;
-    int disconnectedCount = 0;
-    int sendFailCount = 0;
+    // Reused dequeue batches. Normal sends are assigned at most MAX_SEND_BATCH per
+    // iteration so queued resends are never more than one batch behind.
+    std::vector<PacketBuffer> resendBatch;
+    resendBatch.reserve(MAX_RESEND_BATCH);
+    ingressFrames.reserve(INGRESS_BATCH);
+    ingressTags.reserve(INGRESS_BATCH);
+    ingressTimes.reserve(INGRESS_BATCH);
 
-    for (size_t attempt = 0; attempt < resendCount; attempt++)
+    // POLLOUT set for the slots whose outbound queue is waiting on a full socket.
+    std::vector<struct pollfd> pollfds;
+    std::vector<size_t> pollSlots;
+    pollfds.reserve(numConns);
+    pollSlots.reserve(numConns);
+
+    SharedConnectionTable::Reader tableReader(*connTable);
+
+    while (this->isRunning())
     {
-        size_t idx = VC_FIRST_RESEND_CONN_INDEX +
-                     (resendRoundRobin + attempt) % resendCount;
-        const auto &conn = conns[idx];
+        // Pin the current connection table for this iteration: connections and stats
+        // are read straight out of it, with no lock and no shared_ptr copies. A slot
+        // replaced meanwhile is picked up on the next iteration.
+        auto table = tableReader.pin();
+        const auto &conns = table->connections;
+        const auto &sendStats = table->sendStats;
 
-        if (!conn)
+        // Slot upkeep. A slot whose connection died or was replaced hands its queued
+        // frames back for reassignment; a slot that has made no write progress for
+        // PARTIAL_SEND_BUDGET_MS is stuck. Only a stuck slot with a frame partly in
+        // its TCP stream has to be disconnected — the framing is unrecoverable —
+        // otherwise its frames simply move to other slots.
+        auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < numConns; i++)
         {
-            nullCount++;
-            continue;
+            auto &out = outbound[i];
+            const TcpConnection *current = conns[i].get();
+            if (out.owner != current)
+            {
+                reclaimOutbound(i);
+                out.owner = current;
+                if (i < numDataConns)
+                {
+                    highestDataId[i] = 0;
+                    slotWritten[i] = 0;
+                    slotDelivered[i] = 0;
+                    unackedSince[i] = {};
+                    quarantinedSince[i] = {};
+                }
+            }
+            if (out.empty())
+                continue;
+            if (!current || !current->isConnected())
+            {
+                reclaimOutbound(i);
+                continue;
+            }
+            // A quarantined slot's frames were already re-sent; it keeps at most a
+            // partly written frame and gets QUARANTINE_MAX_MS to recover.
+            const bool quarantined =
+                i < numDataConns && quarantinedSince[i] != std::chrono::steady_clock::time_point{};
+            auto stalledMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - out.lastProgress()).count();
+            if (quarantined || stalledMs < PARTIAL_SEND_BUDGET_MS)
+                continue;
+
+            if (i < sendStats.size() && sendStats[i])
+                sendStats[i]->reenqueueCount.fetch_add(1, std::memory_order_relaxed);
+            log_warnning("Send stalled on conn " + std::to_string(i) + " for " +
+                         std::to_string(stalledMs) + "ms (msgId " +
+                         std::to_string(FrameMessageId(out.front())) + ", " +
+                         std::to_string(out.pendingBytes()) + " bytes queued" +
+                         (out.midFrame() ? "); disconnecting" : "); reassigning frames"));
+            // Whatever the socket already holds is stuck with it: re-send that too.
+            const bool dropConnection = out.midFrame();
+            if (i < numDataConns)
+                rescueStalled(i, conns, dropConnection);
+            if (dropConnection)
+                failConnection(i, conns);
+            else
+                reclaimOutbound(i);
         }
-        if (!conn->isConnected())
+
+        // Quarantine data slots that stopped getting ACKs, then report what changed to
+        // the scheduler (connection state, queue room, backlog, quarantine, failures, a
+        // new TCP_INFO sample) so select() is a lookup.
+        for (size_t i = 0; i < numDataConns; i++)
         {
-            disconnectedCount++;
-            continue;
+            checkStall(i, conns);
+            syncSlot(i, conns, sendStats);
         }
+        updateCongestion(conns, now);
 
-        // Skip connections in TCP exponential backoff — sending on them
-        // would waste a round-trip on a connection the kernel already
-        // considers congested.  Refresh runtime info first (the resend
-        // path doesn't go through rateConnection, so it may be stale).
-        refreshConnRuntimeInfo(idx, conns);
-        if (conn->getLastRuntimeInfo().isInExponentialBackoff)
-            continue;
-
-        aliveCount++;
+        // Control frames first: they are what loss recovery waits on.
+        bool progressed = controlQueue && sendControl(conns, sendStats);
 
-        ssize_t n = SendTcpDirect(conn->getSocketFd(), data->data(), data->size(), 0);
+        // Parity of the FEC groups that have waited long enough for more members.
+        if (fec)
+        {
+            fec->adapt(now);
+            fec->flushExpired(parityFrames, now);
+            queueParity();
+        }
 
-        if (n > 0)
+        // Then resend work, but batch-limit the dequeue to avoid
+        // starving normal sends when the resend queue is busy. anyResendAlive is
+        // reused by the idle wait below to decide whether pending resend work is
+        // actually drainable right now.
+        bool anyResendAlive = false;
+        if (resendQueue && !hasResendConns)
         {
-            size_t totalSent = static_cast<size_t>(n);
-            // Same budgeted completion as the normal send path: wait out transient
-            // backpressure instead of killing a healthy-but-busy resend connection.
-            auto partialStart = std::chrono::steady_clock::now();
-            while (totalSent < data->size())
+            resendBatch.clear();
+            resendQueue->tryDequeueMany(resendBatch, MAX_RESEND_BATCH);
+            if (!resendBatch.empty())
+                log_warnning("[RESEND] No resend connections available (connections.size()=" +
+                             std::to_string(numConns) + "), dropping " +
+                             std::to_string(resendBatch.size()) + " resend(s)");
+            resendBatch.clear();
+        }
+        else if (resendQueue)
+        {
+            // Quick check: are ANY resend connections alive? If none are,
+            // leave the queue alone while the watchdog reconnects.
+            for (size_t i = VC_FIRST_RESEND_CONN_INDEX; i < conns.size(); i++)
             {
-                if (!conn->isConnected() || !this->isRunning())
-                    break;
-                if (!IsSocketWritable(conn->getSocketFd(), PARTIAL_SEND_POLL_MS))
+                if (conns[i] && conns[i]->isConnected())
                 {
-                    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                         std::chrono::steady_clock::now() - partialStart)
-                                         .count();
-                    if (elapsedMs >= PARTIAL_SEND_BUDGET_MS)
-                        break;
-                    continue;
+                    anyResendAlive = true;
+                    break;
                 }
-                ssize_t r = SendTcpDirect(conn->getSocketFd(),
-                                          data->data() + totalSent,
-                                          data->size() - totalSent, 0);
-                if (r > 0)
+            }
+
+            if (anyResendAlive)
+            {
+                if (pendingResend.empty())
                 {
-                    totalSent += static_cast<size_t>(r);
+                    resendBatch.clear();
+                    resendQueue->tryDequeueMany(resendBatch, MAX_RESEND_BATCH);
+                    for (auto &resendData : resendBatch)
+                        pendingResend.push_back(std::move(resendData));
                 }
-                else if (r == SOCKET_ERROR_WOULD_BLOCK || r == SOCKET_ERROR_INTERRUPTED)
+                while (!pendingResend.empty())
                 {
-                    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                         std::chrono::steady_clock::now() - partialStart)
-                                         .count();
-                    if (elapsedMs >= PARTIAL_SEND_BUDGET_MS)
+                    PacketBuffer frame = std::move(pendingResend.front());
+                    pendingResend.pop_front();
+                    if (!assignResend(frame, conns))
+                    {
+                        pendingResend.push_front(std::move(frame));
                         break;
-                    continue;
+                    }
+                    progressed = true;
                 }
-                else
+                // FEC parity shares the resend connections, behind the resends.
+                while (pendingResend.empty() && !pendingParity.empty())
                 {
-                    break; // genuine connection error
+                    if (!assignResend(pendingParity.front(), conns))
+                        break;
+                    pendingParity.pop_front();
+                    progressed = true;
                 }
             }
 
-            if (totalSent < data->size())
+            // Prevent unbounded growth of the retry tracker map.
+            if (resendRetryCount.size() > MAX_RESEND_TRACKED)
             {
-                conn->disconnect();
-                if (disconnectCallback)
-                    disconnectCallback(conn);
-                log_warnning("[RESEND] Partial send on resend conn " + std::to_string(idx) +
-                             " for msgId=" + std::to_string(messageId) + "; disconnecting");
-                continue;
+                log_warnning("[RESEND] Retry tracker has " +
+                             std::to_string(resendRetryCount.size()) +
+                             " entries, clearing stale entries");
+                resendRetryCount.clear();
             }
+        }
 
-            resendRoundRobin = (resendRoundRobin + 1) % resendCount;
-            resendRetryCount.erase(messageId);
-            log_info("[RESEND] Sent resend msgId=" + std::to_string(messageId) +
-                     " on conn " + std::to_string(idx));
-            return;
+        // Everything the producers queued goes into the flow queue, which decides the
+        // send order and drops frames that have queued too long.
+        for (;;)
+        {
+            ingressFrames.clear();
+            ingressTags.clear();
+            ingressTimes.clear();
+            size_t n = sendQueue->tryDequeueMany(ingressFrames, ingressTags, ingressTimes, INGRESS_BATCH);
+            for (size_t k = 0; k < n; k++)
+                flowQueue.push(std::move(ingressFrames[k]), ingressTags[k], ingressTimes[k]);
+            if (n < INGRESS_BATCH)
+                break;
         }
-        else
+
+        // Up to MAX_SEND_BATCH normal frames per iteration: frames reclaimed from a
+        // dropped or stalled slot, those left unassigned last time, then the flow queue.
+        // Reclaimed frames skip the pacer, which charged them already. A run of frames
+        // stays on the slot picked for its first frame until that slot's gather limit,
+        // so the flush below writes the run with one syscall.
+        size_t burstSlot = ConnectionScheduler::NONE;
+        size_t burstBytes = 0;
+        TokenBucket::Clock::duration pacingWait{};
+        for (size_t n = 0; n < MAX_SEND_BATCH; n++)
         {
-            sendFailCount++;
-            log_debug("[RESEND] SendTcpDirect failed on conn " + std::to_string(idx) +
-                      " for msgId=" + std::to_string(messageId) +
-                      " rc=" + std::to_string(n));
-            // A genuine error means this resend connection is dead — reap it so the
-            // watchdog reconnects the slot. WOULD_BLOCK is left alone (transient).
-            if (n == SOCKET_ERROR_CLOSED)
+            PacketBuffer dataVec;
+            const bool rescued = !rescuedData.empty();
+            if (rescued)
+            {
+                dataVec = std::move(rescuedData.front());
+                rescuedData.pop_front();
+            }
+            else if (!pendingData.empty())
+            {
+                dataVec = std::move(pendingData.front());
+                pendingData.pop_front();
+            }
+            else if (!flowQueue.empty())
             {
-                conn->disconnect();
-                if (disconnectCallback)
-                    disconnectCallback(conn);
+                dataVec = flowQueue.pop();
+                if (dataVec && frameStamper)
+                    frameStamper(dataVec);
             }
+            if (!dataVec)
+                break;
+
+            if (burstSlot == ConnectionScheduler::NONE || outbound[burstSlot].full() ||
+                burstBytes + dataVec.size() > ConnOutbound::MAX_GATHER_BYTES)
+            {
+                burstSlot = scheduler->select(dataVec.size());
+                burstBytes = 0;
+            }
+            if (burstSlot == ConnectionScheduler::NONE)
+            {
+                // Retained, not re-enqueued.
+                (rescued ? rescuedData : pendingData).push_front(std::move(dataVec));
+                break;
+            }
+            if (!rescued && !pacer.tryConsume(dataVec.size()))
+            {
+                pacingWait = pacer.timeUntil(dataVec.size());
+                pacedSinceSample = true;
+                pendingData.push_front(std::move(dataVec));
+                break;
+            }
+            burstBytes += dataVec.size();
+            if (fec && IsDataFrame(dataVec))
+                fec->add(dataVec, burstSlot, parityFrames, now);
+            commit(burstSlot, dataVec, conns);
+            progressed = true;
         }
-    }
+        if (fec)
+            queueParity();
 
-    resendRoundRobin = (resendRoundRobin + 1) % resendCount;
+        // Write everything just assigned, plus slots whose socket reported POLLOUT
+        // since they last blocked.
+        for (size_t i = 0; i < numConns; i++)
+        {
+            if (!outbound[i].empty() && !awaitingWritable[i])
+                progressed |= flushOutbound(i, conns, sendStats);
+        }
 
-    // Only count a retry when at least one connection was alive but the send
-    // still failed. When ALL connections are down, re-enqueue without burning
-    // a retry — the watchdog needs time (~500ms) to reconnect slots.
-    uint8_t retryCount = resendRetryCount[messageId];
-    bool countThisRetry = (aliveCount > 0);
+        if (!this->isRunning())
+            break;
+        if (progressed)
+            continue;
 
-    if ((!countThisRetry || retryCount < MAX_RESEND_RETRIES) && resendQueue)
-    {
-        if (countThisRetry)
-            resendRetryCount[messageId] = retryCount + 1;
-        resendQueue->enqueue(data);
-        log_debug("[RESEND] Re-enqueued msgId=" + std::to_string(messageId) +
-                  " retry=" + std::to_string(countThisRetry ? retryCount + 1 : retryCount) +
-                  " (alive=" + std::to_string(aliveCount) +
-                  " null=" + std::to_string(nullCount) +
-                  " disconn=" + std::to_string(disconnectedCount) +
-                  " sendFail=" + std::to_string(sendFailCount) + ")");
-    }
-    else
-    {
-        resendRetryCount.erase(messageId);
-        log_warnning("[RESEND] All resend connections failed for msgId=" +
-                     std::to_string(messageId) + " after " +
-                     std::to_string(retryCount) + " retries, dropping" +
-                     " (alive=" + std::to_string(aliveCount) +
-                     " null=" + std::to_string(nullCount) +
-                     " disconn=" + std::to_string(disconnectedCount) +
-                     " sendFail=" + std::to_string(sendFailCount) + ")");
+        // Nothing moved. If some slots are backlogged, wait for any of them to become
+        // writable (POLLERR/POLLHUP also wake us; the next flush surfaces the error).
+        pollfds.clear();
+        pollSlots.clear();
+        for (size_t i = 0; i < numConns; i++)
+        {
+            if (outbound[i].empty() || !awaitingWritable[i])
+                continue;
+            struct pollfd pfd{};
+            pfd.fd = conns[i]->getSocketFd();
+            pfd.events = POLLOUT;
+            pollfds.push_back(pfd);
+            pollSlots.push_back(i);
+        }
+        table.reset();
+        if (!pollfds.empty())
+        {
+            if (SocketPollMany(pollfds.data(), pollfds.size(), OUTBOUND_POLL_MS) > 0)
+            {
+                for (size_t k = 0; k < pollfds.size(); k++)
+                {
+                    if (pollfds[k].revents != 0)
+                        awaitingWritable[pollSlots[k]] = 0;
+                }
+            }
+            continue;
+        }
+
+        // Resend work only wakes the thread when a resend connection is alive to drain
+        // it; see the idle wait below.
+        const bool resendDrainable = anyResendAlive && resendQueue && pendingResend.empty();
+        // The oldest open FEC group is due for its parity by then.
+        auto fecWait = std::chrono::steady_clock::duration::max();
+        if (fec && fec->nextDeadline() != std::chrono::steady_clock::time_point::max())
+            fecWait = std::max<std::chrono::steady_clock::duration>(
+                fec->nextDeadline() - std::chrono::steady_clock::now(), std::chrono::microseconds(100));
+
+        if (pacingWait > TokenBucket::Clock::duration::zero())
+        {
+            // Data waits for pacing tokens. Sleep until they accrue, but wake early for
+            // control frames and resends, which are not paced, and for FEC parity.
+            writeStats->pacingPauses.fetch_add(1, std::memory_order_relaxed);
+            writeStats->pacingWaitUs.fetch_add(
+                std::chrono::duration_cast<std::chrono::microseconds>(pacingWait).count(), std::memory_order_relaxed);
+            std::unique_lock<std::mutex> lock(waker->mtx);
+            if (resendDrainable)
+                resendQueue->park();
+            if (controlQueue)
+                controlQueue->park();
+            waker->cv.wait_for(lock, std::min<std::chrono::steady_clock::duration>(pacingWait, fecWait), [&] {
+                return !this->isRunning() ||
+                       (resendDrainable && resendQueue->approxSize() > 0) ||
+                       (controlQueue && controlQueue->approxSize() > 0);
+            });
+            if (resendDrainable)
+                resendQueue->unpark();
+            if (controlQueue)
+                controlQueue->unpark();
+            continue;
+        }
+
+        if (!pendingData.empty() || !rescuedData.empty() || !pendingControl.empty())
+        {
+            // No slot could take the frame and none is merely backlogged, so no data
+            // connection is usable. Block until the watchdog reconnects a slot
+            // (signalled via connAvailableCv) or a connection comes back. This avoids
+            // burning CPU while no connections are available yet wakes instantly when
+            // one becomes usable.
+            const uint64_t replacementsSeen = connReplacements.load(std::memory_order_acquire);
+            std::unique_lock<std::mutex> lock(connAvailableMutex);
+            connAvailableCv.wait_for(lock, std::chrono::milliseconds(50), [&] {
+                if (!this->isRunning() || connReplacements.load(std::memory_order_acquire) != replacementsSeen)
+                    return true;
+                auto current = tableReader.pin();
+                for (size_t i = 0; i < numDataConns; i++)
+                {
+                    const auto &conn = current->connections[i];
+                    if (conn && conn->isConnected())
+                        return true;
+                }
+                return false;
+            });
+            continue;
+        }
+
+        // No normal-send work right now. Block until there is work or shutdown.
+        // Parking on the queues makes the next enqueue call the notifier, which
+        // wakes us instantly, so send/resend latency is unchanged in the common
+        // case; IDLE_WAIT_MS is only a backstop. Parking before the predicate is
+        // evaluated closes the window against an enqueue racing with the wait. This
+        // replaces the old 5ms busy-poll that woke the thread ~200x/sec per
+        // channel even when fully idle.
+        //
+        // Resend work only counts as wakeable when a resend connection is alive
+        // to drain it. Otherwise (the watchdog-reconnect window) pending resend
+        // items would keep the predicate true and spin the CPU; instead we fall
+        // back to the IDLE_WAIT_MS backstop and re-check liveness next iteration.
+        // Also wake when the oldest open FEC group is due for its parity.
+        const auto idleWait =
+            std::min<std::chrono::steady_clock::duration>(std::chrono::milliseconds(IDLE_WAIT_MS), fecWait);
+        std::unique_lock<std::mutex> lock(waker->mtx);
+        sendQueue->park();
+        if (resendDrainable)
+            resendQueue->park();
+        if (controlQueue)
+            controlQueue->park();
+        waker->cv.wait_for(lock, idleWait, [&] {
+            return !this->isRunning() ||
+                   sendQueue->approxSize() > 0 ||
+                   (resendDrainable && resendQueue->approxSize() > 0) ||
+                   (controlQueue && controlQueue->approxSize() > 0);
+        });
+        sendQueue->unpark();
+        if (resendDrainable)
+            resendQueue->unpark();
+        if (controlQueue)
+            controlQueue->unpark();
     }
+
+    log_info("TcpVCSendThread stopped");
 }
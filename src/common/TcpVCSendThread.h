@@ -1,67 +1,219 @@
 #pragma once
 
-#include "BlockingQueue.h"
+#include "AckTracker.h"
+#include "ConnOutbound.h"
+#include "ConnectionScheduler.h"
+#include "ConnectionTable.h"
+#include "FecEncoder.h"
+#include "FlowQueue.h"
+#include "MpscQueue.h"
 #include "StopableThread.h"
 #include "TcpConnection.h"
 #include "TcpVCWriteThread.h"
+#include "TokenBucket.h"
+#include "VcCongestionController.h"
 #include "VcProtocol.h"
 #include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+/// Write-syscall counters for one VC's send thread. Frames per write shows how well
+/// ConnOutbound::flush() is coalescing.
+struct SendWriteStats
+{
+    std::atomic<uint64_t> writeCalls{0};
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> bytes{0};
+    // Stalled data connections quarantined, and the frames re-sent off them.
+    std::atomic<uint64_t> stallRescues{0};
+    std::atomic<uint64_t> rescuedFrames{0};
+    // Egress pacing: times data sending paused for tokens, and the total pause.
+    std::atomic<uint64_t> pacingPauses{0};
+    std::atomic<uint64_t> pacingWaitUs{0};
+
+    /// One-line summary suitable for log output.
+    std::string format() const;
+};
+
+/// Control-lane counters: frames sent and their delay from enqueue until written to
+/// a socket.
+struct ControlLaneStats
+{
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> totalDelayUs{0};
+    std::atomic<uint64_t> maxDelayUs{0};
+
+    void record(uint64_t delayUs);
+    /// One-line summary suitable for log output.
+    std::string format() const;
+};
+
 class TcpVCSendThread : public StopableThread
 {
   public:
-    TcpVCSendThread(std::vector<TcpConnectionSp> connections,
-                    BlockingQueueSp sendQueue,
-                    BlockingQueueSp resendQueue,
-                    std::vector<std::shared_ptr<ConnSendStats>> connSendStats,
+    TcpVCSendThread(SharedConnectionTableSp connTable,
+                    MpscQueueSp sendQueue,
+                    MpscQueueSp resendQueue,
+                    MpscQueueSp controlQueue,
                     std::shared_ptr<MessageTracker> messageTracker,
-                    std::vector<std::shared_ptr<SocketStatus>> socketStatuses,
+                    std::shared_ptr<SendWriteStats> writeStats,
+                    std::shared_ptr<ControlLaneStats> controlStats,
+                    std::shared_ptr<FlowQueueStats> flowStats,
+                    SchedulerPolicy schedulerPolicy = SchedulerPolicy::EarliestDelivery,
                     std::function<void(TcpConnectionSp)> disconnectCallback = nullptr);
 
     virtual ~TcpVCSendThread();
 
-    // Hot-swap the connection at the given slot. The send thread picks it up
-    // on the next packet (it re-snapshots connections under the mutex per send).
-    void replaceConnection(int slot, TcpConnectionSp conn,
-                           std::shared_ptr<ConnSendStats> stats,
-                           std::shared_ptr<SocketStatus> status);
+    // Called after a new connection has been published in the connection table. The
+    // send thread pins the table per packet, so it already sees the new slot; this
+    // only wakes it if it is waiting for any connection to come back.
+    void onConnectionReplaced(int slot);
 
     void setRunning(bool running) override;
 
+    /// Where stall rescue finds the frames already written to a stalled connection
+    /// (the VC's SentDataCache). Set before start(); without it only frames not yet
+    /// written are moved off the connection.
+    void setFrameSource(std::function<PacketBuffer(uint64_t messageId)> source)
+    {
+        frameSource = std::move(source);
+    }
+
+    /// Where data frames are recorded once written to their socket, for the
+    /// retransmission timers. Set before start().
+    void setAckTracker(std::shared_ptr<AckTracker> tracker)
+    {
+        ackTracker = std::move(tracker);
+    }
+
+    /// Gives a data frame taken from the flow queue its message id (and anything keyed
+    /// by it, such as the sent-data cache entry). Ids are assigned in send order, after
+    /// fair queueing, so the peer's reorder window never waits on a frame still queued
+    /// here. Set before start(); without it frames are sent as enqueued.
+    void setFrameStamper(std::function<void(PacketBuffer &frame)> stamper)
+    {
+        frameStamper = std::move(stamper);
+    }
+
+    /// Pace data frames to `limit` (control frames and resends are not paced). Set
+    /// before start(); unlimited by default. With congestion control on, data is paced
+    /// at the lower of this and the controller's rate.
+    void setPacing(const RateLimit &limit)
+    {
+        pacingLimit = limit;
+        pacer = TokenBucket(limit);
+    }
+
+    /// Run a VcCongestionController over the data connections, aiming for `target`
+    /// queueing delay, and publish its state to `stats`. Set before start(); off by
+    /// default.
+    void setCongestionControl(std::chrono::microseconds target, std::shared_ptr<CongestionControlStats> stats)
+    {
+        congestion = std::make_unique<VcCongestionController>(target, std::move(stats));
+    }
+
+    /// Send FEC parity for the data frames (see FecEncoder), on the resend connections
+    /// and unpaced like resends, and publish its counters to `stats`. Set before
+    /// start(); off by default, and unavailable without resend connections.
+    void setFec(const FecConfig &config, std::shared_ptr<FecStats> stats);
+
+    /// CoDel target and interval for the flow queue. Set before start().
+    void setCoDel(std::chrono::microseconds target, std::chrono::microseconds interval)
+    {
+        flowQueue.setCoDel(target, interval);
+    }
+
   protected:
     virtual void run() override;
 
   private:
     void refreshConnRuntimeInfo(size_t connIndex, const std::vector<TcpConnectionSp>& conns);
-    int rateConnection(size_t connIndex,
+
+    bool isResendSlot(size_t connIndex) const
+    {
+        return hasResendConns && connIndex >= static_cast<size_t>(VC_FIRST_RESEND_CONN_INDEX);
+    }
+    // Bring the scheduler's view of data slot `connIndex` up to date.
+    void syncSlot(size_t connIndex,
+                  const std::vector<TcpConnectionSp>& conns,
+                  const std::vector<std::shared_ptr<ConnSendStats>>& stats);
+    // Commit a resend frame to a resend slot. False when no suitable slot has room.
+    bool assignResend(PacketBuffer &frame, const std::vector<TcpConnectionSp>& conns);
+    // Slot whose socket would put a control frame on the wire soonest, or numConns.
+    size_t pickControlSlot(const std::vector<TcpConnectionSp>& conns) const;
+    // Send queued control frames ahead of everything else. True if any was sent.
+    bool sendControl(const std::vector<TcpConnectionSp>& conns,
+                     const std::vector<std::shared_ptr<ConnSendStats>>& stats);
+    // Queue a frame on a slot; it is written by the next flushOutbound() of that slot.
+    void commit(size_t connIndex, PacketBuffer &frame, const std::vector<TcpConnectionSp>& conns);
+    // Non-blocking write of a slot's outbound queue. Returns true if any frame completed.
+    bool flushOutbound(size_t connIndex,
                        const std::vector<TcpConnectionSp>& conns,
                        const std::vector<std::shared_ptr<ConnSendStats>>& stats);
-    void sendOnResendConn(std::shared_ptr<std::vector<char>> data,
-                          const std::vector<TcpConnectionSp>& conns);
+    // Take every frame queued on a slot back for reassignment to other slots.
+    void reclaimOutbound(size_t connIndex);
+    // Drop the connection on slot `connIndex` and reclaim its frames.
+    void failConnection(size_t connIndex, const std::vector<TcpConnectionSp>& conns);
+    // Quarantine a data slot whose connection stopped getting ACKs, and lift the
+    // quarantine once it does again.
+    void checkStall(size_t connIndex, const std::vector<TcpConnectionSp>& conns);
+    // Re-send on other slots what a stalled data slot still holds: the frames sitting
+    // unacknowledged in its socket (found via messageTracker) and those not yet written.
+    // With `dropConnection` the caller fails the slot next, so its ring is emptied.
+    void rescueStalled(size_t connIndex, const std::vector<TcpConnectionSp>& conns, bool dropConnection);
+    // Feed the congestion controller a sample every CONGESTION_SAMPLE_MS and re-pace.
+    void updateCongestion(const std::vector<TcpConnectionSp>& conns, std::chrono::steady_clock::time_point now);
+    // Queue the parity frames the FEC encoder produced for the resend connections.
+    void queueParity();
 
     static constexpr int TCP_RUNTIME_REFRESH_MS = 250;
     static constexpr int MAX_RESEND_RETRIES = 6;
     static constexpr size_t MAX_RESEND_BATCH = 8;
+    static constexpr size_t MAX_CONTROL_BATCH = 16;
+    // Normal sends taken off the queue and assigned per iteration. Consecutive frames
+    // of a batch stay on one slot (up to ConnOutbound::MAX_GATHER_BYTES) so they go out
+    // in one gathered write. Kept small so a resend waits at most one batch.
+    static constexpr size_t MAX_SEND_BATCH = 32;
+    // Frames moved from sendQueue into the flow queue per dequeue call; the thread
+    // drains the whole queue each iteration so every waiting flow gets its turn.
+    static constexpr size_t INGRESS_BATCH = 256;
     static constexpr size_t MAX_RESEND_TRACKED = 2000;
-    // Idle backstop: with the queue enqueue-notifier wiring, the thread is woken
-    // immediately on new send/resend work, so this timeout is only a lost-wakeup
-    // safety net (and lets the loop re-check isRunning() periodically).
+    // Parity frames waiting for a resend connection. Past this the lane is backed up
+    // and parity would arrive too late to spare a resend, so the oldest is dropped.
+    static constexpr size_t MAX_PENDING_PARITY = 64;
+    // Idle backstop: the thread parks on both queues before waiting, so the next
+    // enqueue wakes it immediately; this timeout is only a lost-wakeup safety net
+    // (and lets the loop re-check isRunning() periodically).
     static constexpr int IDLE_WAIT_MS = 100;
 
-    // Partial-send completion: once any bytes of a packet are written to a
-    // connection, the rest MUST be flushed on the same connection (the receiver
-    // expects contiguous protocol bytes). A full kernel send buffer under load is
-    // normal backpressure, not a dead socket, so we wait for writability up to a
-    // total budget before declaring the connection genuinely stuck. The old code
-    // gave up after a single 10ms poll and disconnected, which tore down healthy
-    // but busy connections as traffic grew — driving a reconnect/resend storm.
+    // Each slot owns a small outbound queue. A full kernel send buffer under load is
+    // normal backpressure, not a dead socket: the slot's frames wait there (the thread
+    // polls it for POLLOUT) while the other slots keep sending. Only a slot that makes
+    // no write progress for PARTIAL_SEND_BUDGET_MS is treated as stuck: if a frame is
+    // already partly in its TCP stream the connection is dropped (the framing is
+    // unrecoverable), otherwise its frames are just moved to other slots.
+    static constexpr size_t OUTBOUND_FRAMES_PER_CONN = MAX_SEND_BATCH;
     static constexpr int PARTIAL_SEND_BUDGET_MS = 3000;
-    static constexpr int PARTIAL_SEND_POLL_MS = 20;
+    // Poll timeout while some slot waits for POLLOUT. New queue work arriving during
+    // the poll is picked up within this bound.
+    static constexpr int OUTBOUND_POLL_MS = 2;
+
+    // A data connection is stalled when it has had unacknowledged data and no ACK for
+    // two RTOs (at least STALL_MIN_MS), or is in repeated RTO backoff. Its frames are
+    // re-sent elsewhere right away instead of waiting for the peer's MISSING_NOTIFY
+    // or reorder timeout, and the slot takes no new frames until ACKs resume; after
+    // QUARANTINE_MAX_MS it is dropped for the watchdog to reconnect.
+    static constexpr uint32_t STALL_MIN_MS = 300;
+    static constexpr int QUARANTINE_MAX_MS = 30000;
+    // Rescue budget when TCP_INFO cannot say how much the socket still holds.
+    static constexpr uint64_t RESCUE_FALLBACK_BYTES = 256 * 1024;
+    // Congestion controller sampling period: the TCP_INFO refresh rate.
+    static constexpr int CONGESTION_SAMPLE_MS = TCP_RUNTIME_REFRESH_MS;
 
     // Shared wake primitive for the idle wait. Held by both this thread and the
     // queues' enqueue notifiers via shared_ptr, so a queue can safely wake the
@@ -74,18 +226,73 @@ class TcpVCSendThread : public StopableThread
     std::shared_ptr<Waker> waker;
 
     std::function<void(TcpConnectionSp)> disconnectCallback;
-    std::mutex connectionsMutex;
+    std::mutex connAvailableMutex;
     std::condition_variable connAvailableCv;
-    std::vector<TcpConnectionSp> connections;
-    BlockingQueueSp sendQueue;
-    BlockingQueueSp resendQueue;
-    std::vector<std::shared_ptr<ConnSendStats>> connSendStats;
+    std::atomic<uint64_t> connReplacements{0}; // bumped by onConnectionReplaced()
+    SharedConnectionTableSp connTable;
+    size_t numConns = 0; // fixed for the channel's lifetime
+    // Data frames from the producers, tagged with FlowQueue::tagOf() and stamped with
+    // their enqueue time. They wait in flowQueue, not here, so the send order and the
+    // delay-based drops are decided there.
+    MpscQueueSp sendQueue;
+    MpscQueueSp resendQueue;
+    // Strict priority: MISSING_NOTIFY and other control frames, drained before resends
+    // and data and sent on the connection that will put them on the wire first.
+    MpscQueueSp controlQueue;
     std::shared_ptr<MessageTracker> messageTracker;
-    std::vector<std::shared_ptr<SocketStatus>> socketStatuses;
+    std::shared_ptr<SendWriteStats> writeStats;
+    std::shared_ptr<ControlLaneStats> controlStats;
     std::vector<std::chrono::steady_clock::time_point> lastRuntimeRefresh;
-    size_t roundRobinStart{0};
     size_t resendRoundRobin{0};
     std::unordered_map<uint64_t, uint8_t> resendRetryCount;
+
+    // Send-thread-only state, one entry per slot.
+    bool hasResendConns = false;
+    size_t numDataConns = 0;
+    std::unique_ptr<ConnectionScheduler> scheduler; // picks data slots
+    std::vector<SlotMetrics> slotMetrics;           // last state reported to it, per data slot
+    std::vector<ConnOutbound> outbound;
+    std::vector<char> awaitingWritable; // last flush hit WOULD_BLOCK; skip until POLLOUT
+    // Stall rescue, per data slot.
+    std::function<PacketBuffer(uint64_t)> frameSource;
+    std::shared_ptr<AckTracker> ackTracker;
+    std::vector<uint64_t> highestDataId;  // newest data frame written to the slot
+    std::vector<std::chrono::steady_clock::time_point> unackedSince; // {} while all acked
+    std::vector<std::chrono::steady_clock::time_point> quarantinedSince; // {} when not
+    FlowQueue flowQueue;
+    RateLimit pacingLimit; // configured cap
+    TokenBucket pacer;     // at the lower of pacingLimit and the controller's rate
+    // Congestion control. Delivered bytes are estimated per data slot as the bytes
+    // written to its socket minus those the socket still holds.
+    std::unique_ptr<VcCongestionController> congestion;
+    std::vector<uint64_t> slotWritten;
+    std::vector<uint64_t> slotDelivered;
+    uint64_t deliveredTotal = 0;
+    uint64_t congestionRate = 0; // last rate applied to the pacer, 0: unpaced
+    bool pacedSinceSample = false;
+    std::chrono::steady_clock::time_point lastCongestionSample{};
+    std::function<void(PacketBuffer &)> frameStamper;
+    // FEC: parity groups over the stamped data frames, sent after queued resends.
+    std::unique_ptr<FecEncoder> fec;
+    std::shared_ptr<FecStats> fecStats;
+    std::vector<PacketBuffer> parityFrames; // scratch for the encoder's output
+    std::deque<PacketBuffer> pendingParity;
+    std::vector<PacketBuffer> ingressFrames; // scratch for draining sendQueue
+    std::vector<uint64_t> ingressTags;
+    std::vector<std::chrono::steady_clock::time_point> ingressTimes;
+    std::vector<PacketBuffer> completedFrames; // scratch for flushOutbound()
+    std::vector<PacketBuffer> reclaimedFrames; // scratch for reclaimOutbound()
+    // Frames waiting for a slot: reclaimed from a dropped or stalled slot (already
+    // paced once), or not yet assignable.
+    std::deque<PacketBuffer> rescuedData;
+    std::deque<PacketBuffer> pendingData;
+    std::deque<PacketBuffer> pendingResend;
+    struct PendingControl
+    {
+        PacketBuffer frame;
+        std::chrono::steady_clock::time_point enqueuedAt;
+    };
+    std::deque<PendingControl> pendingControl;
 };
 
 typedef std::shared_ptr<TcpVCSendThread> TcpVCSendThreadSp;
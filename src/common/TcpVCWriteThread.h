@@ -5,8 +5,7 @@
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
-#include <mutex>
-#include <unordered_map>
+#include <memory>
 #include <vector>
 
 struct ConnSendStats
@@ -19,51 +18,121 @@ struct ConnSendStats
     std::atomic<bool> valid{false};
 };
 
+/// Records which connection (and when) each data message was sent on, so a resend
+/// request or MISSING_NOTIFY can blame the right connection.
+///
+/// A fixed power-of-two ring of 64-bit records indexed by messageId, sized to the
+/// resend horizon (the SentDataCache capacity). Each record packs
+///   [ tag : 28 | conn + 1 : 8 | send time ms : 28 ]
+/// where the tag is the messageId bits above the ring index, so a lookup can tell a
+/// record for `messageId` from one left by an earlier lap. Recording is a single
+/// relaxed store from the send thread and lookups are a single load from any
+/// thread; memory stays constant for the life of the VC.
 class MessageTracker
 {
-    struct Shard
+  public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    struct Record
     {
-        std::mutex mutex;
-        std::unordered_map<uint64_t, int> messageToConn;
+        int connectionIndex{-1};
+        int64_t sendTimeMs{0}; // steady_clock ms, same base as ConnSendStats::lastTxTimeMs
     };
 
-  public:
-    MessageTracker() = default;
-    explicit MessageTracker(size_t numShards) : shards(numShards) {}
+    MessageTracker() : MessageTracker(DEFAULT_CAPACITY) {}
+    explicit MessageTracker(size_t capacity)
+    {
+        size_t slotCount = 2;
+        while (slotCount < capacity)
+            slotCount <<= 1;
+        records = std::make_unique<std::atomic<uint64_t>[]>(slotCount);
+        mask = slotCount - 1;
+        indexBits = 0;
+        while ((size_t{1} << indexBits) < slotCount)
+            indexBits++;
+        for (size_t i = 0; i < slotCount; i++)
+            records[i].store(0, std::memory_order_relaxed);
+    }
+
+    void recordMessage(uint64_t messageId, int connectionIndex, int64_t sendTimeMs)
+    {
+        if (connectionIndex < 0 || connectionIndex >= CONN_NONE)
+            return;
+        uint64_t packed = (tagOf(messageId) << (CONN_BITS + TIME_BITS)) |
+                          (static_cast<uint64_t>(connectionIndex + 1) << TIME_BITS) |
+                          (static_cast<uint64_t>(sendTimeMs) & TIME_MASK);
+        records[messageId & mask].store(packed, std::memory_order_relaxed);
+    }
 
     void recordMessage(uint64_t messageId, int connectionIndex)
     {
-        size_t idx = messageId % shards.size();
-        std::lock_guard<std::mutex> lock(shards[idx].mutex);
-        shards[idx].messageToConn[messageId] = connectionIndex;
+        recordMessage(messageId, connectionIndex, nowMs());
+    }
+
+    /// False if `messageId` was never recorded or its record has been overwritten by a
+    /// later lap of the ring.
+    bool lookup(uint64_t messageId, Record &out) const
+    {
+        uint64_t packed = records[messageId & mask].load(std::memory_order_relaxed);
+        uint64_t conn = (packed >> TIME_BITS) & CONN_MASK;
+        if (conn == 0 || (packed >> (CONN_BITS + TIME_BITS)) != tagOf(messageId))
+            return false;
+        out.connectionIndex = static_cast<int>(conn - 1);
+        // Only the low TIME_BITS of the send time are stored; rebuild it relative to now.
+        int64_t now = nowMs();
+        out.sendTimeMs = now - static_cast<int64_t>((static_cast<uint64_t>(now) - packed) & TIME_MASK);
+        return true;
     }
 
-    int getConnectionIndex(uint64_t messageId)
+    int getConnectionIndex(uint64_t messageId) const
     {
-        size_t idx = messageId % shards.size();
-        std::lock_guard<std::mutex> lock(shards[idx].mutex);
-        auto it = shards[idx].messageToConn.find(messageId);
-        return it != shards[idx].messageToConn.end() ? it->second : -1;
+        Record rec;
+        return lookup(messageId, rec) ? rec.connectionIndex : -1;
     }
 
     void removeMessage(uint64_t messageId)
     {
-        size_t idx = messageId % shards.size();
-        std::lock_guard<std::mutex> lock(shards[idx].mutex);
-        shards[idx].messageToConn.erase(messageId);
+        auto &slot = records[messageId & mask];
+        uint64_t packed = slot.load(std::memory_order_relaxed);
+        if ((packed >> (CONN_BITS + TIME_BITS)) == tagOf(messageId))
+            slot.compare_exchange_strong(packed, 0, std::memory_order_relaxed);
     }
 
     void clear()
     {
-        for (auto &shard : shards)
-        {
-            std::lock_guard<std::mutex> lock(shard.mutex);
-            shard.messageToConn.clear();
-        }
+        for (size_t i = 0; i <= mask; i++)
+            records[i].store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const
+    {
+        return mask + 1;
     }
 
   private:
-    std::vector<Shard> shards;
+    static constexpr unsigned TIME_BITS = 28; // ~74 h of milliseconds
+    static constexpr unsigned CONN_BITS = 8;
+    static constexpr unsigned TAG_BITS = 64 - CONN_BITS - TIME_BITS;
+    static constexpr uint64_t TIME_MASK = (uint64_t{1} << TIME_BITS) - 1;
+    static constexpr uint64_t CONN_MASK = (uint64_t{1} << CONN_BITS) - 1;
+    static constexpr uint64_t TAG_MASK = (uint64_t{1} << TAG_BITS) - 1;
+    static constexpr int CONN_NONE = static_cast<int>(CONN_MASK);
+
+    static int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    uint64_t tagOf(uint64_t messageId) const
+    {
+        return (messageId >> indexBits) & TAG_MASK;
+    }
+
+    std::unique_ptr<std::atomic<uint64_t>[]> records;
+    size_t mask = 0;
+    unsigned indexBits = 0;
 };
 
 struct SocketStatus
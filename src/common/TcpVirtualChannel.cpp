@@ -6,42 +6,15 @@
 #include <chrono>
 #include <cstring>
 #include <format>
+#include <iterator>
 #include <string>
 
 static constexpr auto RECEIVE_CALLBACK_SLOW_WARN_MS = std::chrono::milliseconds(50);
-
-void SentDataCache::insert(uint64_t messageId, std::shared_ptr<std::vector<char>> data)
-{
-    size_t idx = messageId % shards.size();
-    auto &shard = shards[idx];
-    std::lock_guard<std::mutex> lock(shard.mutex);
-    shard.items[messageId] = std::move(data);
-    shard.insertionOrder.push_back(messageId);
-    if (shard.insertionOrder.size() > capacityPerConn)
-    {
-        uint64_t oldest = shard.insertionOrder.front();
-        shard.insertionOrder.pop_front(); // O(1) with deque
-        shard.items.erase(oldest);
-    }
-}
-
-std::shared_ptr<std::vector<char>> SentDataCache::find(uint64_t messageId)
-{
-    size_t idx = messageId % shards.size();
-    std::lock_guard<std::mutex> lock(shards[idx].mutex);
-    auto it = shards[idx].items.find(messageId);
-    return it != shards[idx].items.end() ? it->second : nullptr;
-}
-
-void SentDataCache::clear()
-{
-    for (auto &shard : shards)
-    {
-        std::lock_guard<std::mutex> lock(shard.mutex);
-        shard.items.clear();
-        shard.insertionOrder.clear();
-    }
-}
+static constexpr int SENT_CACHE_RTT_MULTIPLIER = 4;
+// As often as getNetworkScore() re-samples TCP_INFO.
+static constexpr auto PATH_REFRESH_INTERVAL = std::chrono::milliseconds(500);
+// A full connection receive queue, so one bulk dequeue empties it.
+static constexpr size_t RECEIVE_DRAIN_BATCH = 1024;
 
 void TcpVirtualChannel::open()
 {
@@ -88,6 +61,10 @@ void TcpVirtualChannel::open()
                 self->resendQueue->cancelWait();
             }
 
+            if (self->controlQueue) {
+                self->controlQueue->cancelWait();
+            }
+
             if (self->ioThread) {
                 self->ioThread->setRunning(false);
             }
@@ -115,7 +92,7 @@ void TcpVirtualChannel::open()
     connReceiveQueues.clear();
     for (size_t i = 0; i < connections.size(); ++i)
     {
-        connReceiveQueues.push_back(std::make_unique<SpscQueue<DeliveryItem>>());
+        connReceiveQueues.push_back(std::make_unique<SpscQueue<TcpVCIoThread::DataFrame>>());
     }
 
     connSendStats.clear();
@@ -124,8 +101,11 @@ void TcpVirtualChannel::open()
         connSendStats.push_back(std::make_shared<ConnSendStats>());
     }
 
-    messageTracker = std::make_shared<MessageTracker>(connections.size());
-    sentDataCache = SentDataCache(connections.size(), 128);
+    // Track sends over the same horizon the cache can still resend from.
+    messageTracker = std::make_shared<MessageTracker>(sentDataCache.capacity());
+    ackTracker = std::make_shared<AckTracker>(sentDataCache.capacity(), ackStats);
+    framesSinceAck = 0;
+    ackDirty = false;
 
     socketStatuses.clear();
     for (size_t i = 0; i < connections.size(); ++i)
@@ -138,86 +118,102 @@ void TcpVirtualChannel::open()
     reorderRunning = true;
     reorderThread = std::thread(&TcpVirtualChannel::reorderThreadFunc, this);
 
-    auto dataCb = [selfGuard](const uint64_t messageId, std::shared_ptr<std::vector<char>> data, int sourceConnIndex) {
-        selfGuard->processReceivedData(messageId, data, sourceConnIndex);
+    auto dataCb = [selfGuard](int sourceConnIndex, std::vector<TcpVCIoThread::DataFrame> &frames) {
+        selfGuard->processReceivedFrames(sourceConnIndex, frames);
     };
     auto resendReqCb = [selfGuard](uint64_t messageId) {
         selfGuard->processResendRequest(messageId);
     };
-    auto missingNotifyCb = [selfGuard](const std::vector<uint64_t> &missingIds) {
-        selfGuard->processMissingNotify(missingIds);
+    auto missingNotifyCb = [selfGuard](const std::vector<MissingRange> &ranges) {
+        selfGuard->processMissingRanges(ranges);
     };
+    auto ackCb = [selfGuard](const VCAck &ack) { selfGuard->processAck(ack); };
+
+    publishConnectionTable();
 
     ioThread = std::make_shared<TcpVCIoThread>(
-        connections,
+        connTable,
         dataCb,
         resendReqCb,
         missingNotifyCb,
+        ackCb,
         disconnectCB
     );
 
     ioThread->start();
 
     sendThread = std::make_shared<TcpVCSendThread>(
-        connections,
+        connTable,
         sendQueue,
         resendQueue,
-        connSendStats,
+        controlQueue,
         messageTracker,
-        socketStatuses,
+        sendWriteStats,
+        controlLaneStats,
+        flowQueueStats,
+        schedulerPolicy,
         disconnectCB
     );
+    // The send thread is joined in close() before the cache goes away.
+    sendThread->setFrameSource([this](uint64_t messageId) { return sentDataCache.find(messageId); });
+    sendThread->setCoDel(codelTarget, codelInterval);
+    sendThread->setPacing(pacingRate);
+    if (congestionControl)
+        sendThread->setCongestionControl(congestionTarget, congestionStats);
+    if (fecEnabled)
+        sendThread->setFec(fecConfig, fecStats);
+    sendThread->setFrameStamper([this](PacketBuffer &frame) {
+        auto messageId = lastSendMessageId.fetch_add(1);
+        reinterpret_cast<VCDataPacket *>(frame.data())->header.messageId = messageId;
+        // The cache and the send path share the same block; the frame is read-only from here on.
+        sentDataCache.insert(messageId, frame);
+    });
+    sendThread->setAckTracker(ackTracker);
 
     sendThread->start();
 
-    // Default resendCallback: re-enqueue the original packet with its messageId onto the dedicated
-    // resend queue so it is sent over the resend connections (VC_FIRST_RESEND_CONN_INDEX..VC_TCP_CONNECTIONS-1).
-    // Callers may override via setResendCallback().
-    if (!resendCallback)
-    {
-        auto weakSelf = std::weak_ptr<TcpVirtualChannel>(shared_from_this());
-        resendCallback = [weakSelf](uint64_t messageId, const char *data, size_t size) {
-            auto self = weakSelf.lock();
-            if (!self || !self->opened.load() || !self->resendQueue) return;
-            auto totalPacketSize = sizeof(VCDataPacket) + size;
-            auto dataVec = std::make_shared<std::vector<char>>(totalPacketSize);
-            VCDataPacket *packet = reinterpret_cast<VCDataPacket *>(dataVec->data());
-            packet->header.type = VcPacketType::DATA;
-            packet->header.messageId = messageId;
-            packet->dataLength = static_cast<uint16_t>(size);
-            std::memcpy(packet->data, data, size);
-            self->resendQueue->enqueue(dataVec);
-        };
-    }
-
-    // Default missingNotifyCallback: serialize a VCMissingNotify and send it back to the peer over
-    // the existing TCP connections so the sender can respond with resends.
+    // Default missingNotifyCallback: serialize a VCMissingRanges, or VCMissingNotify frames for a
+    // peer that may predate them, and send it back to the peer over the control lane so the sender
+    // can respond with resends without waiting behind queued data.
     // Callers may override via setMissingNotifyCallback().
     if (!missingNotifyCallback)
     {
         auto weakSelf = std::weak_ptr<TcpVirtualChannel>(shared_from_this());
-        missingNotifyCallback = [weakSelf](const std::vector<uint64_t> &missingIds) {
+        missingNotifyCallback = [weakSelf](const std::vector<MissingRange> &ranges) {
             auto self = weakSelf.lock();
-            if (!self || !self->opened.load() || !self->sendQueue) return;
-            size_t count = std::min(missingIds.size(), VC_MAX_MISSING_IDS_PER_NOTIFY);
-            size_t packetSize = sizeof(VCHeader) + sizeof(uint8_t) + count * sizeof(uint64_t);
-            auto dataVec = std::make_shared<std::vector<char>>(packetSize, 0);
-            char *ptr = dataVec->data();
-            VCHeader hdr{VcPacketType::MISSING_NOTIFY, 0};
+            if (!self || !self->opened.load() || !self->controlQueue || ranges.empty()) return;
+            if (!self->peerTakesAcks())
+            {
+                self->sendMissingNotify(ranges);
+                return;
+            }
+            // Ranges arrive in ID order and span at most the reorder window, so every
+            // offset from the first one fits in 32 bits.
+            size_t count = std::min(ranges.size(), VC_MAX_MISSING_RANGES);
+            size_t packetSize = VC_MIN_MISSING_RANGES_SIZE + count * sizeof(VCMissingRange);
+            auto dataVec = PacketBuffer::allocate(packetSize);
+            char *ptr = dataVec.data();
+            const uint64_t base = ranges.front().first;
+            VCHeader hdr{VcPacketType::MISSING_RANGES, base};
             std::memcpy(ptr, &hdr, sizeof(VCHeader));
             ptr += sizeof(VCHeader);
             *reinterpret_cast<uint8_t *>(ptr) = static_cast<uint8_t>(count);
             ptr += sizeof(uint8_t);
             for (size_t i = 0; i < count; i++)
             {
-                std::memcpy(ptr, &missingIds[i], sizeof(uint64_t));
-                ptr += sizeof(uint64_t);
+                VCMissingRange range{static_cast<uint32_t>(ranges[i].first - base),
+                                     static_cast<uint32_t>(ranges[i].count)};
+                std::memcpy(ptr, &range, sizeof(range));
+                ptr += sizeof(range);
             }
-            self->sendQueue->enqueue(dataVec);
+            if (!self->controlQueue->enqueue(std::move(dataVec)))
+                log_warnning("[MISSING] Control queue full, dropping missing notify");
         };
     }
 
     opened = true;
+    // The first pass of the reorder thread sets the RTT-derived limits.
+    kickReorderThread();
 }
 
 void TcpVirtualChannel::send(const char *data, size_t size)
@@ -227,41 +223,79 @@ void TcpVirtualChannel::send(const char *data, size_t size)
         log_debug("send called on closed channel, ignoring");
         return;
     }
-    if (data != nullptr && size > 0)
+    if (data == nullptr || size == 0)
+        return;
+    if (size > VC_MAX_DATA_PAYLOAD_SIZE)
     {
-        if (size > VC_MAX_DATA_PAYLOAD_SIZE)
-        {
-            log_error(std::format("UDP packet size {} exceeds VC_MAX_DATA_PAYLOAD_SIZE {}, dropping", size, VC_MAX_DATA_PAYLOAD_SIZE));
-            return;
-        }
+        log_error(std::format("UDP packet size {} exceeds VC_MAX_DATA_PAYLOAD_SIZE {}, dropping", size, VC_MAX_DATA_PAYLOAD_SIZE));
+        return;
+    }
 
-        auto quesize = this->sendQueue->approxSize();
-        if (quesize > SEND_QUEUE_DROP_THRESHOLD)
-        {
-            log_info(std::format("[PERF-DIAG] Send queue depth {} exceeds threshold {}. "
-                "Dropping UDP packet to apply backpressure.",
-                quesize, SEND_QUEUE_DROP_THRESHOLD));
-            return;
-        }
+    auto frame = allocateSendFrame();
+    std::memcpy(frame.data(), data, size);
+    frame.resize(size);
+    sendFrame(std::move(frame));
+}
+
+void TcpVirtualChannel::sendFrame(PacketBuffer frame)
+{
+    sendFrame(std::move(frame), FlowInfo{});
+}
 
-        auto messageId = this->lastSendMessageId.fetch_add(1);
-        auto messageIdNetwork = messageId;
+void TcpVirtualChannel::sendFrame(PacketBuffer frame, const FlowInfo &flow)
+{
+    if (!opened)
+    {
+        log_debug("send called on closed channel, ignoring");
+        return;
+    }
+    if (!frame || frame.empty())
+        return;
 
-        auto totalPacketSize = sizeof(VCDataPacket) + size;
-        auto dataVec = std::make_shared<std::vector<char>>(totalPacketSize);
+    const size_t size = frame.size();
+    if (size > VC_MAX_DATA_PAYLOAD_SIZE)
+    {
+        log_error(std::format("UDP packet size {} exceeds VC_MAX_DATA_PAYLOAD_SIZE {}, dropping", size, VC_MAX_DATA_PAYLOAD_SIZE));
+        return;
+    }
 
-        VCDataPacket *packet = reinterpret_cast<VCDataPacket *>(dataVec->data());
-        packet->header.type = VcPacketType::DATA;
-        packet->header.messageId = messageIdNetwork;
-        packet->dataLength = static_cast<uint16_t>(size);
-        std::memcpy(packet->data, data, size);
+    // Grow the frame into its headroom so the header lands directly in front of the
+    // payload. A caller that did not reserve headroom pays one copy here instead.
+    if (!frame.prepend(sizeof(VCDataPacket)))
+    {
+        auto withHeadroom = allocateSendFrame();
+        std::memcpy(withHeadroom.data(), frame.data(), size);
+        withHeadroom.resize(size);
+        withHeadroom.prepend(sizeof(VCDataPacket));
+        frame = std::move(withHeadroom);
+    }
 
-        {
-            sentDataCache.insert(messageId, dataVec);
-        }
+    // The message id is assigned by the send thread's frame stamper once the flow
+    // queue releases the frame, so ids follow the actual send order.
+    VCDataPacket *packet = reinterpret_cast<VCDataPacket *>(frame.data());
+    packet->header.type = VcPacketType::DATA;
+    packet->header.messageId = 0;
+    packet->dataLength = static_cast<uint16_t>(size);
 
-        sendQueue->enqueue(dataVec);
+    if (!sendQueue->enqueue(std::move(frame), FlowQueue::tagOf(flow.flowId, flow.tos)))
+        log_debug("Send queue full or closed, dropping UDP packet");
+}
+
+void TcpVirtualChannel::resendFrame(uint64_t messageId, const PacketBuffer &frame)
+{
+    fecStats->resent.fetch_add(1, std::memory_order_relaxed);
+    if (resendCallback)
+    {
+        const VCDataPacket *packet = reinterpret_cast<const VCDataPacket *>(frame.data());
+        resendCallback(messageId, reinterpret_cast<const char *>(packet->data), packet->dataLength);
+        return;
     }
+
+    // Default: put the cached frame itself back on the dedicated resend queue so it goes out
+    // over the resend connections (VC_FIRST_RESEND_CONN_INDEX..VC_TCP_CONNECTIONS-1). The
+    // header already carries the right messageId, so nothing is rebuilt or copied.
+    if (opened.load() && resendQueue)
+        resendQueue->enqueue(frame);
 }
 
 bool TcpVirtualChannel::isOpen() const
@@ -278,6 +312,8 @@ void TcpVirtualChannel::close()
         this->sendQueue->cancelWait();
         if (this->resendQueue)
             this->resendQueue->cancelWait();
+        if (this->controlQueue)
+            this->controlQueue->cancelWait();
 
         log_debug("Closing TcpVirtualChannel connections");
 
@@ -321,12 +357,11 @@ void TcpVirtualChannel::close()
     sentDataCache.clear();
 }
 
-void TcpVirtualChannel::processReceivedData(uint64_t messageId, std::shared_ptr<std::vector<char>> data,
-                                              int sourceConnIndex)
+void TcpVirtualChannel::processReceivedData(uint64_t messageId, PacketBuffer data, int sourceConnIndex)
 {
     if (sourceConnIndex >= 0 && static_cast<size_t>(sourceConnIndex) < connReceiveQueues.size())
     {
-        bool enqueued = connReceiveQueues[sourceConnIndex]->try_enqueue({messageId, data, sourceConnIndex});
+        bool enqueued = connReceiveQueues[sourceConnIndex]->try_enqueue({messageId, std::move(data)});
         if (!enqueued)
         {
             log_warnning(
@@ -338,6 +373,23 @@ void TcpVirtualChannel::processReceivedData(uint64_t messageId, std::shared_ptr<
     reorderCv.notify_one();
 }
 
+void TcpVirtualChannel::processReceivedFrames(int sourceConnIndex, std::vector<TcpVCIoThread::DataFrame> &frames)
+{
+    if (frames.empty() || sourceConnIndex < 0 || static_cast<size_t>(sourceConnIndex) >= connReceiveQueues.size())
+        return;
+
+    size_t enqueued = connReceiveQueues[sourceConnIndex]->try_enqueue_bulk(frames.begin(), frames.size());
+    if (enqueued < frames.size())
+    {
+        log_warnning(std::format("[VC] connReceiveQueue[{}] full, dropping {} frames from messageId={}",
+                                 sourceConnIndex, frames.size() - enqueued, frames[enqueued].messageId));
+    }
+    if (enqueued == 0)
+        return;
+    reorderEnqueueSeq.fetch_add(enqueued, std::memory_order_release);
+    reorderCv.notify_one();
+}
+
 void TcpVirtualChannel::processResendRequest(uint64_t messageId)
 {
     log_info(std::format("[RESEND] Received resend request for messageId={}", messageId));
@@ -354,13 +406,12 @@ void TcpVirtualChannel::processResendRequest(uint64_t messageId)
 
     auto dataVec = sentDataCache.find(messageId);
 
-    if (dataVec && resendCallback)
+    if (dataVec)
     {
-        const VCDataPacket *packet = reinterpret_cast<const VCDataPacket *>(dataVec->data());
         log_info(std::format("[RESEND] Resending messageId={}", messageId));
-        resendCallback(messageId, reinterpret_cast<const char *>(packet->data), packet->dataLength);
+        resendFrame(messageId, dataVec);
     }
-    else if (!dataVec)
+    else
     {
         log_warnning(std::format("[RESEND] No cached data for messageId={}, cannot resend", messageId));
     }
@@ -368,133 +419,302 @@ void TcpVirtualChannel::processResendRequest(uint64_t messageId)
 
 void TcpVirtualChannel::processMissingNotify(const std::vector<uint64_t> &missingIds)
 {
-    log_info(std::format("[MISSING] Received missing notify for {} messageIds", missingIds.size()));
+    std::vector<MissingRange> ranges;
+    ranges.reserve(missingIds.size());
+    for (uint64_t id : missingIds)
+        ranges.push_back({id, 1});
+    processMissingRanges(ranges);
+}
+
+void TcpVirtualChannel::processMissingRanges(const std::vector<MissingRange> &rangesIn)
+{
+    std::vector<MissingRange> ranges(rangesIn);
+    std::sort(ranges.begin(), ranges.end(),
+              [](const MissingRange &a, const MissingRange &b) { return a.first < b.first; });
+    uint64_t total = 0;
+    for (const auto &range : ranges)
+        total += range.count;
+    log_info(std::format("[MISSING] Received missing notify for {} messageIds in {} ranges", total, ranges.size()));
 
     // IDs absent from the new notify have been received by the peer — clear them.
-    // Also expire entries older than pendingResendTtl so dropped resends can be retried.
+    // Also expire entries older than the TTL so dropped resends can be retried: the peer
+    // repeats a NACK only after a resend round trip, so a repeat within one RTO is
+    // already honoured.
     auto now = std::chrono::steady_clock::now();
-    std::unordered_set<uint64_t> newMissingSet(missingIds.begin(), missingIds.end());
+    std::chrono::steady_clock::duration ttl = pendingResendTtl;
+    if (ackTracker)
+        ttl = std::min(ttl, ackTracker->rto());
+    auto inRanges = [&](uint64_t id) {
+        auto it = std::upper_bound(ranges.begin(), ranges.end(), id,
+                                   [](uint64_t v, const MissingRange &r) { return v < r.first; });
+        return it != ranges.begin() && id - std::prev(it)->first < std::prev(it)->count;
+    };
     for (auto it = pendingResendIds.begin(); it != pendingResendIds.end(); )
     {
-        if (newMissingSet.find(it->first) == newMissingSet.end() ||
-            (now - it->second) >= pendingResendTtl)
+        if (!inRanges(it->first) || (now - it->second) >= ttl)
             it = pendingResendIds.erase(it);
         else
             ++it;
     }
 
     int resent = 0;
-    int cacheMiss = 0;
+    uint64_t cacheMiss = 0;
     int skipped = 0;
-    for (uint64_t messageId : missingIds)
+    // A frame may name runs of up to 64K IDs; only those still cached can be resent.
+    const auto [cachedFirst, cachedEnd] = sentDataCache.idRange();
+    std::vector<char> degraded(socketStatuses.size());
+    for (const auto &range : ranges)
     {
-        if (messageTracker)
+        const uint64_t first = std::max(range.first, cachedFirst);
+        const uint64_t end = std::max(first, std::min(range.first + range.count, cachedEnd));
+        cacheMiss += range.count - (end - first);
+        std::fill(degraded.begin(), degraded.end(), 0);
+        for (uint64_t messageId = first; messageId < end; messageId++)
         {
-            int connIndex = messageTracker->getConnectionIndex(messageId);
-            if (connIndex >= 0 && static_cast<size_t>(connIndex) < socketStatuses.size())
+            if (messageTracker)
             {
-                socketStatuses[connIndex]->markDegraded();
+                int connIndex = messageTracker->getConnectionIndex(messageId);
+                if (connIndex >= 0 && static_cast<size_t>(connIndex) < degraded.size())
+                    degraded[connIndex] = 1;
             }
-        }
 
-        // Skip IDs that were recently enqueued for resend and haven't expired yet.
-        if (pendingResendIds.count(messageId))
-        {
-            skipped++;
-            continue;
-        }
+            // Skip IDs that were recently enqueued for resend and haven't expired yet.
+            if (pendingResendIds.count(messageId))
+            {
+                skipped++;
+                continue;
+            }
 
-        auto dataVec = sentDataCache.find(messageId);
+            auto dataVec = sentDataCache.find(messageId);
 
-        if (dataVec && resendCallback)
-        {
-            const VCDataPacket *packet = reinterpret_cast<const VCDataPacket *>(dataVec->data());
-            resendCallback(messageId, reinterpret_cast<const char *>(packet->data), packet->dataLength);
-            pendingResendIds[messageId] = now;
-            resent++;
+            if (dataVec)
+            {
+                resendFrame(messageId, dataVec);
+                pendingResendIds[messageId] = now;
+                resent++;
+            }
+            else
+            {
+                cacheMiss++;
+            }
         }
-        else if (!dataVec)
+        // Once per run for each connection that carried part of it.
+        for (size_t i = 0; i < degraded.size(); i++)
         {
-            cacheMiss++;
+            if (degraded[i])
+                socketStatuses[i]->markDegraded();
         }
     }
 
     if (cacheMiss > 0)
         log_warnning(std::format("[MISSING] {} of {} missing messageIds not found in cache (evicted), cannot resend",
-                                 cacheMiss, missingIds.size()));
+                                 cacheMiss, total));
     log_info(std::format("[MISSING] Resent {}/{} missing messages ({} already pending, skipped)",
-                         resent, missingIds.size(), skipped));
+                         resent, total, skipped));
 }
 
-void TcpVirtualChannel::sendMissingNotifications()
+void TcpVirtualChannel::processAck(const VCAck &ack)
 {
-    if (receivedDataMap.empty() || !gapTimerActive)
-    {
+    if (!ackTracker)
         return;
+    const uint64_t watermark = ack.header.messageId;
+    const bool firstAck = !ackTracker->peerAcknowledges();
+    ackTracker->onAck(watermark, ack.sackBitmap, VC_SACK_WORDS);
+    // Retransmission timers only run once the peer is known to acknowledge.
+    if (firstAck)
+        kickReorderThread();
+    sentDataCache.releaseBelow(watermark);
+    pendingResendIds.erase(pendingResendIds.begin(), pendingResendIds.lower_bound(watermark));
+}
+
+void TcpVirtualChannel::sendMissingNotify(const std::vector<MissingRange> &ranges)
+{
+    // Expanded to single IDs, VC_MAX_MISSING_IDS_PER_NOTIFY per frame. The gap tracker
+    // asks again for whatever does not fit.
+    size_t r = 0;
+    uint64_t next = ranges.front().first;
+    for (size_t frames = 0; frames < VC_MAX_MISSING_NOTIFY_FRAMES && r < ranges.size(); frames++)
+    {
+        uint64_t ids[VC_MAX_MISSING_IDS_PER_NOTIFY];
+        size_t count = 0;
+        while (count < VC_MAX_MISSING_IDS_PER_NOTIFY && r < ranges.size())
+        {
+            ids[count++] = next++;
+            if (next - ranges[r].first >= ranges[r].count && ++r < ranges.size())
+                next = ranges[r].first;
+        }
+
+        auto dataVec = PacketBuffer::allocate(sizeof(VCHeader) + sizeof(uint8_t) + count * sizeof(uint64_t));
+        char *ptr = dataVec.data();
+        VCHeader hdr{VcPacketType::MISSING_NOTIFY, 0};
+        std::memcpy(ptr, &hdr, sizeof(VCHeader));
+        ptr += sizeof(VCHeader);
+        *reinterpret_cast<uint8_t *>(ptr) = static_cast<uint8_t>(count);
+        ptr += sizeof(uint8_t);
+        std::memcpy(ptr, ids, count * sizeof(uint64_t));
+        if (!controlQueue->enqueue(std::move(dataVec)))
+        {
+            log_warnning("[MISSING] Control queue full, dropping missing notify");
+            return;
+        }
     }
+}
+
+bool TcpVirtualChannel::peerTakesAcks() const
+{
+    return acksEnabled || (ackTracker && ackTracker->peerAcknowledges());
+}
 
+void TcpVirtualChannel::maybeSendAck()
+{
+    if (!controlQueue || !peerTakesAcks())
+        return;
     auto now = std::chrono::steady_clock::now();
-    if (now - gapFirstSeen < missingNotifyIntervalMs)
+    auto sinceLast = now - lastAckSent;
+    const bool changed = framesSinceAck > 0 || ackDirty;
+    const bool due = framesSinceAck >= VC_ACK_EVERY_FRAMES || (changed && sinceLast >= VC_ACK_INTERVAL) ||
+                     (!reorderWindow.empty() && sinceLast >= VC_ACK_REPEAT_INTERVAL);
+    if (!due)
+        return;
+
+    auto frame = PacketBuffer::allocate(sizeof(VCAck));
+    auto *ack = reinterpret_cast<VCAck *>(frame.data());
+    ack->header = VCHeader{VcPacketType::ACK, reorderWindow.base()};
+    reorderWindow.bitmap(reorderWindow.base() + 1, ack->sackBitmap, VC_SACK_WORDS);
+    lastAckSent = now; // on failure too: retry after an interval rather than spin
+    if (!controlQueue->enqueue(std::move(frame)))
     {
+        log_warnning("[ACK] Control queue full, dropping ack");
         return;
     }
+    framesSinceAck = 0;
+    ackDirty = false;
+}
+
+void TcpVirtualChannel::retransmitExpired()
+{
+    if (!ackTracker || !ackTracker->peerAcknowledges())
+        return;
+    retransmitIds.clear();
+    ackTracker->collectExpired(retransmitIds);
+    if (retransmitIds.empty())
+        return;
 
-    std::vector<uint64_t> missingIds;
-    auto expected = nextMessageId.load();
-    for (const auto &kv : receivedDataMap)
+    int resent = 0;
+    for (uint64_t messageId : retransmitIds)
     {
-        for (uint64_t id = expected; id < kv.first; ++id)
-        {
-            if (notifiedMissingIds.find(id) == notifiedMissingIds.end())
-            {
-                missingIds.push_back(id);
-                if (missingIds.size() >= VC_MAX_MISSING_IDS_PER_NOTIFY)
-                {
-                    break;
-                }
-            }
-        }
-        if (missingIds.size() >= VC_MAX_MISSING_IDS_PER_NOTIFY)
-        {
-            break;
-        }
+        auto frame = sentDataCache.find(messageId);
+        if (!frame)
+            continue;
+        resendFrame(messageId, frame);
+        resent++;
+    }
+    log_info(std::format("[ACK] Retransmission timeout: resent {}/{} unacknowledged messages (first {}, rto={}ms)",
+                         resent, retransmitIds.size(), retransmitIds.front(),
+                         std::chrono::duration_cast<std::chrono::milliseconds>(ackTracker->rto()).count()));
+}
+
+GapTracker::Copy TcpVirtualChannel::arrivalCopy(size_t connIndex) const
+{
+    // Only with dedicated resend connections does the connection tell a resend apart.
+    // Frames rescued from a stalled connection come back over them too, so their delay
+    // is not mistaken for reordering between the data connections.
+    if (connections.size() <= VC_FIRST_RESEND_CONN_INDEX)
+        return GapTracker::Copy::Unknown;
+    return IsResendConnectionIndex(static_cast<int>(connIndex)) ? GapTracker::Copy::Resend
+                                                                : GapTracker::Copy::Original;
+}
+
+std::chrono::steady_clock::time_point TcpVirtualChannel::nextReorderWake() const
+{
+    auto wake = std::chrono::steady_clock::time_point::max();
+    if (gapTimerActive)
+    {
+        wake = headGapSince + reorderTimeout.timeout();
+    }
+    // Also wake for the next MISSING_RANGES, not only for the timeout.
+    wake = std::min(wake, gapTracker.nextDeadline());
+    if (peerTakesAcks())
+    {
+        if (framesSinceAck > 0 || ackDirty)
+            wake = std::min(wake, lastAckSent + VC_ACK_INTERVAL);
+        if (!reorderWindow.empty())
+            wake = std::min(wake, lastAckSent + VC_ACK_REPEAT_INTERVAL);
+    }
+    if (ackTracker)
+    {
+        wake = std::min(wake, ackTracker->nextDeadline());
+        // Sends reach the tracker without waking this thread; none written after now
+        // is due before now + RTO.
+        if (ackTracker->peerAcknowledges())
+            wake = std::min(wake, std::chrono::steady_clock::now() + ackTracker->rto());
     }
+    return wake;
+}
 
-    if (!missingIds.empty())
+void TcpVirtualChannel::kickReorderThread()
+{
+    reorderKick.store(true, std::memory_order_release);
     {
-        // Cap the set to prevent unbounded growth under sustained packet loss.
-        // Cleared IDs are re-notified next interval if still missing.
-        if (notifiedMissingIds.size() > 1000)
-            notifiedMissingIds.clear();
+        std::lock_guard<std::mutex> lock(reorderMutex);
+    }
+    reorderCv.notify_one();
+}
 
-        for (auto id : missingIds)
-        {
-            notifiedMissingIds.insert(id);
-        }
+void TcpVirtualChannel::sendMissingNotifications()
+{
+    if (gapTracker.empty())
+    {
+        return;
+    }
+
+    // The tracker decides when each gap is due: once it outlives the reordering seen
+    // across the connections, and again per resend round trip while it stays open.
+    auto now = std::chrono::steady_clock::now();
+    missingRanges.clear();
+    gapTracker.collectDue(missingRanges, VC_MAX_MISSING_RANGES, now);
+
+    if (!missingRanges.empty())
+    {
         lastNotifyTime = now;
 
         if (missingNotifyCallback)
         {
-            missingNotifyCallback(missingIds);
+            missingNotifyCallback(missingRanges);
         }
     }
 }
 
-std::vector<TcpVirtualChannel::DeliveryItem> TcpVirtualChannel::drainReceivedDataMap()
+void TcpVirtualChannel::drainReorderWindow(std::vector<DeliveryItem> &out)
 {
-    std::vector<DeliveryItem> items;
+    reorderWindow.drain([&](uint64_t messageId, ReorderWindow::Item &&item) {
+        lastDeliveredConnIndex = item.sourceConnIndex;
+        fecDecoder.onDelivered(messageId, item.data);
+        out.push_back({messageId, std::move(item.data), item.sourceConnIndex});
+    });
+    nextMessageId.store(reorderWindow.base());
+}
 
-    std::map<uint64_t, ReceivedItem>::iterator it;
-    while ((it = receivedDataMap.find(nextMessageId)) != receivedDataMap.end())
-    {
-        notifiedMissingIds.erase(it->first);
-        lastDeliveredConnIndex = it->second.sourceConnIndex;
-        items.push_back({it->first, std::move(it->second.data), it->second.sourceConnIndex});
-        receivedDataMap.erase(it);
-        nextMessageId.fetch_add(1);
-    }
+void TcpVirtualChannel::recoverFromParity()
+{
+    recoveredIds.clear();
+    if (fecDecoder.recover(reorderWindow, recoveredIds) == 0)
+        return;
+    for (uint64_t messageId : recoveredIds)
+        gapTracker.onArrival(messageId, GapTracker::Copy::Recovered);
+    framesSinceAck += recoveredIds.size();
+}
 
-    return items;
+void TcpVirtualChannel::advanceReorderWindow(uint64_t newBase, std::vector<DeliveryItem> &out)
+{
+    reorderWindow.advance(newBase, [&](uint64_t messageId, ReorderWindow::Item &&item) {
+        lastDeliveredConnIndex = item.sourceConnIndex;
+        fecDecoder.onDelivered(messageId, item.data);
+        out.push_back({messageId, std::move(item.data), item.sourceConnIndex});
+    });
+    gapTracker.advance(reorderWindow.base());
+    nextMessageId.store(reorderWindow.base());
+    drainReorderWindow(out);
 }
 
 void TcpVirtualChannel::reorderThreadFunc()
@@ -502,59 +722,106 @@ void TcpVirtualChannel::reorderThreadFunc()
     log_info("Reorder thread started");
 
     uint64_t lastProcessedSeq = 0;
+    // Reused drain buffer: each connection queue is emptied with one bulk dequeue.
+    std::vector<TcpVCIoThread::DataFrame> received;
+    received.reserve(RECEIVE_DRAIN_BATCH);
 
     while (reorderRunning.load())
     {
         bool gotAny = false;
+        std::vector<DeliveryItem> itemsToDeliver;
 
         for (size_t i = 0; i < connReceiveQueues.size(); i++)
         {
-            DeliveryItem item;
-            while (connReceiveQueues[i]->try_dequeue(item))
+            received.clear();
+            if (connReceiveQueues[i]->try_dequeue_bulk(std::back_inserter(received), RECEIVE_DRAIN_BATCH) == 0)
+                continue;
+
+            if (i < lastRxMessageId.size())
+            {
+                lastRxMessageId[i] = received.back().messageId;
+                lastRxTime[i] = std::chrono::steady_clock::now();
+                lastRxValid[i] = true;
+            }
+
+            for (auto &item : received)
             {
-                if (item.sourceConnIndex >= 0 &&
-                    static_cast<size_t>(item.sourceConnIndex) < lastRxMessageId.size())
+                if (item.parity)
                 {
-                    lastRxMessageId[item.sourceConnIndex] = item.messageId;
-                    lastRxTime[item.sourceConnIndex] = std::chrono::steady_clock::now();
-                    lastRxValid[item.sourceConnIndex] = true;
+                    fecDecoder.onParity(item.data);
+                    gotAny = true;
+                    continue;
                 }
 
-                if (item.messageId < nextMessageId)
+                if (item.messageId < reorderWindow.base())
+                {
+                    if (item.messageId >= skippedFrom && item.messageId < skippedTo)
+                    {
+                        reorderTimeout.onLateFill(std::chrono::steady_clock::now() - skippedGapSince);
+                        skippedTo = skippedFrom; // one sample per skip
+                    }
                     continue;
+                }
+
+                if (item.messageId - reorderWindow.base() >= reorderWindow.capacity())
+                {
+                    // Further ahead than the sender can still resend from: give up on the
+                    // oldest gap now rather than waiting out the reorder timeout.
+                    uint64_t newBase = item.messageId - reorderWindow.capacity() + 1;
+                    log_warnning(std::format("Reorder window overflow: messageId={} is {} ahead of {}, "
+                                             "advancing to {} (buffered={})",
+                                             item.messageId, item.messageId - reorderWindow.base(),
+                                             reorderWindow.base(), newBase, reorderWindow.size()));
+                    advanceReorderWindow(newBase, itemsToDeliver);
+                    gapTimerActive = false;
+                }
 
-                receivedDataMap.try_emplace(item.messageId, ReceivedItem{item.data, item.sourceConnIndex});
+                if (reorderWindow.insert(item.messageId, {std::move(item.data), static_cast<int>(i)}) ==
+                    ReorderWindow::InsertResult::Inserted)
+                    gapTracker.onArrival(item.messageId, arrivalCopy(i));
+                framesSinceAck++;
                 gotAny = true;
             }
         }
         lastProcessedSeq = reorderEnqueueSeq.load(std::memory_order_acquire);
+        if (gotAny && fecDecoder.hasPending())
+            recoverFromParity();
+        reorderDepthPeak = std::max(reorderDepthPeak, reorderWindow.size());
 
-        auto itemsToDeliver = drainReceivedDataMap();
+        drainReorderWindow(itemsToDeliver);
 
-        if (!receivedDataMap.empty())
+        if (!reorderWindow.empty())
         {
             if (!gapTimerActive)
             {
-                gapFirstSeen = std::chrono::steady_clock::now();
                 gapTimerActive = true;
+                headGapSince = std::chrono::steady_clock::now();
+                headGapBase = reorderWindow.base();
             }
             else
             {
-                auto elapsed = std::chrono::steady_clock::now() - gapFirstSeen;
-                if (elapsed >= reorderTimeoutMs)
+                if (reorderWindow.base() != headGapBase)
                 {
-                    auto firstIt = receivedDataMap.begin();
-                    auto lastIt = std::prev(receivedDataMap.end());
-                    auto skipTo = firstIt->first;
-                    auto missingStart = nextMessageId.load();
+                    // The head gap filled and the next one is now at the head: its timeout
+                    // starts now.
+                    auto now = std::chrono::steady_clock::now();
+                    reorderTimeout.onGapFilled(now - headGapSince);
+                    headGapSince = now;
+                    headGapBase = reorderWindow.base();
+                }
+                auto elapsed = std::chrono::steady_clock::now() - headGapSince;
+                if (elapsed >= reorderTimeout.timeout())
+                {
+                    auto skipTo = reorderWindow.lowest();
+                    auto missingStart = reorderWindow.base();
                     auto missingEnd = (skipTo > 0) ? (skipTo - 1) : 0ULL;
                     auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
-                    auto mapSize = receivedDataMap.size();
+                    auto mapSize = reorderWindow.size();
                     auto lastDelivConn = lastDeliveredConnIndex;
-                    auto firstBuf = firstIt->first;
-                    auto firstBufConn = firstIt->second.sourceConnIndex;
-                    auto lastBuf = lastIt->first;
-                    auto lastBufConn = lastIt->second.sourceConnIndex;
+                    auto firstBuf = skipTo;
+                    auto firstBufConn = reorderWindow.find(firstBuf)->sourceConnIndex;
+                    auto lastBuf = reorderWindow.highest();
+                    auto lastBufConn = reorderWindow.find(lastBuf)->sourceConnIndex;
 
                     auto now = std::chrono::steady_clock::now();
 
@@ -578,21 +845,21 @@ void TcpVirtualChannel::reorderThreadFunc()
 
                     std::vector<size_t> bufByConn(connections.size(), 0);
                     size_t bufUnknown = 0;
-                    for (const auto &kv : receivedDataMap)
-                    {
-                        int connIdx = kv.second.sourceConnIndex;
+                    reorderWindow.forEach([&](uint64_t, const ReorderWindow::Item &buffered) {
+                        int connIdx = buffered.sourceConnIndex;
                         if (connIdx >= 0 && static_cast<size_t>(connIdx) < bufByConn.size())
                             bufByConn[connIdx]++;
                         else
                             bufUnknown++;
-                    }
+                    });
 
-                    nextMessageId.store(skipTo);
-                    notifiedMissingIds.clear(); // skipped IDs are no longer relevant
                     gapTimerActive = false;
-                    auto moreItems = drainReceivedDataMap();
-                    itemsToDeliver.insert(itemsToDeliver.end(), std::make_move_iterator(moreItems.begin()),
-                                          std::make_move_iterator(moreItems.end()));
+                    reorderTimeoutSkips++;
+                    skippedFrom = missingStart;
+                    skippedTo = skipTo;
+                    skippedGapSince = headGapSince;
+                    advanceReorderWindow(skipTo, itemsToDeliver);
+                    ackDirty = true;
 
                     int suspectPendingBytes = -1;
                     if (suspectConn >= 0 && static_cast<size_t>(suspectConn) < connections.size() &&
@@ -692,27 +959,34 @@ void TcpVirtualChannel::reorderThreadFunc()
         }
         else
         {
+            if (gapTimerActive)
+                reorderTimeout.onGapFilled(std::chrono::steady_clock::now() - headGapSince);
             gapTimerActive = false;
         }
 
         sendMissingNotifications();
+        maybeSendAck();
+        retransmitExpired();
 
         for (auto &item : itemsToDeliver)
         {
             if (receiveCallback)
             {
                 auto cbStart = std::chrono::steady_clock::now();
-                receiveCallback(item.data->data(), item.data->size());
+                receiveCallback(item.data.data(), item.data.size());
                 auto cbDur = std::chrono::steady_clock::now() - cbStart;
                 if (cbDur >= RECEIVE_CALLBACK_SLOW_WARN_MS)
                 {
                     auto cbMs = std::chrono::duration_cast<std::chrono::milliseconds>(cbDur).count();
                     log_warnning(std::format("[VC] Slow receiveCallback: messageId={} conn={} bytes={} cbMs={}",
-                                             item.messageId, item.sourceConnIndex, item.data->size(), cbMs));
+                                             item.messageId, item.sourceConnIndex, item.data.size(), cbMs));
                 }
             }
         }
 
+        if (opened.load(std::memory_order_relaxed))
+            refreshPathEstimates(std::chrono::steady_clock::now());
+
         {
             static constexpr auto HEALTH_LOG_INTERVAL = std::chrono::seconds(10);
             auto now = std::chrono::steady_clock::now();
@@ -767,43 +1041,83 @@ void TcpVirtualChannel::reorderThreadFunc()
                 txInfo += "]";
 
                 auto netScore = getNetworkScore();
-                log_info(std::format("[VC] Health: nextMsgId={} buffered={} queueDepth={} gap={}, {}, {}",
+                log_info(std::format("[VC] Health: nextMsgId={} buffered={} (peak {}) timeoutSkips={} queueDepth={} "
+                                     "gap={}, {}, {}",
                                      nextMessageId.load(),
-                                     receivedDataMap.size(),
-                                     sendQueue->size(),
+                                     reorderWindow.size(),
+                                     reorderDepthPeak,
+                                     reorderTimeoutSkips,
+                                     sendBacklog(),
                                      gapTimerActive ? "active" : "none",
                                      rxInfo,
                                      txInfo));
+                reorderDepthPeak = reorderWindow.size();
                 log_info(netScore.format());
+                log_info(PacketPool::instance().getStats().format());
+                log_info(sendWriteStats->format());
+                log_info(controlLaneStats->format());
+                log_info(flowQueueStats->format());
+                log_info(ackStats->format());
+                log_info(reorderTimeoutStats->format());
+                log_info(gapStats->format());
+                log_info(fecStats->format());
+                log_info(sentDataCache.getStats().format());
+                // The IO thread is almost always pinned, so connection tables retired by
+                // replaceConnection() are usually freed here rather than on the next swap.
+                connTable->reclaim();
             }
         }
 
         if (!gotAny)
         {
+            // Sleep until new frames arrive or the next timer is due.
+            reorderKick.store(false, std::memory_order_relaxed);
+            auto wake = nextReorderWake();
             std::unique_lock<std::mutex> lock(reorderMutex);
-            if (gapTimerActive)
-            {
-                auto remaining = reorderTimeoutMs - (std::chrono::steady_clock::now() - gapFirstSeen);
-                if (remaining > std::chrono::milliseconds::zero())
-                {
-                    reorderCv.wait_for(lock, remaining, [&] {
-                        return reorderEnqueueSeq.load(std::memory_order_acquire) > lastProcessedSeq ||
-                               !reorderRunning;
-                    });
-                }
-            }
-            else
-            {
-                reorderCv.wait(lock, [&] {
-                    return reorderEnqueueSeq.load(std::memory_order_acquire) > lastProcessedSeq || !reorderRunning;
-                });
-            }
+            auto ready = [&] {
+                return reorderEnqueueSeq.load(std::memory_order_acquire) > lastProcessedSeq || !reorderRunning ||
+                       reorderKick.load(std::memory_order_acquire);
+            };
+            if (wake == std::chrono::steady_clock::time_point::max())
+                reorderCv.wait(lock, ready);
+            else if (wake > std::chrono::steady_clock::now())
+                reorderCv.wait_until(lock, wake, ready);
         }
     }
 
     log_info("Reorder thread stopped");
 }
 
+void TcpVirtualChannel::refreshPathEstimates(std::chrono::steady_clock::time_point now)
+{
+    if (lastPathRefresh != std::chrono::steady_clock::time_point{} && now - lastPathRefresh < PATH_REFRESH_INTERVAL)
+        return;
+    lastPathRefresh = now;
+    auto score = getNetworkScore();
+    updateSentCacheRetention(score);
+    updateReorderRecoveryTime(score);
+}
+
+void TcpVirtualChannel::updateSentCacheRetention(const NetworkScore &score)
+{
+    if (score.avgRttMs <= 0.0)
+        return;
+    auto rtt = std::chrono::microseconds(static_cast<int64_t>(score.avgRttMs * 1000.0));
+    auto minAge = std::max<std::chrono::microseconds>(missingNotifyIntervalMs + SENT_CACHE_RTT_MULTIPLIER * rtt,
+                                                      SentDataCache::DEFAULT_MIN_AGE);
+    sentDataCache.setMinAge(minAge);
+}
+
+void TcpVirtualChannel::updateReorderRecoveryTime(const NetworkScore &score)
+{
+    if (score.avgRttMs <= 0.0)
+        return;
+    // A NACK goes out after the notify interval and its resend needs a round trip;
+    // allow a second round trip for queueing behind data on the resend connections.
+    auto rtt = std::chrono::microseconds(static_cast<int64_t>(score.avgRttMs * 1000.0));
+    reorderTimeout.setRecoveryTime(missingNotifyIntervalMs + 2 * rtt);
+}
+
 std::vector<int> TcpVirtualChannel::getDeadSlots() const
 {
     std::vector<int> dead;
@@ -827,9 +1141,11 @@ void TcpVirtualChannel::replaceConnection(int slotIndex, SocketFd newFd)
     auto newConn = std::make_shared<TcpConnection>(newFd);
     auto newStats = std::make_shared<ConnSendStats>();
     auto newStatus = std::make_shared<SocketStatus>();
+    SetSocketNonBlocking(newFd);
 
-    // Update VC's own connections vector under disconnectMutex so getDeadSlots() and
-    // disconnectCB see a consistent view of which connections are alive.
+    // Update VC's own vectors under disconnectMutex so getDeadSlots() and disconnectCB
+    // see a consistent view of which connections are alive, then publish them. The IO
+    // and send threads pick the new slot up on their next pin of the table.
     {
         std::lock_guard<std::mutex> lock(disconnectMutex);
         if (static_cast<size_t>(slotIndex) < socketStatuses.size())
@@ -837,24 +1153,31 @@ void TcpVirtualChannel::replaceConnection(int slotIndex, SocketFd newFd)
         if (static_cast<size_t>(slotIndex) < connSendStats.size())
             connSendStats[slotIndex] = newStats;
         connections[slotIndex] = newConn;
+        publishConnectionTable();
     }
 
-    // Propagate the new connection to the IO and send threads so they actually
-    // use it. Each thread's replaceConnection() holds its own internal mutex,
-    // keeping the snapshot safe for concurrent access during scoring/polling.
-    if (ioThread)
-        ioThread->replaceConnection(slotIndex, newConn);
     if (sendThread)
-        sendThread->replaceConnection(slotIndex, newConn, newStats, newStatus);
+        sendThread->onConnectionReplaced(slotIndex);
 
     log_info(std::format("[VC] Replaced connection at slot {}", slotIndex));
 }
 
+void TcpVirtualChannel::publishConnectionTable()
+{
+    connTable->update([&](ConnectionTable &table) {
+        table.connections = connections;
+        table.sendStats = connSendStats;
+        table.statuses = socketStatuses;
+    });
+}
+
 NetworkScore TcpVirtualChannel::getNetworkScore() const
 {
-    // Hold disconnectMutex to prevent a data race with replaceConnection(),
-    // which writes connections/connSendStats/socketStatuses under the same lock.
-    std::lock_guard<std::mutex> lock(disconnectMutex);
+    // Read the published table rather than taking disconnectMutex, so a caller polling
+    // the score never contends with replaceConnection() or the disconnect callback.
+    SharedConnectionTable::Reader reader(*connTable);
+    auto table = reader.pin();
+    const auto &connections = table->connections;
 
     // Sample per-connection TCP runtime info.
     // Refresh runtime info for connected sockets that haven't been sampled yet
@@ -877,8 +1200,26 @@ NetworkScore TcpVirtualChannel::getNetworkScore() const
         }
     }
 
-    return NetworkScoreCalculator::compute(infos, connSendStats, socketStatuses,
-                                           sendQueue ? sendQueue->approxSize() : 0);
+    NetworkScore score = NetworkScoreCalculator::compute(infos, table->sendStats, table->statuses,
+                                                         sendBacklog());
+    if (congestionControl)
+    {
+        const auto &cc = *congestionStats;
+        score.congestionState = CongestionStateName(cc.state.load(std::memory_order_relaxed));
+        score.btlBwKBps = static_cast<double>(cc.btlBwBytesPerSec.load(std::memory_order_relaxed)) / 1024.0;
+        score.minRttMs = cc.minRttUs.load(std::memory_order_relaxed) / 1000.0;
+        score.pacingRateKBps = static_cast<double>(cc.pacingRateBytesPerSec.load(std::memory_order_relaxed)) / 1024.0;
+        score.queueDelayMs = cc.queueDelayUs.load(std::memory_order_relaxed) / 1000.0;
+    }
+    score.reorderTimeoutMs = reorderTimeoutStats->timeoutUs.load(std::memory_order_relaxed) / 1000.0;
+    return score;
+}
+
+size_t TcpVirtualChannel::sendBacklog() const
+{
+    return (sendQueue ? sendQueue->approxSize() : 0) +
+           flowQueueStats->priorityDepth.load(std::memory_order_relaxed) +
+           flowQueueStats->bulkDepth.load(std::memory_order_relaxed);
 }
 
 TcpVirtualChannel::TcpVirtualChannel(std::vector<SocketFd> fds)
@@ -887,7 +1228,10 @@ TcpVirtualChannel::TcpVirtualChannel(std::vector<SocketFd> fds)
     {
         connections.emplace_back(std::make_shared<TcpConnection>(fd));
     }
-    sendQueue = std::make_shared<BlockingQueue>();
-    resendQueue = std::make_shared<BlockingQueue>();
+    connTable = std::make_shared<SharedConnectionTable>(ConnectionTable{connections, {}, {}});
+    // Stamped: the send thread's CoDel measures queueing delay from the enqueue.
+    sendQueue = std::make_shared<MpscQueue>(MpscQueue::DEFAULT_CAPACITY, true);
+    resendQueue = std::make_shared<MpscQueue>();
+    controlQueue = std::make_shared<MpscQueue>(CONTROL_QUEUE_CAPACITY, true);
     lastNotifyTime = std::chrono::steady_clock::now();
 }
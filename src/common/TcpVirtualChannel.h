@@ -1,7 +1,17 @@
 #pragma once
 
-#include "BlockingQueue.h"
+#include "AckTracker.h"
+#include "ConnectionTable.h"
+#include "FecDecoder.h"
+#include "FecEncoder.h"
+#include "FlowQueue.h"
+#include "GapTracker.h"
+#include "MpscQueue.h"
 #include "NetworkScore.h"
+#include "PacketBuffer.h"
+#include "ReorderTimeoutEstimator.h"
+#include "ReorderWindow.h"
+#include "SentDataCache.h"
 #include "Socket.h"
 #include "SpscQueue.h"
 #include "TcpVCIoThread.h"
@@ -11,39 +21,14 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
-#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
-#include <unordered_set>
 #include <vector>
 
-class SentDataCache
-{
-    struct ConnShard
-    {
-        std::mutex mutex;
-        std::unordered_map<uint64_t, std::shared_ptr<std::vector<char>>> items;
-        std::deque<uint64_t> insertionOrder; // deque for O(1) front removal on eviction
-    };
-
-  public:
-    SentDataCache() = default;
-    explicit SentDataCache(size_t numConns, size_t capacityPerConn)
-        : shards(numConns), capacityPerConn(capacityPerConn) {}
-
-    void insert(uint64_t messageId, std::shared_ptr<std::vector<char>> data);
-    std::shared_ptr<std::vector<char>> find(uint64_t messageId);
-    void clear();
-
-  private:
-    std::vector<ConnShard> shards;
-    size_t capacityPerConn = 128;
-};
-
 class TcpVirtualChannel : public VirtualChannel, public std::enable_shared_from_this<TcpVirtualChannel>
 {
 
@@ -58,26 +43,100 @@ class TcpVirtualChannel : public VirtualChannel, public std::enable_shared_from_
 
     virtual void send(const char *data, size_t size);
 
+    virtual void sendFrame(PacketBuffer frame);
+
+    // Frames are fair-queued per flow ahead of the send thread (see FlowQueue); short
+    // frames and low-delay DSCP classes go first.
+    virtual void sendFrame(PacketBuffer frame, const FlowInfo &flow);
+
     virtual bool isOpen() const;
 
     virtual void close();
 
-    void processReceivedData(uint64_t messageId, std::shared_ptr<std::vector<char>> data, int sourceConnIndex);
+    void processReceivedData(uint64_t messageId, PacketBuffer data, int sourceConnIndex);
+
+    // Hand every frame parsed from one recv() on `sourceConnIndex` to the reorder thread
+    // with a single queue publish and a single wakeup.
+    void processReceivedFrames(int sourceConnIndex, std::vector<TcpVCIoThread::DataFrame> &frames);
 
     void processResendRequest(uint64_t messageId);
 
     void processMissingNotify(const std::vector<uint64_t> &missingIds);
+    void processMissingRanges(const std::vector<MissingRange> &ranges);
 
-    void setReorderTimeout(std::chrono::milliseconds timeout) { reorderTimeoutMs = timeout; }
+    // The peer acknowledged our messages: stop their retransmission timers and release
+    // them from the sent-data cache.
+    void processAck(const VCAck &ack);
 
-    void setMissingNotifyInterval(std::chrono::milliseconds timeout) { missingNotifyIntervalMs = timeout; }
+    // Pin the reorder timeout instead of adapting it to the path (see
+    // ReorderTimeoutEstimator); zero returns to adapting. Set before open().
+    void setReorderTimeout(std::chrono::milliseconds timeout) { reorderTimeout.setFixed(timeout); }
+    // Bounds of the adaptive reorder timeout. Set before open().
+    void setReorderTimeoutBounds(std::chrono::milliseconds min, std::chrono::milliseconds max)
+    {
+        reorderTimeout.setBounds(min, max);
+    }
+
+    // Delay of a gap's first MISSING_RANGES until the VC has seen how far frames overtake
+    // each other, and of repeats until it has timed a resend (see GapTracker).
+    void setMissingNotifyInterval(std::chrono::milliseconds timeout)
+    {
+        missingNotifyIntervalMs = timeout;
+        gapTracker.setInitialDelay(timeout);
+    }
+
+    // How the send thread spreads frames over the data connections. Takes effect on the
+    // next open().
+    void setSchedulerPolicy(SchedulerPolicy policy) { schedulerPolicy = policy; }
 
+    // Cap the rate of outgoing data (control frames and resends excepted). Takes effect
+    // on the next open().
+    void setPacingRate(const RateLimit &limit) { pacingRate = limit; }
+
+    // Queueing delay the send path tolerates before dropping (CoDel target), and how long
+    // it may stay above that first. Takes effect on the next open().
+    void setQueueDelayTarget(std::chrono::microseconds target, std::chrono::microseconds interval)
+    {
+        codelTarget = target;
+        codelInterval = interval;
+    }
+
+    // Pace the VC's total data rate at the path's estimated bandwidth, keeping the
+    // queueing delay the data connections see near `target` (VcCongestionController).
+    // Off by default. Takes effect on the next open().
+    void setCongestionControl(bool enabled, std::chrono::microseconds target = VC_CC_QUEUE_DELAY_TARGET)
+    {
+        congestionControl = enabled;
+        congestionTarget = target;
+    }
+
+    // Send a FEC parity frame per group of data frames, each member on a different data
+    // connection, so the peer rebuilds a frame lost to a stalled connection without a
+    // resend round trip (FecEncoder). Parity goes over the resend connections, so this
+    // needs the full connection set. Off by default. Takes effect on the next open().
+    // Received parity is always used.
+    void setFec(bool enabled, const FecConfig &config = {})
+    {
+        fecEnabled = enabled;
+        fecConfig = config;
+    }
+
+    // Send ACK frames from the start. An older peer cannot parse them and drops the
+    // rest of the connection's stream, so by default they only start once the peer has
+    // sent an ACK itself, which proves it understands them. Enable on at least one side
+    // of two current peers. Takes effect on the next open().
+    void setAcks(bool enabled)
+    {
+        acksEnabled = enabled;
+    }
+
+    // Overrides the default resend path, which re-enqueues the cached frame itself.
     void setResendCallback(std::function<void(uint64_t messageId, const char *data, size_t size)> callback)
     {
         resendCallback = std::move(callback);
     }
 
-    void setMissingNotifyCallback(std::function<void(const std::vector<uint64_t> &missingIds)> callback)
+    void setMissingNotifyCallback(std::function<void(const std::vector<MissingRange> &ranges)> callback)
     {
         missingNotifyCallback = std::move(callback);
     }
@@ -99,38 +158,106 @@ class TcpVirtualChannel : public VirtualChannel, public std::enable_shared_from_
     /// Safe to call from any thread.
     NetworkScore getNetworkScore() const;
 
-  private:
-    struct ReceivedItem
-    {
-        std::shared_ptr<std::vector<char>> data;
-        int sourceConnIndex{-1};
-    };
+    /// Write, stall-rescue and pacing counters of the send thread.
+    const SendWriteStats &getSendWriteStats() const { return *sendWriteStats; }
+
+    /// Depth, drops and sojourn times of the send path's fair queue.
+    const FlowQueueStats &getFlowQueueStats() const { return *flowQueueStats; }
 
+    /// Acknowledgements, retransmission timeouts and delivery latency of sent messages.
+    const AckStats &getAckStats() const { return *ackStats; }
+
+    /// The congestion controller's state and estimates.
+    const CongestionControlStats &getCongestionControlStats() const { return *congestionStats; }
+
+    /// The current reorder timeout and the gap fill times it is derived from.
+    const ReorderTimeoutStats &getReorderTimeoutStats() const { return *reorderTimeoutStats; }
+
+    /// Gap fill times (histogram), NACKs sent and the reordering estimates behind them.
+    const GapStats &getGapStats() const { return *gapStats; }
+
+    /// FEC parity sent and frames rebuilt from received parity, next to the frames
+    /// resent on NACKs and timeouts.
+    const FecStats &getFecStats() const { return *fecStats; }
+
+  private:
     struct DeliveryItem
     {
         uint64_t messageId{0};
-        std::shared_ptr<std::vector<char>> data;
+        PacketBuffer data;
         int sourceConnIndex{-1};
     };
 
-    std::vector<DeliveryItem> drainReceivedDataMap();
+    // Pop the in-order run at the front of the reorder window into `out`.
+    void drainReorderWindow(std::vector<DeliveryItem> &out);
+
+    // Rebuild what the received FEC parity allows into the reorder window.
+    void recoverFromParity();
+
+    // Move the reorder window to `newBase`, delivering what is buffered below it and
+    // skipping the holes.
+    void advanceReorderWindow(uint64_t newBase, std::vector<DeliveryItem> &out);
 
     void sendMissingNotifications();
 
+    // Receiver side: report the reorder window to the peer when an ACK is due.
+    void maybeSendAck();
+    // Whether the peer takes ACK frames: configured so, or it has sent one itself.
+    // MISSING_RANGES goes by the same test.
+    bool peerTakesAcks() const;
+    // Report gaps as MISSING_NOTIFY, which every peer parses.
+    void sendMissingNotify(const std::vector<MissingRange> &ranges);
+    // Sender side: retransmit messages whose retransmission timer expired.
+    void retransmitExpired();
+    // When the reorder thread must next wake without new data: the gap timers, the
+    // next ACK and the next retransmission. time_point::max() if never.
+    std::chrono::steady_clock::time_point nextReorderWake() const;
+    // How the gap tracker should count a frame that arrived on connection `connIndex`.
+    GapTracker::Copy arrivalCopy(size_t connIndex) const;
+    // Wake the reorder thread so it re-arms its timers.
+    void kickReorderThread();
+
+    // Re-derive the limits below from the connections' RTT, at most every
+    // PATH_REFRESH_INTERVAL (reorder thread).
+    void refreshPathEstimates(std::chrono::steady_clock::time_point now);
+    // Keep sent frames at least as long as the peer can still ask for them: one
+    // missing-notify interval to report the gap plus a few RTTs for the round trip.
+    void updateSentCacheRetention(const NetworkScore &score);
+    // Floor the adaptive reorder timeout at what one NACK-driven resend needs on this path.
+    void updateReorderRecoveryTime(const NetworkScore &score);
+
+    // Re-send a cached frame: through resendCallback when one is installed, otherwise by
+    // re-enqueuing the frame itself onto resendQueue.
+    void resendFrame(uint64_t messageId, const PacketBuffer &frame);
+    // Data frames waiting for the send thread: still in sendQueue or in its flow queue.
+    size_t sendBacklog() const;
+
     std::shared_ptr<TcpVCIoThread> ioThread;
     std::shared_ptr<TcpVCSendThread> sendThread;
     std::vector<TcpConnectionSp> connections;
-    BlockingQueueSp sendQueue;
-    BlockingQueueSp resendQueue; // dedicated queue for resend traffic (conns VC_FIRST_RESEND_CONN_INDEX..VC_TCP_CONNECTIONS-1)
+    MpscQueueSp sendQueue;
+    MpscQueueSp resendQueue; // dedicated queue for resend traffic (conns VC_FIRST_RESEND_CONN_INDEX..VC_TCP_CONNECTIONS-1)
+    // Strict-priority lane for control frames (MISSING_NOTIFY and future ones): sent
+    // ahead of resends and data, never behind the send-queue backlog.
+    MpscQueueSp controlQueue;
+    static constexpr size_t CONTROL_QUEUE_CAPACITY = 256;
 
     std::vector<std::shared_ptr<ConnSendStats>> connSendStats;
 
-    std::vector<std::unique_ptr<SpscQueue<DeliveryItem>>> connReceiveQueues;
+    // Published copy of connections / connSendStats / socketStatuses for lock-free
+    // readers (IO thread, send thread, getNetworkScore, health log). The vectors above
+    // stay the writer's copy, updated under disconnectMutex.
+    SharedConnectionTableSp connTable;
+    void publishConnectionTable();
+
+    // One per connection, IO thread -> reorder thread. The queue index is the source connection.
+    std::vector<std::unique_ptr<SpscQueue<TcpVCIoThread::DataFrame>>> connReceiveQueues;
     std::atomic<uint64_t> reorderEnqueueSeq{0};
+    std::atomic<bool> reorderKick{false}; // timers changed: see kickReorderThread()
     std::mutex reorderMutex;
     std::condition_variable reorderCv;
 
-    std::map<uint64_t, ReceivedItem> receivedDataMap;
+    ReorderWindow reorderWindow;
 
     mutable std::mutex disconnectMutex;
 
@@ -140,32 +267,75 @@ class TcpVirtualChannel : public VirtualChannel, public std::enable_shared_from_
 
     std::atomic<bool> opened{false};
     std::atomic<uint64_t> lastSendMessageId{0}; // uint64_t: long is 32-bit on Windows (MSVC)
-    std::atomic<uint64_t> nextMessageId{0};
-    std::chrono::steady_clock::time_point gapFirstSeen;
+    std::atomic<uint64_t> nextMessageId{0}; // mirrors reorderWindow.base() for readers off the reorder thread
     bool gapTimerActive{false};
     int lastDeliveredConnIndex{-1};
     std::chrono::steady_clock::time_point lastHealthLogTime;
-    std::chrono::milliseconds reorderTimeoutMs{4000};
+    std::chrono::steady_clock::time_point lastPathRefresh;
+    std::shared_ptr<ReorderTimeoutStats> reorderTimeoutStats = std::make_shared<ReorderTimeoutStats>();
+    ReorderTimeoutEstimator reorderTimeout{reorderTimeoutStats};
+    // The gap at the head of the window (reorder thread): its first ID, and since when
+    // it is open. The reorder timeout runs per head gap.
+    uint64_t headGapBase{0};
+    std::chrono::steady_clock::time_point headGapSince;
+    // The IDs the last reorder timeout skipped, [skippedFrom, skippedTo), and when their
+    // gap opened: a late arrival among them means the timeout was too short.
+    uint64_t skippedFrom{0};
+    uint64_t skippedTo{0};
+    std::chrono::steady_clock::time_point skippedGapSince;
+    // Reorder-thread only; reported by the health log. The peak resets with each report.
+    uint64_t reorderTimeoutSkips{0};
+    size_t reorderDepthPeak{0};
 
     std::vector<uint64_t> lastRxMessageId;
     std::vector<std::chrono::steady_clock::time_point> lastRxTime;
     std::vector<bool> lastRxValid;
 
     std::shared_ptr<MessageTracker> messageTracker;
+    // Outlives any one send thread, so the health log can read it without racing close().
+    std::shared_ptr<SendWriteStats> sendWriteStats = std::make_shared<SendWriteStats>();
+    std::shared_ptr<ControlLaneStats> controlLaneStats = std::make_shared<ControlLaneStats>();
+    std::shared_ptr<FlowQueueStats> flowQueueStats = std::make_shared<FlowQueueStats>();
+    SchedulerPolicy schedulerPolicy = SchedulerPolicy::EarliestDelivery;
+    RateLimit pacingRate;
+    std::chrono::microseconds codelTarget = VC_CODEL_TARGET;
+    std::chrono::microseconds codelInterval = VC_CODEL_INTERVAL;
+    bool congestionControl = false;
+    std::chrono::microseconds congestionTarget = VC_CC_QUEUE_DELAY_TARGET;
+    std::shared_ptr<CongestionControlStats> congestionStats = std::make_shared<CongestionControlStats>();
     std::vector<std::shared_ptr<SocketStatus>> socketStatuses;
 
-    std::unordered_set<uint64_t> notifiedMissingIds;
+    bool fecEnabled = false;
+    FecConfig fecConfig;
+    std::shared_ptr<FecStats> fecStats = std::make_shared<FecStats>();
+    FecDecoder fecDecoder{fecStats};    // reorder thread
+    std::vector<uint64_t> recoveredIds; // scratch for recoverFromParity
+
+    std::shared_ptr<GapStats> gapStats = std::make_shared<GapStats>();
+    GapTracker gapTracker{gapStats};         // reorder thread
+    std::vector<MissingRange> missingRanges; // scratch for sendMissingNotifications
     std::chrono::steady_clock::time_point lastNotifyTime;
     std::chrono::milliseconds missingNotifyIntervalMs{200};
 
     // IDs enqueued for resend but not yet confirmed received by the peer.
     // Prevents re-enqueuing the same ID on every successive MISSING_NOTIFY.
-    // Entries expire after pendingResendTtl so dropped resends can be retried.
-    std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> pendingResendIds;
+    // Entries expire after pendingResendTtl (or the RTO, if shorter) so dropped resends can be retried.
+    // Ordered, so an ACK releases everything below its watermark from the front.
+    std::map<uint64_t, std::chrono::steady_clock::time_point> pendingResendIds;
     static constexpr std::chrono::milliseconds pendingResendTtl{2000};
 
     SentDataCache sentDataCache;
 
+    // Acknowledgements. Sender: which sent messages await an ACK (created per open()).
+    // Receiver (reorder thread): what arrived since the last ACK went out.
+    std::shared_ptr<AckTracker> ackTracker;
+    std::shared_ptr<AckStats> ackStats = std::make_shared<AckStats>();
+    bool acksEnabled = false;
+    size_t framesSinceAck{0};
+    bool ackDirty{false}; // the window moved without new frames (reorder timeout skip)
+    std::chrono::steady_clock::time_point lastAckSent;
+    std::vector<uint64_t> retransmitIds; // scratch for retransmitExpired()
+
     std::function<void(uint64_t messageId, const char *data, size_t size)> resendCallback;
-    std::function<void(const std::vector<uint64_t> &missingIds)> missingNotifyCallback;
+    std::function<void(const std::vector<MissingRange> &ranges)> missingNotifyCallback;
 };
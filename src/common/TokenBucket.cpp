@@ -0,0 +1,126 @@
+#include "TokenBucket.h"
+#include <algorithm>
+#include <cctype>
+#include <format>
+
+uint64_t RateLimit::effectiveBurst() const
+{
+    if (burstBytes > 0)
+        return burstBytes;
+    return std::max(bytesPerSec * DEFAULT_BURST_MS / 1000, MIN_BURST_BYTES);
+}
+
+namespace
+{
+bool ParseBytes(const std::string &text, uint64_t &out)
+{
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0])))
+        return false;
+    size_t pos = 0;
+    uint64_t value = 0;
+    try
+    {
+        value = std::stoull(text, &pos);
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+    std::string suffix = text.substr(pos);
+    uint64_t multiplier = 1;
+    if (suffix == "K" || suffix == "k")
+        multiplier = 1024;
+    else if (suffix == "M" || suffix == "m")
+        multiplier = 1024 * 1024;
+    else if (suffix == "G" || suffix == "g")
+        multiplier = 1024ull * 1024 * 1024;
+    else if (!suffix.empty())
+        return false;
+    if (value > UINT64_MAX / multiplier)
+        return false; // would wrap to some other rate
+    out = value * multiplier;
+    return true;
+}
+} // namespace
+
+bool RateLimit::parse(const std::string &text, RateLimit &out)
+{
+    RateLimit limit;
+    size_t colon = text.find(':');
+    if (!ParseBytes(text.substr(0, colon), limit.bytesPerSec))
+        return false;
+    if (colon != std::string::npos && !ParseBytes(text.substr(colon + 1), limit.burstBytes))
+        return false;
+    out = limit;
+    return true;
+}
+
+std::string RateLimit::format() const
+{
+    if (unlimited())
+        return "unlimited";
+    return std::format("{}KB/s burst {}KB", bytesPerSec / 1024, effectiveBurst() / 1024);
+}
+
+TokenBucket::TokenBucket(const RateLimit &limit, Clock::time_point now)
+    : rate(static_cast<double>(limit.bytesPerSec)),
+      burst(limit.unlimited() ? 0.0 : static_cast<double>(limit.effectiveBurst())),
+      tokens(burst),
+      last(now)
+{
+}
+
+void TokenBucket::setLimit(const RateLimit &limit, Clock::time_point now)
+{
+    if (limit.unlimited())
+    {
+        *this = TokenBucket();
+        return;
+    }
+    if (unlimited())
+    {
+        *this = TokenBucket(limit, now);
+        return;
+    }
+    refill(now);
+    rate = static_cast<double>(limit.bytesPerSec);
+    burst = static_cast<double>(limit.effectiveBurst());
+    tokens = std::min(tokens, burst);
+}
+
+void TokenBucket::refill(Clock::time_point now)
+{
+    if (now <= last)
+        return;
+    double elapsed = std::chrono::duration<double>(now - last).count();
+    tokens = std::min(burst, tokens + elapsed * rate);
+    last = now;
+}
+
+double TokenBucket::needed(size_t bytes) const
+{
+    return std::min(static_cast<double>(bytes), burst);
+}
+
+bool TokenBucket::tryConsume(size_t bytes, Clock::time_point now)
+{
+    if (unlimited())
+        return true;
+    refill(now);
+    if (tokens < needed(bytes))
+        return false;
+    tokens -= static_cast<double>(bytes);
+    return true;
+}
+
+TokenBucket::Clock::duration TokenBucket::timeUntil(size_t bytes, Clock::time_point now)
+{
+    if (unlimited())
+        return Clock::duration::zero();
+    refill(now);
+    double missing = needed(bytes) - tokens;
+    if (missing <= 0)
+        return Clock::duration::zero();
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(missing / rate)) +
+           Clock::duration(1);
+}
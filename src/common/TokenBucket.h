@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// A byte rate with a burst allowance. bytesPerSec == 0 means unlimited.
+struct RateLimit
+{
+    uint64_t bytesPerSec = 0;
+    uint64_t burstBytes = 0; // 0: DEFAULT_BURST_MS worth of the rate
+
+    static constexpr uint64_t DEFAULT_BURST_MS = 50;
+    static constexpr uint64_t MIN_BURST_BYTES = 16 * 1024; // a few full frames
+
+    bool unlimited() const
+    {
+        return bytesPerSec == 0;
+    }
+    /// burstBytes, or the default derived from the rate.
+    uint64_t effectiveBurst() const;
+
+    /// Parses "RATE[:BURST]", each a byte count with an optional K, M or G suffix
+    /// (powers of 1024), e.g. "2M:256K". Returns false on malformed input.
+    static bool parse(const std::string &text, RateLimit &out);
+    std::string format() const;
+
+    bool operator==(const RateLimit &) const = default;
+};
+
+/// Token bucket over bytes: tokens accrue at the limit's rate up to its burst, and a
+/// packet may pass once there are tokens for it. A packet larger than the burst passes
+/// when the bucket is full, so oversized packets are slowed, not blocked forever.
+///
+/// Not thread-safe: each user (a receive thread, a send thread) owns its bucket.
+class TokenBucket
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    TokenBucket() = default; // unlimited
+    explicit TokenBucket(const RateLimit &limit, Clock::time_point now = Clock::now());
+
+    bool unlimited() const
+    {
+        return rate == 0;
+    }
+
+    /// Change the rate without starting over: accrued tokens carry across, capped at
+    /// the new burst. An unlimited limit turns the bucket off.
+    void setLimit(const RateLimit &limit, Clock::time_point now = Clock::now());
+
+    /// Take tokens for `bytes` if they are available.
+    bool tryConsume(size_t bytes, Clock::time_point now = Clock::now());
+
+    /// How long until tryConsume(bytes) would succeed; zero if it would now.
+    Clock::duration timeUntil(size_t bytes, Clock::time_point now = Clock::now());
+
+  private:
+    void refill(Clock::time_point now);
+    double needed(size_t bytes) const;
+
+    double rate = 0;  // bytes per second
+    double burst = 0; // bytes
+    double tokens = 0;
+    Clock::time_point last{};
+};
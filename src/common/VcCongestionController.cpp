@@ -0,0 +1,202 @@
+#include "VcCongestionController.h"
+#include <algorithm>
+
+namespace
+{
+// ProbeBw gain cycle: probe above the estimate, drain what that queued, then cruise.
+constexpr double PROBE_BW_GAINS[] = {1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+constexpr size_t PROBE_BW_PHASES = sizeof(PROBE_BW_GAINS) / sizeof(PROBE_BW_GAINS[0]);
+} // namespace
+
+const char *CongestionStateName(CongestionState state)
+{
+    switch (state)
+    {
+    case CongestionState::Startup:
+        return "startup";
+    case CongestionState::Drain:
+        return "drain";
+    case CongestionState::ProbeBw:
+        return "probe-bw";
+    case CongestionState::ProbeRtt:
+        return "probe-rtt";
+    }
+    return "unknown";
+}
+
+VcCongestionController::VcCongestionController(std::chrono::microseconds queueDelayTarget,
+                                               std::shared_ptr<CongestionControlStats> stats_)
+    : target(queueDelayTarget), stats(stats_ ? std::move(stats_) : std::make_shared<CongestionControlStats>())
+{
+}
+
+uint64_t VcCongestionController::bottleneckBandwidth() const
+{
+    return bwSamples.empty() ? 0 : static_cast<uint64_t>(bwSamples.front().bytesPerSec);
+}
+
+VcCongestionController::Clock::duration VcCongestionController::bwWindow() const
+{
+    // About ten round trips, as in BBR, but never shorter than a few samples.
+    Clock::duration rounds = std::chrono::microseconds(static_cast<int64_t>(minRttUs) * 10);
+    return std::max<Clock::duration>(rounds, MIN_BW_WINDOW);
+}
+
+void VcCongestionController::updateBandwidth(const Sample &sample, double rate)
+{
+    // An application-limited interval only shows what was offered, not what the path
+    // can carry, so it may raise the estimate but never lower it.
+    if (sample.appLimited && rate < static_cast<double>(bottleneckBandwidth()))
+        return;
+    while (!bwSamples.empty() && bwSamples.back().bytesPerSec <= rate)
+        bwSamples.pop_back();
+    bwSamples.push_back({sample.now, rate});
+    while (bwSamples.size() > 1 && sample.now - bwSamples.front().at > bwWindow())
+        bwSamples.pop_front();
+}
+
+void VcCongestionController::updateMinRtt(const Sample &sample)
+{
+    if (sample.minSrttUs == 0)
+        return;
+    if (minRttUs == 0 || sample.minSrttUs <= minRttUs)
+    {
+        minRttUs = sample.minSrttUs;
+        minRttAt = sample.now;
+    }
+}
+
+uint64_t VcCongestionController::onSample(const Sample &sample)
+{
+    if (!havePrevious)
+    {
+        havePrevious = true;
+        previousAt = sample.now;
+        previousDelivered = sample.deliveredBytes;
+        updateMinRtt(sample);
+        publish(0);
+        return pacingRateBps;
+    }
+    auto elapsed = std::chrono::duration<double>(sample.now - previousAt).count();
+    if (elapsed <= 0)
+        return pacingRateBps;
+    uint64_t delivered = sample.deliveredBytes >= previousDelivered ? sample.deliveredBytes - previousDelivered : 0;
+    previousAt = sample.now;
+    previousDelivered = sample.deliveredBytes;
+
+    updateBandwidth(sample, static_cast<double>(delivered) / elapsed);
+    bool minRttExpired = minRttUs != 0 && sample.now - minRttAt > MIN_RTT_WINDOW;
+    updateMinRtt(sample);
+
+    uint32_t queueDelayUs = (minRttUs != 0 && sample.avgSrttUs > minRttUs) ? sample.avgSrttUs - minRttUs : 0;
+
+    if (minRttUs == 0)
+    {
+        // No RTT data (no TCP_INFO): nothing to steer by.
+        pacingRateBps = 0;
+        publish(queueDelayUs);
+        return pacingRateBps;
+    }
+
+    if (minRttExpired && currentState != CongestionState::Startup && currentState != CongestionState::ProbeRtt)
+    {
+        currentState = CongestionState::ProbeRtt;
+        probeRttEnd = sample.now + PROBE_RTT_DURATION;
+        // Let this probe's samples replace the stale minimum.
+        minRttUs = sample.minSrttUs;
+        minRttAt = sample.now;
+    }
+    advanceState(sample, queueDelayUs);
+
+    double bw = static_cast<double>(bottleneckBandwidth());
+    double gain = 1.0;
+    switch (currentState)
+    {
+    case CongestionState::Startup:
+        pacingRateBps = 0; // each connection's own slow start finds the rate
+        publish(queueDelayUs);
+        return pacingRateBps;
+    case CongestionState::Drain:
+        gain = DRAIN_GAIN;
+        break;
+    case CongestionState::ProbeBw:
+        gain = PROBE_BW_GAINS[cycleIndex];
+        break;
+    case CongestionState::ProbeRtt:
+        gain = PROBE_RTT_GAIN;
+        break;
+    }
+    // The probe still runs: if the queue is someone else's, samples at the held rate
+    // alone would walk the estimate down a tenth per bandwidth window.
+    if (queueDelayUs > static_cast<uint64_t>(target.count()) && gain <= 1.0)
+        gain = std::min(gain, QUEUE_HOLD_GAIN);
+    pacingRateBps = std::max(static_cast<uint64_t>(bw * gain), MIN_PACING_RATE);
+    publish(queueDelayUs);
+    return pacingRateBps;
+}
+
+void VcCongestionController::advanceState(const Sample &sample, uint32_t queueDelayUs)
+{
+    const bool queueAboveTarget = queueDelayUs > static_cast<uint64_t>(target.count());
+    switch (currentState)
+    {
+    case CongestionState::Startup:
+    {
+        double bw = static_cast<double>(bottleneckBandwidth());
+        if (bw >= fullBw * STARTUP_EXIT_GROWTH)
+        {
+            fullBw = bw;
+            flatRounds = 0;
+        }
+        else if (!sample.appLimited)
+        {
+            flatRounds++;
+        }
+        // The bandwidth stopped growing, or the connections are already queueing well
+        // past the target: the path is full.
+        if (fullBw > 0 && (flatRounds >= STARTUP_FLAT_ROUNDS || (!sample.appLimited && queueDelayUs > 2 * target.count())))
+        {
+            currentState = CongestionState::Drain;
+            phaseStart = sample.now;
+        }
+        break;
+    }
+    case CongestionState::Drain:
+        // A queue that outlasts half the bandwidth window is not the one startup built.
+        if (!queueAboveTarget || sample.now - phaseStart >= bwWindow() / 2)
+        {
+            currentState = CongestionState::ProbeBw;
+            cycleIndex = 0;
+            phaseStart = sample.now;
+        }
+        break;
+    case CongestionState::ProbeBw:
+    {
+        // One phase per base RTT; with coarse samples that is one phase per sample.
+        auto phase = std::chrono::microseconds(minRttUs);
+        if (sample.now - phaseStart >= phase)
+        {
+            cycleIndex = (cycleIndex + 1) % PROBE_BW_PHASES;
+            phaseStart = sample.now;
+        }
+        break;
+    }
+    case CongestionState::ProbeRtt:
+        if (sample.now >= probeRttEnd)
+        {
+            currentState = CongestionState::ProbeBw;
+            cycleIndex = 2; // resume cruising rather than probing up straight away
+            phaseStart = sample.now;
+        }
+        break;
+    }
+}
+
+void VcCongestionController::publish(uint32_t queueDelayUs)
+{
+    stats->state.store(currentState, std::memory_order_relaxed);
+    stats->btlBwBytesPerSec.store(bottleneckBandwidth(), std::memory_order_relaxed);
+    stats->minRttUs.store(minRttUs, std::memory_order_relaxed);
+    stats->queueDelayUs.store(queueDelayUs, std::memory_order_relaxed);
+    stats->pacingRateBytesPerSec.store(pacingRateBps, std::memory_order_relaxed);
+}
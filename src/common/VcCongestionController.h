@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+enum class CongestionState : uint8_t
+{
+    Startup,  // rate unknown: not paced, measuring
+    Drain,    // below the estimate until the queue built in startup is gone
+    ProbeBw,  // at the estimate, briefly above it and below it in turn
+    ProbeRtt, // half rate for a moment so the path's base RTT can be re-measured
+};
+
+const char *CongestionStateName(CongestionState state);
+
+/// The controller's current view, published for getNetworkScore() and the health log.
+struct CongestionControlStats
+{
+    std::atomic<CongestionState> state{CongestionState::Startup};
+    std::atomic<uint64_t> btlBwBytesPerSec{0};
+    std::atomic<uint32_t> minRttUs{0};
+    std::atomic<uint32_t> queueDelayUs{0};
+    std::atomic<uint64_t> pacingRateBytesPerSec{0}; // 0: not paced
+};
+
+/// Aggregate congestion control for a VC's data connections, in the spirit of BBR.
+///
+/// Every connection runs its own kernel congestion control, so together they fill the
+/// bottleneck queue 24 times over. This controller looks at the VC as one flow: from
+/// periodic samples it keeps the bottleneck bandwidth (windowed max of the delivery
+/// rate) and the path's base RTT (windowed min of the connections' smoothed RTT), and
+/// paces the VC's total data rate at that bandwidth times a gain. Queueing delay is the
+/// connections' average RTT above the base RTT; whenever it is over the target the gain
+/// is held below 1 until the queue drains, so the delay stays near the target instead of
+/// growing with the number of connections. The short probes above the estimate go on
+/// regardless, so a queue built by cross traffic does not starve the VC.
+///
+/// Samples come from the send thread roughly every TCP_INFO refresh; without RTT data
+/// (no TCP_INFO) the VC is never paced. Owned by the send thread.
+class VcCongestionController
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Sample
+    {
+        Clock::time_point now;
+        uint64_t deliveredBytes = 0; // cumulative, all data connections
+        uint32_t minSrttUs = 0;      // lowest smoothed RTT among live connections; 0 if unknown
+        uint32_t avgSrttUs = 0;      // average over connections carrying data
+        bool appLimited = false;     // nothing was waiting to be sent during the interval
+    };
+
+    static constexpr double STARTUP_EXIT_GROWTH = 1.25;
+    static constexpr int STARTUP_FLAT_ROUNDS = 3;
+    static constexpr double DRAIN_GAIN = 0.75;
+    static constexpr double QUEUE_HOLD_GAIN = 0.9; // while the queue is above target
+    static constexpr double PROBE_RTT_GAIN = 0.5;
+    static constexpr std::chrono::seconds MIN_RTT_WINDOW{10};
+    static constexpr std::chrono::milliseconds PROBE_RTT_DURATION{200};
+    static constexpr std::chrono::seconds MIN_BW_WINDOW{1};
+    static constexpr uint64_t MIN_PACING_RATE = 128 * 1024; // bytes/s
+
+    explicit VcCongestionController(std::chrono::microseconds queueDelayTarget,
+                                    std::shared_ptr<CongestionControlStats> stats = nullptr);
+
+    /// Feed one sample. Returns the pacing rate in bytes per second, 0 for unpaced.
+    uint64_t onSample(const Sample &sample);
+
+    uint64_t pacingRate() const
+    {
+        return pacingRateBps;
+    }
+    CongestionState state() const
+    {
+        return currentState;
+    }
+    uint64_t bottleneckBandwidth() const;
+
+  private:
+    void updateBandwidth(const Sample &sample, double rate);
+    void updateMinRtt(const Sample &sample);
+    void advanceState(const Sample &sample, uint32_t queueDelayUs);
+    Clock::duration bwWindow() const;
+    void publish(uint32_t queueDelayUs);
+
+    const std::chrono::microseconds target;
+    std::shared_ptr<CongestionControlStats> stats;
+
+    CongestionState currentState = CongestionState::Startup;
+    bool havePrevious = false;
+    Clock::time_point previousAt{};
+    uint64_t previousDelivered = 0;
+
+    struct BwSample
+    {
+        Clock::time_point at;
+        double bytesPerSec;
+    };
+    std::deque<BwSample> bwSamples; // max filter: decreasing rates, increasing times
+
+    uint32_t minRttUs = 0;
+    Clock::time_point minRttAt{};
+
+    double fullBw = 0;
+    int flatRounds = 0;
+    size_t cycleIndex = 0;
+    Clock::time_point phaseStart{};
+    Clock::time_point probeRttEnd{};
+    uint64_t pacingRateBps = 0;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 
@@ -11,6 +12,9 @@ enum class VcPacketType : uint8_t {
   RESEND_REQUEST = 0x01,
   RESEND_RESPONSE = 0x02,
   MISSING_NOTIFY = 0x03,
+  ACK = 0x04,
+  MISSING_RANGES = 0x05,
+  FEC_PARITY = 0x06,
 };
 
 struct VCHeader
@@ -48,16 +52,80 @@ struct VCMissingNotify
     uint64_t missingIds[VC_MAX_MISSING_IDS_PER_NOTIFY];
 };
 
+// Gaps as runs: covers thousands of missing IDs in a few hundred bytes, where
+// MISSING_NOTIFY lists at most 64. Older peers drop the stream on it, so the receiver
+// sends MISSING_NOTIFY until the peer is known to be current (the same test as for
+// ACKs), at most VC_MAX_MISSING_NOTIFY_FRAMES per report; MISSING_NOTIFY is always
+// accepted.
+static constexpr size_t VC_MAX_MISSING_RANGES = 64;
+static constexpr size_t VC_MAX_MISSING_NOTIFY_FRAMES = 16;
+
+struct VCMissingRange
+{
+    uint32_t offset; // first missing ID, relative to the notify's base
+    uint32_t count;
+};
+
+struct VCMissingRanges
+{
+    VCHeader header; // messageId: the base the range offsets are relative to
+    uint8_t count;
+    VCMissingRange ranges[VC_MAX_MISSING_RANGES];
+};
+
+// SACK bitmap words in an ACK: the receiver reports up to 256 IDs past its watermark.
+static constexpr size_t VC_SACK_WORDS = 4;
+
+// Receiver state for the sender: header.messageId is the cumulative watermark (every
+// ID below it was delivered or skipped), and bit i of sackBitmap says ID
+// watermark + 1 + i is buffered. The watermark itself is never buffered.
+struct VCAck
+{
+    VCHeader header;
+    uint64_t sackBitmap[VC_SACK_WORDS];
+};
+
+// Forward error correction: one parity frame per group of up to VC_FEC_MAX_GROUP data
+// frames, each member sent on a different data connection. The parity payload is the
+// XOR of the members' payloads, zero-padded to the longest, so the receiver rebuilds
+// any one missing member from the others. Parity frames take no message ID of their
+// own.
+static constexpr size_t VC_FEC_MAX_GROUP = 16;
+
+struct VCFecParity
+{
+    VCHeader header;    // messageId: the group's first member
+    uint8_t count;      // members
+    uint16_t lengthXor; // XOR of the members' dataLength
+    uint16_t dataLength;
+    uint16_t offsets[VC_FEC_MAX_GROUP]; // member ID - header.messageId, ascending
+    // Followed by the dataLength parity bytes, right after offsets[count - 1].
+};
+
 const uint32_t VC_MIN_DATA_PACKET_SIZE = sizeof(VCDataPacket);
 const uint32_t VC_MIN_RESEND_REQUEST_SIZE = sizeof(VCResendRequest);
 const uint32_t VC_MIN_RESEND_RESPONSE_SIZE = sizeof(VCResendResponse);
 const uint32_t VC_MIN_MISSING_NOTIFY_SIZE = sizeof(VCMissingNotify);
+const uint32_t VC_ACK_SIZE = sizeof(VCAck);
+const uint32_t VC_MIN_MISSING_RANGES_SIZE = sizeof(VCHeader) + sizeof(uint8_t);
+const uint32_t VC_MIN_FEC_PARITY_SIZE = sizeof(VCHeader) + sizeof(uint8_t) + 2 * sizeof(uint16_t);
 
  // Max size of the data payload
 const uint16_t VC_MAX_DATA_PAYLOAD_SIZE = 2000;
 
 #pragma pack(pop)
 
+// A run of missing message IDs, decoded from MISSING_RANGES or MISSING_NOTIFY.
+struct MissingRange
+{
+    uint64_t first = 0;
+    uint64_t count = 0;
+};
+
+// Longest run a MISSING_RANGES frame may report: the sender's resend horizon
+// (SentDataCache / ReorderWindow capacity). Longer runs are malformed.
+constexpr uint64_t VC_MAX_MISSING_RUN = 1 << 16;
+
 // TCP Connections per virtual channel
 const uint8_t VC_TCP_CONNECTIONS = 32;
 
@@ -75,9 +143,53 @@ inline bool IsResendConnectionIndex(int index)
     return index >= VC_FIRST_RESEND_CONN_INDEX && index < VC_TCP_CONNECTIONS;
 }
 
-// Drop incoming UDP packets when any send queue exceeds this depth.
-// Prevents unbounded memory growth when the network can't keep up.
-// Increased from 500 to 1000 to reduce packet drops under WAN load.
-// At ~2KB/packet, 1000 packets ≈ 2MB queue depth, which adds at most
-// ~500ms of buffering at typical WAN throughput (32 Mbps).
-const size_t SEND_QUEUE_DROP_THRESHOLD = 1000;
+// Outgoing data is dropped on queueing delay, not depth: the send thread's flow queue
+// runs CoDel with these defaults (per VC: TcpVirtualChannel::setQueueDelayTarget()).
+// A depth threshold ignores frame size and link rate: 1000 frames were ~500ms of
+// buffering on a 32 Mbps path and a needless drop on a fast one.
+constexpr std::chrono::milliseconds VC_CODEL_TARGET{5};
+constexpr std::chrono::milliseconds VC_CODEL_INTERVAL{100};
+
+// Queueing delay the VC congestion controller aims for along the path, measured as the
+// data connections' RTT above the path's base RTT (per VC:
+// TcpVirtualChannel::setCongestionControl()).
+constexpr std::chrono::milliseconds VC_CC_QUEUE_DELAY_TARGET{10};
+
+// Acknowledgements. The receiver sends an ACK once VC_ACK_EVERY_FRAMES frames have
+// arrived since the last one, or VC_ACK_INTERVAL after the first of fewer; while gaps
+// remain it repeats an unchanged ACK every VC_ACK_REPEAT_INTERVAL. The sender times
+// each unacknowledged message out after its RTO (RFC 6298 over the delivery latency,
+// clamped to [VC_MIN_RTO, VC_MAX_RTO]) and retransmits it, at most
+// VC_MAX_RETRANSMITS times. Older peers drop the stream on an unknown frame type, so
+// a VC only sends ACKs once the peer has sent one, unless configured to start
+// (TcpVirtualChannel::setAcks()).
+constexpr std::chrono::milliseconds VC_ACK_INTERVAL{20};
+constexpr size_t VC_ACK_EVERY_FRAMES = 32;
+constexpr std::chrono::milliseconds VC_ACK_REPEAT_INTERVAL{200};
+constexpr std::chrono::milliseconds VC_INITIAL_RTO{1000};
+constexpr std::chrono::milliseconds VC_MIN_RTO{200};
+constexpr std::chrono::milliseconds VC_MAX_RTO{3000};
+constexpr uint8_t VC_MAX_RETRANSMITS = 4;
+
+// Reorder timeout: how long the receiver holds frames behind a gap before skipping it.
+// Adaptive by default (ReorderTimeoutEstimator): srtt + 4 * rttvar of how long head-of-
+// line gaps took to fill, never below the time a NACK-driven resend needs, clamped to
+// [VC_MIN_REORDER_TIMEOUT, VC_MAX_REORDER_TIMEOUT]; VC_INITIAL_REORDER_TIMEOUT until
+// the first gap fills.
+constexpr std::chrono::milliseconds VC_INITIAL_REORDER_TIMEOUT{4000};
+constexpr std::chrono::milliseconds VC_MIN_REORDER_TIMEOUT{300};
+constexpr std::chrono::milliseconds VC_MAX_REORDER_TIMEOUT{8000};
+
+// FEC (off by default, per VC: TcpVirtualChannel::setFec()). Data frames per parity
+// frame, adapted within [min, max] to the loss the peer reports; a group still open
+// after VC_FEC_MAX_HOLD is closed early so its parity never trails its members by more.
+constexpr size_t VC_FEC_GROUP_SIZE = 8;
+constexpr size_t VC_FEC_MIN_GROUP_SIZE = 2;
+constexpr std::chrono::milliseconds VC_FEC_MAX_HOLD{10};
+
+// Memory cap on queued outgoing data frames (~8MB), only reached if CoDel cannot keep
+// up, e.g. while no data connection is usable.
+const size_t SEND_QUEUE_HARD_LIMIT = 4096;
+
+// Send backlog at which NetworkScore::queueHealth reaches 0.
+const size_t SEND_QUEUE_UNHEALTHY_DEPTH = 1000;
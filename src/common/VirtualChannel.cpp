@@ -1,6 +1,12 @@
 #include "VirtualChannel.h"
+#include "VcProtocol.h"
 
 void VirtualChannel::setReceiveCallback(std::function<void(const char *data, size_t size)> callback)
 {
     receiveCallback = callback;
 }
+
+PacketBuffer VirtualChannel::allocateSendFrame()
+{
+    return PacketBuffer::allocate(VC_MAX_DATA_PAYLOAD_SIZE + 1, sizeof(VCDataPacket));
+}
@@ -1,8 +1,19 @@
 #pragma once
 
+#include "PacketBuffer.h"
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+
+// Where a datagram came from, for channels that queue flows fairly: datagrams with the
+// same flowId share a queue, and the IP TOS byte can ask for the low-latency class.
+struct FlowInfo
+{
+    uint64_t flowId = 0; // e.g. FlowIdOf() of the UDP source address
+    uint8_t tos = 0;
+};
+
 class VirtualChannel
 {
 
@@ -16,6 +27,29 @@ class VirtualChannel
     // Method to send data through the channel
     virtual void send(const char *data, size_t size) = 0;
 
+    // Borrow a frame buffer that a datagram can be received straight into. data()
+    // points at the payload area (one byte larger than the maximum payload, so an
+    // oversized datagram is detectable after truncation) and the frame reserves
+    // headroom for the channel's protocol header. Resize to the received length,
+    // then hand it over with sendFrame().
+    static PacketBuffer allocateSendFrame();
+
+    // Send a frame obtained from allocateSendFrame(), transferring ownership. The
+    // channel writes its header into the headroom in place, so the payload is not
+    // copied. The default implementation falls back to send().
+    virtual void sendFrame(PacketBuffer frame)
+    {
+        send(frame.data(), frame.size());
+    }
+
+    // As above, classifying the frame as part of `flow`. Channels without per-flow
+    // queueing ignore it.
+    virtual void sendFrame(PacketBuffer frame, const FlowInfo &flow)
+    {
+        (void)flow;
+        sendFrame(std::move(frame));
+    }
+
     // Method to check if the channel is open
     virtual bool isOpen() const = 0;
 
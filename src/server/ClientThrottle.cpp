@@ -0,0 +1,54 @@
+#include "ClientThrottle.h"
+#include <Log.h>
+#include <format>
+
+using namespace Logger;
+
+namespace
+{
+RateLimit PolicerLimit(const RateLimit &limit)
+{
+    RateLimit policer = limit;
+    policer.burstBytes = limit.effectiveBurst() * 2;
+    return policer;
+}
+} // namespace
+
+ClientThrottle::ClientThrottle(uint32_t clientId_, const RateLimit &limit_, Clock::time_point now)
+    : clientId(clientId_),
+      limit(limit_),
+      bucket(limit_.unlimited() ? TokenBucket() : TokenBucket(PolicerLimit(limit_), now)),
+      lastReport(now)
+{
+}
+
+bool ClientThrottle::admit(size_t bytes, Clock::time_point now)
+{
+    if (bucket.tryConsume(bytes, now))
+    {
+        admitted++;
+        admittedBytes += bytes;
+        return true;
+    }
+    dropped++;
+    droppedBytes += bytes;
+    return false;
+}
+
+void ClientThrottle::maybeReport(const SendWriteStats *egress, Clock::time_point now)
+{
+    if (limit.unlimited() || now - lastReport < REPORT_INTERVAL)
+        return;
+    lastReport = now;
+    log_info(format(egress));
+}
+
+std::string ClientThrottle::format(const SendWriteStats *egress) const
+{
+    std::string line = std::format("[THROTTLE] client={} limit={} in={} inKB={} dropped={} droppedKB={}", clientId,
+                                   limit.format(), admitted, admittedBytes / 1024, dropped, droppedBytes / 1024);
+    if (egress)
+        line += std::format(" pacingPauses={} pacingWaitMs={}", egress->pacingPauses.load(std::memory_order_relaxed),
+                            egress->pacingWaitUs.load(std::memory_order_relaxed) / 1000);
+    return line;
+}
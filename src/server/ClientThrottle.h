@@ -0,0 +1,48 @@
+#pragma once
+
+#include "TcpVCSendThread.h"
+#include "TokenBucket.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Ingress side of a client's rate limit, owned by the client's UDP receive thread.
+//
+// Datagrams beyond the client's rate are dropped before they reach the VC, so a heavy
+// client cannot make the server spend CPU and queue memory on traffic its VC is not
+// allowed to send. The VC's send thread paces what is admitted to the same rate; the
+// policer allows twice the pacer's burst so that short bursts are smoothed there
+// rather than dropped here.
+class ClientThrottle
+{
+  public:
+    using Clock = TokenBucket::Clock;
+    static constexpr std::chrono::seconds REPORT_INTERVAL{10};
+
+    ClientThrottle(uint32_t clientId, const RateLimit &limit, Clock::time_point now = Clock::now());
+
+    // False if a datagram of `bytes` must be dropped.
+    bool admit(size_t bytes, Clock::time_point now = Clock::now());
+
+    // Log a [THROTTLE] line for a rate-limited client at most every REPORT_INTERVAL.
+    // `egress` is the VC's send-thread counters, or null.
+    void maybeReport(const SendWriteStats *egress, Clock::time_point now = Clock::now());
+
+    std::string format(const SendWriteStats *egress) const;
+
+    uint64_t droppedFrames() const
+    {
+        return dropped;
+    }
+
+  private:
+    uint32_t clientId;
+    RateLimit limit;
+    TokenBucket bucket;
+    uint64_t admitted = 0;
+    uint64_t admittedBytes = 0;
+    uint64_t dropped = 0;
+    uint64_t droppedBytes = 0;
+    Clock::time_point lastReport;
+};
@@ -1,4 +1,5 @@
 #include "Server.h"
+#include "ClientThrottle.h"
 #include "Peer.h"
 #include "Protocol.h"
 #include "ReplaceSlotPolicy.h"
@@ -243,8 +244,15 @@ void Server::AcceptConnections()
             std::vector<SocketFd> fds = peer->GetSockets();
             VirtualChannelSp vc = VirtualChannelFactory::create(fds);
 
-            // Match client-side reorder timeout for WAN links.
-            ((TcpVirtualChannel *)vc.get())->setReorderTimeout(std::chrono::milliseconds(8000));
+            // The VC adapts its reorder timeout to the path; a configured value pins it.
+            if (auto reorderTimeout = ServerConfiguration::getInstance()->getReorderTimeout())
+                ((TcpVirtualChannel *)vc.get())->setReorderTimeout(*reorderTimeout);
+            if (auto fecGroupSize = ServerConfiguration::getInstance()->getFecGroupSize())
+                ((TcpVirtualChannel *)vc.get())->setFec(true, FecConfig{.groupSize = *fecGroupSize});
+            if (ServerConfiguration::getInstance()->getCongestionControl())
+                ((TcpVirtualChannel *)vc.get())->setCongestionControl(true);
+            if (ServerConfiguration::getInstance()->getAcks())
+                ((TcpVirtualChannel *)vc.get())->setAcks(true);
 
             // Add the virtual channel to the manager using client ID
             VcManager::getInstance().Add(clientId, vc);
@@ -327,12 +335,29 @@ void Server::AcceptConnections()
                 clientConnSlots.erase(clientId);
             });
 
+            SocketEnableRecvTos(udpSocket);
+
+            // Per-client rate limit: paced in the VC's send thread, policed on ingress below.
+            RateLimit rateLimit = ServerConfiguration::getInstance()->getRateLimit(clientId);
+            auto *tcpVc = dynamic_cast<TcpVirtualChannel *>(vc.get());
+            if (tcpVc)
+                tcpVc->setPacingRate(rateLimit);
+            if (!rateLimit.unlimited())
+                log_info(std::format("Client {} rate limited to {}", clientId, rateLimit.format()));
+
             // start a new thread to receive data from the UDP socket
-            std::thread([udpSocket, vc]() {
-                char buffer[VC_MAX_DATA_PAYLOAD_SIZE + VC_MIN_DATA_PACKET_SIZE];
+            std::thread([udpSocket, vc, tcpVc, clientId, rateLimit]() {
+                ClientThrottle throttle(clientId, rateLimit);
                 while (true)
                 {
-                    ssize_t receivedBytes = recv(udpSocket, buffer, sizeof(buffer), 0);
+                    // Receive into a VC frame with header headroom; sendFrame() fills the
+                    // header in place, so the payload is never copied.
+                    auto frame = VirtualChannel::allocateSendFrame();
+                    struct sockaddr_in srcAddr{};
+                    socklen_t srcAddrLen = sizeof(srcAddr);
+                    uint8_t tos = 0;
+                    ssize_t receivedBytes = RecvUdpDataWithTos(udpSocket, frame.data(), frame.size(), 0,
+                                                               (struct sockaddr *)&srcAddr, &srcAddrLen, &tos);
                     if (receivedBytes < 0)
                     {
                         log_error("Failed to receive data from UDP socket");
@@ -346,7 +371,12 @@ void Server::AcceptConnections()
                     else
                     {
                         log_debug(std::format("Received {} bytes from UDP socket", receivedBytes));
-                        vc->send(buffer, receivedBytes);
+                        auto now = ClientThrottle::Clock::now();
+                        throttle.maybeReport(tcpVc ? &tcpVc->getSendWriteStats() : nullptr, now);
+                        if (!throttle.admit(static_cast<size_t>(receivedBytes), now))
+                            continue;
+                        frame.resize(static_cast<size_t>(receivedBytes));
+                        vc->sendFrame(std::move(frame), FlowInfo{FlowIdOf(srcAddr), tos});
                     }
                 }
                 // Socket is closed by the disconnect callback; do not close it here.
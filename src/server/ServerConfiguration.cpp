@@ -1,4 +1,6 @@
 #include "ServerConfiguration.h"
+#include <climits>
+#include <stdexcept>
 
 ServerConfiguration* ServerConfiguration::instance = nullptr;
 
@@ -24,3 +26,72 @@ int ServerConfiguration::getUdpTargetPort() const {
 void ServerConfiguration::setUdpTargetPort(int port) {
     udpTargetPort = port;
 }
+
+RateLimit ServerConfiguration::getRateLimit(uint32_t clientId) const {
+    std::lock_guard<std::mutex> lock(rateLimitMutex);
+    auto it = clientRateLimits.find(clientId);
+    return it != clientRateLimits.end() ? it->second : defaultRateLimit;
+}
+
+void ServerConfiguration::setDefaultRateLimit(const RateLimit &limit) {
+    std::lock_guard<std::mutex> lock(rateLimitMutex);
+    defaultRateLimit = limit;
+}
+
+void ServerConfiguration::setClientRateLimit(uint32_t clientId, const RateLimit &limit) {
+    std::lock_guard<std::mutex> lock(rateLimitMutex);
+    clientRateLimits[clientId] = limit;
+}
+
+bool ServerConfiguration::parseClientRateLimit(const std::string &text) {
+    size_t eq = text.find('=');
+    if (eq == std::string::npos || eq == 0)
+        return false;
+    uint32_t clientId = 0;
+    try {
+        size_t pos = 0;
+        unsigned long value = std::stoul(text.substr(0, eq), &pos);
+        if (pos != eq || value > UINT32_MAX)
+            return false;
+        clientId = static_cast<uint32_t>(value);
+    } catch (const std::exception &) {
+        return false;
+    }
+    RateLimit limit;
+    if (!RateLimit::parse(text.substr(eq + 1), limit))
+        return false;
+    setClientRateLimit(clientId, limit);
+    return true;
+}
+
+std::optional<std::chrono::milliseconds> ServerConfiguration::getReorderTimeout() const {
+    return reorderTimeout;
+}
+
+void ServerConfiguration::setReorderTimeout(std::chrono::milliseconds timeout) {
+    reorderTimeout = timeout;
+}
+
+std::optional<size_t> ServerConfiguration::getFecGroupSize() const {
+    return fecGroupSize;
+}
+
+void ServerConfiguration::setFecGroupSize(size_t groupSize) {
+    fecGroupSize = groupSize;
+}
+
+bool ServerConfiguration::getCongestionControl() const {
+    return congestionControl;
+}
+
+void ServerConfiguration::setCongestionControl(bool enabled) {
+    congestionControl = enabled;
+}
+
+bool ServerConfiguration::getAcks() const {
+    return acks;
+}
+
+void ServerConfiguration::setAcks(bool enabled) {
+    acks = enabled;
+}
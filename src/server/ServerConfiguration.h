@@ -1,7 +1,14 @@
 #ifndef CONFIGURATION_H
 #define CONFIGURATION_H
 
+#include "TokenBucket.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
 
 class ServerConfiguration
 {
@@ -13,12 +20,47 @@ class ServerConfiguration
     int portNumber = 7001;
     int udpTargetPort = 7001;
 
+    mutable std::mutex rateLimitMutex;
+    RateLimit defaultRateLimit;
+    std::unordered_map<uint32_t, RateLimit> clientRateLimits;
+
+    std::optional<std::chrono::milliseconds> reorderTimeout;
+    std::optional<size_t> fecGroupSize;
+    bool congestionControl = false;
+    bool acks = false;
+
   public:
     static ServerConfiguration *getInstance();
     int getPortNumber() const;
     void setPortNumber(int port);
     int getUdpTargetPort() const;
     void setUdpTargetPort(int port);
+
+    // Per-client send rate: the override for clientId if one is set, else the default.
+    // Applied when the client's VC is created.
+    RateLimit getRateLimit(uint32_t clientId) const;
+    void setDefaultRateLimit(const RateLimit &limit);
+    void setClientRateLimit(uint32_t clientId, const RateLimit &limit);
+    // Parses "CLIENT_ID=RATE[:BURST]" (see RateLimit::parse) into an override.
+    bool parseClientRateLimit(const std::string &text);
+
+    // Fixed VC reorder timeout; unset means each VC adapts it to its path.
+    std::optional<std::chrono::milliseconds> getReorderTimeout() const;
+    void setReorderTimeout(std::chrono::milliseconds timeout);
+
+    // FEC on the VCs' outgoing data, starting at this many frames per parity frame;
+    // unset means no FEC.
+    std::optional<size_t> getFecGroupSize() const;
+    void setFecGroupSize(size_t groupSize);
+
+    // Pace each VC's data at the path's estimated bandwidth (off by default).
+    bool getCongestionControl() const;
+    void setCongestionControl(bool enabled);
+
+    // Send ACK frames from the start rather than once the client sends one; only for
+    // clients that understand them (off by default).
+    bool getAcks() const;
+    void setAcks(bool enabled);
 };
 
 #endif // CONFIGURATION_H
@@ -2,6 +2,7 @@
 #include "Server.h"
 #include "ServerConfiguration.h"
 #include <Log.h>
+#include <VcProtocol.h>
 #include <cstdlib>
 #include <iostream>
 #include <signal.h>
@@ -37,6 +38,17 @@ void printUsage(const char *programName)
     std::cout << "  --log-level=LEVEL       Set log level (DEBUG, INFO, WARNING, ERROR)" << std::endl;
     std::cout << "  --port=PORT             TCP listen port (default: 7001)" << std::endl;
     std::cout << "  --udp-target-port=PORT  UDP target port for outgoing data (default: same as --port)" << std::endl;
+    std::cout << "  --rate-limit=RATE[:BURST]" << std::endl;
+    std::cout << "                          Per-client send rate in bytes/s with optional burst bytes," << std::endl;
+    std::cout << "                          K/M/G suffixes allowed, e.g. 2M:256K (default: unlimited)" << std::endl;
+    std::cout << "  --client-rate-limit=ID=RATE[:BURST]" << std::endl;
+    std::cout << "                          Override the rate for one client ID; repeatable" << std::endl;
+    std::cout << "  --reorder-timeout=MS    Fixed VC reorder timeout (default: adapted to each path)" << std::endl;
+    std::cout << "  --fec=N                 Send FEC parity, starting at one per N data frames and" << std::endl;
+    std::cout << "                          adapted to loss (default: off)" << std::endl;
+    std::cout << "  --congestion-control    Pace each VC at the path's estimated bandwidth (default: off)" << std::endl;
+    std::cout << "  --acks                  Send ACKs from the start; every client must understand them" << std::endl;
+    std::cout << "                          (default: only once the client sends one)" << std::endl;
     std::cout << "  --help                  Display this help message" << std::endl;
 }
 
@@ -72,6 +84,52 @@ int main(int argc, char *argv[])
             int port = std::stoi(arg.substr(18));
             ServerConfiguration::getInstance()->setUdpTargetPort(port);
         }
+        else if (arg.find("--rate-limit=") == 0)
+        {
+            RateLimit limit;
+            if (!RateLimit::parse(arg.substr(13), limit))
+            {
+                std::cerr << "Invalid --rate-limit: " << arg.substr(13) << std::endl;
+                return 1;
+            }
+            ServerConfiguration::getInstance()->setDefaultRateLimit(limit);
+        }
+        else if (arg.find("--client-rate-limit=") == 0)
+        {
+            if (!ServerConfiguration::getInstance()->parseClientRateLimit(arg.substr(20)))
+            {
+                std::cerr << "Invalid --client-rate-limit: " << arg.substr(20) << std::endl;
+                return 1;
+            }
+        }
+        else if (arg.find("--reorder-timeout=") == 0)
+        {
+            int ms = std::stoi(arg.substr(18));
+            if (ms <= 0)
+            {
+                std::cerr << "Invalid --reorder-timeout: must be a positive number of milliseconds" << std::endl;
+                return 1;
+            }
+            ServerConfiguration::getInstance()->setReorderTimeout(std::chrono::milliseconds(ms));
+        }
+        else if (arg.find("--fec=") == 0)
+        {
+            int groupSize = std::stoi(arg.substr(6));
+            if (groupSize < 1 || static_cast<size_t>(groupSize) > VC_FEC_MAX_GROUP)
+            {
+                std::cerr << "Invalid --fec: group size must be 1-" << VC_FEC_MAX_GROUP << std::endl;
+                return 1;
+            }
+            ServerConfiguration::getInstance()->setFecGroupSize(static_cast<size_t>(groupSize));
+        }
+        else if (arg == "--congestion-control")
+        {
+            ServerConfiguration::getInstance()->setCongestionControl(true);
+        }
+        else if (arg == "--acks")
+        {
+            ServerConfiguration::getInstance()->setAcks(true);
+        }
     }
 
     Log::getInstance().setLogLevel(logLevel);
@@ -0,0 +1,121 @@
+#include "AckTracker.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST(AckTrackerTest, CumulativeAndSelectiveAcks)
+{
+    AckTracker tracker(64);
+    auto t0 = AckTracker::Clock::now();
+    for (uint64_t id = 10; id < 20; id++)
+        tracker.onSent(id, t0);
+
+    // Peer delivered up to 13 and holds 16 and 18.
+    uint64_t sack[VC_SACK_WORDS] = {(1u << 1) | (1u << 3)};
+    EXPECT_EQ(tracker.onAck(14, sack, VC_SACK_WORDS, t0 + 40ms), 6u);
+    // Repeating the ACK acknowledges nothing new.
+    EXPECT_EQ(tracker.onAck(14, sack, VC_SACK_WORDS, t0 + 50ms), 0u);
+    EXPECT_EQ(tracker.onAck(20, nullptr, 0, t0 + 60ms), 4u);
+}
+
+// Writes complete out of ID order across connections; each message is timed from its
+// own first write, and later writes of it change nothing.
+TEST(AckTrackerTest, TimesEachMessageFromItsFirstWrite)
+{
+    auto stats = std::make_shared<AckStats>();
+    AckTracker tracker(64, stats);
+    auto t0 = AckTracker::Clock::now();
+    tracker.onSent(0, t0);
+    tracker.onSent(2, t0 + 10ms);
+    tracker.onAck(0, nullptr, 0, t0 + 10ms);
+    EXPECT_EQ(stats->inFlight.load(), 2u); // 1 is not written yet
+    EXPECT_EQ(tracker.nextDeadline(), t0 + VC_INITIAL_RTO);
+
+    tracker.onSent(1, t0 + 20ms);
+    tracker.onSent(0, t0 + 30ms); // stall rescue rewrote it
+    EXPECT_EQ(stats->writes.load(), 4u);
+
+    std::vector<uint64_t> due;
+    tracker.collectExpired(due, t0 + VC_INITIAL_RTO);
+    EXPECT_EQ(due, (std::vector<uint64_t>{0}));
+    EXPECT_EQ(stats->inFlight.load(), 3u);
+    due.clear();
+    tracker.collectExpired(due, t0 + VC_INITIAL_RTO + 20ms);
+    EXPECT_EQ(due, (std::vector<uint64_t>{1, 2}));
+}
+
+TEST(AckTrackerTest, RetransmitsAfterRtoWithBackoff)
+{
+    auto stats = std::make_shared<AckStats>();
+    AckTracker tracker(64, stats);
+    auto t0 = AckTracker::Clock::now();
+    for (uint64_t id = 0; id < 4; id++)
+        tracker.onSent(id, t0);
+
+    // No timer runs until the peer shows it acknowledges at all.
+    std::vector<uint64_t> due;
+    tracker.collectExpired(due, t0 + 10s);
+    EXPECT_TRUE(due.empty());
+    EXPECT_EQ(tracker.nextDeadline(), AckTracker::Clock::time_point::max());
+
+    // 0 and 2 arrive after 100ms: the RTO follows the measured latency, but 1 and 3
+    // keep the initial timeout they were sent with.
+    uint64_t sack[VC_SACK_WORDS] = {1}; // ID 2
+    tracker.onAck(1, sack, VC_SACK_WORDS, t0 + 100ms);
+    EXPECT_EQ(stats->srttUs.load(), 100000u);
+    EXPECT_EQ(tracker.rto(), 250ms); // srtt 100ms + 4 * rttvar 37.5ms
+    EXPECT_EQ(tracker.nextDeadline(), t0 + VC_INITIAL_RTO);
+
+    tracker.collectExpired(due, t0 + VC_INITIAL_RTO - 1ms);
+    EXPECT_TRUE(due.empty());
+    auto t1 = t0 + VC_INITIAL_RTO;
+    tracker.collectExpired(due, t1);
+    EXPECT_EQ(due, (std::vector<uint64_t>{1, 3}));
+
+    // Backed off to twice the RTO.
+    EXPECT_EQ(tracker.nextDeadline(), t1 + 2 * tracker.rto());
+    due.clear();
+    tracker.collectExpired(due, t1 + 2 * tracker.rto() - 1ms);
+    EXPECT_TRUE(due.empty());
+
+    // A late ACK for a retransmitted message gives no latency sample (Karn).
+    tracker.onAck(4, nullptr, 0, t1 + 50ms);
+    EXPECT_EQ(stats->latencySamples.load(), 2u);
+    EXPECT_EQ(stats->inFlight.load(), 0u);
+    EXPECT_EQ(stats->retransmits.load(), 2u);
+}
+
+TEST(AckTrackerTest, AbandonsAfterMaxRetransmits)
+{
+    auto stats = std::make_shared<AckStats>();
+    AckTracker tracker(64, stats);
+    auto now = AckTracker::Clock::now();
+    tracker.onSent(0, now);
+    tracker.onAck(0, nullptr, 0, now);
+
+    std::vector<uint64_t> due;
+    for (int i = 0; i <= VC_MAX_RETRANSMITS; i++)
+    {
+        now += VC_MAX_RTO;
+        tracker.collectExpired(due, now);
+    }
+    EXPECT_EQ(due.size(), VC_MAX_RETRANSMITS);
+    EXPECT_EQ(stats->abandoned.load(), 1u);
+    EXPECT_EQ(stats->inFlight.load(), 0u);
+    EXPECT_EQ(tracker.nextDeadline(), AckTracker::Clock::time_point::max());
+}
+
+TEST(AckTrackerTest, OldestDropOutOfAFullRing)
+{
+    auto stats = std::make_shared<AckStats>();
+    AckTracker tracker(8, stats);
+    auto t0 = AckTracker::Clock::now();
+    for (uint64_t id = 0; id < 10; id++)
+        tracker.onSent(id, t0);
+    tracker.nextDeadline(); // sends are tracked once drained
+    EXPECT_EQ(stats->untracked.load(), 2u);
+    EXPECT_EQ(stats->inFlight.load(), 8u);
+    EXPECT_EQ(tracker.onAck(10, nullptr, 0, t0 + 1ms), 8u);
+}
@@ -5,16 +5,26 @@
 #include <thread>
 #include <vector>
 
+static PacketBuffer MakeBuffer(const std::vector<char> &bytes)
+{
+    return PacketBuffer::copyOf(bytes.data(), bytes.size());
+}
+
+static std::vector<char> ToVector(const PacketBuffer &buf)
+{
+    return std::vector<char>(buf.data(), buf.data() + buf.size());
+}
+
 // ─── Basic enqueue / dequeue ────────────────────────────────────────────────
 
 TEST(BlockingQueueTest, EnqueueDequeueSingleItem)
 {
     BlockingQueue q;
-    auto data = std::make_shared<std::vector<char>>(std::vector<char>{'a', 'b', 'c'});
+    auto data = MakeBuffer(std::vector<char>{'a', 'b', 'c'});
     q.enqueue(data);
     auto result = q.dequeue();
-    ASSERT_NE(result, nullptr);
-    EXPECT_EQ(*result, *data);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(ToVector(result), ToVector(data));
 }
 
 TEST(BlockingQueueTest, EnqueueDequeueMultipleItemsFIFO)
@@ -22,14 +32,14 @@ TEST(BlockingQueueTest, EnqueueDequeueMultipleItemsFIFO)
     BlockingQueue q;
     for (int i = 0; i < 5; ++i)
     {
-        auto data = std::make_shared<std::vector<char>>(std::vector<char>{static_cast<char>(i)});
-        q.enqueue(data);
+        auto data = MakeBuffer(std::vector<char>{static_cast<char>(i)});
+        q.enqueue(std::move(data));
     }
     for (int i = 0; i < 5; ++i)
     {
         auto result = q.dequeue();
-        ASSERT_NE(result, nullptr);
-        EXPECT_EQ(result->at(0), static_cast<char>(i));
+        ASSERT_TRUE(result);
+        EXPECT_EQ(result.data()[0], static_cast<char>(i));
     }
 }
 
@@ -37,10 +47,10 @@ TEST(BlockingQueueTest, EnqueuePreservesDataContents)
 {
     BlockingQueue q;
     std::vector<char> payload = {'h', 'e', 'l', 'l', 'o'};
-    q.enqueue(std::make_shared<std::vector<char>>(payload));
+    q.enqueue(MakeBuffer(payload));
     auto result = q.dequeue();
-    ASSERT_NE(result, nullptr);
-    EXPECT_EQ(*result, payload);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(ToVector(result), payload);
 }
 
 // ─── Blocking behaviour ─────────────────────────────────────────────────────
@@ -53,25 +63,24 @@ TEST(BlockingQueueTest, DequeueBlocksUntilEnqueue)
 
     std::thread consumer([&]() {
         auto result = q.dequeue();
-        received = (result != nullptr);
+        received = static_cast<bool>(result);
     });
 
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
     EXPECT_FALSE(received.load()); // still blocked
 
-    q.enqueue(std::make_shared<std::vector<char>>(std::vector<char>{'x'}));
+    q.enqueue(MakeBuffer(std::vector<char>{'x'}));
     consumer.join();
     EXPECT_TRUE(received.load());
 }
 
 // ─── cancelWait ─────────────────────────────────────────────────────────────
 
-// cancelWait unblocks a waiting dequeue and makes it return nullptr
+// cancelWait unblocks a waiting dequeue and makes it return an empty buffer
 TEST(BlockingQueueTest, CancelWaitUnblocksDequeue)
 {
     BlockingQueue q;
-    std::shared_ptr<std::vector<char>> result =
-        std::make_shared<std::vector<char>>(std::vector<char>{1}); // non-null sentinel
+    PacketBuffer result = MakeBuffer(std::vector<char>{1}); // non-empty sentinel
 
     std::thread consumer([&]() { result = q.dequeue(); });
 
@@ -79,10 +88,10 @@ TEST(BlockingQueueTest, CancelWaitUnblocksDequeue)
     q.cancelWait();
     consumer.join();
 
-    EXPECT_EQ(result, nullptr);
+    EXPECT_FALSE(result);
 }
 
-// Once cancelled, dequeue returns nullptr immediately without blocking
+// Once cancelled, dequeue returns an empty buffer immediately without blocking
 TEST(BlockingQueueTest, CancelledQueueReturnsNullImmediately)
 {
     BlockingQueue q;
@@ -92,19 +101,19 @@ TEST(BlockingQueueTest, CancelledQueueReturnsNullImmediately)
     auto result = q.dequeue();
     auto elapsed = std::chrono::steady_clock::now() - start;
 
-    EXPECT_EQ(result, nullptr);
+    EXPECT_FALSE(result);
     EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), 100);
 }
 
-// After cancelWait, dequeue returns nullptr even when data was already enqueued
+// After cancelWait, dequeue returns an empty buffer even when data was already enqueued
 TEST(BlockingQueueTest, CancelWaitTakesPriorityOverEnqueuedData)
 {
     BlockingQueue q;
-    q.enqueue(std::make_shared<std::vector<char>>(std::vector<char>{'z'}));
+    q.enqueue(MakeBuffer(std::vector<char>{'z'}));
     q.cancelWait();
 
     auto result = q.dequeue();
-    EXPECT_EQ(result, nullptr);
+    EXPECT_FALSE(result);
 }
 
 // cancelWait must unblock all concurrently waiting consumers
@@ -119,7 +128,7 @@ TEST(BlockingQueueTest, CancelWaitUnblocksMultipleConsumers)
     {
         consumers.emplace_back([&]() {
             auto result = q.dequeue();
-            if (result == nullptr)
+            if (!result)
                 nullCount++;
         });
     }
@@ -145,8 +154,8 @@ TEST(BlockingQueueTest, ConcurrentEnqueueDequeue)
     std::thread producer([&]() {
         for (int i = 0; i < N; ++i)
         {
-            auto data = std::make_shared<std::vector<char>>(std::vector<char>{static_cast<char>(i & 0xFF)});
-            q.enqueue(data);
+            auto data = MakeBuffer(std::vector<char>{static_cast<char>(i & 0xFF)});
+            q.enqueue(std::move(data));
         }
     });
 
@@ -154,7 +163,7 @@ TEST(BlockingQueueTest, ConcurrentEnqueueDequeue)
         for (int i = 0; i < N; ++i)
         {
             auto result = q.dequeue();
-            if (result != nullptr)
+            if (result)
                 receivedCount++;
         }
     });
@@ -179,7 +188,7 @@ TEST(BlockingQueueTest, MultipleProducersSingleConsumer)
     {
         producerThreads.emplace_back([&]() {
             for (int i = 0; i < itemsPerProducer; ++i)
-                q.enqueue(std::make_shared<std::vector<char>>(std::vector<char>{'x'}));
+                q.enqueue(MakeBuffer(std::vector<char>{'x'}));
         });
     }
 
@@ -187,7 +196,7 @@ TEST(BlockingQueueTest, MultipleProducersSingleConsumer)
         while (receivedCount.load() < total)
         {
             auto result = q.dequeue();
-            if (result != nullptr)
+            if (result)
                 receivedCount++;
         }
     });
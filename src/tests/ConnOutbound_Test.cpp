@@ -0,0 +1,311 @@
+#include "ConnOutbound.h"
+#include "Socket.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+// Connected loopback pair with a non-blocking sender. `minimalSendBuffer` clamps the
+// sender's SO_SNDBUF so a single flush of a large frame is guaranteed to stop mid-frame.
+std::pair<SocketFd, SocketFd> MakeSenderPair(bool minimalSendBuffer)
+{
+    SocketFd listenFd = SocketCreate(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = 0;
+    SocketBind(listenFd, (sockaddr *)&addr, sizeof(addr));
+    socklen_t addrLen = sizeof(addr);
+    getsockname(listenFd, (sockaddr *)&addr, &addrLen);
+    SocketListen(listenFd, 1);
+
+    SocketFd sender = SocketCreate(AF_INET, SOCK_STREAM, 0);
+    SocketConnect(sender, (sockaddr *)&addr, sizeof(addr));
+    sockaddr_in peer{};
+    socklen_t peerLen = sizeof(peer);
+    SocketFd receiver = SocketAccept(listenFd, (sockaddr *)&peer, &peerLen);
+    SocketClose(listenFd);
+
+    if (minimalSendBuffer)
+    {
+        int tiny = 1;
+        setsockopt(sender, SOL_SOCKET, SO_SNDBUF, (const char *)&tiny, sizeof(tiny));
+    }
+    SetSocketNonBlocking(sender);
+    return {sender, receiver};
+}
+
+PacketBuffer MakeFrame(char fill, size_t size)
+{
+    std::string bytes(size, fill);
+    return PacketBuffer::copyOf(bytes.data(), bytes.size());
+}
+} // namespace
+
+TEST(ConnOutboundTest, PushFailsWhenFull)
+{
+    ConnOutbound out(3); // rounded up to 4
+    EXPECT_EQ(out.capacity(), 4u);
+    for (int i = 0; i < 4; i++)
+    {
+        auto f = MakeFrame('a', 10);
+        ASSERT_TRUE(out.push(f));
+    }
+    auto extra = MakeFrame('b', 10);
+    EXPECT_FALSE(out.push(extra));
+    EXPECT_TRUE(extra); // left with the caller
+    EXPECT_TRUE(out.full());
+    EXPECT_EQ(out.pendingBytes(), 40u);
+}
+
+// Frames larger than the loopback socket buffers: flush() returns WouldBlock mid-frame and
+// later calls resume at the cursor, so the receiver sees every byte once, in order.
+TEST(ConnOutboundTest, PartialWritesResumeAtCursor)
+{
+    auto [sender, receiver] = MakeSenderPair(false);
+    ConnOutbound out;
+    const size_t frameSize = 8 * 1024 * 1024;
+    for (char c : std::string("wxyz"))
+    {
+        auto f = MakeFrame(c, frameSize);
+        ASSERT_TRUE(out.push(f));
+    }
+
+    std::vector<PacketBuffer> completed;
+    ConnOutbound::WriteCounts counts;
+    std::string received;
+    bool sawWouldBlock = false;
+    bool sawMidFrame = false;
+    std::vector<char> buf(256 * 1024);
+    while (received.size() < 4 * frameSize)
+    {
+        auto result = out.flush(sender, completed, counts);
+        ASSERT_NE(result, ConnOutbound::FlushResult::Error);
+        if (result == ConnOutbound::FlushResult::WouldBlock)
+        {
+            sawWouldBlock = true;
+            sawMidFrame |= out.midFrame();
+        }
+        ssize_t n = RecvTcpDirect(receiver, buf.data(), buf.size(), 0);
+        if (n > 0)
+            received.append(buf.data(), static_cast<size_t>(n));
+    }
+
+    EXPECT_TRUE(sawWouldBlock);
+    EXPECT_TRUE(sawMidFrame);
+    EXPECT_TRUE(out.empty());
+    EXPECT_EQ(out.pendingBytes(), 0u);
+    ASSERT_EQ(completed.size(), 4u);
+    EXPECT_EQ(counts.bytes, 4 * frameSize);
+    for (size_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(completed[i].size(), frameSize);
+        EXPECT_EQ(received.compare(i * frameSize, frameSize, std::string(frameSize, "wxyz"[i])), 0);
+    }
+
+    SocketClose(sender);
+    SocketClose(receiver);
+}
+
+TEST(ConnOutboundTest, TakeAllReturnsPartlyWrittenFrameWhole)
+{
+    auto [sender, receiver] = MakeSenderPair(true);
+    ConnOutbound out;
+    const size_t frameSize = 1024 * 1024;
+    auto first = MakeFrame('p', frameSize);
+    auto second = MakeFrame('q', 100);
+    ASSERT_TRUE(out.push(first));
+    ASSERT_TRUE(out.push(second));
+
+    std::vector<PacketBuffer> completed;
+    ConnOutbound::WriteCounts counts;
+    ASSERT_EQ(out.flush(sender, completed, counts), ConnOutbound::FlushResult::WouldBlock);
+    EXPECT_TRUE(completed.empty());
+    ASSERT_TRUE(out.midFrame());
+    EXPECT_LT(out.pendingBytes(), frameSize + 100);
+
+    std::vector<PacketBuffer> reclaimed;
+    out.takeAll(reclaimed);
+    ASSERT_EQ(reclaimed.size(), 2u);
+    EXPECT_EQ(reclaimed[0].size(), frameSize);
+    EXPECT_EQ(reclaimed[0].data()[0], 'p');
+    EXPECT_EQ(reclaimed[1].size(), 100u);
+    EXPECT_TRUE(out.empty());
+    EXPECT_FALSE(out.midFrame());
+    EXPECT_EQ(out.pendingBytes(), 0u);
+
+    SocketClose(sender);
+    SocketClose(receiver);
+}
+
+// Quarantine moves the unwritten frames away but the partly written one stays, so the
+// stream can still be completed if the connection recovers.
+TEST(ConnOutboundTest, TakeUnstartedKeepsPartlyWrittenFrame)
+{
+    auto [sender, receiver] = MakeSenderPair(true);
+    ConnOutbound out;
+    const size_t frameSize = 1024 * 1024;
+    auto first = MakeFrame('p', frameSize);
+    auto second = MakeFrame('q', 100);
+    auto third = MakeFrame('r', 200);
+    ASSERT_TRUE(out.push(first));
+    ASSERT_TRUE(out.push(second));
+    ASSERT_TRUE(out.push(third));
+
+    std::vector<PacketBuffer> completed;
+    ConnOutbound::WriteCounts counts;
+    ASSERT_EQ(out.flush(sender, completed, counts), ConnOutbound::FlushResult::WouldBlock);
+    ASSERT_TRUE(out.midFrame());
+    size_t frontRemaining = out.pendingBytes() - 300;
+
+    std::vector<PacketBuffer> moved;
+    out.takeUnstarted(moved);
+    ASSERT_EQ(moved.size(), 2u);
+    EXPECT_EQ(moved[0].data()[0], 'q');
+    EXPECT_EQ(moved[1].data()[0], 'r');
+    EXPECT_EQ(out.size(), 1u);
+    EXPECT_TRUE(out.midFrame());
+    EXPECT_EQ(out.pendingBytes(), frontRemaining);
+    EXPECT_EQ(out.front().data()[0], 'p');
+
+    // Nothing partly written: everything moves.
+    ConnOutbound fresh;
+    auto f = MakeFrame('s', 10);
+    ASSERT_TRUE(fresh.push(f));
+    fresh.takeUnstarted(moved);
+    EXPECT_EQ(moved.size(), 3u);
+    EXPECT_TRUE(fresh.empty());
+
+    SocketClose(sender);
+    SocketClose(receiver);
+}
+
+TEST(ConnOutboundTest, DeadSocketReportsError)
+{
+    ConnOutbound out;
+    auto f = MakeFrame('e', 10);
+    ASSERT_TRUE(out.push(f));
+    std::vector<PacketBuffer> completed;
+    ConnOutbound::WriteCounts counts;
+    EXPECT_EQ(out.flush((SocketFd)-1, completed, counts), ConnOutbound::FlushResult::Error);
+    EXPECT_EQ(out.size(), 1u);
+    EXPECT_EQ(counts.calls, 0u);
+}
+
+// Small queued frames go out together: one write for the whole backlog while the
+// socket has room, then byte-exact order on the wire.
+TEST(ConnOutboundTest, GathersQueuedFramesIntoOneWrite)
+{
+    auto [sender, receiver] = MakeSenderPair(false);
+    SocketSetSendBufferSize(sender, 1024 * 1024); // room for the whole batch
+    ConnOutbound out;
+    const size_t frameSize = 1400;
+    std::string expected;
+    for (size_t i = 0; i < ConnOutbound::MAX_GATHER_FRAMES; i++)
+    {
+        char fill = static_cast<char>('A' + i % 26);
+        auto f = MakeFrame(fill, frameSize);
+        expected.append(frameSize, fill);
+        ASSERT_TRUE(out.push(f));
+    }
+
+    std::vector<PacketBuffer> completed;
+    ConnOutbound::WriteCounts counts;
+    ASSERT_EQ(out.flush(sender, completed, counts), ConnOutbound::FlushResult::Drained);
+    EXPECT_EQ(counts.calls, 1u);
+    EXPECT_EQ(counts.bytes, expected.size());
+    EXPECT_EQ(completed.size(), ConnOutbound::MAX_GATHER_FRAMES);
+
+    std::string received;
+    std::vector<char> buf(64 * 1024);
+    while (received.size() < expected.size())
+    {
+        ssize_t n = RecvTcpDirect(receiver, buf.data(), buf.size(), 0);
+        ASSERT_GT(n, 0);
+        received.append(buf.data(), static_cast<size_t>(n));
+    }
+    EXPECT_EQ(received, expected);
+
+    SocketClose(sender);
+    SocketClose(receiver);
+}
+
+TEST(ConnOutboundTest, GatherRespectsByteCap)
+{
+    auto [sender, receiver] = MakeSenderPair(false);
+    ConnOutbound out;
+    const size_t frameSize = ConnOutbound::MAX_GATHER_BYTES / 2 + 1; // two never fit one write
+    for (int i = 0; i < 3; i++)
+    {
+        auto f = MakeFrame('c', frameSize);
+        ASSERT_TRUE(out.push(f));
+    }
+
+    std::vector<PacketBuffer> completed;
+    ConnOutbound::WriteCounts counts;
+    ASSERT_EQ(out.flush(sender, completed, counts), ConnOutbound::FlushResult::Drained);
+    EXPECT_GE(counts.calls, 3u);
+    EXPECT_EQ(completed.size(), 3u);
+
+    SocketClose(sender);
+    SocketClose(receiver);
+}
+
+// Run with --gtest_also_run_disabled_tests. Pushes 1400-byte frames over loopback
+// through ConnOutbound, once with one frame queued per flush (a write per frame) and
+// once with the queue kept full (gathered writes), and reports writes and throughput.
+TEST(ConnOutboundBenchmark, DISABLED_GatheredVsPerFrameWrites)
+{
+    const size_t frameSize = 1400;
+    const size_t totalFrames = 200000;
+    auto frame = MakeFrame('b', frameSize);
+
+    for (size_t batch : {size_t{1}, ConnOutbound::MAX_GATHER_FRAMES})
+    {
+        auto [sender, receiver] = MakeSenderPair(false);
+        std::thread drain([fd = receiver, total = totalFrames * frameSize] {
+            std::vector<char> buf(256 * 1024);
+            size_t got = 0;
+            while (got < total)
+            {
+                ssize_t n = RecvTcpDirect(fd, buf.data(), buf.size(), 0);
+                if (n <= 0)
+                    break;
+                got += static_cast<size_t>(n);
+            }
+        });
+
+        ConnOutbound out(batch);
+        std::vector<PacketBuffer> completed;
+        ConnOutbound::WriteCounts counts;
+        size_t queued = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (queued < totalFrames || !out.empty())
+        {
+            while (queued < totalFrames && !out.full())
+            {
+                auto f = frame; // shares the block
+                out.push(f);
+                queued++;
+            }
+            if (out.flush(sender, completed, counts) == ConnOutbound::FlushResult::WouldBlock)
+                IsSocketWritable(sender, 10);
+            completed.clear();
+        }
+        drain.join();
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("[BENCH] ConnOutbound batch=%zu writes=%llu framesPerWrite=%.1f MB/s=%.0f\n", batch,
+                    static_cast<unsigned long long>(counts.calls),
+                    static_cast<double>(totalFrames) / counts.calls,
+                    totalFrames * frameSize / secs / (1024 * 1024));
+        std::fflush(stdout);
+
+        SocketClose(sender);
+        SocketClose(receiver);
+    }
+}
@@ -0,0 +1,231 @@
+#include "ConnectionScheduler.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+namespace
+{
+SlotMetrics Live(uint32_t rttUs = 1000, uint32_t cwnd = 64 * 1024, uint32_t inFlight = 0)
+{
+    SlotMetrics m;
+    m.connected = true;
+    m.info.supported = true;
+    m.info.valid = true;
+    m.info.smoothedRttUs = rttUs;
+    m.info.congestionWindowBytes = cwnd;
+    m.info.bytesInFlight = inFlight;
+    return m;
+}
+
+std::map<size_t, int> Tally(ConnectionScheduler &s, int picks, size_t frameBytes = 1400)
+{
+    std::map<size_t, int> counts;
+    for (int i = 0; i < picks; i++)
+    {
+        size_t slot = s.select(frameBytes);
+        counts[slot]++;
+        if (slot != ConnectionScheduler::NONE)
+            s.onSendComplete(slot, frameBytes);
+    }
+    return counts;
+}
+
+class ManualClockScheduler : public EarliestDeliveryScheduler
+{
+  public:
+    using EarliestDeliveryScheduler::EarliestDeliveryScheduler;
+    int64_t now = 1000000;
+
+  protected:
+    int64_t nowUs() const override
+    {
+        return now;
+    }
+};
+} // namespace
+
+TEST(ConnectionSchedulerTest, NothingSelectableReturnsNone)
+{
+    for (auto policy : {SchedulerPolicy::WeightedScore, SchedulerPolicy::RoundRobin, SchedulerPolicy::LowestRtt,
+                        SchedulerPolicy::CwndWeighted, SchedulerPolicy::EarliestDelivery})
+    {
+        auto s = MakeConnectionScheduler(policy, 4);
+        EXPECT_EQ(s->select(100), ConnectionScheduler::NONE) << SchedulerPolicyName(policy);
+
+        auto m = Live();
+        s->onMetricsUpdate(2, m);
+        EXPECT_EQ(s->select(100), 2u) << SchedulerPolicyName(policy);
+
+        m.hasRoom = false;
+        s->onMetricsUpdate(2, m);
+        EXPECT_EQ(s->select(100), ConnectionScheduler::NONE) << SchedulerPolicyName(policy);
+
+        m.hasRoom = true;
+        m.quarantined = true;
+        s->onMetricsUpdate(2, m);
+        EXPECT_EQ(s->select(100), ConnectionScheduler::NONE) << SchedulerPolicyName(policy);
+    }
+}
+
+TEST(ConnectionSchedulerTest, RoundRobinVisitsEverySelectableSlot)
+{
+    RoundRobinScheduler s(4);
+    for (size_t i = 0; i < 4; i++)
+        s.onMetricsUpdate(i, Live(1000 * (i + 1)));
+    auto down = Live();
+    down.connected = false;
+    s.onMetricsUpdate(1, down);
+
+    auto counts = Tally(s, 300);
+    EXPECT_EQ(counts[0], 100);
+    EXPECT_EQ(counts[1], 0);
+    EXPECT_EQ(counts[2], 100);
+    EXPECT_EQ(counts[3], 100);
+}
+
+TEST(ConnectionSchedulerTest, WeightedScorePrefersBestAndRotatesTies)
+{
+    WeightedScoreScheduler s(4);
+    s.onMetricsUpdate(0, Live(200000)); // 200ms RTT: -1000 points
+    s.onMetricsUpdate(1, Live(1000));
+    s.onMetricsUpdate(2, Live(1000));
+    auto backoff = Live(1000);
+    backoff.info.isInExponentialBackoff = true;
+    s.onMetricsUpdate(3, backoff);
+
+    auto counts = Tally(s, 100);
+    EXPECT_EQ(counts[1], 50);
+    EXPECT_EQ(counts[2], 50);
+
+    // Failures push a slot below its peers; backlog drops it to the bottom of the
+    // eligible range; backoff slots are used only when nothing else is selectable.
+    auto failing = Live(1000);
+    failing.failCount = 10;
+    s.onMetricsUpdate(1, failing);
+    auto backlogged = Live(1000);
+    backlogged.backlogged = true;
+    s.onMetricsUpdate(2, backlogged);
+    EXPECT_EQ(s.select(1400), 0u);
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        auto gone = Live();
+        gone.connected = false;
+        s.onMetricsUpdate(i, gone);
+    }
+    EXPECT_EQ(s.select(1400), 3u);
+}
+
+TEST(ConnectionSchedulerTest, LowestRttNeedsWindowSpace)
+{
+    LowestRttScheduler s(3);
+    s.onMetricsUpdate(0, Live(5000));
+    s.onMetricsUpdate(1, Live(1000, 10000, 10000)); // fastest, but its window is full
+    s.onMetricsUpdate(2, Live(3000));
+    EXPECT_EQ(s.select(1400), 2u);
+    EXPECT_EQ(s.select(1400), 2u);
+
+    s.onMetricsUpdate(1, Live(1000, 10000, 2000));
+    EXPECT_EQ(s.select(1400), 1u);
+}
+
+TEST(ConnectionSchedulerTest, CwndWeightedSharesBytesByWindow)
+{
+    CwndWeightedScheduler s(3);
+    s.onMetricsUpdate(0, Live(1000, 40000));
+    s.onMetricsUpdate(1, Live(1000, 20000));
+    s.onMetricsUpdate(2, Live(1000, 20000));
+
+    auto counts = Tally(s, 4000);
+    EXPECT_NEAR(counts[0], 2000, 5);
+    EXPECT_NEAR(counts[1], 1000, 5);
+    EXPECT_NEAR(counts[2], 1000, 5);
+
+    // A slot returning after a break starts level with the others rather than taking
+    // every frame until its pass catches up.
+    auto gone = Live(1000, 20000);
+    gone.connected = false;
+    s.onMetricsUpdate(2, gone);
+    Tally(s, 3000);
+    s.onMetricsUpdate(2, Live(1000, 20000));
+    counts = Tally(s, 400);
+    EXPECT_NEAR(counts[2], 100, 5);
+}
+
+TEST(ConnectionSchedulerTest, EarliestDeliveryAvoidsUnsentBacklog)
+{
+    ManualClockScheduler s(2);
+    // Same path, but slot 0 already has 64 KB waiting in its socket: ~10ms at 64 KB / 10ms.
+    auto queued = Live(10000, 64 * 1024);
+    queued.info.notSentBytes = 64 * 1024;
+    s.onMetricsUpdate(0, queued);
+    s.onMetricsUpdate(1, Live(10000, 64 * 1024));
+    EXPECT_NEAR(s.predictedArrivalUs(0, 0), 15000, 10);
+    EXPECT_NEAR(s.predictedArrivalUs(1, 0), 5000, 10);
+
+    // Slot 1 takes frames until its own queue predicts a later arrival than slot 0's.
+    auto counts = Tally(s, 46, 1400);
+    EXPECT_EQ(counts[0], 0);
+    EXPECT_EQ(counts[1], 46);
+    counts = Tally(s, 20, 1400);
+    EXPECT_NEAR(counts[0], 10, 1);
+    EXPECT_NEAR(counts[1], 10, 1);
+
+    // The queue drains with time; a fresh sample replaces the running estimate.
+    s.now += 100000;
+    EXPECT_NEAR(s.predictedArrivalUs(0, 0), 5000, 10);
+    queued.info.notSentBytes = 0;
+    s.onMetricsUpdate(0, queued);
+    EXPECT_NEAR(s.predictedArrivalUs(0, 0), 5000, 10);
+}
+
+TEST(ConnectionSchedulerTest, EarliestDeliveryWeighsRateAgainstRtt)
+{
+    ManualClockScheduler s(3);
+    s.onMetricsUpdate(0, Live(2000, 16 * 1024));  // short path, small window: 8 KB/ms
+    s.onMetricsUpdate(1, Live(20000, 640 * 1024)); // long fat path: 32 KB/ms
+    auto backoff = Live(1000, 1024 * 1024);
+    backoff.info.isInExponentialBackoff = true;
+    s.onMetricsUpdate(2, backoff);
+
+    // A single frame is fastest over the short path; a burst spills onto the fat one once
+    // the short path's queue costs more than the 9ms of extra one-way delay.
+    EXPECT_EQ(s.select(1400), 0u);
+    s.onSendComplete(0, 1400);
+    auto counts = Tally(s, 400, 1400);
+    EXPECT_EQ(counts[2], 0);
+    EXPECT_GT(counts[0], 50);
+    EXPECT_GT(counts[1], counts[0]);
+}
+
+// Run with --gtest_also_run_disabled_tests. Cost of one select + completion with 24
+// slots whose metrics change every 32 frames.
+TEST(ConnectionSchedulerBenchmark, DISABLED_SelectCost)
+{
+    const size_t slots = 24;
+    const int picks = 2000000;
+    for (auto policy : {SchedulerPolicy::WeightedScore, SchedulerPolicy::RoundRobin, SchedulerPolicy::LowestRtt,
+                        SchedulerPolicy::CwndWeighted, SchedulerPolicy::EarliestDelivery})
+    {
+        auto s = MakeConnectionScheduler(policy, slots);
+        for (size_t i = 0; i < slots; i++)
+            s->onMetricsUpdate(i, Live(1000 + 100 * static_cast<uint32_t>(i)));
+
+        size_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < picks; i++)
+        {
+            size_t slot = s->select(1400);
+            sink += slot;
+            s->onSendComplete(slot, 1400);
+            if (i % 32 == 0)
+                s->onMetricsUpdate(i % slots, Live(1000 + static_cast<uint32_t>(i % 5000)));
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / picks;
+        std::printf("[BENCH] scheduler=%s slots=%zu ns/select=%.1f (sink=%zu)\n", SchedulerPolicyName(policy), slots,
+                    ns, sink);
+        std::fflush(stdout);
+    }
+}
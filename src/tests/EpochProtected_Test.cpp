@@ -0,0 +1,119 @@
+#include "EpochProtected.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct Counted
+{
+    static inline std::atomic<int> live{0};
+    int value = 0;
+
+    explicit Counted(int v) : value(v)
+    {
+        live++;
+    }
+    Counted(const Counted &other) : value(other.value)
+    {
+        live++;
+    }
+    ~Counted()
+    {
+        live--;
+    }
+};
+} // namespace
+
+TEST(EpochProtectedTest, PinSeesLatestVersion)
+{
+    EpochProtected<Counted> shared(Counted{1});
+    EpochProtected<Counted>::Reader reader(shared);
+
+    EXPECT_EQ(reader.pin()->value, 1);
+    shared.update([](Counted &c) { c.value = 2; });
+    EXPECT_EQ(reader.pin()->value, 2);
+}
+
+TEST(EpochProtectedTest, RetiredVersionOutlivesPin)
+{
+    int before = Counted::live.load();
+    {
+        EpochProtected<Counted> shared(Counted{1});
+        EpochProtected<Counted>::Reader reader(shared);
+
+        auto pinned = reader.pin();
+        shared.update([](Counted &c) { c.value = 2; });
+        shared.update([](Counted &c) { c.value = 3; });
+        EXPECT_EQ(pinned->value, 1);
+        EXPECT_EQ(shared.retiredCount(), 2u);
+
+        pinned.reset();
+        shared.reclaim();
+        EXPECT_EQ(shared.retiredCount(), 0u);
+        EXPECT_EQ(reader.pin()->value, 3);
+    }
+    EXPECT_EQ(Counted::live.load(), before);
+}
+
+TEST(EpochProtectedTest, ReadersBeyondSlotLimitFallBackToLock)
+{
+    EpochProtected<Counted> shared(Counted{7});
+    std::vector<std::unique_ptr<EpochProtected<Counted>::Reader>> readers;
+    for (size_t i = 0; i < EpochProtected<Counted>::MAX_READERS + 2; i++)
+        readers.push_back(std::make_unique<EpochProtected<Counted>::Reader>(shared));
+
+    EXPECT_EQ(readers.back()->pin()->value, 7);
+    shared.update([](Counted &c) { c.value = 8; });
+    EXPECT_EQ(readers.back()->pin()->value, 8);
+    EXPECT_EQ(readers.front()->pin()->value, 8);
+}
+
+// Readers keep re-pinning and checking a version whose fields must always agree while
+// a writer publishes new versions; a freed-too-early version would show torn values.
+TEST(EpochProtectedTest, ConcurrentUpdatesNeverExposeFreedVersions)
+{
+    struct Table
+    {
+        std::vector<int> slots = std::vector<int>(32, 0);
+    };
+    EpochProtected<Table> shared(Table{});
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; r++)
+    {
+        readers.emplace_back([&] {
+            EpochProtected<Table>::Reader reader(shared);
+            while (!done.load(std::memory_order_acquire))
+            {
+                auto t = reader.pin();
+                int first = t->slots[0];
+                for (int v : t->slots)
+                {
+                    if (v != first)
+                        torn++;
+                }
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    for (int i = 1; i <= 2000; i++)
+    {
+        shared.update([i](Table &t) {
+            for (auto &v : t.slots)
+                v = i;
+        });
+    }
+    done.store(true, std::memory_order_release);
+    for (auto &t : readers)
+        t.join();
+
+    shared.reclaim();
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(shared.retiredCount(), 0u);
+}
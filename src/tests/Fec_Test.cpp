@@ -0,0 +1,276 @@
+#include "FecDecoder.h"
+#include "FecEncoder.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+PacketBuffer MakeData(uint64_t messageId, const std::string &payload)
+{
+    auto frame = PacketBuffer::allocate(sizeof(VCDataPacket) + payload.size());
+    auto *packet = reinterpret_cast<VCDataPacket *>(frame.data());
+    packet->header = VCHeader{VcPacketType::DATA, messageId};
+    packet->dataLength = static_cast<uint16_t>(payload.size());
+    std::memcpy(packet->data, payload.data(), payload.size());
+    return frame;
+}
+
+std::string Payload(uint64_t messageId)
+{
+    // Lengths differ per ID so the rebuilt length is checked too.
+    return "message-" + std::to_string(messageId) + std::string(messageId % 7, '*');
+}
+
+PacketBuffer PayloadOf(uint64_t messageId)
+{
+    std::string payload = Payload(messageId);
+    return PacketBuffer::copyOf(payload.data(), payload.size());
+}
+
+std::vector<uint64_t> Members(const PacketBuffer &parity)
+{
+    VCFecParity header;
+    std::memcpy(&header, parity.data(), std::min(parity.size(), sizeof(header)));
+    std::vector<uint64_t> ids;
+    for (size_t i = 0; i < header.count; i++)
+        ids.push_back(header.header.messageId + header.offsets[i]);
+    return ids;
+}
+
+std::string Text(const PacketBuffer &buffer)
+{
+    return std::string(buffer.data(), buffer.size());
+}
+} // namespace
+
+TEST(FecEncoderTest, GroupsFramesFromDifferentConnections)
+{
+    auto stats = std::make_shared<FecStats>();
+    FecEncoder encoder(FecConfig{.groupSize = 4, .adaptive = false}, stats);
+    std::vector<PacketBuffer> parity;
+    auto now = FecEncoder::Clock::now();
+    for (uint64_t id = 0; id < 4; id++)
+        encoder.add(MakeData(id, Payload(id)), id, parity, now);
+
+    ASSERT_EQ(parity.size(), 1u);
+    EXPECT_EQ(Members(parity[0]), (std::vector<uint64_t>{0, 1, 2, 3}));
+    EXPECT_EQ(reinterpret_cast<const VCHeader *>(parity[0].data())->type, VcPacketType::FEC_PARITY);
+    EXPECT_EQ(encoder.nextDeadline(), FecEncoder::Clock::time_point::max());
+    EXPECT_EQ(stats->protectedFrames.load(), 4u);
+    EXPECT_EQ(stats->parityFrames.load(), 1u);
+
+    // A re-sent frame is not protected twice.
+    encoder.add(MakeData(2, Payload(2)), 5, parity, now);
+    EXPECT_EQ(stats->protectedFrames.load(), 4u);
+}
+
+TEST(FecEncoderTest, InterleavesRunsOnOneConnection)
+{
+    FecEncoder encoder(FecConfig{.groupSize = 2, .adaptive = false});
+    std::vector<PacketBuffer> parity;
+    auto now = FecEncoder::Clock::now();
+    // Two runs of four frames, each written to one connection.
+    for (uint64_t id = 0; id < 8; id++)
+        encoder.add(MakeData(id, Payload(id)), id < 4 ? 0 : 1, parity, now);
+
+    ASSERT_EQ(parity.size(), 4u);
+    for (uint64_t i = 0; i < 4; i++)
+        EXPECT_EQ(Members(parity[i]), (std::vector<uint64_t>{i, i + 4}));
+}
+
+TEST(FecEncoderTest, ClosesGroupsHeldTooLong)
+{
+    FecEncoder encoder(FecConfig{.groupSize = 8, .adaptive = false, .maxHold = 10ms});
+    std::vector<PacketBuffer> parity;
+    auto t0 = FecEncoder::Clock::now();
+    encoder.add(MakeData(0, Payload(0)), 0, parity, t0);
+    encoder.add(MakeData(1, Payload(1)), 1, parity, t0 + 4ms);
+    EXPECT_EQ(encoder.nextDeadline(), t0 + 10ms);
+
+    encoder.flushExpired(parity, t0 + 9ms);
+    EXPECT_TRUE(parity.empty());
+    encoder.flushExpired(parity, t0 + 10ms);
+    ASSERT_EQ(parity.size(), 1u);
+    EXPECT_EQ(Members(parity[0]), (std::vector<uint64_t>{0, 1}));
+}
+
+TEST(FecEncoderTest, AdaptsGroupSizeToReportedLoss)
+{
+    auto stats = std::make_shared<FecStats>();
+    FecEncoder encoder(FecConfig{.groupSize = 8, .minGroupSize = 2, .maxGroupSize = 16}, stats);
+    std::vector<PacketBuffer> parity;
+    auto t = FecEncoder::Clock::now();
+    uint64_t id = 0;
+    auto sendPeriod = [&](uint64_t frames, uint64_t resent) {
+        for (uint64_t i = 0; i < frames; i++, id++)
+            encoder.add(MakeData(id, "x"), id % 24, parity, t);
+        stats->resent.fetch_add(resent);
+        t += FecEncoder::ADAPT_PERIOD;
+        encoder.adapt(t);
+    };
+    encoder.adapt(t);
+
+    // 10% of the frames needed a resend: a group of 5 expects half a loss.
+    sendPeriod(200, 20);
+    EXPECT_EQ(encoder.groupSize(), 5u);
+    EXPECT_EQ(stats->lossPermille.load(), 100u);
+
+    // Loss stops: groups grow back one step per period.
+    sendPeriod(200, 0);
+    EXPECT_EQ(encoder.groupSize(), 6u);
+    for (int i = 0; i < 20; i++)
+        sendPeriod(200, 0);
+    EXPECT_EQ(encoder.groupSize(), 16u);
+}
+
+TEST(FecDecoderTest, RebuildsTheOneMissingMember)
+{
+    FecEncoder encoder(FecConfig{.groupSize = 4, .adaptive = false});
+    std::vector<PacketBuffer> parity;
+    for (uint64_t id = 0; id < 4; id++)
+        encoder.add(MakeData(id, Payload(id)), id, parity);
+    ASSERT_EQ(parity.size(), 1u);
+
+    auto stats = std::make_shared<FecStats>();
+    FecDecoder decoder(stats);
+    ReorderWindow window(64);
+    for (uint64_t id : {0, 1, 3})
+        window.insert(id, {PayloadOf(id), 0});
+    decoder.onParity(parity[0]);
+
+    std::vector<uint64_t> recovered;
+    EXPECT_EQ(decoder.recover(window, recovered), 1u);
+    EXPECT_EQ(recovered, (std::vector<uint64_t>{2}));
+    const auto *item = window.find(2);
+    ASSERT_NE(item, nullptr);
+    EXPECT_EQ(Text(item->data), Payload(2));
+    EXPECT_FALSE(decoder.hasPending());
+    EXPECT_EQ(stats->recovered.load(), 1u);
+}
+
+TEST(FecDecoderTest, WaitsWhileTwoMembersAreMissing)
+{
+    FecEncoder encoder(FecConfig{.groupSize = 4, .adaptive = false});
+    std::vector<PacketBuffer> parity;
+    for (uint64_t id = 0; id < 4; id++)
+        encoder.add(MakeData(id, Payload(id)), id, parity);
+
+    FecDecoder decoder;
+    ReorderWindow window(64);
+    window.insert(0, {PayloadOf(0), 0});
+    window.insert(3, {PayloadOf(3), 0});
+    decoder.onParity(parity[0]);
+
+    std::vector<uint64_t> recovered;
+    EXPECT_EQ(decoder.recover(window, recovered), 0u);
+    EXPECT_TRUE(decoder.hasPending());
+
+    window.insert(1, {PayloadOf(1), 0});
+    EXPECT_EQ(decoder.recover(window, recovered), 1u);
+    ASSERT_NE(window.find(2), nullptr);
+    EXPECT_EQ(Text(window.find(2)->data), Payload(2));
+}
+
+TEST(FecDecoderTest, UsesMembersAlreadyDelivered)
+{
+    FecEncoder encoder(FecConfig{.groupSize = 4, .adaptive = false});
+    std::vector<PacketBuffer> parity;
+    for (uint64_t id = 0; id < 8; id++)
+        encoder.add(MakeData(id, Payload(id)), id % 4, parity);
+    ASSERT_EQ(parity.size(), 2u);
+
+    auto stats = std::make_shared<FecStats>();
+    FecDecoder decoder(stats);
+    ReorderWindow window(64);
+    // The first group's parity arrives after its members were delivered: nothing to do,
+    // but from now on delivered payloads are kept.
+    for (uint64_t id = 0; id < 4; id++)
+        window.insert(id, {PayloadOf(id), 0});
+    window.drain([&](uint64_t id, ReorderWindow::Item &&item) { decoder.onDelivered(id, item.data); });
+    decoder.onParity(parity[0]);
+    std::vector<uint64_t> recovered;
+    EXPECT_EQ(decoder.recover(window, recovered), 0u);
+    EXPECT_EQ(stats->parityUnused.load(), 1u);
+
+    // 4 and 5 are delivered, 6 is lost and 7 waits behind it.
+    window.insert(4, {PayloadOf(4), 0});
+    window.insert(5, {PayloadOf(5), 0});
+    window.insert(7, {PayloadOf(7), 0});
+    window.drain([&](uint64_t id, ReorderWindow::Item &&item) { decoder.onDelivered(id, item.data); });
+    EXPECT_EQ(window.base(), 6u);
+    decoder.onParity(parity[1]);
+    EXPECT_EQ(decoder.recover(window, recovered), 1u);
+    ASSERT_NE(window.find(6), nullptr);
+    EXPECT_EQ(Text(window.find(6)->data), Payload(6));
+}
+
+// Delivered members are held by reference until their group resolves; a group that
+// waits on two members copies the delivered ones instead.
+TEST(FecDecoderTest, HoldsDeliveredMembersOnlyUntilTheirGroupResolves)
+{
+    FecEncoder encoder(FecConfig{.groupSize = 4, .adaptive = false});
+    std::vector<PacketBuffer> parity;
+    for (uint64_t id = 0; id < 12; id++)
+        encoder.add(MakeData(id, Payload(id)), id % 4, parity);
+    ASSERT_EQ(parity.size(), 3u);
+
+    FecDecoder decoder;
+    ReorderWindow window(64);
+    std::vector<uint64_t> recovered;
+    std::vector<PacketBuffer> payloads;
+    for (uint64_t id = 0; id < 12; id++)
+        payloads.push_back(PayloadOf(id));
+    auto deliver = [&](uint64_t id) {
+        window.insert(id, {payloads[id], 0});
+        window.drain([&](uint64_t delivered, ReorderWindow::Item &&item) { decoder.onDelivered(delivered, item.data); });
+    };
+
+    // The first parity frame turns the history on.
+    for (uint64_t id = 0; id < 4; id++)
+        deliver(id);
+    decoder.onParity(parity[0]);
+    EXPECT_EQ(decoder.recover(window, recovered), 0u);
+
+    // Group 4-7 completes on its own: referenced, not copied, until its parity is seen.
+    for (uint64_t id = 4; id < 10; id++)
+        deliver(id);
+    EXPECT_EQ(payloads[4].useCount(), 2u);
+    decoder.onParity(parity[1]);
+    EXPECT_EQ(decoder.recover(window, recovered), 0u);
+    for (uint64_t id = 4; id < 8; id++)
+        EXPECT_EQ(payloads[id].useCount(), 1u) << id;
+    EXPECT_EQ(payloads[8].useCount(), 2u);
+
+    // 10 and 11 are both missing: the waiting group keeps copies of 8 and 9.
+    decoder.onParity(parity[2]);
+    EXPECT_EQ(decoder.recover(window, recovered), 0u);
+    EXPECT_EQ(payloads[8].useCount(), 1u);
+    EXPECT_EQ(payloads[9].useCount(), 1u);
+
+    window.insert(11, {payloads[11], 0});
+    EXPECT_EQ(decoder.recover(window, recovered), 1u);
+    ASSERT_NE(window.find(10), nullptr);
+    EXPECT_EQ(Text(window.find(10)->data), Payload(10));
+}
+
+TEST(FecDecoderTest, LoneFrameParityIsACopy)
+{
+    FecEncoder encoder(FecConfig{.groupSize = 4, .adaptive = false});
+    std::vector<PacketBuffer> parity;
+    encoder.add(MakeData(0, Payload(5)), 0, parity);
+    encoder.flush(parity);
+    ASSERT_EQ(parity.size(), 1u);
+
+    FecDecoder decoder;
+    ReorderWindow window(64);
+    window.insert(1, {PayloadOf(1), 0});
+    decoder.onParity(parity[0]);
+    std::vector<uint64_t> recovered;
+    EXPECT_EQ(decoder.recover(window, recovered), 1u);
+    EXPECT_EQ(Text(window.find(0)->data), Payload(5));
+}
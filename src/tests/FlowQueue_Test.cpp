@@ -0,0 +1,145 @@
+#include "FlowQueue.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <map>
+
+namespace
+{
+constexpr size_t BULK_BYTES = 1200;
+
+// Frames carry their flow id in the first bytes so tests can see where a pop came from.
+PacketBuffer Frame(uint64_t flow, size_t bytes = BULK_BYTES)
+{
+    auto frame = PacketBuffer::allocate(bytes);
+    std::memset(frame.data(), 0, bytes);
+    std::memcpy(frame.data(), &flow, sizeof(flow));
+    return frame;
+}
+
+uint64_t FlowOf(const PacketBuffer &frame)
+{
+    uint64_t flow = 0;
+    std::memcpy(&flow, frame.data(), sizeof(flow));
+    return flow;
+}
+} // namespace
+
+TEST(FlowQueueTest, BulkFlowsShareRoundRobin)
+{
+    FlowQueue q(1000);
+    // Flow 1 queues a long backlog before flow 2 shows up.
+    for (int i = 0; i < 100; i++)
+        q.push(Frame(1), FlowQueue::tagOf(1, 0));
+    for (int i = 0; i < 10; i++)
+        q.push(Frame(2), FlowQueue::tagOf(2, 0));
+
+    // Flow 2 does not wait behind the backlog: over any window both get a fair share.
+    std::map<uint64_t, int> firstTwenty;
+    for (int i = 0; i < 20; i++)
+        firstTwenty[FlowOf(q.pop())]++;
+    EXPECT_NEAR(firstTwenty[1], 10, 2);
+    EXPECT_NEAR(firstTwenty[2], 10, 2);
+    EXPECT_EQ(q.size(), 90u);
+}
+
+TEST(FlowQueueTest, ShortAndLowDelayFramesGoFirst)
+{
+    auto stats = std::make_shared<FlowQueueStats>();
+    FlowQueue q(1000, stats);
+    for (int i = 0; i < 5; i++)
+        q.push(Frame(1), FlowQueue::tagOf(1, 0));
+    q.push(Frame(2, 100), FlowQueue::tagOf(2, 0));      // short
+    q.push(Frame(3), FlowQueue::tagOf(3, 46 << 2));     // DSCP EF
+    EXPECT_EQ(stats->priorityDepth.load(), 2u);
+    EXPECT_EQ(stats->bulkDepth.load(), 5u);
+
+    EXPECT_EQ(FlowOf(q.pop()), 2u);
+    EXPECT_EQ(FlowOf(q.pop()), 3u);
+    EXPECT_EQ(FlowOf(q.pop()), 1u);
+    EXPECT_EQ(stats->priorityDepth.load(), 0u);
+}
+
+TEST(FlowQueueTest, PriorityClassCannotStarveBulk)
+{
+    FlowQueue q(1000);
+    q.push(Frame(1), FlowQueue::tagOf(1, 0));
+    for (size_t i = 0; i < FlowQueue::PRIORITY_CAPACITY; i++)
+        q.push(Frame(2, 64), FlowQueue::tagOf(2, 0));
+
+    // The bulk frame goes out after at most one burst of priority frames.
+    size_t beforeBulk = 0;
+    while (FlowOf(q.pop()) != 1)
+        beforeBulk++;
+    EXPECT_EQ(beforeBulk, FlowQueue::PRIORITY_BURST);
+
+    // Short frames beyond the priority capacity wait in their flow's bucket instead.
+    for (size_t i = 0; i < FlowQueue::PRIORITY_CAPACITY + 10; i++)
+        q.push(Frame(3, 64), FlowQueue::tagOf(3, 0));
+    size_t popped = 0;
+    while (q.pop())
+        popped++;
+    EXPECT_EQ(popped, FlowQueue::PRIORITY_CAPACITY - FlowQueue::PRIORITY_BURST + FlowQueue::PRIORITY_CAPACITY + 10);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(FlowQueueTest, OverflowDropsFromFattestFlow)
+{
+    auto stats = std::make_shared<FlowQueueStats>();
+    FlowQueue q(20, stats);
+    for (int i = 0; i < 15; i++)
+        q.push(Frame(1), FlowQueue::tagOf(1, 0));
+    for (int i = 0; i < 10; i++)
+        q.push(Frame(2), FlowQueue::tagOf(2, 0));
+
+    EXPECT_EQ(q.size(), 20u);
+    EXPECT_EQ(stats->bulkDrops.load(), 5u);
+    std::map<uint64_t, int> counts;
+    while (auto frame = q.pop())
+        counts[FlowOf(frame)]++;
+    // Flow 1 paid for the overflow until it was no bigger than flow 2.
+    EXPECT_EQ(counts[1], 10);
+    EXPECT_EQ(counts[2], 10);
+}
+
+TEST(FlowQueueTest, CoDelDropsOnlyAStandingQueue)
+{
+    using namespace std::chrono_literals;
+    auto stats = std::make_shared<FlowQueueStats>();
+    FlowQueue q(1000, stats);
+    q.setCoDel(5ms, 100ms);
+    auto t0 = FlowQueue::Clock::now();
+    for (int i = 0; i < 40; i++)
+        q.push(Frame(1), FlowQueue::tagOf(1, 0), t0);
+
+    // Above target, but not yet for a whole interval.
+    EXPECT_TRUE(q.pop(t0 + 20ms));
+    EXPECT_TRUE(q.pop(t0 + 100ms));
+    EXPECT_EQ(stats->codelDrops.load(), 0u);
+
+    // One interval later the head is dropped, and the next drop follows one interval on.
+    EXPECT_TRUE(q.pop(t0 + 121ms));
+    EXPECT_EQ(stats->codelDrops.load(), 1u);
+    EXPECT_TRUE(q.pop(t0 + 122ms));
+    EXPECT_EQ(stats->codelDrops.load(), 1u);
+    EXPECT_TRUE(q.pop(t0 + 222ms));
+    EXPECT_EQ(stats->codelDrops.load(), 2u);
+    EXPECT_EQ(q.size(), 33u);
+
+    // A flow that does not build a queue is not dropped, even while flow 1 is.
+    q.push(Frame(2), FlowQueue::tagOf(2, 0), t0 + 230ms);
+    bool flow2Sent = false;
+    while (auto frame = q.pop(t0 + 231ms))
+        flow2Sent |= FlowOf(frame) == 2;
+    EXPECT_TRUE(flow2Sent);
+    EXPECT_EQ(stats->sojournFrames.load(), 41u - stats->codelDrops.load());
+    EXPECT_GE(stats->sojournMaxUs.load(), 222000u);
+
+    // Frames queued for less than the target are never dropped.
+    uint64_t dropsBefore = stats->codelDrops.load();
+    for (int i = 0; i < 40; i++)
+        q.push(Frame(1), FlowQueue::tagOf(1, 0), t0 + 1s);
+    for (int i = 0; i < 40; i++)
+        EXPECT_TRUE(q.pop(t0 + 1s + 4ms));
+    EXPECT_EQ(stats->codelDrops.load(), dropsBefore);
+}
@@ -0,0 +1,148 @@
+#include "GapTracker.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+using Copy = GapTracker::Copy;
+
+std::vector<MissingRange> Due(GapTracker &tracker, GapTracker::Clock::time_point now)
+{
+    std::vector<MissingRange> out;
+    tracker.collectDue(out, VC_MAX_MISSING_RANGES, now);
+    return out;
+}
+} // namespace
+
+TEST(GapTrackerTest, FirstNackAfterInitialDelayAsOneRange)
+{
+    GapTracker tracker;
+    tracker.setInitialDelay(200ms);
+    auto t0 = GapTracker::Clock::now();
+    tracker.onArrival(0, Copy::Original, t0);
+    tracker.onArrival(1000, Copy::Original, t0); // 1..999 missing
+    EXPECT_EQ(tracker.nextDeadline(), t0 + 200ms);
+
+    EXPECT_TRUE(Due(tracker, t0 + 199ms).empty());
+    auto due = Due(tracker, t0 + 200ms);
+    ASSERT_EQ(due.size(), 1u);
+    EXPECT_EQ(due[0].first, 1u);
+    EXPECT_EQ(due[0].count, 999u);
+    // Not again before the repeat delay.
+    EXPECT_TRUE(Due(tracker, t0 + 201ms).empty());
+}
+
+TEST(GapTrackerTest, LearnsReorderSpreadFromGapsThatFillThemselves)
+{
+    auto stats = std::make_shared<GapStats>();
+    GapTracker tracker(stats);
+    tracker.setInitialDelay(200ms);
+    auto t = GapTracker::Clock::now();
+
+    // Frames overtaken by the next 4 IDs, arriving 10ms after the gap showed.
+    uint64_t id = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        for (uint64_t k = 1; k <= 4; k++)
+            tracker.onArrival(id + k, Copy::Original, t);
+        tracker.onArrival(id, Copy::Original, t + 10ms);
+        id += 5;
+        t += 20ms;
+    }
+    EXPECT_TRUE(tracker.empty());
+    EXPECT_EQ(stats->reorderFills.load(), 10u);
+    EXPECT_EQ(stats->skewUs.load(), 10000u);
+    EXPECT_EQ(stats->reorderDistance.load(), 4u);
+    EXPECT_EQ(stats->fillMs[GapStats::bucketOf(10ms)].load(), 10u);
+
+    // A real loss is now NACKed after 1.5 * 10ms instead of 200ms...
+    tracker.onArrival(id + 1, Copy::Original, t);
+    EXPECT_EQ(tracker.nextDeadline(), t + 15ms);
+    EXPECT_TRUE(Due(tracker, t + 14ms).empty());
+    ASSERT_EQ(Due(tracker, t + 15ms).size(), 1u);
+
+    // ...or as soon as 1.5 * 4 later IDs have arrived.
+    uint64_t lost = id + 2;
+    for (uint64_t k = 1; k <= 5; k++)
+        tracker.onArrival(lost + k, Copy::Original, t + 16ms);
+    EXPECT_TRUE(Due(tracker, t + 16ms).empty());
+    tracker.onArrival(lost + 6, Copy::Original, t + 16ms);
+    auto due = Due(tracker, t + 16ms);
+    ASSERT_EQ(due.size(), 1u);
+    EXPECT_EQ(due[0].first, lost);
+    EXPECT_EQ(due[0].count, 1u);
+    EXPECT_EQ(stats->nacks.load(), 2u);
+}
+
+TEST(GapTrackerTest, RepeatsNackPerResendRoundTripWithBackoff)
+{
+    auto stats = std::make_shared<GapStats>();
+    GapTracker tracker(stats);
+    tracker.setInitialDelay(100ms);
+    auto t = GapTracker::Clock::now();
+
+    // One resend round trip of 30ms measured: NACK, resend fills.
+    tracker.onArrival(1, Copy::Original, t);
+    ASSERT_EQ(Due(tracker, t + 100ms).size(), 1u);
+    tracker.onArrival(0, Copy::Resend, t + 130ms);
+    EXPECT_EQ(stats->resendRttUs.load(), 30000u);
+    EXPECT_EQ(stats->resendFills.load(), 1u);
+
+    // The next loss: its resend is lost too, so it is NACKed again after
+    // srtt + 4 * rttvar = 90ms, then 180ms, 360ms, and then no more.
+    t += 1s;
+    tracker.onArrival(3, Copy::Original, t);
+    auto nacked = t + 100ms;
+    ASSERT_EQ(Due(tracker, nacked).size(), 1u);
+    for (auto wait : {90ms, 180ms, 360ms})
+    {
+        EXPECT_TRUE(Due(tracker, nacked + wait - 1ms).empty());
+        ASSERT_EQ(Due(tracker, nacked + wait).size(), 1u);
+        nacked += wait;
+    }
+    EXPECT_EQ(tracker.nextDeadline(), GapTracker::Clock::time_point::max());
+    EXPECT_TRUE(Due(tracker, nacked + 10s).empty());
+    EXPECT_EQ(stats->renacks.load(), 3u);
+
+    // The reorder timeout gives up on it.
+    tracker.advance(3);
+    EXPECT_TRUE(tracker.empty());
+    EXPECT_EQ(stats->skipped.load(), 1u);
+}
+
+TEST(GapTrackerTest, FillInsideARunSplitsIt)
+{
+    GapTracker tracker;
+    tracker.setInitialDelay(50ms);
+    auto t = GapTracker::Clock::now();
+    tracker.onArrival(10, Copy::Original, t); // 0..9 missing
+    tracker.onArrival(5, Copy::Original, t + 1ms);
+    tracker.onArrival(5, Copy::Original, t + 2ms); // a duplicate changes nothing
+
+    auto due = Due(tracker, t + 50ms);
+    ASSERT_EQ(due.size(), 2u);
+    EXPECT_EQ(due[0].first, 0u);
+    EXPECT_EQ(due[0].count, 5u);
+    EXPECT_EQ(due[1].first, 6u);
+    EXPECT_EQ(due[1].count, 4u);
+
+    tracker.advance(8);
+    due.clear();
+    tracker.collectDue(due, VC_MAX_MISSING_RANGES, t + 10s);
+    ASSERT_EQ(due.size(), 1u);
+    EXPECT_EQ(due[0].first, 8u);
+    EXPECT_EQ(due[0].count, 2u);
+}
+
+TEST(GapStatsTest, FillHistogramBuckets)
+{
+    EXPECT_EQ(GapStats::bucketOf(500us), 0u);
+    EXPECT_EQ(GapStats::bucketOf(1ms), 1u);
+    EXPECT_EQ(GapStats::bucketOf(3ms), 2u);
+    EXPECT_EQ(GapStats::bucketOf(1023ms), GapStats::FILL_BUCKETS - 2);
+    EXPECT_EQ(GapStats::bucketOf(60s), GapStats::FILL_BUCKETS - 1);
+    EXPECT_NE(GapStats{}.format().find("fillMs=[<1:0 <2:0"), std::string::npos);
+}
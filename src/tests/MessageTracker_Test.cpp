@@ -0,0 +1,58 @@
+#include "TcpVCWriteThread.h"
+#include <gtest/gtest.h>
+
+TEST(MessageTrackerTest, RecordsConnectionAndSendTime)
+{
+    MessageTracker tracker(16);
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+                   .count();
+    tracker.recordMessage(5, 3, now - 250);
+
+    MessageTracker::Record rec;
+    ASSERT_TRUE(tracker.lookup(5, rec));
+    EXPECT_EQ(rec.connectionIndex, 3);
+    EXPECT_EQ(rec.sendTimeMs, now - 250);
+    EXPECT_EQ(tracker.getConnectionIndex(6), -1);
+}
+
+TEST(MessageTrackerTest, ConnectionZeroIsNotEmpty)
+{
+    MessageTracker tracker(16);
+    EXPECT_EQ(tracker.getConnectionIndex(0), -1);
+    tracker.recordMessage(0, 0);
+    EXPECT_EQ(tracker.getConnectionIndex(0), 0);
+}
+
+// A record overwritten by a later lap of the ring must not answer for the old ID.
+TEST(MessageTrackerTest, LaterLapReplacesRecord)
+{
+    MessageTracker tracker(16);
+    EXPECT_EQ(tracker.capacity(), 16u);
+    tracker.recordMessage(2, 1);
+    tracker.recordMessage(2 + 16, 7);
+
+    EXPECT_EQ(tracker.getConnectionIndex(2), -1);
+    EXPECT_EQ(tracker.getConnectionIndex(2 + 16), 7);
+}
+
+TEST(MessageTrackerTest, RemoveOnlyClearsMatchingId)
+{
+    MessageTracker tracker(16);
+    tracker.recordMessage(4 + 16, 2);
+    tracker.removeMessage(4);
+    EXPECT_EQ(tracker.getConnectionIndex(4 + 16), 2);
+
+    tracker.removeMessage(4 + 16);
+    EXPECT_EQ(tracker.getConnectionIndex(4 + 16), -1);
+}
+
+TEST(MessageTrackerTest, ClearForgetsEverything)
+{
+    MessageTracker tracker(16);
+    for (uint64_t id = 0; id < 16; id++)
+        tracker.recordMessage(id, static_cast<int>(id % 4));
+    tracker.clear();
+    for (uint64_t id = 0; id < 16; id++)
+        EXPECT_EQ(tracker.getConnectionIndex(id), -1);
+}
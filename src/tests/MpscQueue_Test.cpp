@@ -0,0 +1,286 @@
+#include "BlockingQueue.h"
+#include "MpscQueue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static PacketBuffer MakeItem(uint32_t value)
+{
+    return PacketBuffer::copyOf(&value, sizeof(value));
+}
+
+static uint32_t ValueOf(const PacketBuffer &item)
+{
+    uint32_t value = 0;
+    std::memcpy(&value, item.data(), sizeof(value));
+    return value;
+}
+
+TEST(MpscQueueTest, FifoSingleProducer)
+{
+    MpscQueue q(8);
+    for (uint32_t i = 0; i < 5; i++)
+        ASSERT_TRUE(q.enqueue(MakeItem(i)));
+    EXPECT_EQ(q.approxSize(), 5u);
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        auto item = q.tryDequeue();
+        ASSERT_TRUE(item);
+        EXPECT_EQ(ValueOf(item), i);
+    }
+    EXPECT_FALSE(q.tryDequeue());
+    EXPECT_EQ(q.approxSize(), 0u);
+}
+
+TEST(MpscQueueTest, StampsEnqueueTimeWhenAsked)
+{
+    MpscQueue plain(8);
+    ASSERT_TRUE(plain.enqueue(MakeItem(1)));
+    std::chrono::steady_clock::time_point enqueuedAt = std::chrono::steady_clock::now();
+    ASSERT_TRUE(plain.tryDequeue(enqueuedAt));
+    EXPECT_EQ(enqueuedAt, std::chrono::steady_clock::time_point{});
+
+    MpscQueue stamped(8, true);
+    auto before = std::chrono::steady_clock::now();
+    ASSERT_TRUE(stamped.enqueue(MakeItem(2)));
+    auto after = std::chrono::steady_clock::now();
+    auto item = stamped.tryDequeue(enqueuedAt);
+    ASSERT_TRUE(item);
+    EXPECT_EQ(ValueOf(item), 2u);
+    EXPECT_GE(enqueuedAt, before);
+    EXPECT_LE(enqueuedAt, after);
+}
+
+TEST(MpscQueueTest, RejectsWhenFullAndRecoversAfterDequeue)
+{
+    MpscQueue q(4);
+    ASSERT_EQ(q.capacity(), 4u);
+    for (uint32_t i = 0; i < 4; i++)
+        ASSERT_TRUE(q.enqueue(MakeItem(i)));
+    EXPECT_FALSE(q.enqueue(MakeItem(99)));
+    EXPECT_EQ(q.approxSize(), 4u);
+
+    ASSERT_TRUE(q.tryDequeue());
+    EXPECT_TRUE(q.enqueue(MakeItem(4)));
+
+    std::vector<PacketBuffer> out;
+    EXPECT_EQ(q.tryDequeueMany(out, 10), 4u);
+    ASSERT_EQ(out.size(), 4u);
+    for (uint32_t i = 0; i < 4; i++)
+        EXPECT_EQ(ValueOf(out[i]), i + 1);
+}
+
+TEST(MpscQueueTest, TryDequeueManyRespectsLimitAndAppends)
+{
+    MpscQueue q(16);
+    for (uint32_t i = 0; i < 10; i++)
+        q.enqueue(MakeItem(i));
+
+    std::vector<PacketBuffer> out;
+    out.push_back(MakeItem(1000));
+    EXPECT_EQ(q.tryDequeueMany(out, 3), 3u);
+    ASSERT_EQ(out.size(), 4u);
+    EXPECT_EQ(ValueOf(out[0]), 1000u);
+    EXPECT_EQ(ValueOf(out[3]), 2u);
+    EXPECT_EQ(q.approxSize(), 7u);
+}
+
+TEST(MpscQueueTest, TagsTravelWithItems)
+{
+    MpscQueue q(16);
+    for (uint32_t i = 0; i < 4; i++)
+        q.enqueue(MakeItem(i), 100 + i);
+
+    std::vector<PacketBuffer> out;
+    std::vector<uint64_t> tags;
+    EXPECT_EQ(q.tryDequeueMany(out, tags, 3), 3u);
+    ASSERT_EQ(tags.size(), 3u);
+    EXPECT_EQ(tags[0], 100u);
+    EXPECT_EQ(tags[2], 102u);
+    EXPECT_EQ(ValueOf(out[2]), 2u);
+}
+
+TEST(MpscQueueTest, CancelWaitRejectsAndWakes)
+{
+    MpscQueue q;
+    std::atomic<int> wakes{0};
+    q.setEnqueueNotifier([&] { wakes++; });
+    q.enqueue(MakeItem(1));
+
+    q.cancelWait();
+    EXPECT_TRUE(q.isCancelled());
+    EXPECT_EQ(wakes.load(), 1);
+    EXPECT_FALSE(q.tryDequeue());
+    EXPECT_FALSE(q.enqueue(MakeItem(2)));
+}
+
+TEST(MpscQueueTest, NotifierOnlyCalledWhenParked)
+{
+    MpscQueue q;
+    std::atomic<int> wakes{0};
+    q.setEnqueueNotifier([&] { wakes++; });
+
+    q.enqueue(MakeItem(1));
+    EXPECT_EQ(wakes.load(), 0);
+
+    q.park();
+    q.enqueue(MakeItem(2));
+    q.enqueue(MakeItem(3));
+    EXPECT_EQ(wakes.load(), 1); // the first enqueue clears the park flag
+
+    q.unpark();
+    q.enqueue(MakeItem(4));
+    EXPECT_EQ(wakes.load(), 1);
+}
+
+// Several producers against a consumer that parks whenever the queue runs dry: every
+// item must arrive exactly once and in per-producer order. The wait has a backstop
+// like the send thread's IDLE_WAIT_MS, since some glibc versions can lose a
+// condvar signal.
+TEST(MpscQueueTest, ConcurrentProducersWithParkingConsumer)
+{
+    constexpr uint32_t producers = 4;
+    constexpr uint32_t perProducer = 20000;
+    MpscQueue q(256);
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    q.setEnqueueNotifier([&] {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+        }
+        cv.notify_one();
+    });
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&, p] {
+            for (uint32_t i = 0; i < perProducer; i++)
+            {
+                while (!q.enqueue(MakeItem((p << 24) | i)))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<uint32_t> nextExpected(producers, 0);
+    std::vector<PacketBuffer> batch;
+    size_t received = 0;
+    while (received < producers * perProducer)
+    {
+        batch.clear();
+        if (q.tryDequeueMany(batch, 64) == 0)
+        {
+            std::unique_lock<std::mutex> lk(mtx);
+            q.park();
+            cv.wait_for(lk, std::chrono::milliseconds(100), [&] { return q.approxSize() > 0; });
+            q.unpark();
+            continue;
+        }
+        for (auto &item : batch)
+        {
+            uint32_t value = ValueOf(item);
+            uint32_t p = value >> 24;
+            ASSERT_LT(p, producers);
+            ASSERT_EQ(value & 0xFFFFFF, nextExpected[p]);
+            nextExpected[p]++;
+        }
+        received += batch.size();
+    }
+
+    for (auto &t : threads)
+        t.join();
+    EXPECT_EQ(q.approxSize(), 0u);
+    for (uint32_t p = 0; p < producers; p++)
+        EXPECT_EQ(nextExpected[p], perProducer);
+}
+
+// Throughput of the send-queue hand-off under producer contention. Each producer
+// enqueues pre-built buffers; a single consumer drains until it has them all. On a
+// machine with few cores the BlockingQueue side can degrade to a context switch per
+// item (every enqueue wakes the consumer), so the item count is kept modest.
+TEST(MpscQueueBenchmark, DISABLED_ContentionVsBlockingQueue)
+{
+    constexpr size_t totalItems = 200000;
+    auto payload = PacketBuffer::allocate(64);
+
+    for (int producers : {1, 2, 4, 8})
+    {
+        const size_t perProducer = totalItems / producers;
+        const size_t expected = perProducer * producers;
+
+        auto run = [&](auto &&produce, auto &&consume) {
+            std::atomic<bool> go{false};
+            std::vector<std::thread> threads;
+            for (int p = 0; p < producers; p++)
+            {
+                threads.emplace_back([&] {
+                    while (!go.load(std::memory_order_acquire))
+                        std::this_thread::yield();
+                    for (size_t i = 0; i < perProducer; i++)
+                        produce(payload);
+                });
+            }
+            auto start = std::chrono::steady_clock::now();
+            go.store(true, std::memory_order_release);
+            consume(expected);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            for (auto &t : threads)
+                t.join();
+            return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(expected);
+        };
+
+        BlockingQueue blocking;
+        double blockingNs = run([&](const PacketBuffer &item) { blocking.enqueue(item); },
+                                [&](size_t n) {
+                                    for (size_t got = 0; got < n; got++)
+                                        blocking.dequeue();
+                                });
+
+        MpscQueue mpsc(1 << 16);
+        std::mutex mtx;
+        std::condition_variable cv;
+        mpsc.setEnqueueNotifier([&] {
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+            }
+            cv.notify_one();
+        });
+        double mpscNs = run(
+            [&](const PacketBuffer &item) {
+                while (!mpsc.enqueue(item))
+                    std::this_thread::yield();
+            },
+            [&](size_t n) {
+                std::vector<PacketBuffer> batch;
+                batch.reserve(64);
+                for (size_t got = 0; got < n;)
+                {
+                    batch.clear();
+                    size_t taken = mpsc.tryDequeueMany(batch, 64);
+                    if (taken == 0)
+                    {
+                        std::unique_lock<std::mutex> lk(mtx);
+                        mpsc.park();
+                        cv.wait_for(lk, std::chrono::milliseconds(100), [&] { return mpsc.approxSize() > 0; });
+                        mpsc.unpark();
+                    }
+                    got += taken;
+                }
+            });
+
+        std::printf("[BENCH] send queue producers=%d items=%zu BlockingQueue=%.1f ns/item MpscQueue=%.1f ns/item "
+                    "speedup=%.1fx\n",
+                    producers, expected, blockingNs, mpscNs, blockingNs / mpscNs);
+        std::fflush(stdout);
+        EXPECT_EQ(mpsc.approxSize(), 0u);
+    }
+}
@@ -0,0 +1,151 @@
+#include "PacketBuffer.h"
+#include "VcProtocol.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A full VC data frame must fit one pooled block, otherwise every packet would
+// fall through to the heap.
+TEST(PacketBufferTest, MaxFrameFitsSizeClass)
+{
+    PacketPool pool;
+    auto buf = pool.allocate(sizeof(VCDataPacket) + VC_MAX_DATA_PAYLOAD_SIZE);
+    ASSERT_TRUE(buf);
+    EXPECT_EQ(buf.size(), sizeof(VCDataPacket) + VC_MAX_DATA_PAYLOAD_SIZE);
+    EXPECT_EQ(pool.getStats().oversize, 0u);
+}
+
+TEST(PacketBufferTest, CopyOfPreservesBytes)
+{
+    const char payload[] = "hello pool";
+    auto buf = PacketBuffer::copyOf(payload, sizeof(payload));
+    ASSERT_TRUE(buf);
+    ASSERT_EQ(buf.size(), sizeof(payload));
+    EXPECT_EQ(std::memcmp(buf.data(), payload, sizeof(payload)), 0);
+}
+
+TEST(PacketBufferTest, CopySharesBlockAndMoveTransfers)
+{
+    PacketPool pool;
+    auto a = pool.allocate(100);
+    EXPECT_EQ(a.useCount(), 1u);
+
+    auto b = a;
+    EXPECT_EQ(a.data(), b.data());
+    EXPECT_EQ(a.useCount(), 2u);
+
+    auto c = std::move(b);
+    EXPECT_FALSE(b);
+    EXPECT_EQ(c.useCount(), 2u);
+
+    c.reset();
+    EXPECT_EQ(a.useCount(), 1u);
+}
+
+// Released blocks go back to the free list and are reused without touching the heap.
+TEST(PacketBufferTest, ReleasedBlockIsReused)
+{
+    PacketPool pool;
+    const char *first = nullptr;
+    {
+        auto buf = pool.allocate(1500);
+        first = buf.data();
+    }
+    auto again = pool.allocate(1500);
+    EXPECT_EQ(again.data(), first);
+
+    auto stats = pool.getStats();
+    const auto &cls = stats.classes[2];
+    EXPECT_EQ(cls.misses, 1u);
+    EXPECT_EQ(cls.hits, 1u);
+    EXPECT_EQ(cls.outstanding, 1u);
+    EXPECT_EQ(cls.highWater, 1u);
+}
+
+TEST(PacketBufferTest, HighWaterTracksPeakOutstanding)
+{
+    PacketPool pool;
+    {
+        std::vector<PacketBuffer> held;
+        for (int i = 0; i < 10; i++)
+            held.push_back(pool.allocate(64));
+    }
+    auto stats = pool.getStats();
+    EXPECT_EQ(stats.classes[0].outstanding, 0u);
+    EXPECT_EQ(stats.classes[0].highWater, 10u);
+}
+
+TEST(PacketBufferTest, ResizeWithinCapacity)
+{
+    PacketPool pool;
+    auto buf = pool.allocate(10);
+    EXPECT_TRUE(buf.resize(100));
+    EXPECT_EQ(buf.size(), 100u);
+    EXPECT_FALSE(buf.resize(PacketPool::SIZE_CLASSES[0] + 1));
+    EXPECT_EQ(buf.size(), 100u);
+}
+
+TEST(PacketBufferTest, PrependGrowsIntoHeadroom)
+{
+    PacketPool pool;
+    auto buf = pool.allocate(100, sizeof(VCDataPacket));
+    char *payload = buf.data();
+    EXPECT_EQ(buf.headroom(), sizeof(VCDataPacket));
+
+    ASSERT_TRUE(buf.prepend(sizeof(VCDataPacket)));
+    EXPECT_EQ(buf.headroom(), 0u);
+    EXPECT_EQ(buf.size(), 100 + sizeof(VCDataPacket));
+    EXPECT_EQ(buf.data() + sizeof(VCDataPacket), payload);
+
+    EXPECT_FALSE(buf.prepend(1));
+    EXPECT_EQ(buf.size(), 100 + sizeof(VCDataPacket));
+}
+
+TEST(PacketBufferTest, OversizeFallsBackToHeap)
+{
+    PacketPool pool;
+    auto buf = pool.allocate(PacketPool::SIZE_CLASSES.back() + 1);
+    ASSERT_TRUE(buf);
+    EXPECT_EQ(pool.getStats().oversize, 1u);
+}
+
+// Allocate on one thread and release on another, as the VC does between the UDP
+// reader and the send thread.
+TEST(PacketBufferTest, CrossThreadRelease)
+{
+    PacketPool pool;
+    const int N = 5000;
+    std::vector<PacketBuffer> bufs;
+    bufs.reserve(N);
+    for (int i = 0; i < N; i++)
+        bufs.push_back(pool.allocate(2000));
+
+    std::thread releaser([&]() { bufs.clear(); });
+    releaser.join();
+
+    auto stats = pool.getStats();
+    EXPECT_EQ(stats.classes[2].outstanding, 0u);
+    EXPECT_EQ(stats.classes[2].highWater, static_cast<size_t>(N));
+}
+
+TEST(PacketBufferTest, SliceSharesBlock)
+{
+    const char payload[] = "header|payload";
+    auto buf = PacketBuffer::copyOf(payload, sizeof(payload) - 1);
+
+    auto view = buf.slice(7, 7);
+    ASSERT_TRUE(view);
+    EXPECT_EQ(std::string(view.data(), view.size()), "payload");
+    EXPECT_EQ(view.data(), buf.data() + 7);
+    EXPECT_EQ(buf.useCount(), 2u);
+
+    EXPECT_FALSE(buf.slice(10, 5));
+    EXPECT_FALSE(buf.slice(15, 0));
+    EXPECT_TRUE(buf.slice(14, 0));
+
+    buf.reset();
+    EXPECT_EQ(std::string(view.data(), view.size()), "payload");
+    EXPECT_EQ(view.useCount(), 1u);
+}
@@ -0,0 +1,114 @@
+#include "ReceiveRing.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static void Write(ReceiveRing &ring, const std::string &bytes)
+{
+    size_t done = 0;
+    while (done < bytes.size())
+    {
+        size_t n = std::min(ring.writable(), bytes.size() - done);
+        ASSERT_GT(n, 0u);
+        std::memcpy(ring.writePtr(), bytes.data() + done, n);
+        ring.commitWrite(n);
+        done += n;
+    }
+}
+
+// A frame written across the end of the ring reads back as one contiguous run.
+TEST(MirroredRingTest, WrappedBytesAreContiguous)
+{
+    MirroredRing ring(8192);
+    ASSERT_GE(ring.size(), 8192u);
+    uint64_t pos = ring.size() - 5;
+    const std::string frame = "0123456789";
+
+    size_t first = ring.writableAt(pos, frame.size());
+    std::memcpy(ring.at(pos), frame.data(), first);
+    ring.commit(pos, first);
+    if (first < frame.size())
+    {
+        std::memcpy(ring.at(pos + first), frame.data() + first, frame.size() - first);
+        ring.commit(pos + first, frame.size() - first);
+    }
+
+    EXPECT_EQ(std::string(ring.at(pos), frame.size()), frame);
+    EXPECT_EQ(std::string(ring.at(0), 5), "56789");
+}
+
+TEST(ReceiveRingTest, ParsesAcrossWrapPoint)
+{
+    auto ring = ReceiveRing::create(8192);
+    const size_t size = ring->size();
+
+    // Park the positions just short of the end, then write a frame straddling it.
+    Write(*ring, std::string(size - 3, 'x'));
+    ring->consume(size - 3);
+    Write(*ring, "header+payload");
+
+    ASSERT_EQ(ring->available(), 14u);
+    EXPECT_EQ(std::string(ring->readPtr(), 14), "header+payload");
+    auto view = ring->view(7, 7);
+    EXPECT_EQ(std::string(view.data(), view.size()), "payload");
+}
+
+// Space behind an outstanding view is not reused until the view is released.
+TEST(ReceiveRingTest, ViewPinsRingUntilReleased)
+{
+    auto ring = ReceiveRing::create(8192);
+    const size_t size = ring->size();
+    Write(*ring, "abcdefgh");
+
+    auto view = ring->view(2, 4);
+    ring->consume(8);
+    EXPECT_EQ(ring->writable(), size - 6); // "cdef" onwards still pinned
+    auto copy = view;
+    view.reset();
+    EXPECT_EQ(ring->writable(), size - 6);
+
+    copy.reset();
+    EXPECT_EQ(ring->writable(), size);
+}
+
+// Retiring the ring (connection replaced) must not invalidate views still in flight.
+TEST(ReceiveRingTest, ViewOutlivesRetiredRing)
+{
+    auto ring = ReceiveRing::create(8192);
+    Write(*ring, "still here");
+    auto view = ring->view(0, 10);
+    ring.reset();
+    EXPECT_EQ(std::string(view.data(), view.size()), "still here");
+}
+
+TEST(ReceiveRingTest, CopiesWhenSpanDescriptorsRunOut)
+{
+    auto ring = ReceiveRing::create(64 * 1024);
+    std::vector<PacketBuffer> views;
+    Write(*ring, std::string(ReceiveRing::MAX_SPANS + 1, 'v'));
+    for (size_t i = 0; i < ReceiveRing::MAX_SPANS; i++)
+    {
+        views.push_back(ring->view(0, 1));
+        EXPECT_EQ(views.back().data(), ring->readPtr());
+        ring->consume(1);
+    }
+
+    auto copied = ring->view(0, 1);
+    ASSERT_TRUE(copied);
+    EXPECT_NE(copied.data(), ring->readPtr());
+    EXPECT_EQ(copied.data()[0], 'v');
+
+    views.clear();
+    auto again = ring->view(0, 1);
+    EXPECT_EQ(again.data(), ring->readPtr());
+}
+
+TEST(ReceiveRingTest, FullRingReportsNoSpace)
+{
+    auto ring = ReceiveRing::create(8192);
+    Write(*ring, std::string(ring->size(), 'f'));
+    EXPECT_EQ(ring->writable(), 0u);
+    ring->consume(100);
+    EXPECT_EQ(ring->writable(), 100u);
+}
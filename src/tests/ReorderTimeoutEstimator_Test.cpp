@@ -0,0 +1,69 @@
+#include "ReorderTimeoutEstimator.h"
+#include <gtest/gtest.h>
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+TEST(ReorderTimeoutEstimatorTest, StartsAtInitialAndFollowsGapFillTimes)
+{
+    auto stats = std::make_shared<ReorderTimeoutStats>();
+    ReorderTimeoutEstimator estimator(stats);
+    EXPECT_EQ(estimator.timeout(), VC_INITIAL_REORDER_TIMEOUT);
+
+    // A short path: gaps fill within ~40ms, so the timeout drops to the lower bound.
+    for (int i = 0; i < 50; i++)
+        estimator.onGapFilled(i % 2 ? 30ms : 50ms);
+    EXPECT_EQ(estimator.timeout(), VC_MIN_REORDER_TIMEOUT);
+    EXPECT_EQ(stats->samples.load(), 50u);
+    EXPECT_EQ(stats->timeoutUs.load(), 300000u);
+
+    // A long path: gap fills around 1.5s give srtt + 4 * rttvar above them.
+    ReorderTimeoutEstimator slow;
+    for (int i = 0; i < 50; i++)
+        slow.onGapFilled(i % 2 ? 1400ms : 1600ms);
+    EXPECT_GT(slow.timeout(), 1600ms);
+    EXPECT_LT(slow.timeout(), 2500ms);
+}
+
+TEST(ReorderTimeoutEstimatorTest, RecoveryTimeAndBoundsLimitTheTimeout)
+{
+    ReorderTimeoutEstimator estimator;
+    for (int i = 0; i < 20; i++)
+        estimator.onGapFilled(10ms);
+    estimator.setRecoveryTime(1200ms);
+    EXPECT_EQ(estimator.timeout(), 1200ms);
+
+    estimator.setBounds(100ms, 1000ms);
+    EXPECT_EQ(estimator.timeout(), 1000ms);
+    estimator.setRecoveryTime(0ms);
+    EXPECT_EQ(estimator.timeout(), 100ms);
+}
+
+TEST(ReorderTimeoutEstimatorTest, LateFillRaisesTheTimeoutAtOnce)
+{
+    auto stats = std::make_shared<ReorderTimeoutStats>();
+    ReorderTimeoutEstimator estimator(stats);
+    for (int i = 0; i < 20; i++)
+        estimator.onGapFilled(20ms);
+    ASSERT_EQ(estimator.timeout(), VC_MIN_REORDER_TIMEOUT);
+
+    // A frame the 300ms timeout gave up on turned up 700ms after its gap opened.
+    estimator.onLateFill(700ms);
+    EXPECT_GT(estimator.timeout(), 700ms);
+    EXPECT_EQ(stats->lateFills.load(), 1u);
+}
+
+TEST(ReorderTimeoutEstimatorTest, FixedTimeoutOverridesTheEstimate)
+{
+    auto stats = std::make_shared<ReorderTimeoutStats>();
+    ReorderTimeoutEstimator estimator(stats);
+    estimator.setFixed(8000ms);
+    for (int i = 0; i < 20; i++)
+        estimator.onGapFilled(20ms);
+    EXPECT_EQ(estimator.timeout(), 8000ms);
+    EXPECT_TRUE(stats->fixed.load());
+
+    estimator.setFixed(0ms);
+    EXPECT_EQ(estimator.timeout(), VC_MIN_REORDER_TIMEOUT);
+    EXPECT_FALSE(stats->fixed.load());
+}
@@ -0,0 +1,40 @@
+#include "RttEstimator.h"
+#include <gtest/gtest.h>
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+TEST(RttEstimatorTest, FirstSampleSeedsTheEstimate)
+{
+    RttEstimator rtt;
+    EXPECT_TRUE(rtt.empty());
+    EXPECT_EQ(rtt.rto(), 0us);
+
+    rtt.sample(-5);
+    EXPECT_TRUE(rtt.empty());
+
+    rtt.sample(10000);
+    EXPECT_DOUBLE_EQ(rtt.srtt(), 10000);
+    EXPECT_DOUBLE_EQ(rtt.rttvar(), 5000);
+    EXPECT_EQ(rtt.rto(), 30000us);
+}
+
+TEST(RttEstimatorTest, SmoothsLaterSamplesAndFloorsTheVariance)
+{
+    RttEstimator rtt;
+    rtt.sample(10000);
+    rtt.sample(18000);
+    // rttvar = 3/4 * 5000 + 1/4 * 8000, srtt = 7/8 * 10000 + 1/8 * 18000
+    EXPECT_DOUBLE_EQ(rtt.rttvar(), 5750);
+    EXPECT_DOUBLE_EQ(rtt.srtt(), 11000);
+
+    // A steady path: the variance decays, the floor keeps some slack.
+    for (int i = 0; i < 100; i++)
+        rtt.sample(11000);
+    EXPECT_EQ(rtt.rto(4, 1ms), 12000us);
+
+    rtt.floorSrtt(20000);
+    EXPECT_DOUBLE_EQ(rtt.srtt(), 20000);
+    rtt.floorSrtt(15000);
+    EXPECT_DOUBLE_EQ(rtt.srtt(), 20000);
+}
@@ -0,0 +1,171 @@
+#include "SentDataCache.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+
+static PacketBuffer MakeFrame(const std::string &text)
+{
+    return PacketBuffer::copyOf(text.data(), text.size());
+}
+
+static std::string ToString(const PacketBuffer &buf)
+{
+    return std::string(buf.data(), buf.size());
+}
+
+TEST(SentDataCacheTest, FindReturnsInsertedFrame)
+{
+    SentDataCache cache(16, 1 << 20);
+    cache.insert(7, MakeFrame("seven"));
+
+    auto found = cache.find(7);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(ToString(found), "seven");
+    EXPECT_FALSE(cache.find(8));
+
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+}
+
+TEST(SentDataCacheTest, CapacityRoundsUpToPowerOfTwo)
+{
+    SentDataCache cache(100, 1 << 20);
+    EXPECT_EQ(cache.capacity(), 128u);
+}
+
+// The cache and the returned handle share one block; nothing is copied.
+TEST(SentDataCacheTest, FindSharesCachedBlock)
+{
+    SentDataCache cache(16, 1 << 20);
+    auto frame = MakeFrame("shared");
+    const char *bytes = frame.data();
+    cache.insert(1, frame);
+
+    auto found = cache.find(1);
+    EXPECT_EQ(found.data(), bytes);
+    EXPECT_EQ(found.useCount(), 3u); // frame, cache slot, found
+}
+
+// A slot reused by messageId + capacity evicts the older frame even if it is young.
+TEST(SentDataCacheTest, RingWrapOverwritesOldLap)
+{
+    SentDataCache cache(4, 1 << 20);
+    for (uint64_t id = 0; id < 6; id++)
+        cache.insert(id, MakeFrame(std::to_string(id)));
+
+    EXPECT_FALSE(cache.find(0));
+    EXPECT_FALSE(cache.find(1));
+    for (uint64_t id = 2; id < 6; id++)
+        EXPECT_EQ(ToString(cache.find(id)), std::to_string(id));
+
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.entries, 4u);
+    EXPECT_EQ(stats.forcedEvictions, 2u);
+}
+
+// The ID range bounds what may still be cached, across ring wraps and releases.
+TEST(SentDataCacheTest, IdRangeCoversCachedFrames)
+{
+    SentDataCache cache(4, 1 << 20);
+    EXPECT_EQ(cache.idRange(), (std::pair<uint64_t, uint64_t>{0, 0}));
+    for (uint64_t id = 10; id < 16; id++)
+        cache.insert(id, MakeFrame(std::to_string(id)));
+    EXPECT_EQ(cache.idRange(), (std::pair<uint64_t, uint64_t>{12, 16}));
+
+    cache.releaseBelow(14);
+    EXPECT_EQ(cache.idRange(), (std::pair<uint64_t, uint64_t>{14, 16}));
+    cache.releaseBelow(16);
+    EXPECT_EQ(cache.idRange().first, cache.idRange().second);
+}
+
+// Frames younger than the minimum age survive even when the byte budget is exceeded.
+TEST(SentDataCacheTest, YoungFramesOutliveByteBudget)
+{
+    SentDataCache cache(64, 10);
+    cache.setMinAge(std::chrono::seconds(60));
+    for (uint64_t id = 0; id < 8; id++)
+        cache.insert(id, MakeFrame("0123456789"));
+
+    for (uint64_t id = 0; id < 8; id++)
+        EXPECT_TRUE(cache.find(id)) << id;
+    EXPECT_EQ(cache.getStats().budgetEvictions, 0u);
+    EXPECT_EQ(cache.getStats().bytes, 80u);
+}
+
+// Once frames are older than the minimum age the budget evicts oldest first.
+TEST(SentDataCacheTest, AgedFramesEvictedOldestFirst)
+{
+    SentDataCache cache(64, 30);
+    cache.setMinAge(std::chrono::microseconds(0));
+    for (uint64_t id = 0; id < 8; id++)
+        cache.insert(id, MakeFrame("0123456789"));
+
+    for (uint64_t id = 0; id < 5; id++)
+        EXPECT_FALSE(cache.find(id)) << id;
+    for (uint64_t id = 5; id < 8; id++)
+        EXPECT_TRUE(cache.find(id)) << id;
+
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.budgetEvictions, 5u);
+    EXPECT_EQ(stats.bytes, 30u);
+    EXPECT_EQ(stats.entries, 3u);
+}
+
+TEST(SentDataCacheTest, ClearReleasesFrames)
+{
+    SentDataCache cache(16, 1 << 20);
+    auto frame = MakeFrame("x");
+    cache.insert(3, frame);
+    EXPECT_EQ(frame.useCount(), 2u);
+
+    cache.clear();
+    EXPECT_EQ(frame.useCount(), 1u);
+    EXPECT_FALSE(cache.find(3));
+    EXPECT_EQ(cache.getStats().entries, 0u);
+}
+
+// Lookups racing a sender that laps a small ring must only ever see the frame they
+// asked for, never a torn or recycled one.
+TEST(SentDataCacheTest, ConcurrentInsertAndFind)
+{
+    SentDataCache cache(64, 1 << 20);
+    cache.setMinAge(std::chrono::microseconds(0));
+    const uint64_t N = 200000;
+    std::atomic<uint64_t> published{0};
+    std::atomic<int> mismatches{0};
+
+    std::thread sender([&]() {
+        for (uint64_t id = 0; id < N; id++)
+        {
+            auto frame = PacketBuffer::allocate(sizeof(uint64_t));
+            std::memcpy(frame.data(), &id, sizeof(id));
+            cache.insert(id, std::move(frame));
+            published.store(id, std::memory_order_release);
+        }
+    });
+
+    std::thread reader([&]() {
+        while (published.load(std::memory_order_acquire) + 1 < N)
+        {
+            uint64_t want = published.load(std::memory_order_acquire);
+            for (uint64_t id = want > 32 ? want - 32 : 0; id <= want; id++)
+            {
+                auto found = cache.find(id);
+                if (!found)
+                    continue;
+                uint64_t got = 0;
+                std::memcpy(&got, found.data(), sizeof(got));
+                if (got != id)
+                    mismatches++;
+            }
+        }
+    });
+
+    sender.join();
+    reader.join();
+    EXPECT_EQ(mismatches.load(), 0);
+}
@@ -0,0 +1,93 @@
+#include "ServerConfiguration.h"
+#include "TokenBucket.h"
+#include <gtest/gtest.h>
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+TEST(TokenBucketTest, ParsesRateAndBurst)
+{
+    RateLimit limit;
+    ASSERT_TRUE(RateLimit::parse("2M:256K", limit));
+    EXPECT_EQ(limit.bytesPerSec, 2u * 1024 * 1024);
+    EXPECT_EQ(limit.burstBytes, 256u * 1024);
+
+    ASSERT_TRUE(RateLimit::parse("1000000", limit));
+    EXPECT_EQ(limit.bytesPerSec, 1000000u);
+    EXPECT_EQ(limit.effectiveBurst(), 50000u); // 50ms of the rate
+
+    EXPECT_FALSE(RateLimit::parse("", limit));
+    EXPECT_FALSE(RateLimit::parse("fast", limit));
+    EXPECT_FALSE(RateLimit::parse("1X", limit));
+    EXPECT_FALSE(RateLimit::parse("1M:", limit));
+    // Too large for 64 bits once scaled, rather than wrapping to another rate.
+    EXPECT_FALSE(RateLimit::parse("99999999999G", limit));
+    EXPECT_FALSE(RateLimit::parse("1K:99999999999G", limit));
+}
+
+TEST(TokenBucketTest, AllowsBurstThenRate)
+{
+    auto t0 = TokenBucket::Clock::now();
+    TokenBucket bucket(RateLimit{100000, 10000}, t0); // 100 KB/s, 10 KB burst
+
+    for (int i = 0; i < 10; i++)
+        EXPECT_TRUE(bucket.tryConsume(1000, t0));
+    EXPECT_FALSE(bucket.tryConsume(1000, t0));
+    using Ms = std::chrono::duration<double, std::milli>;
+    EXPECT_NEAR(Ms(bucket.timeUntil(1000, t0)).count(), 10.0, 0.1);
+
+    // 10ms refills 1000 bytes; a long pause refills only up to the burst.
+    EXPECT_TRUE(bucket.tryConsume(1000, t0 + 10ms));
+    EXPECT_FALSE(bucket.tryConsume(1000, t0 + 10ms));
+    int passed = 0;
+    while (bucket.tryConsume(1000, t0 + 10s))
+        passed++;
+    EXPECT_EQ(passed, 10);
+}
+
+TEST(TokenBucketTest, OversizedPacketWaitsForFullBucket)
+{
+    auto t0 = TokenBucket::Clock::now();
+    TokenBucket bucket(RateLimit{100000, 1000}, t0);
+    EXPECT_TRUE(bucket.tryConsume(3000, t0)); // full bucket: passes, goes into debt
+    EXPECT_FALSE(bucket.tryConsume(100, t0 + 20ms));
+    EXPECT_TRUE(bucket.tryConsume(100, t0 + 21ms));
+
+    TokenBucket unlimited;
+    EXPECT_TRUE(unlimited.tryConsume(1 << 30));
+    EXPECT_EQ(unlimited.timeUntil(1 << 30), TokenBucket::Clock::duration::zero());
+}
+
+TEST(TokenBucketTest, SetLimitKeepsTokensUpToNewBurst)
+{
+    auto t0 = TokenBucket::Clock::now();
+    TokenBucket bucket(RateLimit{100000, 10000}, t0);
+    EXPECT_TRUE(bucket.tryConsume(4000, t0)); // 6000 left
+
+    // A lower rate with a smaller burst caps what was saved up.
+    bucket.setLimit(RateLimit{50000, 5000}, t0);
+    EXPECT_TRUE(bucket.tryConsume(5000, t0));
+    EXPECT_FALSE(bucket.tryConsume(1000, t0));
+    using Ms = std::chrono::duration<double, std::milli>;
+    EXPECT_NEAR(Ms(bucket.timeUntil(1000, t0)).count(), 20.0, 0.1);
+
+    bucket.setLimit(RateLimit{}, t0);
+    EXPECT_TRUE(bucket.unlimited());
+    EXPECT_TRUE(bucket.tryConsume(1 << 20, t0));
+}
+
+TEST(TokenBucketTest, ServerAppliesPerClientOverride)
+{
+    auto *config = ServerConfiguration::getInstance();
+    config->setDefaultRateLimit(RateLimit{1000000, 0});
+    ASSERT_TRUE(config->parseClientRateLimit("42=5M:1M"));
+    EXPECT_FALSE(config->parseClientRateLimit("x=5M"));
+    EXPECT_FALSE(config->parseClientRateLimit("43"));
+
+    EXPECT_EQ(config->getRateLimit(42).bytesPerSec, 5u * 1024 * 1024);
+    EXPECT_EQ(config->getRateLimit(42).burstBytes, 1024u * 1024);
+    EXPECT_EQ(config->getRateLimit(7).bytesPerSec, 1000000u);
+
+    config->setDefaultRateLimit(RateLimit{});
+    config->setClientRateLimit(42, RateLimit{});
+}
@@ -0,0 +1,149 @@
+#include "VcCongestionController.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+// Drives a controller with samples 250ms apart, as the send thread does.
+struct Feeder
+{
+    VcCongestionController cc{10ms};
+    VcCongestionController::Clock::time_point now = VcCongestionController::Clock::now();
+    uint64_t delivered = 0;
+
+    uint64_t feed(uint64_t bytes, uint32_t minSrttUs, uint32_t avgSrttUs, bool appLimited = false)
+    {
+        now += 250ms;
+        delivered += bytes;
+        return cc.onSample({now, delivered, minSrttUs, avgSrttUs, appLimited});
+    }
+};
+
+constexpr uint64_t MB = 1024 * 1024;
+} // namespace
+
+TEST(VcCongestionControllerTest, StartupDrainThenProbeBandwidth)
+{
+    Feeder f;
+    EXPECT_EQ(f.feed(0, 20000, 20000), 0u);
+    // The rate doubles and then levels off at 4 MB/s; startup does not pace.
+    for (uint64_t bytes : {MB / 4, MB / 2, MB, MB, MB})
+    {
+        EXPECT_EQ(f.feed(bytes, 20000, 20000), 0u);
+        EXPECT_EQ(f.cc.state(), CongestionState::Startup);
+    }
+    // Third round without 25% growth: the path is full, drain the queue startup built.
+    EXPECT_EQ(f.feed(MB, 20000, 35000), 3 * MB);
+    EXPECT_EQ(f.cc.state(), CongestionState::Drain);
+    EXPECT_EQ(f.cc.bottleneckBandwidth(), 4 * MB);
+
+    // Once the queueing delay is back under target, cruise at the estimate, probing
+    // above it in turn.
+    uint64_t rate = f.feed(MB, 20000, 22000);
+    EXPECT_EQ(f.cc.state(), CongestionState::ProbeBw);
+    EXPECT_EQ(rate, 5 * MB);
+    EXPECT_EQ(f.feed(MB, 20000, 22000), 3 * MB);
+    EXPECT_EQ(f.feed(MB, 20000, 22000), 4 * MB);
+}
+
+TEST(VcCongestionControllerTest, HoldsBelowEstimateWhileQueueAboveTarget)
+{
+    auto stats = std::make_shared<CongestionControlStats>();
+    Feeder f{VcCongestionController(10ms, stats)};
+    f.feed(0, 20000, 20000);
+    // Queueing delay more than twice the target ends startup right away.
+    f.feed(MB, 20000, 20000);
+    f.feed(MB, 20000, 45000);
+    EXPECT_EQ(f.cc.state(), CongestionState::Drain);
+
+    // Every probe-bw phase but the 1.25 probe stays below the estimate.
+    f.feed(MB, 20000, 20000);
+    ASSERT_EQ(f.cc.state(), CongestionState::ProbeBw);
+    for (int i = 0; i < 7; i++)
+        EXPECT_LE(f.feed(MB, 20000, 40000), static_cast<uint64_t>(0.9 * 4 * MB));
+    EXPECT_EQ(f.feed(MB, 20000, 40000), 5 * MB);
+    EXPECT_EQ(stats->state.load(), CongestionState::ProbeBw);
+    EXPECT_EQ(stats->minRttUs.load(), 20000u);
+    EXPECT_EQ(stats->queueDelayUs.load(), 20000u);
+    EXPECT_EQ(stats->btlBwBytesPerSec.load(), 4 * MB);
+}
+
+TEST(VcCongestionControllerTest, KeepsEstimateUnderQueueItDidNotBuild)
+{
+    Feeder f;
+    f.feed(0, 20000, 20000);
+    f.feed(MB, 20000, 20000);
+    f.feed(MB, 20000, 45000);
+    ASSERT_EQ(f.cc.state(), CongestionState::Drain);
+
+    // Cross traffic keeps the queue 20ms deep whatever the VC does, and the VC gets
+    // what it paces at, up to its 4 MB/s share of the path.
+    uint64_t lowest = UINT64_MAX;
+    for (int i = 0; i < 200; i++)
+    {
+        uint64_t rate = f.cc.pacingRate();
+        f.feed(std::min(rate, 4 * MB) / 4, 20000, 40000);
+        if (i >= 100)
+            lowest = std::min(lowest, f.cc.bottleneckBandwidth());
+    }
+    EXPECT_EQ(f.cc.state(), CongestionState::ProbeBw);
+    EXPECT_GE(lowest, 3 * MB);
+}
+
+TEST(VcCongestionControllerTest, AppLimitedSamplesDoNotLowerEstimate)
+{
+    Feeder f;
+    f.feed(0, 20000, 20000);
+    f.feed(MB, 20000, 20000);
+    f.feed(MB, 20000, 45000);
+    f.feed(MB, 20000, 20000);
+    ASSERT_EQ(f.cc.state(), CongestionState::ProbeBw);
+
+    // The sender ran dry for far longer than the bandwidth window.
+    for (int i = 0; i < 20; i++)
+        f.feed(MB / 100, 20000, 20000, true);
+    EXPECT_EQ(f.cc.bottleneckBandwidth(), 4 * MB);
+    EXPECT_GE(f.cc.pacingRate(), 3 * MB);
+
+    // A sender-limited sample does lower it.
+    for (int i = 0; i < 5; i++)
+        f.feed(MB / 2, 20000, 20000);
+    EXPECT_EQ(f.cc.bottleneckBandwidth(), 2 * MB);
+}
+
+TEST(VcCongestionControllerTest, ProbesRttWhenMinimumGoesStale)
+{
+    Feeder f;
+    f.feed(0, 20000, 20000);
+    f.feed(MB, 20000, 20000);
+    f.feed(MB, 20000, 45000);
+    f.feed(MB, 20000, 20000);
+    ASSERT_EQ(f.cc.state(), CongestionState::ProbeBw);
+
+    // The base RTT is not seen again for over 10s: drop to half rate to measure it.
+    bool probed = false;
+    for (int i = 0; i < 44 && !probed; i++)
+    {
+        uint64_t rate = f.feed(MB, 25000, 25000);
+        probed = f.cc.state() == CongestionState::ProbeRtt;
+        if (probed)
+        {
+            EXPECT_EQ(rate, 2 * MB);
+        }
+    }
+    ASSERT_TRUE(probed);
+    f.feed(MB, 25000, 25000);
+    EXPECT_EQ(f.cc.state(), CongestionState::ProbeBw);
+}
+
+TEST(VcCongestionControllerTest, UnpacedWithoutRttData)
+{
+    Feeder f;
+    for (int i = 0; i < 10; i++)
+        EXPECT_EQ(f.feed(MB, 0, 0), 0u);
+    EXPECT_EQ(f.cc.state(), CongestionState::Startup);
+}
@@ -1,5 +1,6 @@
 #include "Log.h"
 #include "Socket.h"
+#include "TcpVCIoThread.h"
 #include "TcpVirtualChannel.h"
 #include <algorithm>
 #include <condition_variable>
@@ -7,6 +8,7 @@
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
+#include <map>
 
 // Test fixture for TcpVirtualChannel
 class TcpVirtualChannelTest : public ::testing::Test
@@ -229,9 +231,9 @@ TEST_F(TcpVirtualChannelTest, processReceivedDataTest)
     {
         // instead of sending via channel, directly call processReceivedData to simulate out-of-order
         log_info("Simulating out-of-order message reception");
-        serverChannel->processReceivedData(2, std::make_shared<std::vector<char>>(data3, data3 + size3), 0);
-        serverChannel->processReceivedData(0, std::make_shared<std::vector<char>>(data1, data1 + size1), 0);
-        serverChannel->processReceivedData(1, std::make_shared<std::vector<char>>(data2, data2 + size2), 0);
+        serverChannel->processReceivedData(2, PacketBuffer::copyOf(data3, size3), 0);
+        serverChannel->processReceivedData(0, PacketBuffer::copyOf(data1, size1), 0);
+        serverChannel->processReceivedData(1, PacketBuffer::copyOf(data2, size2), 0);
         std::cout << "Client thread finished simulating out-of-order messages" << std::endl;
     });
 
@@ -258,8 +260,8 @@ TEST_F(TcpVirtualChannelTest, DuplicateMessageDropTest)
     clientChannel->open();
 
     // Send same messageId=0 twice
-    serverChannel->processReceivedData(0, std::make_shared<std::vector<char>>(data1, data1 + size1), 0);
-    serverChannel->processReceivedData(0, std::make_shared<std::vector<char>>(data1, data1 + size1), 0);
+    serverChannel->processReceivedData(0, PacketBuffer::copyOf(data1, size1), 0);
+    serverChannel->processReceivedData(0, PacketBuffer::copyOf(data1, size1), 0);
 
     // Wait for async delivery thread to process
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -306,10 +308,10 @@ TEST_F(TcpVirtualChannelTest, OldMessageDropTest)
     clientChannel->open();
 
     // Deliver messages 0 and 1 in order
-    serverChannel->processReceivedData(0, std::make_shared<std::vector<char>>(data1, data1 + size1), 0);
-    serverChannel->processReceivedData(1, std::make_shared<std::vector<char>>(data2, data2 + size2), 0);
+    serverChannel->processReceivedData(0, PacketBuffer::copyOf(data1, size1), 0);
+    serverChannel->processReceivedData(1, PacketBuffer::copyOf(data2, size2), 0);
     // Now nextMessageId==2; sending messageId=0 again should be silently dropped
-    serverChannel->processReceivedData(0, std::make_shared<std::vector<char>>(dataOld, dataOld + sizeOld), 0);
+    serverChannel->processReceivedData(0, PacketBuffer::copyOf(dataOld, sizeOld), 0);
 
     // Wait for async delivery thread to process
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -359,7 +361,7 @@ TEST_F(TcpVirtualChannelTest, ReorderTimeoutTest)
     clientChannel->open();
 
     // Send messageId=1 (skipping 0) — gets buffered, gap timer starts
-    serverChannel->processReceivedData(1, std::make_shared<std::vector<char>>(data2, data2 + size2), 0);
+    serverChannel->processReceivedData(1, PacketBuffer::copyOf(data2, size2), 0);
 
     // Nothing should be delivered yet (waiting for messageId=0)
     ASSERT_EQ(callbackCount.load(), 0);
@@ -371,7 +373,7 @@ TEST_F(TcpVirtualChannelTest, ReorderTimeoutTest)
     ASSERT_EQ(callbackCount.load(), 1);
 
     // Send messageId=2 — delivered immediately since nextMessageId is now 2
-    serverChannel->processReceivedData(2, std::make_shared<std::vector<char>>(data3, data3 + size3), 0);
+    serverChannel->processReceivedData(2, PacketBuffer::copyOf(data3, size3), 0);
 
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
@@ -401,16 +403,16 @@ TEST_F(TcpVirtualChannelTest, ReorderTimeoutResetsAfterGapFilled)
     clientChannel->open();
 
     // Create first gap: send id=1 (missing id=0)
-    serverChannel->processReceivedData(1, std::make_shared<std::vector<char>>(data1, data1 + size1), 0);
+    serverChannel->processReceivedData(1, PacketBuffer::copyOf(data1, size1), 0);
     ASSERT_EQ(callbackCount.load(), 0);
 
     // Fill the gap quickly — both 0 and 1 delivered, timer clears
-    serverChannel->processReceivedData(0, std::make_shared<std::vector<char>>(data0, data0 + size0), 0);
+    serverChannel->processReceivedData(0, PacketBuffer::copyOf(data0, size0), 0);
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
     ASSERT_EQ(callbackCount.load(), 2);
 
     // Create second gap: send id=3 (missing id=2), fresh timer starts now
-    serverChannel->processReceivedData(3, std::make_shared<std::vector<char>>(data3, data3 + size3), 0);
+    serverChannel->processReceivedData(3, PacketBuffer::copyOf(data3, size3), 0);
     ASSERT_EQ(callbackCount.load(), 2);
 
     // Wait past the timeout — active thread fires automatically, skips id=2, delivers id=3
@@ -418,13 +420,47 @@ TEST_F(TcpVirtualChannelTest, ReorderTimeoutResetsAfterGapFilled)
     ASSERT_EQ(callbackCount.load(), 3);
 
     // Send id=4 — delivered immediately since nextMessageId is now 4
-    serverChannel->processReceivedData(4, std::make_shared<std::vector<char>>(data4, data4 + size4), 0);
+    serverChannel->processReceivedData(4, PacketBuffer::copyOf(data4, size4), 0);
 
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
     ASSERT_EQ(callbackCount.load(), 4);
 }
 
+// Without a fixed timeout the reorder timeout follows how fast gaps fill: after a
+// gap fills in ~50ms, the next unfillable gap is skipped at the lower bound rather
+// than after the initial timeout.
+TEST_F(TcpVirtualChannelTest, AdaptiveReorderTimeoutFollowsGapFillTimes)
+{
+    std::atomic<int> callbackCount = 0;
+    serverChannel->setReceiveCallback([&](const char *, size_t) { callbackCount++; });
+    serverChannel->open();
+    clientChannel->open();
+    EXPECT_EQ(serverChannel->getNetworkScore().reorderTimeoutMs, 4000.0);
+
+    const char *data = "msg";
+    serverChannel->processReceivedData(1, PacketBuffer::copyOf(data, strlen(data) + 1), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    serverChannel->processReceivedData(0, PacketBuffer::copyOf(data, strlen(data) + 1), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(callbackCount.load(), 2);
+    EXPECT_EQ(serverChannel->getReorderTimeoutStats().samples.load(), 1u);
+    EXPECT_EQ(serverChannel->getGapStats().reorderFills.load(), 1u); // filled before any NACK
+    EXPECT_EQ(serverChannel->getNetworkScore().reorderTimeoutMs, 300.0);
+
+    // id=2 never arrives: id=3 is delivered after ~300ms, long before 4000ms.
+    serverChannel->processReceivedData(3, PacketBuffer::copyOf(data, strlen(data) + 1), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(700));
+    EXPECT_EQ(callbackCount.load(), 3);
+
+    // id=2 turns up after all: the timeout was too short, and grows past its delay.
+    serverChannel->processReceivedData(2, PacketBuffer::copyOf(data, strlen(data) + 1), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(callbackCount.load(), 3);
+    EXPECT_EQ(serverChannel->getReorderTimeoutStats().lateFills.load(), 1u);
+    EXPECT_GT(serverChannel->getNetworkScore().reorderTimeoutMs, 800.0);
+}
+
 // Test that send path handles partial TCP writes correctly.
 // With non-blocking sockets and small send buffers, send() can return fewer bytes
 // than requested. If the send thread doesn't retry the remaining bytes, the receiver
@@ -462,6 +498,9 @@ TEST_F(TcpVirtualChannelTest, PartialSendHandledCorrectly)
     };
     serverChannel->setReceiveCallback(recvCallback);
     serverChannel->open();
+    // The burst stands in the send queue for seconds behind the 2KB buffer. Keep CoDel
+    // from dropping any of it within the test's 30s window: this test is about framing.
+    clientChannel->setQueueDelayTarget(std::chrono::seconds(60), std::chrono::seconds(60));
     clientChannel->open();
 
     // Send max-size packets through the channel rapidly.
@@ -478,7 +517,7 @@ TEST_F(TcpVirtualChannelTest, PartialSendHandledCorrectly)
     // Wait for all packets or corruption
     {
         std::unique_lock<std::mutex> lock(receivedMutex);
-        receivedCv.wait_for(lock, std::chrono::seconds(15),
+        receivedCv.wait_for(lock, std::chrono::seconds(30),
                             [&] { return callbackCount.load() >= numPackets || corrupted.load(); });
     }
 
@@ -487,6 +526,112 @@ TEST_F(TcpVirtualChannelTest, PartialSendHandledCorrectly)
         << "Not all packets received. Got " << callbackCount.load() << "/" << numPackets;
 }
 
+// The same backlog with the default CoDel target: the queue stands far above 5ms, so
+// frames are dropped instead of delivered late. Every frame is either delivered or
+// counted as a CoDel drop.
+TEST_F(TcpVirtualChannelTest, CoDelDropsFromStandingQueue)
+{
+    int sendBufSize = 2048;
+    setsockopt(clientSocket, SOL_SOCKET, SO_SNDBUF, (const char *)&sendBufSize, sizeof(sendBufSize));
+    int recvBufSize = 2048;
+    setsockopt(serverAcceptedSocket, SOL_SOCKET, SO_RCVBUF, (const char *)&recvBufSize, sizeof(recvBufSize));
+
+    const int numPackets = 200;
+    std::atomic<int> callbackCount{0};
+    serverChannel->setReceiveCallback([&](const char *, size_t) { callbackCount++; });
+    serverChannel->open();
+    clientChannel->open();
+
+    std::vector<char> payload(2000, 'A');
+    for (int i = 0; i < numPackets; i++)
+        clientChannel->send(payload.data(), payload.size());
+
+    const auto &stats = clientChannel->getFlowQueueStats();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(15);
+    while (std::chrono::steady_clock::now() < deadline &&
+           callbackCount.load() + static_cast<int>(stats.codelDrops.load()) < numPackets)
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    EXPECT_GT(stats.codelDrops.load(), 0u);
+    EXPECT_EQ(stats.bulkDrops.load() + stats.priorityDrops.load(), 0u);
+    EXPECT_EQ(callbackCount.load() + static_cast<int>(stats.codelDrops.load()), numPackets);
+}
+
+// Frames received straight into allocateSendFrame() buffers are sent without a payload
+// copy; frames without headroom still go through. Both must arrive intact and in order.
+TEST_F(TcpVirtualChannelTest, SendFrameDeliversPayload)
+{
+    std::vector<std::string> received;
+    std::mutex receivedMutex;
+    std::condition_variable receivedCv;
+
+    serverChannel->setReceiveCallback([&](const char *recvData, size_t recvSize) {
+        {
+            std::lock_guard<std::mutex> lock(receivedMutex);
+            received.emplace_back(recvData, recvSize);
+        }
+        receivedCv.notify_all();
+    });
+    serverChannel->open();
+    clientChannel->open();
+
+    const std::string first = "zero-copy frame";
+    auto frame = VirtualChannel::allocateSendFrame();
+    ASSERT_GE(frame.headroom(), sizeof(VCDataPacket));
+    ASSERT_GT(frame.size(), static_cast<size_t>(VC_MAX_DATA_PAYLOAD_SIZE));
+    std::memcpy(frame.data(), first.data(), first.size());
+    frame.resize(first.size());
+    clientChannel->sendFrame(std::move(frame));
+
+    const std::string second = "no headroom";
+    clientChannel->sendFrame(PacketBuffer::copyOf(second.data(), second.size()));
+
+    {
+        std::unique_lock<std::mutex> lock(receivedMutex);
+        receivedCv.wait_for(lock, std::chrono::seconds(5), [&] { return received.size() >= 2; });
+    }
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_EQ(received[0], first);
+    EXPECT_EQ(received[1], second);
+}
+
+// More traffic than the read ring holds, so some frames wrap the ring boundary and
+// still reach the callback as contiguous views through the mirrored mapping.
+TEST_F(TcpVirtualChannelTest, PayloadsWrappingReceiveRingArriveIntact)
+{
+    const int count = 200;
+    const size_t payloadSize = 1500;
+    std::vector<std::string> received;
+    std::mutex receivedMutex;
+    std::condition_variable receivedCv;
+
+    serverChannel->setReceiveCallback([&](const char *recvData, size_t recvSize) {
+        {
+            std::lock_guard<std::mutex> lock(receivedMutex);
+            received.emplace_back(recvData, recvSize);
+        }
+        receivedCv.notify_all();
+    });
+    serverChannel->open();
+    clientChannel->open();
+
+    std::vector<std::string> sent;
+    for (int i = 0; i < count; i++)
+    {
+        sent.emplace_back(payloadSize, static_cast<char>('a' + i % 26));
+        std::memcpy(sent.back().data(), &i, sizeof(i));
+        clientChannel->send(sent.back().data(), sent.back().size());
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(receivedMutex);
+        receivedCv.wait_for(lock, std::chrono::seconds(10), [&] { return received.size() >= sent.size(); });
+    }
+    ASSERT_EQ(received.size(), sent.size());
+    for (int i = 0; i < count; i++)
+        EXPECT_EQ(received[i], sent[i]) << "payload " << i;
+}
+
 // Direct proof that non-blocking TCP send() can return partial writes under backpressure.
 // This verifies the premise that the send thread MUST handle partial sends.
 TEST(PartialSendTest, NonBlockingSendCanReturnPartial)
@@ -600,6 +745,96 @@ static std::pair<SocketFd, SocketFd> MakeSocketPair(int &portOut)
     return {clientFd, serverFd};
 }
 
+// A read ring pinned full by held payload views resumes reading as soon as the views
+// are released, not on the IO thread's next 50ms poll timeout.
+TEST(ReceiveRingBackpressureTest, ReadingResumesPromptlyAfterViewsReleased)
+{
+#ifdef _WIN32
+    WSAData wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    int port = 0;
+    auto [c0, s0] = MakeSocketPair(port);
+    auto conn = std::make_shared<TcpConnection>(s0);
+    auto table = std::make_shared<SharedConnectionTable>(ConnectionTable{{conn}, {}, {}});
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<TcpVCIoThread::DataFrame> held;
+    bool hold = true;
+    uint64_t batches = 0;
+    auto lastBatch = std::chrono::steady_clock::now();
+
+    TcpVCIoThread io(
+        table,
+        [&](int, std::vector<TcpVCIoThread::DataFrame> &frames) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (hold)
+                std::move(frames.begin(), frames.end(), std::back_inserter(held));
+            batches++;
+            lastBatch = std::chrono::steady_clock::now();
+            cv.notify_all();
+        },
+        nullptr, nullptr, nullptr, nullptr);
+    io.start();
+
+    // Several ringfuls of DATA frames; whatever the ring cannot take waits in the socket.
+    const int frameCount = static_cast<int>(4 * ReceiveRing::DEFAULT_SIZE / VC_MAX_DATA_PAYLOAD_SIZE);
+    std::thread sender([&] {
+        std::vector<char> frame(sizeof(VCDataPacket) + VC_MAX_DATA_PAYLOAD_SIZE, 'r');
+        auto *pkt = reinterpret_cast<VCDataPacket *>(frame.data());
+        pkt->header.type = VcPacketType::DATA;
+        pkt->dataLength = VC_MAX_DATA_PAYLOAD_SIZE;
+        for (int i = 0; i < frameCount; i++)
+        {
+            pkt->header.messageId = static_cast<uint64_t>(i);
+            if (SendTcpData(c0, frame.data(), frame.size(), 0) <= 0)
+                return;
+        }
+    });
+
+    for (int round = 0; round < 3; round++)
+    {
+        std::vector<TcpVCIoThread::DataFrame> release;
+        uint64_t batchesBefore;
+        {
+            // Full ring: no new batches for a while although the sender has more. Release
+            // half-way through a poll interval, where a timeout-only resume would take ~25ms.
+            std::unique_lock<std::mutex> lock(mtx);
+            while (std::chrono::steady_clock::now() - lastBatch < std::chrono::milliseconds(150))
+                cv.wait_for(lock, std::chrono::milliseconds(150));
+            lock.unlock();
+            std::this_thread::sleep_until(lastBatch + std::chrono::milliseconds(175));
+            lock.lock();
+            ASSERT_FALSE(held.empty());
+            release.swap(held);
+            batchesBefore = batches;
+        }
+
+        auto releasedAt = std::chrono::steady_clock::now();
+        release.clear();
+
+        std::unique_lock<std::mutex> lock(mtx);
+        ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(1), [&] { return batches > batchesBefore; }));
+        auto resumeMs = std::chrono::duration_cast<std::chrono::milliseconds>(lastBatch - releasedAt).count();
+        EXPECT_LT(resumeMs, 10) << "round " << round;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        hold = false;
+        held.clear();
+    }
+    sender.join();
+    io.stop();
+    SocketClose(c0);
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
 TEST(PartialDisconnectTest, VcStaysOpenWhenOneConnectionDrops)
 {
 #ifdef _WIN32
@@ -643,6 +878,71 @@ TEST(PartialDisconnectTest, VcStaysOpenWhenOneConnectionDrops)
 #endif
 }
 
+#ifndef _WIN32
+// A data connection stuck with a frame partly written is dropped and its frames are
+// re-sent on the other one. The partly written frame must be re-sent once, not once as
+// the rescue copy and again when the dropped slot's queue is reclaimed. Unix socket
+// pairs have no TCP_INFO, so the stall is found by PARTIAL_SEND_BUDGET_MS rather than
+// by ACK silence.
+TEST(StallRescueTest, PartlyWrittenFrameIsRescuedOnce)
+{
+    int pair0[2], pair1[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair0), 0);
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair1), 0);
+    const SocketFd c0 = pair0[0], s0 = pair0[1], c1 = pair1[0], s1 = pair1[1];
+    // s0 is never read, so with a small buffer connection 0 soon holds a frame it has
+    // only partly written.
+    SocketSetSendBufferSize(c0, 4096);
+
+    auto vc = std::make_shared<TcpVirtualChannel>(std::vector<SocketFd>{c0, c1});
+    vc->open();
+
+    std::vector<char> payload(VC_MAX_DATA_PAYLOAD_SIZE, 'p');
+    for (int i = 0; i < 100; i++)
+        vc->send(payload.data(), payload.size());
+
+    // Read connection 1 past the stall budget, while connection 0's frames move over.
+    SetSocketNonBlocking(s1);
+    std::vector<char> wire;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(5000);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        char buf[16384];
+        ssize_t n = RecvTcpDirect(s1, buf, sizeof(buf), 0);
+        if (n > 0)
+            wire.insert(wire.end(), buf, buf + n);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    auto dead = vc->getDeadSlots();
+    ASSERT_TRUE(std::find(dead.begin(), dead.end(), 0) != dead.end())
+        << "connection 0 should have been dropped with a frame partly written";
+    EXPECT_EQ(vc->getSendWriteStats().stallRescues.load(), 1u);
+
+    std::map<uint64_t, int> copies;
+    size_t pos = 0;
+    while (wire.size() - pos >= sizeof(VCDataPacket))
+    {
+        VCDataPacket pkt;
+        std::memcpy(&pkt, wire.data() + pos, sizeof(pkt));
+        ASSERT_EQ(pkt.header.type, VcPacketType::DATA) << "at offset " << pos;
+        if (wire.size() - pos < sizeof(VCDataPacket) + pkt.dataLength)
+            break;
+        copies[pkt.header.messageId]++;
+        pos += sizeof(VCDataPacket) + pkt.dataLength;
+    }
+    ASSERT_FALSE(copies.empty());
+    for (const auto &[messageId, n] : copies)
+        EXPECT_EQ(n, 1) << "messageId " << messageId;
+
+    vc->close();
+    SocketClose(c1);
+    SocketClose(s0);
+    SocketClose(s1);
+}
+#endif
+
 TEST(PartialDisconnectTest, AllDeadTriggersDisconnectCallback)
 {
 #ifdef _WIN32
@@ -960,3 +1260,338 @@ TEST_F(ReplaceConnectionCascadeTest, DataFlowSurvivesReplace)
     EXPECT_TRUE(vc->isOpen()) << "VC must still be open after data flow test";
     EXPECT_TRUE(ExpectOnlyTheseSlotsDead({})) << "No slots should be dead after replacements and data flow";
 }
+
+// ---------------------------------------------------------------------------
+// Control lane: MISSING_RANGES goes out through the send thread's priority queue
+// ---------------------------------------------------------------------------
+
+TEST(ControlLaneTest, MissingNotifyReachesPeer)
+{
+#ifdef _WIN32
+    WSAData wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    int port = 0;
+    auto [c0, s0] = MakeSocketPair(port);
+    auto vc = std::make_shared<TcpVirtualChannel>(std::vector<SocketFd>{c0});
+    vc->setAcks(true);
+    vc->open();
+
+    // A gap at messageId 0: the reorder thread reports it after the notify interval.
+    const char *payload = "message id1";
+    vc->processReceivedData(1, PacketBuffer::copyOf(payload, strlen(payload) + 1), 0);
+
+    SetSocketNonBlocking(s0);
+    std::vector<char> wire;
+    bool found = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (!found && std::chrono::steady_clock::now() < deadline)
+    {
+        char buf[4096];
+        ssize_t n = RecvTcpDirect(s0, buf, sizeof(buf), 0);
+        if (n > 0)
+            wire.insert(wire.end(), buf, buf + n);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        // Besides the notify, only ACKs for the frame received are sent on this channel.
+        while (wire.size() >= sizeof(VCAck) && static_cast<VcPacketType>(wire[0]) == VcPacketType::ACK)
+            wire.erase(wire.begin(), wire.begin() + sizeof(VCAck));
+        const size_t minSize = VC_MIN_MISSING_RANGES_SIZE + sizeof(VCMissingRange);
+        if (wire.size() >= minSize && static_cast<VcPacketType>(wire[0]) != VcPacketType::ACK)
+        {
+            VCHeader header;
+            std::memcpy(&header, wire.data(), sizeof(header));
+            VCMissingRange range;
+            std::memcpy(&range, wire.data() + VC_MIN_MISSING_RANGES_SIZE, sizeof(range));
+            EXPECT_EQ(header.type, VcPacketType::MISSING_RANGES);
+            EXPECT_EQ(static_cast<uint8_t>(wire[sizeof(VCHeader)]), 1);
+            EXPECT_EQ(header.messageId + range.offset, 0u);
+            EXPECT_EQ(range.count, 1u);
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found) << "MISSING_RANGES for messageId 0 never reached the peer";
+
+    vc->close();
+    SocketClose(c0);
+    SocketClose(s0);
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+// Until the peer is known to parse MISSING_RANGES the gap goes out as MISSING_NOTIFY,
+// 64 IDs per frame.
+TEST(ControlLaneTest, MissingNotifyForPeerWithoutRanges)
+{
+#ifdef _WIN32
+    WSAData wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    int port = 0;
+    auto [c0, s0] = MakeSocketPair(port);
+    auto vc = std::make_shared<TcpVirtualChannel>(std::vector<SocketFd>{c0});
+    vc->open();
+
+    // 0-69 missing.
+    const char *payload = "message id70";
+    vc->processReceivedData(70, PacketBuffer::copyOf(payload, strlen(payload) + 1), 0);
+
+    SetSocketNonBlocking(s0);
+    std::vector<char> wire;
+    std::vector<uint64_t> ids;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (ids.size() < 70 && std::chrono::steady_clock::now() < deadline)
+    {
+        char buf[4096];
+        ssize_t n = RecvTcpDirect(s0, buf, sizeof(buf), 0);
+        if (n > 0)
+            wire.insert(wire.end(), buf, buf + n);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        while (wire.size() > sizeof(VCHeader))
+        {
+            ASSERT_EQ(static_cast<VcPacketType>(wire[0]), VcPacketType::MISSING_NOTIFY);
+            const size_t count = static_cast<uint8_t>(wire[sizeof(VCHeader)]);
+            const size_t size = sizeof(VCHeader) + 1 + count * sizeof(uint64_t);
+            if (wire.size() < size)
+                break;
+            EXPECT_EQ(count, ids.empty() ? VC_MAX_MISSING_IDS_PER_NOTIFY : 6u);
+            for (size_t i = 0; i < count; i++)
+            {
+                uint64_t id;
+                std::memcpy(&id, wire.data() + sizeof(VCHeader) + 1 + i * sizeof(uint64_t), sizeof(id));
+                ids.push_back(id);
+            }
+            wire.erase(wire.begin(), wire.begin() + size);
+        }
+    }
+    ASSERT_EQ(ids.size(), 70u);
+    for (uint64_t id = 0; id < 70; id++)
+        EXPECT_EQ(ids[id], id);
+
+    vc->close();
+    SocketClose(c0);
+    SocketClose(s0);
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Acknowledgements
+// ---------------------------------------------------------------------------
+
+TEST(AckTest, ReceiverReportsWatermarkAndSack)
+{
+#ifdef _WIN32
+    WSAData wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    int port = 0;
+    auto [c0, s0] = MakeSocketPair(port);
+    auto vc = std::make_shared<TcpVirtualChannel>(std::vector<SocketFd>{c0});
+    vc->setMissingNotifyCallback([](const std::vector<MissingRange> &) {});
+    vc->setAcks(true);
+    vc->open();
+
+    // 0, 1 and 3 arrive: 0-1 are delivered, 2 is missing, 3 is buffered.
+    for (uint64_t id : {0, 1, 3})
+    {
+        std::string payload = "message " + std::to_string(id);
+        vc->processReceivedData(id, PacketBuffer::copyOf(payload.c_str(), payload.size() + 1), 0);
+    }
+
+    SetSocketNonBlocking(s0);
+    std::vector<char> wire;
+    VCAck last{};
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (last.header.messageId != 2 && std::chrono::steady_clock::now() < deadline)
+    {
+        char buf[4096];
+        ssize_t n = RecvTcpDirect(s0, buf, sizeof(buf), 0);
+        if (n > 0)
+            wire.insert(wire.end(), buf, buf + n);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        while (wire.size() >= sizeof(VCAck))
+        {
+            ASSERT_EQ(static_cast<VcPacketType>(wire[0]), VcPacketType::ACK);
+            std::memcpy(&last, wire.data(), sizeof(VCAck));
+            wire.erase(wire.begin(), wire.begin() + sizeof(VCAck));
+        }
+    }
+    EXPECT_EQ(last.header.messageId, 2u);
+    EXPECT_EQ(last.sackBitmap[0], 1u); // watermark + 1 = 3
+    EXPECT_EQ(last.sackBitmap[1], 0u);
+
+    vc->close();
+    SocketClose(c0);
+    SocketClose(s0);
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+// An older peer would drop the stream on an ACK: none goes out until the peer sends one.
+TEST(AckTest, ReceiverAcksOnlyOncePeerDoes)
+{
+#ifdef _WIN32
+    WSAData wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    int port = 0;
+    auto [c0, s0] = MakeSocketPair(port);
+    auto vc = std::make_shared<TcpVirtualChannel>(std::vector<SocketFd>{c0});
+    vc->setMissingNotifyCallback([](const std::vector<MissingRange> &) {});
+    vc->open();
+
+    for (uint64_t id : {0, 1, 3})
+    {
+        std::string payload = "message " + std::to_string(id);
+        vc->processReceivedData(id, PacketBuffer::copyOf(payload.c_str(), payload.size() + 1), 0);
+    }
+
+    SetSocketNonBlocking(s0);
+    char buf[4096];
+    std::this_thread::sleep_for(VC_ACK_REPEAT_INTERVAL * 2);
+    EXPECT_LE(RecvTcpDirect(s0, buf, sizeof(buf), 0), 0);
+
+    VCAck peerAck{};
+    peerAck.header = VCHeader{VcPacketType::ACK, 0};
+    vc->processAck(peerAck);
+    ssize_t n = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while ((n = RecvTcpDirect(s0, buf, sizeof(buf), 0)) <= 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_GE(n, static_cast<ssize_t>(sizeof(VCAck)));
+    EXPECT_EQ(static_cast<VcPacketType>(buf[0]), VcPacketType::ACK);
+
+    vc->close();
+    SocketClose(c0);
+    SocketClose(s0);
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+TEST(AckTest, SenderReleasesAckedAndRetransmitsTheRest)
+{
+#ifdef _WIN32
+    WSAData wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    int port = 0;
+    auto [c0, s0] = MakeSocketPair(port);
+    auto vc = std::make_shared<TcpVirtualChannel>(std::vector<SocketFd>{c0});
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<uint64_t> resent;
+    vc->setResendCallback([&](uint64_t messageId, const char *, size_t) {
+        std::lock_guard<std::mutex> lock(mtx);
+        resent.push_back(messageId);
+        cv.notify_all();
+    });
+    vc->open();
+
+    for (int i = 0; i < 3; i++)
+    {
+        std::string msg = "message " + std::to_string(i);
+        vc->send(msg.c_str(), msg.size() + 1);
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (vc->getAckStats().writes.load() < 3 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_EQ(vc->getAckStats().writes.load(), 3u);
+
+    // The peer has 0 and 2: 0 leaves the cache, 2 only stops its timer, 1 times out.
+    VCAck ack{};
+    ack.header = VCHeader{VcPacketType::ACK, 1};
+    ack.sackBitmap[0] = 1; // ID 2
+    vc->processAck(ack);
+    EXPECT_EQ(vc->getAckStats().acked.load(), 2u);
+    EXPECT_EQ(vc->getAckStats().inFlight.load(), 1u);
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(3), [&] { return !resent.empty(); }));
+        EXPECT_EQ(resent.front(), 1u);
+    }
+    EXPECT_GE(vc->getAckStats().retransmits.load(), 1u);
+
+    vc->close();
+    SocketClose(c0);
+    SocketClose(s0);
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// MISSING_RANGES: one range asks for every ID in a run, each resent once
+// ---------------------------------------------------------------------------
+
+TEST(MissingRangesTest, SenderResendsEveryIdInRanges)
+{
+#ifdef _WIN32
+    WSAData wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    int port = 0;
+    auto [c0, s0] = MakeSocketPair(port);
+    auto vc = std::make_shared<TcpVirtualChannel>(std::vector<SocketFd>{c0});
+    std::mutex mtx;
+    std::vector<uint64_t> resent;
+    vc->setResendCallback([&](uint64_t messageId, const char *, size_t) {
+        std::lock_guard<std::mutex> lock(mtx);
+        resent.push_back(messageId);
+    });
+    vc->open();
+
+    for (int i = 0; i < 300; i++)
+    {
+        std::string msg = "message " + std::to_string(i);
+        vc->send(msg.c_str(), msg.size() + 1);
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (vc->getAckStats().writes.load() < 300 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_EQ(vc->getAckStats().writes.load(), 300u);
+
+    // Out of order on purpose; a repeat of the same ranges is already pending.
+    vc->processMissingRanges({{250, 5}, {10, 200}});
+    vc->processMissingRanges({{10, 200}, {250, 5}});
+
+    std::vector<uint64_t> ids;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ids = resent;
+    }
+    std::vector<uint64_t> expected;
+    for (uint64_t id = 10; id < 210; id++)
+        expected.push_back(id);
+    for (uint64_t id = 250; id < 255; id++)
+        expected.push_back(id);
+    // The retransmission timer may have resent some of them too, but not within the
+    // initial RTO.
+    EXPECT_EQ(ids, expected);
+
+    vc->close();
+    SocketClose(c0);
+    SocketClose(s0);
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}